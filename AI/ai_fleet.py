@@ -0,0 +1,211 @@
+import time
+import threading
+import numpy as np
+from concurrent.futures import ThreadPoolExecutor, Future, wait
+from typing import List, Tuple, Dict, Optional, Callable
+from Common.constants import AI_LEVELS, PIECE_COLORS
+from Common.logger import Logger
+from AI.base_ai import BaseAI
+from AI.minimax_ai import MinimaxAI
+from AI.mcts_ai import MCTSAI
+from AI.rl_ai import RLAI
+from AI.nn_ai import NNAI
+from Compute.cpp_interface import CppCore
+
+class SharedCandidates:
+    """共享候选点生成器（同一根局面只建一次搜索棋盘、每种(颜色, 威胁优先)只生成一次，成员AI共用）
+
+    AIFleet把同一份根局面快照交给所有成员，这里按对象身份识别根局面；其他局面（成员内部的派生局面）照常现算。
+    """
+    def __init__(self, cpp_core: CppCore):
+        self.cpp_core = cpp_core
+        self._lock = threading.Lock()
+        self._root: Optional[List[List[int]]] = None
+        self._root_board = None
+        self._cache: Dict[Tuple[int, bool], List[Tuple[int, int]]] = {}
+
+    def reset(self, board: List[List[int]]):
+        """设置本步的根局面（按身份比较，调用方之后不得修改该快照）"""
+        with self._lock:
+            self._root = board
+            self._root_board = self.cpp_core.create_search_board(board)
+            self._cache = {}
+
+    def __call__(self, board: List[List[int]], color: int, threat_first: bool = False) -> List[Tuple[int, int]]:
+        if board is not self._root:
+            return self.cpp_core.create_search_board(board).candidates(color, threat_first)
+        key = (color, threat_first)
+        with self._lock:
+            candidates = self._cache.get(key)
+            if candidates is None:
+                candidates = self._cache[key] = self._root_board.candidates(color, threat_first)
+        return list(candidates)
+
+    def ranked(self, color: int, limit: int) -> List[Tuple[int, int]]:
+        """根局面按进攻+防守得分排序的前limit个候选点（合并投票时的平票依据与兜底落子）"""
+        with self._lock:
+            return self._root_board.sorted_moves(color, limit)
+
+class AIFleet(BaseAI):
+    """多AI协同（专家级）：成员AI并发思考，到本步截止时间按已完成成员的投票合并，未完成的成员取消
+
+    - 成员在同一个线程池里同时运行，原生计算（MCTS树并行等）共用C++进程级线程池，不会超额订阅CPU；
+    - Minimax成员使用舰队的置换表，后台思考与下一手的搜索都能命中；
+    - 必胜检查/开局库在舰队层只做一次，候选点由SharedCandidates统一生成；
+    - 每步只有一个截止时间：成员拿到略早的截止时间自行收敛，舰队到点只统计已返回的结果，
+      其余成员调用cancel()尽快退出，下一次move/ponder开始前等它们收尾。
+    """
+    DEADLINE_MARGIN = 0.05  # 成员截止时间比舰队提前的秒数（留给结果返回与合并）
+    MEMBER_FACTORIES = {
+        'minimax': lambda fleet: MinimaxAI(fleet.color, fleet.level, tt=fleet.tt),
+        'mcts': lambda fleet: MCTSAI(fleet.color, fleet.level),
+        'rl': lambda fleet: RLAI(fleet.color, fleet.level),
+        'nn': lambda fleet: NNAI(fleet.color, fleet.level)
+    }
+    DEFAULT_WEIGHTS = {'minimax': 1.0, 'mcts': 1.0, 'rl': 0.8, 'nn': 0.6}
+
+    def __init__(self, color: int, level: str = AI_LEVELS['EXPERT']):
+        super().__init__(color, level)
+        self.logger = Logger.get_instance()
+        self.cpp_core = CppCore()
+        self.time_budget = self.config.get_float('AI', 'fleet_time_budget', 4.0)  # 每步总时间（秒）
+        self.tt = self.cpp_core.create_transposition_table(self.config.get_int('AI', 'tt_size_mb', 64))
+        self.candidates = SharedCandidates(self.cpp_core)
+        names = self.config.get_list('AI', 'fleet_members') or list(self.DEFAULT_WEIGHTS)
+        weights = [float(w) for w in self.config.get_list('AI', 'fleet_weights')]
+        self.members: Dict[str, BaseAI] = {}
+        self.weights: Dict[str, float] = {}
+        for i, name in enumerate(n.strip() for n in names):
+            factory = self.MEMBER_FACTORIES.get(name)
+            if factory is None:
+                self.logger.warning(f"未知的协同AI成员：{name}")
+                continue
+            member = factory(self)
+            member.candidate_source = self.candidates
+            self.members[name] = member
+            self.weights[name] = weights[i] if i < len(weights) else self.DEFAULT_WEIGHTS.get(name, 1.0)
+        self.executor = ThreadPoolExecutor(max_workers=max(len(self.members), 1), thread_name_prefix='ai_fleet')
+        self._stragglers: List[Future] = []  # 上一步被取消、尚未退出的成员任务
+        self._move_id = 0  # 当前步编号（丢弃过期成员的思维回调）
+        self._member_thinking: Dict[str, Dict] = {}  # 本步各成员最近一次的思维数据
+        self.logger.info(f"多AI协同初始化：成员{list(self.members)}，每步{self.time_budget}s，"
+                         f"原生线程池{self.cpp_core.thread_pool_size()}线程")
+
+    def _drain_stragglers(self):
+        """等待上一步被取消的成员退出（它们已收到cancel，通常很快返回），之后成员状态可安全复用"""
+        for future in self._stragglers:
+            try:
+                future.result()
+            except Exception:
+                pass
+        self._stragglers = []
+
+    def _run_member(self, name: str, member: BaseAI, board: List[List[int]], move_id: int) -> Tuple[int, int]:
+        def on_thinking(data: Dict):
+            # 成员的中间结果只记录，不直接推给界面（多个成员交替推送会互相覆盖）
+            if move_id == self._move_id:
+                self._member_thinking[name] = data
+        return member.move(board, on_thinking)
+
+    def move(self, board: List[List[int]], thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
+        """协同落子（成员并发，截止时间到即按已完成成员的加权投票合并）"""
+        self.thinking_callback = thinking_callback
+        self._drain_stragglers()
+        start_time = time.time()
+        deadline = start_time + self.time_budget
+
+        thinking_data = {
+            'scores': np.zeros((self.board_size, self.board_size)),
+            'best_move': (self.board_size//2, self.board_size//2),
+            'considering_moves': [],
+            'depth': 0,
+            'iteration': 0,
+            'members': {}
+        }
+        self._notify_thinking(thinking_data)
+
+        # 必胜检查与开局库只在舰队层做一次
+        winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
+        if winning_move:
+            thinking_data['best_move'] = winning_move
+            self._notify_thinking(thinking_data)
+            return winning_move
+        book_move = self._book_move(board)
+        if book_move:
+            thinking_data['best_move'] = book_move
+            self._notify_thinking(thinking_data)
+            return book_move
+
+        # 所有成员共用同一份根局面快照（SharedCandidates按身份命中缓存）
+        root = [row[:] for row in board]
+        self.candidates.reset(root)
+        self._move_id += 1
+        self._member_thinking = {}
+        futures: Dict[Future, str] = {}
+        for name, member in self.members.items():
+            member.deadline = deadline - self.DEADLINE_MARGIN
+            futures[self.executor.submit(self._run_member, name, member, root, self._move_id)] = name
+        done, pending = wait(futures, timeout=max(deadline - time.time(), 0.0))
+
+        # 未完成的成员取消，结果不再等待
+        for future in pending:
+            self.members[futures[future]].cancel()
+        self._stragglers = list(pending)
+
+        votes: Dict[Tuple[int, int], float] = {}
+        results: Dict[str, Tuple[int, int]] = {}
+        for future in done:
+            name = futures[future]
+            try:
+                move = tuple(future.result())
+            except Exception as e:
+                self.logger.error(f"协同AI成员{name}落子失败：{str(e)}")
+                continue
+            if root[move[0]][move[1]] != PIECE_COLORS['EMPTY']:
+                continue
+            results[name] = move
+            votes[move] = votes.get(move, 0.0) + self.weights[name]
+
+        # 平票按共享候选点的静态排序取先，无成员按时完成时直接取静态最优点
+        ranked = self.candidates.ranked(self.color, 15)
+        rank = {move: i for i, move in enumerate(ranked)}
+        if votes:
+            best_move = max(votes, key=lambda m: (votes[m], -rank.get(m, len(rank))))
+        else:
+            best_move = ranked[0] if ranked else self._get_empty_positions(root)[0]
+
+        total = sum(votes.values()) or 1.0
+        for (x, y), weight in votes.items():
+            thinking_data['scores'][x][y] = weight / total * 100
+        thinking_data['best_move'] = best_move
+        thinking_data['considering_moves'] = sorted(votes, key=lambda m: -votes[m])[:5]
+        thinking_data['depth'] = max((data.get('depth', 0) for data in self._member_thinking.values()), default=0)
+        thinking_data['members'] = results
+        self._notify_thinking(thinking_data)
+
+        self.logger.info(f"多AI协同落子：{best_move}，投票{results}，超时取消{[futures[f] for f in pending]}，"
+                         f"耗时{time.time() - start_time:.2f}s")
+        return best_move
+
+    def on_new_game(self):
+        """新对局开始：等上一步的成员收尾后逐个重置（Minimax成员清空共享置换表）"""
+        self._drain_stragglers()
+        for member in self.members.values():
+            member.on_new_game()
+
+    def ponder(self, board: List[List[int]], control) -> None:
+        """后台思考：依次让支持后台思考的成员在对手回合继续搜索（共享置换表/保留的搜索树下一手直接复用）"""
+        self._drain_stragglers()
+        for member in self.members.values():
+            if control.stopped:
+                break
+            member.deadline = None
+            member.ponder(board, control)
+
+    def shutdown(self):
+        """释放成员线程池"""
+        for future in self._stragglers:
+            future.cancel()
+        for member in self.members.values():
+            member.cancel()
+        self.executor.shutdown(wait=True)
@@ -12,12 +12,36 @@ class BaseAI(metaclass=abc.ABCMeta):
         self.config = Config.get_instance()
         self.board_size = self.config.board_size
         self.thinking_callback: Optional[Callable[[Dict], None]] = None  # 思维可视化回调
+        self.deadline: Optional[float] = None  # 外部指定的本步截止时间（time.time()，AIFleet协同时设置）
+        self.candidate_source: Optional[Callable] = None  # 共享候选点生成器（AIFleet成员共用，None时自行生成）
 
     @abc.abstractmethod
     def move(self, board: List[List[int]], thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
         """核心落子方法（必须实现）"""
         pass
 
+    def on_new_game(self):
+        """新对局开始时调用（清理跨回合保留的搜索状态，默认无操作）"""
+        pass
+
+    def cancel(self):
+        """让进行中的move尽快返回已有的最好结果（可从其他线程调用；默认把截止时间提前到现在）"""
+        self.deadline = 0.0
+
+    def ponder(self, board: List[List[int]], control) -> None:
+        """后台思考（board为己方落子后的局面，轮到对手；循环中调用control.yield_cpu()，返回True时尽快退出）。
+        默认不支持，直接返回"""
+        pass
+
+    def _book_move(self, board: List[List[int]]) -> Optional[Tuple[int, int]]:
+        """查开局库（规范化局面哈希，前若干步命中即直接落子，不再搜索）；未命中或未启用返回None"""
+        from AI.opening_book import OpeningBook
+        move = OpeningBook.get_instance(self.board_size).choose(board)
+        if move is not None:
+            from Common.logger import Logger
+            Logger.get_instance().info(f"{self.__class__.__name__}命中开局库：{move}")
+        return move
+
     def set_thinking_callback(self, callback: Optional[Callable[[Dict], None]]):
         """设置思维可视化回调"""
         self.thinking_callback = callback
@@ -41,4 +65,23 @@ class BaseAI(metaclass=abc.ABCMeta):
         from Compute.cpp_interface import CppCore
         cpp_core = CppCore()
         result = cpp_core.check_game_end(board, self.board_size)
-        return (result['is_end'] and result['winner'] == color, result['win_line'])
\ No newline at end of file
+        return (result['is_end'] and result['winner'] == color, result['win_line'])
+
+    def _is_win_from(self, board: List[List[int]], x: int, y: int, color: int, empty_count: Optional[int] = None) -> Tuple[bool, bool, List[Tuple[int, int]]]:
+        """增量检查color在(x,y)落子后是否获胜：返回(是否获胜, 是否终局, 获胜线)"""
+        from Compute.cpp_interface import CppCore
+        cpp_core = getattr(self, 'cpp_core', None) or CppCore()
+        result = cpp_core.check_game_end_from(board, x, y, color, empty_count)
+        return (result['winner'] == color, result['is_end'], result['win_line'])
+
+    def _get_candidates(self, board: List[List[int]], color: Optional[int] = None, threat_first: bool = False) -> List[Tuple[int, int]]:
+        """获取候选落子点（已有棋子2格以内的空位；threat_first时成五/堵四/堵活三优先）"""
+        if self.candidate_source is not None:
+            return self.candidate_source(board, color or self.color, threat_first)
+        return self._create_search_board(board).candidates(color or self.color, threat_first)
+
+    def _create_search_board(self, board: List[List[int]]):
+        """创建搜索用有状态棋盘（原地make/unmake，对接C++核心）"""
+        from Compute.cpp_interface import CppCore
+        cpp_core = getattr(self, 'cpp_core', None) or CppCore()
+        return cpp_core.create_search_board(board)
\ No newline at end of file
@@ -0,0 +1,136 @@
+import os
+import multiprocessing as mp
+from collections import deque
+from concurrent.futures import ProcessPoolExecutor
+from typing import Callable, Dict, Iterator, List, Optional, Tuple
+import numpy as np
+from Common.position_file import PositionReader, RESULT_CODES
+
+POPCOUNT = np.array([bin(i).count('1') for i in range(256)], dtype=np.uint16)  # 单字节置位数查表
+
+class OnlineStats:
+    """在线统计量（Welford均值/方差+最值，分块结果用Chan公式合并，内存与数据量无关）"""
+    def __init__(self, count: int = 0, mean: float = 0.0, m2: float = 0.0,
+                 minimum: float = float('inf'), maximum: float = float('-inf')):
+        self.count = count
+        self.mean = mean
+        self.m2 = m2
+        self.min = minimum
+        self.max = maximum
+
+    @classmethod
+    def from_values(cls, values: np.ndarray) -> 'OnlineStats':
+        if len(values) == 0:
+            return cls()
+        values = values.astype(np.float64)
+        mean = float(values.mean())
+        return cls(len(values), mean, float(((values - mean) ** 2).sum()), float(values.min()), float(values.max()))
+
+    @classmethod
+    def from_dict(cls, data: Dict) -> 'OnlineStats':
+        return cls(data['count'], data['mean'], data['m2'], data['min'], data['max'])
+
+    def to_dict(self) -> Dict:
+        return {'count': self.count, 'mean': self.mean, 'm2': self.m2, 'min': self.min, 'max': self.max}
+
+    def merge(self, other: 'OnlineStats') -> 'OnlineStats':
+        if other.count == 0:
+            return self
+        if self.count == 0:
+            self.count, self.mean, self.m2, self.min, self.max = other.count, other.mean, other.m2, other.min, other.max
+            return self
+        total = self.count + other.count
+        delta = other.mean - self.mean
+        self.mean += delta * other.count / total
+        self.m2 += other.m2 + delta * delta * self.count * other.count / total
+        self.count = total
+        self.min = min(self.min, other.min)
+        self.max = max(self.max, other.max)
+        return self
+
+    @property
+    def variance(self) -> float:
+        return self.m2 / self.count if self.count else 0.0
+
+# ------------------------------ 分块处理（在工作进程中执行，只接收路径和该块的meta条目） ------------------------------
+# 数据集路径 -> (meta.json的(mtime_ns, size), 读取器)；块的位置/长度随任务传入，读取器只提供棋盘大小与棋型表，
+# meta.json变化（追加分块、清理后整体替换）时重新加载
+_readers: Dict[str, Tuple[Tuple[int, int], PositionReader]] = {}
+
+def _meta_stamp(path: str) -> Tuple[int, int]:
+    stat = os.stat(os.path.join(path, 'meta.json'))
+    return stat.st_mtime_ns, stat.st_size
+
+def _chunk_records(path: str, chunk: Dict) -> Tuple[PositionReader, np.ndarray]:
+    stamp = _meta_stamp(path)
+    cached = _readers.get(path)
+    if cached is None or cached[0] != stamp:
+        cached = _readers[path] = (stamp, PositionReader(path))
+    reader = cached[1]
+    return reader, reader._load_chunk(chunk)
+
+def release_readers(path: Optional[str] = None):
+    """丢弃本进程缓存的读取器（path为None时全部丢弃）；删除或替换数据集目录前调用"""
+    if path is None:
+        _readers.clear()
+    else:
+        _readers.pop(path, None)
+
+def chunk_statistics(path: str, chunk: Dict) -> Dict:
+    """单块统计：得分/质量在线统计量、胜负平计数、棋型计数（按名称）、落子覆盖位图"""
+    reader, records = _chunk_records(path, chunk)
+    n = reader.board_size
+    pattern_counts = np.bincount(records['pattern'], minlength=len(reader.patterns))
+    result_counts = np.bincount(records['result'], minlength=3)
+    coverage = np.zeros(n * n, dtype=bool)
+    coverage[records['x'].astype(np.int64) * n + records['y']] = True
+    return {
+        'count': len(records),
+        'score': OnlineStats.from_values(records['score']),
+        'quality': OnlineStats.from_values(records['quality']),
+        'results': result_counts,
+        'patterns': {reader.patterns[i]: int(c) for i, c in enumerate(pattern_counts) if c},
+        'coverage': coverage
+    }
+
+def chunk_features(path: str, chunk: Dict, min_score: float, max_score: float, game_prefix: str) -> Dict[str, np.ndarray]:
+    """单块特征提取（全部向量化）：归一化得分、空位占比（位棋盘置位数查表）、结果标签"""
+    reader, records = _chunk_records(path, chunk)
+    cells = reader.board_size * reader.board_size
+    stones = POPCOUNT[records['black']].sum(axis=1) + POPCOUNT[records['white']].sum(axis=1)
+    if max_score > min_score:
+        normalized = (records['score'].astype(np.float64) - min_score) / (max_score - min_score)
+    else:
+        normalized = np.full(len(records), 0.5)
+    result_label = np.select([records['result'] == RESULT_CODES['win'], records['result'] == RESULT_CODES['lose']], [1.0, 0.0], 0.5)
+    patterns = np.array(reader.patterns + ['None'], dtype=object)
+    return {
+        'game_id': np.char.add(game_prefix, records['game'].astype(str)),
+        'x': records['x'].astype(np.int64),
+        'y': records['y'].astype(np.int64),
+        'color': records['color'].astype(np.int64),
+        'normalized_score': np.round(normalized, 4),
+        'quality': np.round(records['quality'].astype(np.float64), 2),
+        'empty_ratio': np.round((cells - stones) / cells, 4),
+        'pattern': patterns[np.minimum(records['pattern'], len(reader.patterns))],
+        'result_label': result_label,
+        'timestamp': records['timestamp']
+    }
+
+def map_chunks(tasks: List[Tuple], fn: Callable, workers: int) -> Iterator:
+    """在工作进程池中按块执行fn(*task)，按提交顺序产出结果；同时在途的块数有上限，内存占用与块数无关"""
+    if workers <= 1 or len(tasks) <= 1:
+        for task in tasks:
+            yield fn(*task)
+        return
+    with ProcessPoolExecutor(max_workers=workers, mp_context=mp.get_context('spawn')) as executor:
+        pending = deque()
+        for task in tasks:
+            pending.append(executor.submit(fn, *task))
+            if len(pending) >= workers * 2:
+                yield pending.popleft().result()
+        while pending:
+            yield pending.popleft().result()
+
+def default_workers() -> int:
+    return max((os.cpu_count() or 1) - 1, 1)
@@ -1,5 +1,5 @@
 import numpy as np
-from typing import List, Tuple, Dict
+from typing import List, Tuple, Dict, Optional
 from Common.constants import PIECE_COLORS, EVAL_WEIGHTS
 from Common.logger import Logger
 from Compute.cpp_interface import CppCore
@@ -22,8 +22,12 @@ class BoardEvaluator:
                 # 距离天元越近，权重越高
                 dist = np.sqrt((x - center)**2 + (y - center)**2)
                 weights[x][y] = max(0.3, 1.0 - dist / (self.board_size / 2))
-        # 星位和天元额外加权
-        star_positions = [(3, 3), (3, 11), (7, 7), (11, 3), (11, 11)]
+        # 星位和天元额外加权（按棋盘尺寸计算：15路为(3,3)/(3,11)/(7,7)/(11,3)/(11,11)，19路另加边星）
+        edge = 3 if self.board_size >= 13 else 2
+        far = self.board_size - 1 - edge
+        star_positions = [(edge, edge), (edge, far), (center, center), (far, edge), (far, far)]
+        if self.board_size >= 19:
+            star_positions += [(edge, center), (center, edge), (center, far), (far, center)]
         for (x, y) in star_positions:
             weights[x][y] *= 1.2
         return weights
@@ -33,27 +37,19 @@ class BoardEvaluator:
         if self.cpp_core:
             # 调用C++核心识别棋型（高效）
             score = self.cpp_core.evaluate_move(board, x, y, color, EVAL_WEIGHTS)
-            # 根据得分判断棋型
-            if score >= EVAL_WEIGHTS['FIVE']:
-                return ('FIVE', score)
-            elif score >= EVAL_WEIGHTS['FOUR']:
-                return ('FOUR', score)
-            elif score >= EVAL_WEIGHTS['BLOCKED_FOUR']:
-                return ('BLOCKED_FOUR', score)
-            elif score >= EVAL_WEIGHTS['THREE']:
-                return ('THREE', score)
-            elif score >= EVAL_WEIGHTS['BLOCKED_THREE']:
-                return ('BLOCKED_THREE', score)
-            elif score >= EVAL_WEIGHTS['TWO']:
-                return ('TWO', score)
-            elif score >= EVAL_WEIGHTS['BLOCKED_TWO']:
-                return ('BLOCKED_TWO', score)
-            else:
-                return ('ONE', score)
+            return (self.pattern_from_score(score), score)
         else:
             # Python降级实现
             return self._python_recognize_pattern(board, x, y, color)
 
+    @staticmethod
+    def pattern_from_score(score: float) -> str:
+        """根据落子棋型得分（四个方向之和）判断棋型"""
+        for pattern in ('FIVE', 'FOUR', 'BLOCKED_FOUR', 'THREE', 'BLOCKED_THREE', 'TWO', 'BLOCKED_TWO'):
+            if score >= EVAL_WEIGHTS[pattern]:
+                return pattern
+        return 'ONE'
+
     def _python_recognize_pattern(self, board: List[List[int]], x: int, y: int, color: int) -> Tuple[str, int]:
         """Python降级棋型识别"""
         directions = [(0, 1), (1, 0), (1, 1), (1, -1)]
@@ -113,7 +109,9 @@ class BoardEvaluator:
             return 'ONE'
 
     def evaluate_board(self, board: List[List[int]], color: int) -> float:
-        """评估整个棋盘的局势得分"""
+        """评估整个棋盘的局势得分（C++：9格窗口查表，15/19路走编译期特化的扫描）"""
+        if self.cpp_core:
+            return self.cpp_core.evaluate_board(board, color)
         total_score = 0.0
         for x in range(self.board_size):
             for y in range(self.board_size):
@@ -125,31 +123,42 @@ class BoardEvaluator:
                     total_score -= score
         return total_score
 
-    def evaluate_move(self, board: List[List[int]], x: int, y: int, color: int) -> float:
-        """评估单个落子的得分"""
-        # 模拟落子
+    def evaluate_delta(self, board: List[List[int]], x: int, y: int, color: int, search_board=None) -> float:
+        """落子前后的局势得分变化（C++只重算过该点四条线上受影响的窗口；可传入已有搜索棋盘复用）"""
+        if board[x][y] != PIECE_COLORS['EMPTY']:
+            # 已落子（如落子后复盘）：按拿掉该子前后的差值计算
+            board = [row.copy() for row in board]
+            board[x][y] = PIECE_COLORS['EMPTY']
+            search_board = None
+        if self.cpp_core:
+            search_board = search_board or self.cpp_core.create_search_board(board)
+            return search_board.evaluate_delta(x, y, color)
         temp_board = [row.copy() for row in board]
         temp_board[x][y] = color
-        # 计算落子后的局势得分变化
-        new_score = self.evaluate_board(temp_board, color)
-        old_score = self.evaluate_board(board, color)
-        return new_score - old_score + self.position_weights[x][y]
+        return self.evaluate_board(temp_board, color) - self.evaluate_board(board, color)
+
+    def evaluate_move(self, board: List[List[int]], x: int, y: int, color: int, weights: Optional[Dict[str, float]] = None, search_board=None) -> float:
+        """评估单个落子的得分（局势得分变化+位置权重；weights仅为兼容旧调用保留）"""
+        return self.evaluate_delta(board, x, y, color, search_board) + self.position_weights[x][y]
 
     def analyze_move_quality(self, board: List[List[int]], x: int, y: int, color: int) -> Dict:
         """分析落子质量（用于复盘）"""
         pattern, score = self._recognize_pattern(board, x, y, color)
         max_possible_score = 0.0
         best_move = (x, y)
-        # 查找最优落子
-        for nx in range(self.board_size):
-            for ny in range(self.board_size):
-                if board[nx][ny] == PIECE_COLORS['EMPTY']:
-                    temp_score = self.evaluate_move(board, nx, ny, color)
-                    if temp_score > max_possible_score:
-                        max_possible_score = temp_score
-                        best_move = (nx, ny)
+        # 查找最优落子（C++：整盘共用一块搜索棋盘，只评估候选点，每点查表O(4条线)）
+        search_board = self.cpp_core.create_search_board(board) if self.cpp_core else None
+        if search_board is not None:
+            positions = search_board.candidates(color)
+        else:
+            positions = [(nx, ny) for nx in range(self.board_size) for ny in range(self.board_size) if board[nx][ny] == PIECE_COLORS['EMPTY']]
+        for (nx, ny) in positions:
+            temp_score = self.evaluate_move(board, nx, ny, color, search_board=search_board)
+            if temp_score > max_possible_score:
+                max_possible_score = temp_score
+                best_move = (nx, ny)
         # 计算落子质量（0-100分）
-        move_score = self.evaluate_move(board, x, y, color)
+        move_score = self.evaluate_move(board, x, y, color, search_board=search_board)
         quality = min(100, (move_score / max_possible_score) * 100) if max_possible_score > 0 else 0
         return {
             'move': (x, y),
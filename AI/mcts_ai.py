@@ -1,33 +1,27 @@
+import time
 import random
+import threading
 import numpy as np
 from typing import List, Tuple, Dict, Optional, Callable
 from Common.constants import AI_LEVELS, EVAL_WEIGHTS, PIECE_COLORS
 from Common.logger import Logger
+from Common.metrics import SearchMetrics
 from AI.base_ai import BaseAI
 from Compute.cpp_interface import CppCore
-from Compute.parallel_compute import ParallelWorker
 
 class MCTSNode:
-    """MCTS节点类"""
-    def __init__(self, board: List[List[int]], parent: Optional['MCTSNode'] = None, move: Optional[Tuple[int, int]] = None, color: int = PIECE_COLORS['BLACK']):
-        self.board = board  # 节点对应的棋盘状态
+    """MCTS节点类（不保存棋盘，局面由搜索棋盘沿路径落子还原）"""
+    def __init__(self, untried_moves: List[Tuple[int, int]], parent: Optional['MCTSNode'] = None, move: Optional[Tuple[int, int]] = None, color: int = PIECE_COLORS['BLACK']):
         self.parent = parent  # 父节点
         self.move = move  # 到达该节点的落子
         self.color = color  # 当前落子玩家
         self.children: List['MCTSNode'] = []  # 子节点
         self.visits = 0  # 访问次数
         self.wins = 0  # 获胜次数
-        self.untried_moves = self._get_empty_positions(board)  # 未尝试落子
+        self.untried_moves = untried_moves  # 未尝试落子
         self.value = 0.0  # 节点价值
-
-    def _get_empty_positions(self, board: List[List[int]]) -> List[Tuple[int, int]]:
-        """获取空位置"""
-        empty_pos = []
-        for x in range(len(board)):
-            for y in range(len(board)):
-                if board[x][y] == PIECE_COLORS['EMPTY']:
-                    empty_pos.append((x, y))
-        return empty_pos
+        self.is_terminal = False  # 是否终局
+        self.winner = PIECE_COLORS['EMPTY']  # 终局时的获胜方（0为平局）
 
     def select(self, exploration_constant: float = 1.414) -> 'MCTSNode':
         """选择子节点（UCT算法）"""
@@ -39,33 +33,51 @@ class MCTSNode:
             return float('inf')
         return (self.wins / self.visits) + exploration_constant * np.sqrt(np.log(self.parent.visits) / self.visits)
 
-    def expand(self) -> 'MCTSNode':
-        """扩展节点（随机选择未尝试落子）"""
-        move = random.choice(self.untried_moves)
-        self.untried_moves.remove(move)
-        new_board = [row.copy() for row in self.board]
-        new_board[move[0]][move[1]] = self.color
+    def expand(self, search_board) -> 'MCTSNode':
+        """扩展节点（随机选择未尝试落子，在搜索棋盘上原地落子；子节点只展开候选点）"""
+        # 随机取出一个未尝试落子（与末尾交换后弹出，O(1)）
+        idx = random.randrange(len(self.untried_moves))
+        self.untried_moves[idx], self.untried_moves[-1] = self.untried_moves[-1], self.untried_moves[idx]
+        move = self.untried_moves.pop()
+        won = search_board.make_move(move[0], move[1], self.color)
         next_color = PIECE_COLORS['WHITE'] if self.color == PIECE_COLORS['BLACK'] else PIECE_COLORS['BLACK']
-        child_node = MCTSNode(new_board, self, move, next_color)
+        child_node = MCTSNode([] if won else search_board.candidates(next_color), self, move, next_color)
+        if won or search_board.empty_count() == 0:
+            child_node.is_terminal = True
+            child_node.winner = self.color if won else PIECE_COLORS['EMPTY']
         self.children.append(child_node)
         return child_node
 
     def backpropagate(self, result: float):
-        """回溯更新节点数据"""
-        self.visits += 1
-        self.wins += result
-        if self.parent:
-            self.parent.backpropagate(1 - result)  # 父节点结果反转
+        """回溯更新节点数据（逐层向上，父节点结果反转）"""
+        node = self
+        while node:
+            node.visits += 1
+            node.wins += result
+            result = 1 - result
+            node = node.parent
 
 class MCTSAI(BaseAI):
-    """MCTS蒙特卡洛树搜索AI（并行迭代）"""
+    """MCTS蒙特卡洛树搜索AI（C++引擎：连续节点池+无锁树并行；未编译扩展时使用Python MCTSNode单线程迭代）"""
+    PONDER_SLICE = 128  # 后台思考每片迭代次数（片间检查停止信号）
     def __init__(self, color: int, level: str = AI_LEVELS['HARD'], use_cpp: bool = True):
         super().__init__(color, level)
         self.logger = Logger.get_instance()
         self.cpp_core = CppCore() if use_cpp else None
         self.iterations = self._get_iterations()  # 迭代次数（适配难度）
+        self.playouts = 0  # 本步实际完成的模拟次数（不含复用子树已有的访问）
         self.exploration_constant = 1.414  # UCT探索常数
-        self.parallel_workers = self.config.get_int('AI', 'mcts_parallel_workers', 4)  # 并行工作线程数
+        self.parallel_workers = self.config.get_int('AI', 'mcts_parallel_workers', 4)  # C++搜索线程数
+        # 并行方式：tree为共享一棵树（虚拟损失），root为每线程独立建树后合并根节点统计
+        self.parallel_mode = self.config.get('AI', 'mcts_parallel_mode', 'tree')
+        self._root_board: List[List[int]] = []  # 本次搜索的根局面
+        # 树复用：己方落子+对方应手后把对应孙节点提升为新根，继续累加上一手的统计
+        self.tree_reuse = self.config.get_bool('AI', 'mcts_tree_reuse', True)
+        self._last_root: Optional[MCTSNode] = None  # 上一手搜索的根节点（Python实现）
+        self._last_root_board: List[List[int]] = []
+        self._thread_boards = threading.local()  # 线程私有搜索棋盘
+        # C++ MCTS引擎（节点池在多次搜索之间复用）
+        self.engine = self.cpp_core.create_mcts_engine(self.config.get_int('AI', 'mcts_arena_mb', 32)) if self.cpp_core else None
 
     def _get_iterations(self) -> int:
         """根据难度获取迭代次数"""
@@ -77,67 +89,73 @@ class MCTSAI(BaseAI):
         }
         return iter_map.get(self.level, 1000)
 
-    def _simulate(self, board: List[List[int]], current_color: int) -> float:
-        """模拟对局（快速rollout）"""
-        temp_board = [row.copy() for row in board]
-        while True:
-            # 检查游戏结束
-            win, _ = self._is_win(temp_board, self.color)
-            if win:
-                return 1.0
-            win, _ = self._is_win(temp_board, self.opponent_color)
-            if win:
-                return 0.0
-            # 检查平局
-            if not self._get_empty_positions(temp_board):
+    def _simulate(self, search_board, node: MCTSNode) -> float:
+        """模拟对局（快速rollout，结束后撤销全部模拟落子）"""
+        if node.is_terminal:
+            if node.winner == PIECE_COLORS['EMPTY']:
                 return 0.5
-            # 随机落子（C++加速棋型评估优化）
-            empty_pos = self._get_empty_positions(temp_board)
+            return 1.0 if node.winner == self.color else 0.0
+        current_color = node.color
+        played = 0
+        result = 0.5
+        while search_board.empty_count() > 0:
+            # 基于棋型评分选择落子（C++加速，提升模拟质量），否则随机落子
             if self.cpp_core:
-                # 基于棋型评分选择落子（提升模拟质量）
-                scores = [self.cpp_core.evaluate_move(temp_board, x, y, current_color, EVAL_WEIGHTS) for x, y in empty_pos]
-                best_idx = np.argmax(scores)
-                move = empty_pos[best_idx]
+                x, y = search_board.sorted_moves(current_color, 1)[0]
             else:
-                move = random.choice(empty_pos)
-            # 执行落子
-            temp_board[move[0]][move[1]] = current_color
+                x, y = random.choice(search_board.candidates(current_color))
+            won = search_board.make_move(x, y, current_color)
+            played += 1
+            if won:
+                result = 1.0 if current_color == self.color else 0.0
+                break
             current_color = PIECE_COLORS['WHITE'] if current_color == PIECE_COLORS['BLACK'] else PIECE_COLORS['BLACK']
+        for _ in range(played):
+            search_board.unmake_move()
+        return result
+
+    def _get_thread_board(self):
+        """获取当前线程的搜索棋盘（每个线程一块，迭代结束后回到根局面）"""
+        if not hasattr(self._thread_boards, 'board'):
+            self._thread_boards.board = self._create_search_board(self._root_board)
+        return self._thread_boards.board
 
     def _mcts_iteration(self, root: MCTSNode) -> None:
         """单次MCTS迭代（选择→扩展→模拟→回溯）"""
+        search_board = self._get_thread_board()
         node = root
+        path_length = 0
         # 选择：直到叶子节点
         while node.children and not node.untried_moves:
             node = node.select(self.exploration_constant)
+            search_board.make_move(node.move[0], node.move[1], node.parent.color)
+            path_length += 1
         # 扩展：如果不是终局节点
-        if not self._is_win(node.board, self.color)[0] and not self._is_win(node.board, self.opponent_color)[0] and self._get_empty_positions(node.board):
-            node = node.expand()
+        if not node.is_terminal and node.untried_moves:
+            node = node.expand(search_board)
+            path_length += 1
         # 模拟：获取结果
-        result = self._simulate(node.board, node.color)
+        result = self._simulate(search_board, node)
+        # 还原搜索棋盘到根局面
+        for _ in range(path_length):
+            search_board.unmake_move()
         # 回溯：更新节点
         node.backpropagate(result)
 
     def _parallel_iterations(self, root: MCTSNode, iterations: int) -> None:
-        """并行执行MCTS迭代"""
-        if self.parallel_workers <= 1:
-            # 单线程执行
-            for _ in range(iterations):
-                self._mcts_iteration(root)
-            return
-        # 多线程并行
-        worker = ParallelWorker(
-            target=self._mcts_iteration,
-            args=(root,),
-            num_workers=self.parallel_workers,
-            total_tasks=iterations
-        )
-        worker.run()
+        """执行MCTS迭代（Python实现受GIL限制，多线程没有加速，统计量也无同步，因此单线程执行；并行搜索由C++引擎完成）"""
+        for i in range(iterations):
+            # 有截止时间时每16次迭代检查一次（至少完成1次，保证根节点有子节点）
+            if i and i & 15 == 0 and self.deadline is not None and time.time() >= self.deadline:
+                break
+            self._mcts_iteration(root)
 
     def move(self, board: List[List[int]], thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
         """AI落子（并行MCTS+C++加速）"""
         self.thinking_callback = thinking_callback
-        root = MCTSNode(board, color=self.color)
+        self.playouts = 0
+        # C++引擎在共享原生线程池上搜索，线程计数会混入其他会话的搜索，改用引擎自身的计数
+        probe = SearchMetrics.get_instance().begin_move('mcts', thread_only=self.engine is None)
 
         # 思维可视化：初始化数据
         thinking_data = {
@@ -150,16 +168,40 @@ class MCTSAI(BaseAI):
         }
         self._notify_thinking(thinking_data)
 
-        # 检查必胜落子（C++快速判断）
+        # 检查必胜落子（C++威胁空间搜索：成五/VCF/VCT，命中则跳过整棵搜索）
         if self.cpp_core:
-            winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
+            with probe.phase('win_check'):
+                winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
             if winning_move:
                 thinking_data['best_move'] = winning_move
                 self._notify_thinking(thinking_data)
+                probe.finish(move=winning_move, source='win_check')
                 return winning_move
 
-        # 并行MCTS迭代
-        self._parallel_iterations(root, self.iterations)
+        # 查开局库（前若干步命中则直接落子，不占搜索预算）
+        with probe.phase('book'):
+            book_move = self._book_move(board)
+        if book_move:
+            thinking_data['best_move'] = book_move
+            self._notify_thinking(thinking_data)
+            probe.finish(move=book_move, source='book')
+            return book_move
+
+        if self.engine is not None:
+            return self._native_move(board, thinking_data, probe)
+
+        # 并行MCTS迭代（Python实现）
+        self._root_board = board
+        self._thread_boards = threading.local()
+        root = self._reuse_root(board) if self.tree_reuse else None
+        if root is None:
+            root = MCTSNode(self._get_thread_board().candidates(self.color, threat_first=True), color=self.color)
+        reused_visits = root.visits
+        with probe.phase('search'):
+            self._parallel_iterations(root, self.iterations)
+        self.playouts = root.visits - reused_visits
+        self._last_root = root
+        self._last_root_board = [row[:] for row in board]
 
         # 选择最佳落子（访问次数最多的子节点）
         best_node = max(root.children, key=lambda node: node.visits)
@@ -175,14 +217,133 @@ class MCTSAI(BaseAI):
         thinking_data['iteration'] = self.iterations
         self._notify_thinking(thinking_data)
 
+        expanded, children, tree_nodes, seldepth = self._tree_stats(root)
+        probe.finish(move=best_move, source='search', playouts=self.playouts, reused=reused_visits,
+                     depth=thinking_data['depth'], seldepth=seldepth, expanded=expanded, children=children,
+                     nodes=tree_nodes, nodes_allocated=tree_nodes)
+
         self.logger.info(f"MCTS AI落子：{best_move}，访问次数：{best_node.visits}/{root.visits}")
         return best_move
 
+    def on_new_game(self):
+        """新对局开始：丢弃上一局保留的搜索树"""
+        self._last_root = None
+        self._last_root_board = []
+        if self.engine is not None:
+            self.engine.clear()
+
+    def cancel(self):
+        """提前结束搜索（C++引擎在原生线程上收到停止信号，已完成的迭代照常计入）"""
+        super().cancel()
+        if self.engine is not None:
+            self.engine.stop()
+
+    def ponder(self, board: List[List[int]], control) -> None:
+        """后台思考：以对手为先手分片搜索当前局面（树复用会把上一手的对应子树接过来），
+        对手落子后move按孙节点复用这棵树（Python实现受GIL限制，不做后台思考）"""
+        if self.engine is None or not self.tree_reuse:
+            return
+        if self.cpp_core.check_game_end(board, self.board_size)['is_end']:
+            return  # 已终局：引擎不在根判胜负，搜下去只会反复回溯同样的结果
+        nodes, grown_visits = -1, 0  # 树最近一次增长后的节点数与当时的根访问次数
+        while self.engine.node_count() < self.engine.capacity() * 0.9:
+            move = self.engine.search(board, self.opponent_color, self.PONDER_SLICE, self.exploration_constant,
+                                      EVAL_WEIGHTS, random.getrandbits(64), 1, CppCore.MCTS_TREE_PARALLEL, True)
+            visits = self.engine.root_visits()
+            # 无子可下，或这一片没有增加根访问次数时，再搜也只是空转
+            if move is None or visits <= self.engine.reused_visits():
+                break
+            if self.engine.node_count() != nodes:
+                nodes, grown_visits = self.engine.node_count(), visits
+            elif visits - grown_visits > nodes:
+                break  # 模拟数超过节点数仍未扩展：未访问的叶子已走遍，其余路径都止于终局，树不会再长
+            if control.yield_cpu():
+                break
+        self.logger.info(f"MCTS后台思考：根访问次数{self.engine.root_visits()}")
+
+    def _reuse_root(self, board: List[List[int]]) -> Optional[MCTSNode]:
+        """在上一手的树中找到当前局面对应的节点（沿新增棋子逐层匹配子节点），找不到返回None"""
+        root = self._last_root
+        if root is None or len(self._last_root_board) != len(board):
+            return None
+        extra = set()
+        for x, row in enumerate(board):
+            for y, piece in enumerate(row):
+                old = self._last_root_board[x][y]
+                if old != PIECE_COLORS['EMPTY'] and old != piece:
+                    return None
+                if old == PIECE_COLORS['EMPTY'] and piece != PIECE_COLORS['EMPTY']:
+                    extra.add((x, y))
+        node = root
+        while extra:
+            to_move = node.color
+            node = next((child for child in node.children
+                         if child.move in extra and board[child.move[0]][child.move[1]] == to_move), None)
+            if node is None:
+                return None
+            extra.discard(node.move)
+        if node.color != self.color or node.visits == 0:
+            return None
+        node.parent = None  # 与兄弟分支断开，旧树其余部分随之释放
+        return node
+
+    def _native_move(self, board: List[List[int]], thinking_data: Dict, probe) -> Tuple[int, int]:
+        """C++引擎搜索（原生线程并行，释放GIL）；开启树复用时搜索树保留到下一手"""
+        mode = CppCore.MCTS_ROOT_PARALLEL if self.parallel_mode == 'root' else CppCore.MCTS_TREE_PARALLEL
+        # 有截止时间时按剩余时间限时（迭代次数仍是上限），线程取自进程共享的原生线程池
+        time_limit = max(self.deadline - time.time(), 1e-3) if self.deadline is not None else 0.0
+        with probe.phase('search'):
+            best_move = self.engine.search(board, self.color, self.iterations, self.exploration_constant, EVAL_WEIGHTS,
+                                           random.getrandbits(64), max(1, self.parallel_workers), mode,
+                                           self.tree_reuse, time_limit)
+        children = self.engine.root_children()
+        root_visits = self.engine.root_visits()
+        reused_visits = self.engine.reused_visits()
+        self.playouts = root_visits - reused_visits
+        depth = self.engine.max_depth()
+        stats = self.engine.search_stats()
+        if not self.tree_reuse:
+            self.engine.clear()
+        if best_move is None:
+            best_move = self._get_candidates(board)[0]
+
+        # 思维可视化：更新数据（与Python实现一致：前10个子节点的访问占比、前5个候选点）
+        for (x, y, visits, _) in children[:10]:
+            thinking_data['scores'][x][y] = visits / root_visits * 100
+        thinking_data['best_move'] = best_move
+        thinking_data['considering_moves'] = [(x, y) for (x, y, _, _) in children[:5]]
+        thinking_data['depth'] = depth
+        thinking_data['iteration'] = self.iterations
+        self._notify_thinking(thinking_data)
+
+        # 扩展次数、子节点数与节点池分配数取引擎本次搜索的计数（每个子节点占一个节点池节点）
+        probe.finish(move=best_move, source='search', playouts=self.playouts, reused=reused_visits,
+                     seldepth=depth, expanded=stats['expansions'], children=stats['children'],
+                     native_nodes=stats['children'])
+
+        best_visits = max((visits for (_, _, visits, _) in children), default=0)
+        self.logger.info(f"MCTS AI落子：{best_move}，访问次数：{best_visits}/{root_visits}（复用{reused_visits}）")
+        return best_move
+
     def _get_node_depth(self, node: MCTSNode) -> int:
-        """计算节点深度（用于可视化）"""
+        """主变例深度（沿访问次数最多的子节点下行，用于可视化与搜索统计）"""
         depth = 0
         current = node
         while current.children:
-            current = current.children[0]
+            current = max(current.children, key=lambda child: child.visits)
             depth += 1
-        return depth
\ No newline at end of file
+        return depth
+
+    def _tree_stats(self, root: MCTSNode) -> Tuple[int, int, int, int]:
+        """遍历搜索树：(已展开节点数, 子节点总数, 节点总数, 最大深度)"""
+        expanded = children = nodes = seldepth = 0
+        stack = [(root, 0)]
+        while stack:
+            node, depth = stack.pop()
+            nodes += 1
+            seldepth = max(seldepth, depth)
+            if node.children:
+                expanded += 1
+                children += len(node.children)
+                stack.extend((child, depth + 1) for child in node.children)
+        return expanded, children, nodes, seldepth
\ No newline at end of file
@@ -1,51 +1,70 @@
+import time
 import numpy as np
 from typing import List, Tuple, Dict, Optional, Callable
 from Common.constants import AI_LEVELS, EVAL_WEIGHTS, PIECE_COLORS
 from Common.logger import Logger
+from Common.metrics import SearchMetrics
 from AI.base_ai import BaseAI
 from Compute.cpp_interface import CppCore
+from Compute.transposition_table import BOUND_EXACT, BOUND_LOWER, BOUND_UPPER
+
+class _SearchTimeout(Exception):
+    """迭代加深单轮搜索超时（内部使用，由move捕获）"""
+    pass
 
 class MinimaxAI(BaseAI):
     """Minimax+Alpha-Beta剪枝AI（C++加速核心）"""
-    def __init__(self, color: int, level: str = AI_LEVELS['HARD'], use_cpp: bool = True):
+    WIN_SCORE = 1e8  # 成五评分（远高于任何静态评估，便于识别已分胜负）
+
+    def __init__(self, color: int, level: str = AI_LEVELS['HARD'], use_cpp: bool = True, tt=None):
         super().__init__(color, level)
         self.logger = Logger.get_instance()
         self.cpp_core = CppCore() if use_cpp else None
-        self.max_depth = self._get_max_depth()  # 动态深度适配难度
+        self.max_depth = self._get_max_depth()  # 迭代加深的深度上限（适配难度）
+        self.time_budget = self._get_time_budget()  # 每步思考时间预算（秒）
+        self.aspiration_window = EVAL_WEIGHTS['THREE']  # 渴望窗口半宽
         self.alpha = -float('inf')
         self.beta = float('inf')
         self.best_move: Tuple[int, int] = (0, 0)
-        self.eval_cache = {}  # 评估缓存（减少重复计算）
+        self.nodes = 0  # 本步已搜索节点数
+        # 本步搜索统计：置换表探查/命中/截断、展开节点数与实际搜索的子节点数（分支因子）
+        self.tt_probes = self.tt_hits = self.tt_cutoffs = 0
+        self.expanded = self.children = 0
+        self._search_depth = 0  # 当前迭代的根深度
+        self._root_best_move: Optional[Tuple[int, int]] = None  # 当前迭代的根最佳落子
+        self._deadline = 0.0  # 本步截止时间
+        self._ponder_control = None  # 后台思考时的停止信号/CPU上限
+        self.tt_size_mb = self.config.get_int('AI', 'tt_size_mb', 64)  # 置换表大小（MB）
+        # 置换表（跨回合保留；AIFleet传入共享表，无锁条目可多线程同时读写）
+        self.tt = tt if tt is not None else (self.cpp_core or CppCore()).create_transposition_table(self.tt_size_mb)
 
     def _get_max_depth(self) -> int:
-        """根据难度获取最大搜索深度"""
+        """根据难度获取迭代加深的最大深度"""
         depth_map = {
-            AI_LEVELS['EASY']: 3,
-            AI_LEVELS['MEDIUM']: 4,
-            AI_LEVELS['HARD']: 5,
-            AI_LEVELS['EXPERT']: 6
+            AI_LEVELS['EASY']: 4,
+            AI_LEVELS['MEDIUM']: 6,
+            AI_LEVELS['HARD']: 8,
+            AI_LEVELS['EXPERT']: 10
+        }
+        return depth_map.get(self.level, 8)
+
+    def _get_time_budget(self) -> float:
+        """根据难度获取每步思考时间预算（秒）"""
+        time_map = {
+            AI_LEVELS['EASY']: 0.5,
+            AI_LEVELS['MEDIUM']: 1.0,
+            AI_LEVELS['HARD']: 2.0,
+            AI_LEVELS['EXPERT']: 4.0
         }
-        return depth_map.get(self.level, 5)
+        return time_map.get(self.level, 2.0)
 
-    def _evaluate(self, board: List[List[int]], color: int) -> float:
-        """评估棋盘（优先调用C++核心）"""
+    def _evaluate(self, search_board, color: int) -> float:
+        """评估棋盘（优先使用C++增量棋型计数）"""
         if self.cpp_core:
-            # 找当前最佳落子位置评估（C++高效计算）
-            empty_pos = self._get_empty_positions(board)[:10]  # 取前10个候选位
-            best_score = -float('inf')
-            for (x, y) in empty_pos:
-                cache_key = (tuple(tuple(row) for row in board), x, y, color)
-                if cache_key in self.eval_cache:
-                    score = self.eval_cache[cache_key]
-                else:
-                    score = self.cpp_core.evaluate_move(board, x, y, color, EVAL_WEIGHTS)
-                    self.eval_cache[cache_key] = score
-                if score > best_score:
-                    best_score = score
-            return best_score
+            return search_board.evaluate(color)
         else:
             # Python降级实现（备用）
-            return self._python_evaluate(board, color)
+            return self._python_evaluate(search_board.to_list(), color)
 
     def _python_evaluate(self, board: List[List[int]], color: int) -> float:
         """Python降级评估（无C++核心时使用）"""
@@ -96,85 +115,243 @@ class MinimaxAI(BaseAI):
                 score += 10.0
         return score
 
-    def _minimax(self, board: List[List[int]], depth: int, alpha: float, beta: float, is_maximizing: bool) -> float:
-        """Minimax核心算法（Alpha-Beta剪枝）"""
-        # 检查游戏结束
-        win, _ = self._is_win(board, self.color if is_maximizing else self.opponent_color)
-        if win:
-            return 10000.0 * (1 + depth / 10) if is_maximizing else -10000.0 * (1 + depth / 10)
+    def _minimax(self, search_board, depth: int, alpha: float, beta: float, is_maximizing: bool) -> float:
+        """Minimax核心算法（Alpha-Beta剪枝+置换表，在搜索棋盘上原地落子/撤销）"""
+        self.nodes += 1
+        # 超时检查（每64个节点一次；第1层必须搜完，保证总有可用落子）
+        if self.nodes & 63 == 0:
+            if self._ponder_control is not None:
+                if self._ponder_control.yield_cpu():
+                    raise _SearchTimeout()
+            elif self._search_depth > 1 and time.time() >= self._deadline:
+                raise _SearchTimeout()
+        # 检查平局
+        if search_board.empty_count() == 0:
+            return 0.0
+        key = search_board.zobrist_hash()
+        alpha_orig, beta_orig = alpha, beta
+        # 置换表：深度足够时直接截断（根节点需要产出最佳落子，不截断）
+        tt_move = None
+        entry = self.tt.probe(key)
+        self.tt_probes += 1
+        if entry is not None:
+            self.tt_hits += 1
+            tt_depth, tt_bound, tt_score, tt_move = entry
+            if tt_depth >= depth and depth != self._search_depth:
+                if tt_bound == BOUND_EXACT:
+                    self.tt_cutoffs += 1
+                    return tt_score
+                if tt_bound == BOUND_LOWER:
+                    alpha = max(alpha, tt_score)
+                else:
+                    beta = min(beta, tt_score)
+                if beta <= alpha:
+                    self.tt_cutoffs += 1
+                    return tt_score
         # 搜索深度终止
         if depth == 0:
-            return self._evaluate(board, self.color)
-        # 空位置排序（提升剪枝效率）
-        empty_pos = self._get_empty_positions(board)
-        empty_pos.sort(key=lambda pos: self._evaluate(self._simulate_move(board, pos[0], pos[1], self.color if is_maximizing else self.opponent_color), self.color), reverse=is_maximizing)
-        # 最大化玩家（己方）
-        if is_maximizing:
-            max_score = -float('inf')
-            for (x, y) in empty_pos[:15]:  # 限制候选位数量，提升速度
-                new_board = self._simulate_move(board, x, y, self.color)
-                score = self._minimax(new_board, depth - 1, alpha, beta, False)
-                if score > max_score:
-                    max_score = score
-                    if depth == self.max_depth:
-                        self.best_move = (x, y)
-                alpha = max(alpha, max_score)
-                if beta <= alpha:
-                    break  # Beta剪枝
-            return max_score
-        # 最小化玩家（对手）
+            score = self._evaluate(search_board, self.color)
+            self.tt.store(key, 0, BOUND_EXACT, score)
+            return score
+        color = self.color if is_maximizing else self.opponent_color
+        # 候选位按进攻+防守得分排序（提升剪枝效率），限制候选位数量提升速度；
+        # 置换表最佳落子优先（即上一轮迭代的主变例）
+        candidates = search_board.sorted_moves(color, 15)
+        if tt_move is not None and search_board.at(tt_move[0], tt_move[1]) == PIECE_COLORS['EMPTY']:
+            if tt_move in candidates:
+                candidates.remove(tt_move)
+            candidates.insert(0, tt_move)
+        best_score = -float('inf') if is_maximizing else float('inf')
+        best_local_move = None
+        self.expanded += 1
+        for (x, y) in candidates:
+            self.children += 1
+            if search_board.make_move(x, y, color):
+                score = self.WIN_SCORE * (1 + (depth - 1) / 10)  # 落子即获胜（越早获胜越好）
+                if not is_maximizing:
+                    score = -score
+            else:
+                score = self._minimax(search_board, depth - 1, alpha, beta, not is_maximizing)
+            search_board.unmake_move()
+            # 最大化玩家（己方）
+            if is_maximizing:
+                if score > best_score:
+                    best_score = score
+                    best_local_move = (x, y)
+                    if depth == self._search_depth:
+                        self._root_best_move = (x, y)
+                alpha = max(alpha, best_score)
+            # 最小化玩家（对手）
+            else:
+                if score < best_score:
+                    best_score = score
+                    best_local_move = (x, y)
+                beta = min(beta, best_score)
+            if beta <= alpha:
+                break  # Alpha-Beta剪枝
+        # 写入置换表（边界类型相对进入节点时的原始窗口）
+        if best_score <= alpha_orig:
+            bound = BOUND_UPPER
+        elif best_score >= beta_orig:
+            bound = BOUND_LOWER
         else:
-            min_score = float('inf')
-            for (x, y) in empty_pos[:15]:
-                new_board = self._simulate_move(board, x, y, self.opponent_color)
-                score = self._minimax(new_board, depth - 1, alpha, beta, True)
-                if score < min_score:
-                    min_score = score
-                beta = min(beta, min_score)
-                if beta <= alpha:
-                    break  # Alpha剪枝
-            return min_score
+            bound = BOUND_EXACT
+        self.tt.store(key, depth, bound, best_score, best_local_move)
+        return best_score
+
+    def on_new_game(self):
+        """新对局开始：清空置换表"""
+        self.tt.clear()
+
+    def cancel(self):
+        """提前结束迭代加深（当前一轮作废，返回最后一轮完整搜索的结果）"""
+        super().cancel()
+        self._deadline = 0.0
+
+    def ponder(self, board: List[List[int]], control) -> None:
+        """后台思考：按置换表主变例预测对手应手（没有则取评分最高的点），
+        对预测局面做不限时的迭代加深；对手落子后move直接命中置换表"""
+        search_board = self._create_search_board(board)
+        entry = self.tt.probe(search_board.zobrist_hash())
+        reply = entry[3] if entry is not None else None
+        if reply is None or search_board.at(*reply) != PIECE_COLORS['EMPTY']:
+            moves = search_board.sorted_moves(self.opponent_color, 1)
+            if not moves:
+                return
+            reply = moves[0]
+        if search_board.make_move(reply[0], reply[1], self.opponent_color) or search_board.empty_count() == 0:
+            return
+        self._ponder_control = control
+        self.nodes = 0
+        completed_depth = 0
+        score = None
+        try:
+            for depth in range(1, self.max_depth + 1):
+                self._root_best_move = None
+                score = self._search_root(search_board, depth, score)
+                completed_depth = depth
+                if abs(score) >= self.WIN_SCORE:
+                    break
+        except _SearchTimeout:
+            pass
+        finally:
+            self._ponder_control = None
+        self.logger.info(f"Minimax后台思考：预测应手{reply}，完成深度{completed_depth}，节点数{self.nodes}")
 
-    def _simulate_move(self, board: List[List[int]], x: int, y: int, color: int) -> List[List[int]]:
-        """模拟落子（深拷贝棋盘）"""
-        new_board = [row.copy() for row in board]
-        new_board[x][y] = color
-        return new_board
+    def _search_root(self, search_board, depth: int, prev_score: Optional[float]) -> float:
+        """单轮根搜索（渴望窗口：以上一轮评分为中心搜索，失败则全窗口重搜）"""
+        self._search_depth = depth
+        if prev_score is not None and depth > 1 and abs(prev_score) < self.WIN_SCORE:
+            alpha, beta = prev_score - self.aspiration_window, prev_score + self.aspiration_window
+            score = self._minimax(search_board, depth, alpha, beta, True)
+            if alpha < score < beta:
+                return score
+        return self._minimax(search_board, depth, self.alpha, self.beta, True)
+
+    def _extract_pv(self, search_board, depth: int) -> List[Tuple[int, int]]:
+        """沿置换表最佳落子还原主变例"""
+        pv = []
+        color = self.color
+        while len(pv) < depth:
+            entry = self.tt.probe(search_board.zobrist_hash())
+            if entry is None or entry[3] is None or search_board.at(*entry[3]) != PIECE_COLORS['EMPTY']:
+                break
+            pv.append(entry[3])
+            if search_board.make_move(entry[3][0], entry[3][1], color):
+                break
+            color = self.opponent_color if color == self.color else self.color
+        for _ in pv:
+            search_board.unmake_move()
+        return pv
 
     def move(self, board: List[List[int]], thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
-        """AI落子（C++加速+剪枝）"""
+        """AI落子（迭代加深+时间预算，超时返回最后一轮完整搜索的结果）"""
         self.thinking_callback = thinking_callback
-        self.eval_cache.clear()
+        self.tt.new_search()  # 置换表跨回合保留，仅推进代数
         self.best_move = (self.board_size//2, self.board_size//2)  # 默认天元落子
-        
+        start_time = time.time()
+        self._deadline = start_time + self.time_budget
+        if self.deadline is not None:
+            self._deadline = min(self._deadline, self.deadline)
+        self.nodes = 0
+        self.tt_probes = self.tt_hits = self.tt_cutoffs = 0
+        self.expanded = self.children = 0
+        probe = SearchMetrics.get_instance().begin_move('minimax')
+
         # 思维可视化：初始化数据
         thinking_data = {
             'scores': np.zeros((self.board_size, self.board_size)),
             'best_move': self.best_move,
             'considering_moves': [],
-            'depth': self.max_depth,
-            'iteration': 0
+            'depth': 0,
+            'iteration': 0,
+            'nps': 0
         }
         self._notify_thinking(thinking_data)
 
-        # 检查必胜落子（C++快速判断）
+        # 检查必胜落子（C++威胁空间搜索：成五/VCF/VCT，命中则跳过整棵搜索）
         if self.cpp_core:
-            winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
+            with probe.phase('win_check'):
+                winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
             if winning_move:
                 thinking_data['best_move'] = winning_move
                 self._notify_thinking(thinking_data)
+                probe.finish(move=winning_move, source='win_check')
                 return winning_move
 
-        # 启动Minimax搜索
-        score = self._minimax(board, self.max_depth, self.alpha, self.beta, True)
+        # 查开局库（前若干步命中则直接落子，不占搜索预算）
+        with probe.phase('book'):
+            book_move = self._book_move(board)
+        if book_move:
+            thinking_data['best_move'] = book_move
+            self._notify_thinking(thinking_data)
+            probe.finish(move=book_move, source='book')
+            return book_move
+
+        # 迭代加深（整个搜索共用一块棋盘，不再逐节点拷贝）
+        search_board = self._create_search_board(board)
+        score = None
+        completed_depth = 0
+        with probe.phase('search'):
+            for depth in range(1, self.max_depth + 1):
+                self._root_best_move = None
+                try:
+                    iteration_score = self._search_root(search_board, depth, score)
+                except _SearchTimeout:
+                    # 超时：撤销未完成分支的落子，保留上一轮结果
+                    while search_board.move_count() > 0:
+                        search_board.unmake_move()
+                    break
+                score = iteration_score
+                completed_depth = depth
+                if self._root_best_move is not None:
+                    self.best_move = self._root_best_move
+                # 思维可视化：每完成一层推送实际深度与搜索速度
+                elapsed = max(time.time() - start_time, 1e-6)
+                thinking_data['best_move'] = self.best_move
+                thinking_data['considering_moves'] = self._extract_pv(search_board, depth)
+                thinking_data['depth'] = depth
+                thinking_data['iteration'] = depth
+                thinking_data['nps'] = int(self.nodes / elapsed)
+                self._notify_thinking(thinking_data)
+                # 已找到必胜/必败，或剩余时间不够再搜一层（下一层耗时通常数倍于本层）
+                if abs(score) >= self.WIN_SCORE or elapsed >= (self._deadline - start_time) / 2:
+                    break
 
         # 思维可视化：更新最终数据
-        empty_pos = self._get_empty_positions(board)[:10]
-        for (x, y) in empty_pos:
-            thinking_data['scores'][x][y] = self._evaluate(board, self.color) * 20
+        candidates = search_board.sorted_moves(self.color, 10)
+        for (x, y) in candidates:
+            thinking_data['scores'][x][y] = search_board.evaluate_move(x, y, self.color) / 100
         thinking_data['best_move'] = self.best_move
-        thinking_data['considering_moves'] = empty_pos[:5]
         self._notify_thinking(thinking_data)
 
-        self.logger.info(f"Minimax AI落子：{self.best_move}，局势评分：{score:.2f}")
-        return self.best_move
\ No newline at end of file
+        # 搜索统计：有效深度为主变例长度（置换表可还原的实际线路），depth为完成的迭代深度
+        probe.finish(move=self.best_move, source='search', depth=completed_depth,
+                     pv_length=len(thinking_data['considering_moves']), nodes=self.nodes,
+                     tt_probes=self.tt_probes, tt_hits=self.tt_hits, tt_cutoffs=self.tt_cutoffs,
+                     expanded=self.expanded, children=self.children)
+
+        elapsed = max(time.time() - start_time, 1e-6)
+        self.logger.info(f"Minimax AI落子：{self.best_move}，局势评分：{score if score is not None else 0.0:.2f}，"
+                         f"深度：{completed_depth}，节点/秒：{int(self.nodes / elapsed)}")
+        return self.best_move
@@ -1,16 +1,19 @@
 import os
-import torch
+import json
+import time
 import zipfile
 import shutil
 from typing import List, Dict, Optional
 from Common.config import Config
 from Common.logger import Logger
 from Storage.model_storage import ModelStorage
-from AI.rl_ai import RLAI
-from AI.nn_ai import NNAI
+from AI.base_ai import BaseAI
 
 class ModelManager:
-    """AI模型管理器（保存/加载/合并/导入导出）"""
+    """AI模型管理器（保存/加载/合并/导入导出）
+
+    torch与各AI类只在实际加载/合并模型时才导入，只做模型列表、导入导出的场景（及其启动）不付出这部分开销。
+    """
     def __init__(self):
         self.config = Config.get_instance()
         self.logger = Logger.get_instance()
@@ -40,12 +43,14 @@ class ModelManager:
         return user_models
 
     def load_model(self, ai_type: str, model_path: str, color: int, level: str) -> Optional[BaseAI]:
-        """加载模型到对应AI"""
+        """加载模型到对应AI（权重经ModelRegistry共享，同一文件只加载一次）"""
         if ai_type == 'rl':
+            from AI.rl_ai import RLAI
             ai = RLAI(color, level)
             ai.load_model(model_path)
             return ai
         elif ai_type == 'nn':
+            from AI.nn_ai import NNAI
             ai = NNAI(color, level, model_path)
             return ai
         else:
@@ -56,6 +61,7 @@ class ModelManager:
         """合并多个模型（仅支持同类型AI）"""
         if len(model_paths) < 2:
             raise ValueError("合并模型至少需要2个输入模型")
+        import torch
         # 加载所有模型参数
         models = []
         for path in model_paths:
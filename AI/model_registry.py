@@ -0,0 +1,193 @@
+import os
+import json
+import mmap
+import time
+import struct
+import threading
+import torch
+import torch.nn as nn
+from typing import Callable, Dict, Optional, Sequence, Tuple
+from Common.config import Config
+from Common.logger import Logger
+
+# safetensors格式：8字节小端头长度 + JSON头（张量名→dtype/shape/数据区偏移，__metadata__为字符串字典）+ 连续数据区
+_SAFETENSORS_DTYPES = {
+    'F64': torch.float64, 'F32': torch.float32, 'F16': torch.float16, 'BF16': torch.bfloat16,
+    'I64': torch.int64, 'I32': torch.int32, 'I16': torch.int16, 'I8': torch.int8, 'U8': torch.uint8, 'BOOL': torch.bool
+}
+_SAFETENSORS_NAMES = {dtype: name for name, dtype in _SAFETENSORS_DTYPES.items()}
+
+def read_safetensors(path: str) -> Tuple[Dict[str, torch.Tensor], Dict[str, str]]:
+    """内存映射读取safetensors文件：张量直接指向映射区（写时复制映射，按需分页，不整体读入内存）"""
+    with open(path, 'rb') as f:
+        header_len = struct.unpack('<Q', f.read(8))[0]
+        header = json.loads(f.read(header_len))
+        buffer = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_COPY)
+    metadata = header.pop('__metadata__', {}) or {}
+    base = 8 + header_len
+    tensors = {}
+    for name, info in header.items():
+        dtype = _SAFETENSORS_DTYPES[info['dtype']]
+        start, end = info['data_offsets']
+        if end == start:
+            tensors[name] = torch.empty(info['shape'], dtype=dtype)
+            continue
+        element_size = torch.empty((), dtype=dtype).element_size()
+        tensors[name] = torch.frombuffer(buffer, dtype=dtype, count=(end - start) // element_size,
+                                         offset=base + start).reshape(info['shape'])
+    return tensors, metadata
+
+def write_safetensors(tensors: Dict[str, torch.Tensor], path: str, metadata: Optional[Dict[str, str]] = None):
+    """写safetensors文件（先写临时文件再原子替换）"""
+    header, chunks, offset = {}, [], 0
+    for name in sorted(tensors):
+        tensor = tensors[name].detach().cpu().contiguous()
+        data = tensor.reshape(-1).view(torch.uint8).numpy().tobytes() if tensor.numel() else b''
+        header[name] = {'dtype': _SAFETENSORS_NAMES[tensor.dtype], 'shape': list(tensor.shape),
+                        'data_offsets': [offset, offset + len(data)]}
+        chunks.append(data)
+        offset += len(data)
+    if metadata:
+        header['__metadata__'] = {key: str(value) for key, value in metadata.items()}
+    header_bytes = json.dumps(header, separators=(',', ':')).encode('utf-8')
+    header_bytes += b' ' * (-len(header_bytes) % 8)  # 数据区按8字节对齐，映射后的张量可直接使用
+    tmp_path = path + '.tmp'
+    with open(tmp_path, 'wb') as f:
+        f.write(struct.pack('<Q', len(header_bytes)))
+        f.write(header_bytes)
+        for data in chunks:
+            f.write(data)
+    os.replace(tmp_path, path)
+
+class ModelHandle:
+    """注册表中的一份共享模型（只读：eval模式、不求梯度；需要训练的调用方自行深拷贝）"""
+    def __init__(self, module: nn.Module, path: Optional[str], meta: Dict, load_time: float):
+        self.module = module
+        self.path = path  # 原始检查点路径（None为随机初始化）
+        self.meta = meta  # 检查点中的标量信息（训练步数、胜率等）
+        self.load_time = load_time
+
+class ModelRegistry:
+    """进程级模型注册表：每个(类型, 检查点, 设备)只加载一次，所有AI实例/会话共享同一份只读权重
+
+    - 首次取用时才查找最优模型并加载（构造AI不再各自find_best_model+torch.load）；
+    - 检查点旁有同名.safetensors且不旧于检查点时直接内存映射加载（CPU上零拷贝）；
+      否则torch.load（支持mmap时按mmap打开）后按配置导出.safetensors，下次冷启动走映射；
+    - 共享模块的InferenceServer按模块对象共用，同一模型全进程只有一个批量推理线程。
+    """
+    _instance = None
+    _instance_lock = threading.Lock()
+
+    def __init__(self):
+        self.config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self.export_safetensors = self.config.get_bool('AI', 'model_export_safetensors', True)
+        self._handles: Dict[Tuple[str, str, str], ModelHandle] = {}
+        self._key_locks: Dict[Tuple[str, str, str], threading.Lock] = {}
+        self._best_paths: Dict[str, Optional[str]] = {}
+        self._lock = threading.Lock()
+        self._model_storage = None
+
+    @classmethod
+    def get_instance(cls) -> 'ModelRegistry':
+        if cls._instance is None:
+            with cls._instance_lock:
+                if cls._instance is None:
+                    cls._instance = cls()
+        return cls._instance
+
+    # ------------------------------ 取用 ------------------------------
+    def get(self, kind: str, build: Callable[[], nn.Module], device, path: Optional[str] = None,
+            state_keys: Sequence[str] = ('model_state_dict',)) -> ModelHandle:
+        """取共享模型：path为空时用该类型的最优模型（不存在则随机初始化），build构造未加载权重的网络"""
+        if path is None:
+            path = self.best_model_path(kind)
+        key = (kind, path or '', str(device))
+        handle = self._handles.get(key)
+        if handle is not None:
+            return handle
+        with self._lock:
+            key_lock = self._key_locks.setdefault(key, threading.Lock())
+        with key_lock:  # 同一模型并发首次取用时只加载一次，不同模型互不阻塞
+            handle = self._handles.get(key)
+            if handle is None:
+                handle = self._load(kind, build, device, path, state_keys)
+                self._handles[key] = handle
+        return handle
+
+    def best_model_path(self, kind: str) -> Optional[str]:
+        """该类型的最优模型路径（进程内缓存，保存新模型后调用invalidate刷新）"""
+        if kind not in self._best_paths:
+            if self._model_storage is None:
+                from Storage.model_storage import ModelStorage
+                self._model_storage = ModelStorage()
+            self._best_paths[kind] = self._model_storage.find_best_model(kind)
+        return self._best_paths[kind]
+
+    def invalidate(self, kind: Optional[str] = None):
+        """丢弃最优模型路径缓存（已取走的共享模型不受影响，新取用按新的最优模型加载）"""
+        with self._lock:
+            if kind is None:
+                self._best_paths.clear()
+            else:
+                self._best_paths.pop(kind, None)
+
+    def stats(self) -> Dict[str, Dict]:
+        """已加载模型：来源与加载耗时（冷启动基准参考）"""
+        return {f"{kind}:{os.path.basename(path) or '随机初始化'}@{device}": {'load_time': handle.load_time, 'path': handle.path}
+                for (kind, path, device), handle in self._handles.items()}
+
+    # ------------------------------ 加载 ------------------------------
+    def _load(self, kind: str, build: Callable[[], nn.Module], device, path: Optional[str],
+              state_keys: Sequence[str]) -> ModelHandle:
+        start = time.perf_counter()
+        module = build()
+        meta: Dict = {}
+        if path:
+            state, meta, source = self._read_weights(path, state_keys)
+            if str(device) != 'cpu':
+                state = {name: tensor.to(device) for name, tensor in state.items()}
+            try:
+                module.load_state_dict(state, assign=True)  # 直接采用映射区张量，不再拷贝一份
+            except TypeError:
+                module.load_state_dict(state)  # 旧版torch没有assign参数
+            self.logger.info(f"加载{kind}模型：{source}，耗时{time.perf_counter() - start:.3f}s")
+        module.to(device)
+        module.eval()
+        module.requires_grad_(False)
+        return ModelHandle(module, path, meta, time.perf_counter() - start)
+
+    def _read_weights(self, path: str, state_keys: Sequence[str]) -> Tuple[Dict[str, torch.Tensor], Dict, str]:
+        """读取权重：优先同名.safetensors（内存映射），否则torch.load检查点并按需导出"""
+        if path.endswith('.safetensors'):
+            tensors, metadata = read_safetensors(path)
+            return tensors, self._decode_meta(metadata), path
+        sidecar = os.path.splitext(path)[0] + '.safetensors'
+        if os.path.exists(sidecar) and os.path.getmtime(sidecar) >= os.path.getmtime(path):
+            tensors, metadata = read_safetensors(sidecar)
+            return tensors, self._decode_meta(metadata), sidecar
+
+        try:
+            checkpoint = torch.load(path, map_location='cpu', mmap=True)
+        except (TypeError, RuntimeError):
+            checkpoint = torch.load(path, map_location='cpu')  # 旧版torch或旧格式检查点不支持mmap
+        state = next((checkpoint[key] for key in state_keys if isinstance(checkpoint, dict) and key in checkpoint), checkpoint)
+        meta = {key: value for key, value in checkpoint.items()
+                if isinstance(value, (int, float, str, bool))} if isinstance(checkpoint, dict) else {}
+        if self.export_safetensors:
+            try:
+                write_safetensors(state, sidecar, {key: json.dumps(value) for key, value in meta.items()})
+                self.logger.info(f"已导出内存映射权重：{sidecar}")
+            except (OSError, KeyError) as e:
+                self.logger.warning(f"导出safetensors失败：{str(e)}")
+        return state, meta, path
+
+    @staticmethod
+    def _decode_meta(metadata: Dict[str, str]) -> Dict:
+        meta = {}
+        for key, value in metadata.items():
+            try:
+                meta[key] = json.loads(value)
+            except ValueError:
+                meta[key] = value
+        return meta
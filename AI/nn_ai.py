@@ -5,14 +5,19 @@ from typing import List, Tuple, Dict, Optional, Callable
 from Common.constants import AI_LEVELS, PIECE_COLORS
 from Common.config import Config
 from Common.logger import Logger
+from Common.metrics import SearchMetrics
 from AI.base_ai import BaseAI
+from AI.model_registry import ModelRegistry
 from Storage.model_storage import ModelStorage
 from Compute.gpu_accelerator import GPUAccelerator
+from Compute.inference_server import InferenceServer
 
 class NNNetwork(nn.Module):
     """神经网络模型（棋盘→落子概率）"""
-    def __init__(self, input_size: int = 225, hidden_size: int = 1024, output_size: int = 225):
+    def __init__(self, input_size: int = 225, hidden_size: int = 1024, output_size: int = 225, board_size: Optional[int] = None):
         super().__init__()
+        # 棋盘边长（未指定时由输入维度推断）
+        self.board_size = board_size or int(round(input_size ** 0.5))
         self.input_size = input_size
         self.output_size = output_size
         # 网络结构：输入→卷积→全连接→输出
@@ -26,7 +31,7 @@ class NNNetwork(nn.Module):
             nn.Flatten()
         )
         # 计算卷积层输出维度
-        conv_out_size = self.conv_layers(torch.zeros(1, 2, 15, 15)).shape[1]
+        conv_out_size = self.conv_layers(torch.zeros(1, 2, self.board_size, self.board_size)).shape[1]
         self.fc_layers = nn.Sequential(
             nn.Linear(conv_out_size, hidden_size),
             nn.ReLU(),
@@ -39,7 +44,7 @@ class NNNetwork(nn.Module):
         )
 
     def forward(self, x: torch.Tensor) -> torch.Tensor:
-        """前向传播：x shape=(batch, 2, 15, 15)"""
+        """前向传播：x shape=(batch, 2, board_size, board_size)"""
         conv_out = self.conv_layers(x)
         return self.fc_layers(conv_out)
 
@@ -51,23 +56,30 @@ class NNAI(BaseAI):
         self.gpu_accelerator = GPUAccelerator()
         self.device = self.gpu_accelerator.get_device()
         self.model_storage = ModelStorage()
-        # 初始化模型
-        self.model = NNNetwork(input_size=self.board_size**2, output_size=self.board_size**2).to(self.device)
-        self.model.eval()
-        # 加载预训练模型
+        # 加载模型（进程级注册表共享只读权重，未找到预训练模型时为随机初始化）
+        self._inference: Optional[InferenceServer] = None
         if model_path:
             self.load_model(model_path)
         else:
             self.load_best_model()
 
-    def _preprocess_board(self, board: List[List[int]]) -> torch.Tensor:
-        """预处理棋盘：转换为模型输入（batch, 2, 15, 15）"""
-        # 己方为1，对手为0（通道1）；对手为1，己方为0（通道2）
+    @property
+    def inference(self) -> InferenceServer:
+        """批量推理服务（同一模型的所有请求攒批前向，首次使用时启动）"""
+        if self._inference is None:
+            self._inference = InferenceServer.for_model(self.model, self.device)
+        return self._inference
+
+    def _board_planes(self, board: List[List[int]]) -> np.ndarray:
+        """棋盘→双通道输入（2, board_size, board_size）：己方为1（通道1），对手为1（通道2）"""
         board_np = np.array(board, dtype=np.float32)
         own_channel = (board_np == self.color).astype(np.float32)
         opp_channel = (board_np == self.opponent_color).astype(np.float32)
-        input_tensor = torch.tensor(np.stack([own_channel, opp_channel], axis=0), dtype=torch.float32).unsqueeze(0)
-        return input_tensor.to(self.device)
+        return np.stack([own_channel, opp_channel], axis=0)
+
+    def _preprocess_board(self, board: List[List[int]]) -> torch.Tensor:
+        """预处理棋盘：转换为模型输入（batch, 2, board_size, board_size）"""
+        return torch.from_numpy(self._board_planes(board)).unsqueeze(0).to(self.device)
 
     def _idx_to_move(self, idx: int) -> Tuple[int, int]:
         """索引→落子坐标"""
@@ -75,28 +87,27 @@ class NNAI(BaseAI):
         y = idx % self.board_size
         return (x, y)
 
-    def load_model(self, model_path: str):
-        """加载模型"""
-        checkpoint = torch.load(model_path, map_location=self.device)
-        if 'model_state_dict' in checkpoint:
-            self.model.load_state_dict(checkpoint['model_state_dict'])
+    def _build_network(self) -> NNNetwork:
+        return NNNetwork(input_size=self.board_size**2, output_size=self.board_size**2, board_size=self.board_size)
+
+    def load_model(self, model_path: Optional[str] = None):
+        """加载模型（经进程级注册表共享，model_path为空时取最优模型）"""
+        handle = ModelRegistry.get_instance().get('nn', self._build_network, self.device, model_path)
+        self.model = handle.module
+        self._inference = None
+        if handle.path:
+            self.logger.info(f"加载神经网络模型成功：{handle.path}")
         else:
-            self.model.load_state_dict(checkpoint)
-        self.model.eval()
-        self.logger.info(f"加载神经网络模型成功：{model_path}")
+            self.logger.warning("未找到预训练模型，使用随机初始化模型")
 
     def load_best_model(self):
         """加载最优模型"""
-        best_model_path = self.model_storage.find_best_model('nn')
-        if best_model_path:
-            self.load_model(best_model_path)
-        else:
-            self.logger.warning("未找到预训练模型，使用随机初始化模型")
+        self.load_model()
 
     def move(self, board: List[List[int]], thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
         """AI落子（神经网络预测）"""
         self.thinking_callback = thinking_callback
-        input_tensor = self._preprocess_board(board)
+        probe = SearchMetrics.get_instance().begin_move('nn')
 
         # 思维可视化：初始化数据
         thinking_data = {
@@ -108,10 +119,18 @@ class NNAI(BaseAI):
         }
         self._notify_thinking(thinking_data)
 
-        # 模型预测
-        with torch.no_grad():
-            output = self.model(input_tensor)
-            prob = output.cpu().numpy()[0]  # 落子概率分布
+        # 查开局库（前若干步命中则直接落子，不占搜索预算）
+        with probe.phase('book'):
+            book_move = self._book_move(board)
+        if book_move:
+            thinking_data['best_move'] = book_move
+            self._notify_thinking(thinking_data)
+            probe.finish(move=book_move, source='book')
+            return book_move
+
+        # 模型预测（经批量推理服务，与其他对局的请求合批）
+        with probe.phase('inference'):
+            prob = self.inference.infer(self._board_planes(board)).copy()  # 落子概率分布
 
         # 过滤已落子位置
         board_flat = np.array(board).flatten()
@@ -128,6 +147,7 @@ class NNAI(BaseAI):
         thinking_data['best_move'] = best_move
         thinking_data['considering_moves'] = [self._idx_to_move(np.argsort(prob)[-i-1]) for i in range(5)]
         self._notify_thinking(thinking_data)
+        probe.finish(move=best_move, source='policy', depth=1)
 
         self.logger.info(f"神经网络AI落子：{best_move}，预测概率：{prob[best_idx]:.2%}")
         return best_move
@@ -0,0 +1,170 @@
+import os
+import random
+import threading
+import numpy as np
+from typing import Dict, Iterable, List, Optional, Tuple
+from Common.constants import PIECE_COLORS
+from Common.config import Config
+from Common.logger import Logger
+from AI.replay_buffer import dihedral_permutations
+
+BOOK_DTYPE = np.dtype([('hash', '<u8'), ('move', '<u2'), ('count', '<u4'), ('score', '<f4')])
+
+class PositionHasher:
+    """对称归一化的局面哈希（固定种子的Zobrist键，8种对称变换下取最小值，开局库文件跨版本稳定）"""
+    def __init__(self, board_size: int):
+        self.board_size = board_size
+        cells = board_size * board_size
+        rng = random.Random(0x60B0 + board_size)
+        self.keys = np.array([[0] * cells] + [[rng.getrandbits(64) for _ in range(cells)] for _ in range(2)], dtype=np.uint64)
+        self.gather, self.scatter = dihedral_permutations(board_size)
+
+    def canonical(self, boards: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+        """(N, cells)的棋盘 → (规范哈希, 取到最小值的对称编号)，整批向量化"""
+        boards = boards.reshape(len(boards), -1).astype(np.int64)
+        cell_index = np.arange(boards.shape[1])
+        hashes = np.empty((8, len(boards)), dtype=np.uint64)
+        for k in range(8):
+            transformed = boards[:, self.gather[k]]
+            hashes[k] = np.bitwise_xor.reduce(self.keys[transformed, cell_index], axis=1)
+        syms = np.argmin(hashes, axis=0)
+        return hashes[syms, np.arange(len(boards))], syms
+
+    def to_canonical_move(self, sym: int, cell: int) -> int:
+        return int(self.scatter[sym][cell])
+
+    def from_canonical_move(self, sym: int, cell: int) -> int:
+        return int(self.gather[sym][cell])
+
+class OpeningBook:
+    """开局库（按规范哈希排序的定长表，np.load内存映射打开即用，二分查找O(log n)）
+
+    每行是(局面规范哈希, 规范坐标下的落子, 出现次数, 落子方累计得分)，同一局面的各落子相邻存放。
+    查询时把当前局面归一化，取出该局面下的所有落子，再按对称变换映射回实际坐标。
+    """
+    _instances: Dict[int, 'OpeningBook'] = {}
+    _instances_lock = threading.Lock()
+
+    def __init__(self, board_size: int = 15, path: Optional[str] = None):
+        self.config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self.board_size = board_size
+        self.enabled = self.config.get_bool('AI', 'book_enabled', True)
+        self.max_plies = self.config.get_int('AI', 'book_max_plies', 10)  # 超过该步数不再查库
+        self.min_count = self.config.get_int('AI', 'book_min_count', 3)  # 出现次数不足的落子不采用
+        self.path = path or self.default_path(board_size)
+        self.hasher = PositionHasher(board_size)
+        self.table = None
+        if self.enabled and os.path.exists(self.path):
+            self.table = np.load(self.path, mmap_mode='r')
+            self.hashes = self.table['hash']
+            self.logger.info(f"加载开局库：{self.path}，{len(self.table)}条")
+
+    @staticmethod
+    def default_path(board_size: int) -> str:
+        model_dir = Config.get_instance().get('PATH', 'model_dir', os.path.join(os.getcwd(), 'data', 'model'))
+        return os.path.join(model_dir, f"opening_book_{board_size}.npy")
+
+    @classmethod
+    def get_instance(cls, board_size: int = 15) -> 'OpeningBook':
+        """按棋盘大小共享的开局库（所有AI共用一份内存映射）"""
+        with cls._instances_lock:
+            book = cls._instances.get(board_size)
+            if book is None:
+                book = cls._instances[board_size] = cls(board_size)
+            return book
+
+    def lookup(self, board: List[List[int]]) -> List[Tuple[Tuple[int, int], int, float]]:
+        """当前局面的库内落子：[((x, y), 出现次数, 平均得分)]，按次数降序；未命中返回空列表"""
+        if self.table is None:
+            return []
+        board_np = np.asarray(board, dtype=np.int8)
+        if np.count_nonzero(board_np) >= self.max_plies:
+            return []
+        hashes, syms = self.hasher.canonical(board_np[None])
+        lo = np.searchsorted(self.hashes, hashes[0], side='left')
+        hi = np.searchsorted(self.hashes, hashes[0], side='right')
+        n = self.board_size
+        moves = []
+        for row in self.table[lo:hi]:
+            cell = self.hasher.from_canonical_move(int(syms[0]), int(row['move']))
+            x, y = cell // n, cell % n
+            if board[x][y] == PIECE_COLORS['EMPTY']:
+                moves.append(((x, y), int(row['count']), float(row['score']) / max(int(row['count']), 1)))
+        moves.sort(key=lambda m: -m[1])
+        return moves
+
+    def choose(self, board: List[List[int]]) -> Optional[Tuple[int, int]]:
+        """按出现次数×平均得分加权随机选一个库内落子（次数不足min_count的不选）"""
+        moves = [m for m in self.lookup(board) if m[1] >= self.min_count]
+        if not moves:
+            return None
+        weights = [count * (0.1 + score) for _, count, score in moves]
+        return random.choices([move for move, _, _ in moves], weights=weights)[0]
+
+class OpeningBookBuilder:
+    """离线构建开局库（来源：对局记录的落子历史、二进制训练数据集），统计后排序写成定长表"""
+    def __init__(self, board_size: int = 15, max_plies: Optional[int] = None):
+        self.logger = Logger.get_instance()
+        self.board_size = board_size
+        self.max_plies = max_plies or Config.get_instance().get_int('AI', 'book_max_plies', 10)
+        self.hasher = PositionHasher(board_size)
+        self._stats: Dict[Tuple[int, int], List[float]] = {}  # (规范哈希, 规范落子) -> [次数, 累计得分]
+
+    def _add_positions(self, boards: np.ndarray, cells: np.ndarray, scores: np.ndarray):
+        if len(boards) == 0:
+            return
+        hashes, syms = self.hasher.canonical(boards)
+        canonical_moves = self.hasher.scatter[syms, cells]
+        for h, move, score in zip(hashes.tolist(), canonical_moves.tolist(), scores.tolist()):
+            entry = self._stats.setdefault((h, move), [0, 0.0])
+            entry[0] += 1
+            entry[1] += score
+
+    def add_game(self, moves: List[Tuple[int, int, int]], winner: int):
+        """加入一局的前max_plies步（winner为胜方颜色，平局为EMPTY）"""
+        n = self.board_size
+        board = np.zeros(n * n, dtype=np.int8)
+        boards, cells, scores = [], [], []
+        for x, y, color in moves[:self.max_plies]:
+            boards.append(board.copy())
+            cells.append(x * n + y)
+            scores.append(0.5 if winner == PIECE_COLORS['EMPTY'] else 1.0 if winner == color else 0.0)
+            board[x * n + y] = color
+        if boards:
+            self._add_positions(np.stack(boards), np.array(cells), np.array(scores))
+
+    def add_game_record(self, record: Dict):
+        """加入GameRecordStorage的一条对战记录（move_history + result.winner）"""
+        winner_name = (record.get('result') or {}).get('winner', 'draw')
+        winner = {'black': PIECE_COLORS['BLACK'], 'white': PIECE_COLORS['WHITE']}.get(winner_name, PIECE_COLORS['EMPTY'])
+        self.add_game([(m['x'], m['y'], m['color']) for m in record.get('move_history', [])], winner)
+
+    def add_dataset(self, path: str):
+        """加入二进制训练数据集中棋子数少于max_plies的局面（按块向量化哈希；数据集不含胜方颜色，得分记0.5）"""
+        from Common.position_file import PositionReader, unpack_boards
+        from AI.data_pipeline import POPCOUNT
+        reader = PositionReader(path)
+        if reader.board_size != self.board_size:
+            return
+        for records in reader.chunks():
+            stones = POPCOUNT[records['black']].sum(axis=1) + POPCOUNT[records['white']].sum(axis=1)
+            selected = records[stones < self.max_plies]
+            if len(selected) == 0:
+                continue
+            boards = unpack_boards(selected, self.board_size).reshape(len(selected), -1)
+            cells = selected['x'].astype(np.int64) * self.board_size + selected['y']
+            self._add_positions(boards, cells, np.full(len(selected), 0.5))
+
+    def save(self, path: Optional[str] = None, min_count: int = 1) -> str:
+        """按(哈希, 落子)排序写出（先写临时文件再改名），返回文件路径"""
+        path = path or OpeningBook.default_path(self.board_size)
+        rows = [(h, move, int(count), score) for (h, move), (count, score) in self._stats.items() if count >= min_count]
+        table = np.array(rows, dtype=BOOK_DTYPE) if rows else np.empty(0, dtype=BOOK_DTYPE)
+        table.sort(order=['hash', 'move'])
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        tmp_path = path + '.tmp.npy'
+        np.save(tmp_path, table)
+        os.replace(tmp_path, path)
+        self.logger.info(f"开局库构建完成：{path}，{len(set(h for h, _ in self._stats))}个局面，{len(table)}条落子")
+        return path
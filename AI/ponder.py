@@ -0,0 +1,69 @@
+import time
+import threading
+from typing import List, Optional
+from Common.config import Config
+from Common.logger import Logger
+from AI.base_ai import BaseAI
+
+class PonderControl:
+    """后台思考的停止信号+CPU上限（搜索循环周期调用yield_cpu，按占空比休眠，避免抢占界面主循环）"""
+    def __init__(self, cpu_cap: float = 0.5, slice_seconds: float = 0.02):
+        self.cpu_cap = min(max(cpu_cap, 0.05), 1.0)  # 后台思考允许占用的CPU比例
+        self.slice_seconds = slice_seconds  # 连续计算超过该时长后让出CPU
+        self._stop_event = threading.Event()
+        self._slice_start = time.perf_counter()
+
+    @property
+    def stopped(self) -> bool:
+        return self._stop_event.is_set()
+
+    def stop(self):
+        self._stop_event.set()
+
+    def yield_cpu(self) -> bool:
+        """计算满一个时间片后休眠（忙碌时长×(1-上限)/上限，休眠期间可被stop立即唤醒），返回是否应停止"""
+        busy = time.perf_counter() - self._slice_start
+        if busy >= self.slice_seconds and self.cpu_cap < 1.0:
+            self._stop_event.wait(busy * (1.0 - self.cpu_cap) / self.cpu_cap)
+            self._slice_start = time.perf_counter()
+        return self._stop_event.is_set()
+
+class Ponderer:
+    """后台思考管理器（AI落子后在对手思考时继续搜索，对手落子前停止；命中预测时下一步复用搜索结果）"""
+    def __init__(self):
+        self.config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self.enabled = self.config.get_bool('AI', 'ponder_enabled', True)
+        self.cpu_cap = self.config.get_float('AI', 'ponder_cpu_cap', 0.5)
+        self._control: Optional[PonderControl] = None
+        self._thread: Optional[threading.Thread] = None
+
+    @property
+    def active(self) -> bool:
+        return self._thread is not None and self._thread.is_alive()
+
+    def start(self, ai: BaseAI, board: List[List[int]]):
+        """开始后台思考（board为AI落子后的局面，轮到对手），已有的后台思考先停止"""
+        self.stop()
+        if not self.enabled:
+            return
+        self._control = PonderControl(self.cpu_cap)
+        self._thread = threading.Thread(target=self._run, args=(ai, [row[:] for row in board], self._control), daemon=True)
+        self._thread.start()
+
+    def stop(self):
+        """停止后台思考并等待线程退出（返回后AI的搜索状态可安全使用）"""
+        if self._control:
+            self._control.stop()
+        if self._thread:
+            self._thread.join()
+        self._control = None
+        self._thread = None
+
+    def _run(self, ai: BaseAI, board: List[List[int]], control: PonderControl):
+        start_time = time.time()
+        try:
+            ai.ponder(board, control)
+        except Exception as e:
+            self.logger.error(f"后台思考失败：{str(e)}")
+        self.logger.info(f"后台思考结束：耗时{time.time() - start_time:.2f}s")
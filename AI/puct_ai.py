@@ -0,0 +1,221 @@
+import time
+import torch
+import torch.nn as nn
+import numpy as np
+from typing import List, Tuple, Dict, Optional, Callable
+from Common.constants import AI_LEVELS, PIECE_COLORS
+from Common.logger import Logger
+from Common.metrics import SearchMetrics
+from AI.base_ai import BaseAI
+from AI.model_registry import ModelRegistry
+from Storage.model_storage import ModelStorage
+from Compute.cpp_interface import CppCore
+from Compute.gpu_accelerator import GPUAccelerator
+from Compute.inference_server import InferenceServer
+
+class PolicyValueNetwork(nn.Module):
+    """策略-价值双头网络（AlphaZero式：棋盘→落子先验+局面价值）"""
+    def __init__(self, board_size: int = 15, channels: int = 128):
+        super().__init__()
+        self.board_size = board_size
+        cells = board_size * board_size
+        # 公共卷积主干：输入为走子方/对方两个通道
+        self.trunk = nn.Sequential(
+            nn.Conv2d(2, 64, kernel_size=3, padding=1),
+            nn.ReLU(),
+            nn.Conv2d(64, channels, kernel_size=3, padding=1),
+            nn.ReLU(),
+            nn.Conv2d(channels, channels, kernel_size=3, padding=1),
+            nn.ReLU()
+        )
+        # 策略头：各点落子概率
+        self.policy_head = nn.Sequential(
+            nn.Conv2d(channels, 2, kernel_size=1),
+            nn.ReLU(),
+            nn.Flatten(),
+            nn.Linear(2 * cells, cells),
+            nn.Softmax(dim=-1)
+        )
+        # 价值头：走子方视角的胜负期望[-1, 1]
+        self.value_head = nn.Sequential(
+            nn.Conv2d(channels, 1, kernel_size=1),
+            nn.ReLU(),
+            nn.Flatten(),
+            nn.Linear(cells, 64),
+            nn.ReLU(),
+            nn.Linear(64, 1),
+            nn.Tanh()
+        )
+
+    def forward(self, x: torch.Tensor) -> Tuple[torch.Tensor, torch.Tensor]:
+        """前向传播：x shape=(batch, 2, board_size, board_size)，返回(先验, 价值)"""
+        features = self.trunk(x)
+        return self.policy_head(features), self.value_head(features)
+
+class PUCTAI(BaseAI):
+    """神经网络引导的MCTS AI（C++引擎PUCT模式：批量选叶→批量推理服务评估→回溯，不做随机模拟）"""
+    MAX_STALLED_BATCHES = 8  # 连续无进展的选叶批数上限
+
+    def __init__(self, color: int, level: str = AI_LEVELS['HARD'], use_cpp: bool = True, model_path: Optional[str] = None):
+        super().__init__(color, level)
+        self.logger = Logger.get_instance()
+        self.cpp_core = CppCore() if use_cpp else None
+        self.gpu_accelerator = GPUAccelerator()
+        self.device = self.gpu_accelerator.get_device()
+        self.model_storage = ModelStorage()
+        self.simulations = self._get_simulations()  # 每步模拟次数（适配难度）
+        self.c_puct = self.config.get_float('AI', 'puct_c', 1.5)  # PUCT探索常数
+        self.leaf_batch = self.config.get_int('AI', 'puct_leaf_batch', 16)  # 每批选出的叶子数
+        self.tree_reuse = self.config.get_bool('AI', 'mcts_tree_reuse', True)
+        # 加载模型（进程级注册表共享只读权重）
+        if model_path:
+            self.load_model(model_path)
+        else:
+            self.load_best_model()
+        self.engine = self.cpp_core.create_mcts_engine(self.config.get_int('AI', 'mcts_arena_mb', 32)) if self.cpp_core else None
+
+    def _get_simulations(self) -> int:
+        """根据难度获取每步模拟次数"""
+        sim_map = {
+            AI_LEVELS['EASY']: 200,
+            AI_LEVELS['MEDIUM']: 400,
+            AI_LEVELS['HARD']: 800,
+            AI_LEVELS['EXPERT']: 1600
+        }
+        return sim_map.get(self.level, 800)
+
+    def load_model(self, model_path: Optional[str] = None):
+        """加载模型（经进程级注册表共享，model_path为空时取最优模型）"""
+        handle = ModelRegistry.get_instance().get('puct', lambda: PolicyValueNetwork(self.board_size), self.device, model_path)
+        self.model = handle.module
+        self.inference = InferenceServer.for_model(self.model, self.device)
+        if handle.path:
+            self.logger.info(f"加载策略价值网络成功：{handle.path}")
+        else:
+            self.logger.warning("未找到策略价值网络模型，使用随机初始化模型")
+
+    def load_best_model(self):
+        """加载最优模型"""
+        self.load_model()
+
+    def on_new_game(self):
+        """新对局开始：丢弃上一局保留的搜索树"""
+        if self.engine is not None:
+            self.engine.clear()
+
+    def _board_planes(self, board: List[List[int]], color: int) -> np.ndarray:
+        """棋盘→双通道输入（与C++引擎导出的格式一致：通道0走子方棋子，通道1对方棋子）"""
+        board_np = np.array(board, dtype=np.float32)
+        opponent = PIECE_COLORS['WHITE'] if color == PIECE_COLORS['BLACK'] else PIECE_COLORS['BLACK']
+        return np.stack([(board_np == color).astype(np.float32), (board_np == opponent).astype(np.float32)], axis=0)
+
+    def _run_search(self, board: List[List[int]], probe) -> None:
+        """PUCT搜索：引擎选出一批叶子→推理服务成批评估→写回先验与价值，直到根访问次数达到目标
+
+        每批检查截止时间（cancel会把截止时间提前到现在），到时即停，已完成的模拟照常计入；
+        连续多批既无待评估叶子、根访问次数也不增长时视为无法推进，提前结束。
+        """
+        self.engine.puct_begin(board, self.color, self.tree_reuse)
+        target = self.engine.root_visits() + self.simulations
+        cells = self.board_size * self.board_size
+        stalled = 0
+        while self.engine.root_visits() < target:
+            if self.deadline is not None and time.time() >= self.deadline:
+                break
+            visits_before = self.engine.root_visits()
+            count, planes = self.engine.puct_select(self.leaf_batch, self.c_puct)
+            if count == 0:
+                # 本批全部命中终局节点（已在引擎内回溯），或与未写回的叶子冲突（没有进展）
+                stalled = stalled + 1 if self.engine.root_visits() == visits_before else 0
+                if stalled >= self.MAX_STALLED_BATCHES:
+                    self.logger.warning(f"PUCT搜索连续{stalled}批无进展，提前结束（根访问{visits_before}）")
+                    break
+                continue
+            stalled = 0
+            inputs = np.frombuffer(planes, dtype=np.float32).reshape(count, 2, self.board_size, self.board_size)
+            try:
+                with probe.phase('inference'):
+                    results = self.inference.infer_many(list(inputs))
+            except Exception:
+                # 本批叶子已加虚拟损失并标记为扩展中，不写回会永久卡住选择；丢弃整棵树
+                self.engine.clear()
+                raise
+            policies = np.ascontiguousarray(np.stack([r[0] for r in results]).reshape(count, cells), dtype=np.float32)
+            values = np.ascontiguousarray([r[1][0] for r in results], dtype=np.float32)
+            self.engine.puct_apply(policies, values)
+
+    def move(self, board: List[List[int]], thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
+        """AI落子（PUCT搜索，访问次数最多的点）"""
+        self.thinking_callback = thinking_callback
+        probe = SearchMetrics.get_instance().begin_move('puct')
+        thinking_data = {
+            'scores': np.zeros((self.board_size, self.board_size)),
+            'best_move': (self.board_size//2, self.board_size//2),
+            'considering_moves': [],
+            'depth': 0,
+            'iteration': 0,
+            'total_iterations': self.simulations,
+            'value_estimate': 0.0
+        }
+        self._notify_thinking(thinking_data)
+
+        # 检查必胜落子（C++威胁空间搜索：成五/VCF/VCT，命中则跳过整棵搜索）
+        if self.cpp_core:
+            with probe.phase('win_check'):
+                winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
+            if winning_move:
+                thinking_data['best_move'] = winning_move
+                self._notify_thinking(thinking_data)
+                probe.finish(move=winning_move, source='win_check')
+                return winning_move
+
+        # 查开局库（前若干步命中则直接落子，不占搜索预算）
+        with probe.phase('book'):
+            book_move = self._book_move(board)
+        if book_move:
+            thinking_data['best_move'] = book_move
+            self._notify_thinking(thinking_data)
+            probe.finish(move=book_move, source='book')
+            return book_move
+
+        if self.engine is None:
+            with probe.phase('inference'):
+                best_move = self._policy_move(board, thinking_data)
+            probe.finish(move=best_move, source='policy', depth=1)
+            return best_move
+
+        self._run_search(board, probe)
+        best_move = self.engine.best_move() or self._get_candidates(board, threat_first=True)[0]
+        children = sorted(self.engine.root_children(), key=lambda child: -child[2])
+        root_visits = max(self.engine.root_visits(), 1)
+
+        # 思维可视化：访问占比热力图、前5个候选点、最佳点胜率
+        for (x, y, visits, _) in children[:10]:
+            thinking_data['scores'][x][y] = visits / root_visits * 100
+        thinking_data['best_move'] = best_move
+        thinking_data['considering_moves'] = [(x, y) for (x, y, _, _) in children[:5]]
+        thinking_data['depth'] = self.engine.max_depth()
+        thinking_data['iteration'] = self.simulations
+        if children and children[0][2] > 0:
+            thinking_data['value_estimate'] = children[0][3] / children[0][2] * 2 - 1
+        self._notify_thinking(thinking_data)
+        # 模拟数、扩展数与子节点数取原生计数（puct_select/puct_apply在调用线程上执行）
+        probe.finish(move=best_move, source='search', seldepth=thinking_data['depth'],
+                     reused=self.engine.reused_visits())
+
+        self.logger.info(f"PUCT AI落子：{best_move}，访问次数：{children[0][2] if children else 0}/{root_visits}"
+                         f"（复用{self.engine.reused_visits()}），价值：{thinking_data['value_estimate']:.3f}")
+        return best_move
+
+    def _policy_move(self, board: List[List[int]], thinking_data: Dict) -> Tuple[int, int]:
+        """未编译C++扩展时直接取策略头概率最高的空位"""
+        prior, value = self.inference.infer(self._board_planes(board, self.color))
+        prior = prior.copy()
+        prior[np.array(board).flatten() != PIECE_COLORS['EMPTY']] = 0.0
+        best_idx = int(np.argmax(prior))
+        best_move = (best_idx // self.board_size, best_idx % self.board_size)
+        thinking_data['scores'] = prior.reshape(self.board_size, self.board_size) * 100
+        thinking_data['best_move'] = best_move
+        thinking_data['value_estimate'] = float(value[0])
+        self._notify_thinking(thinking_data)
+        return best_move
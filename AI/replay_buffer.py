@@ -0,0 +1,225 @@
+import os
+import json
+import numpy as np
+from typing import Optional, Tuple
+from Common.logger import Logger
+
+def dihedral_permutations(board_size: int) -> Tuple[np.ndarray, np.ndarray]:
+    """棋盘8种对称变换（4种旋转×是否翻转）的格子置换表
+
+    返回(gather, scatter)：gather[k][新格子] = 原格子，用于一次取出变换后的局面；
+    scatter[k][原格子] = 新格子，用于把落子下标映射到变换后的棋盘。
+    """
+    cells = np.arange(board_size * board_size).reshape(board_size, board_size)
+    gather = np.empty((8, board_size * board_size), dtype=np.int64)
+    for k in range(8):
+        view = np.rot90(cells, k % 4)
+        if k >= 4:
+            view = np.fliplr(view)
+        gather[k] = view.ravel()
+    scatter = np.empty_like(gather)
+    for k in range(8):
+        scatter[k][gather[k]] = np.arange(board_size * board_size)
+    return gather, scatter
+
+class SumTree:
+    """优先级求和树（叶子为各条经验的优先级，批量更新/批量按前缀和采样均为向量化的O(log N)）"""
+    def __init__(self, capacity: int):
+        self.leaves = 1
+        while self.leaves < capacity:
+            self.leaves *= 2
+        self.tree = np.zeros(2 * self.leaves, dtype=np.float64)
+
+    @property
+    def total(self) -> float:
+        return float(self.tree[1])
+
+    def update(self, indices: np.ndarray, priorities: np.ndarray):
+        """设置叶子优先级并逐层重算父节点"""
+        nodes = np.asarray(indices, dtype=np.int64) + self.leaves
+        self.tree[nodes] = priorities
+        nodes = np.unique(nodes // 2)
+        while nodes[0] >= 1:
+            self.tree[nodes] = self.tree[2 * nodes] + self.tree[2 * nodes + 1]
+            if nodes[0] == 1:
+                break
+            nodes = np.unique(nodes // 2)
+
+    def rebuild(self, priorities: np.ndarray):
+        """由全部叶子优先级整体重建（加载持久化缓冲区时使用）"""
+        self.tree[:] = 0.0
+        self.tree[self.leaves:self.leaves + len(priorities)] = priorities
+        node = self.leaves // 2
+        while node >= 1:
+            self.tree[node:2 * node] = self.tree[2 * node:4 * node:2] + self.tree[2 * node + 1:4 * node:2]
+            node //= 2
+
+    def find(self, prefix: np.ndarray) -> np.ndarray:
+        """按前缀和批量下降到叶子，返回叶子下标"""
+        nodes = np.ones(len(prefix), dtype=np.int64)
+        prefix = prefix.copy()
+        while nodes[0] < self.leaves:
+            left = 2 * nodes
+            left_sum = self.tree[left]
+            go_right = prefix > left_sum
+            prefix = np.where(go_right, prefix - left_sum, prefix)
+            nodes = np.where(go_right, left + 1, left)
+        return nodes - self.leaves
+
+class ReplayBuffer:
+    """预分配环形经验回放池（int8局面连续存储，O(1)写入，向量化采样，可选优先级采样与8向对称增强）
+
+    局面按落子方视角存为int8（己方1、对方-1、空0）。指定path时所有数组以np.memmap落盘，
+    进程重启后按原容量重新打开即可继续使用（写指针与条数保存在meta.json）。
+    """
+    FIELDS = ('states', 'next_states', 'actions', 'rewards', 'dones', 'priorities')
+
+    def __init__(self, capacity: int, board_size: int = 15, path: Optional[str] = None,
+                 prioritized: bool = False, alpha: float = 0.6, beta: float = 0.4, augment: bool = True):
+        self.logger = Logger.get_instance()
+        self.capacity = capacity
+        self.board_size = board_size
+        self.cells = board_size * board_size
+        self.path = path
+        self.prioritized = prioritized
+        self.alpha = alpha  # 优先级指数（0为均匀采样）
+        self.beta = beta  # 重要性采样修正指数
+        self.augment = augment
+        self.gather, self.scatter = dihedral_permutations(board_size)
+        self.position = 0  # 下一条写入位置
+        self.size = 0  # 有效条数
+        self.max_priority = 1.0
+        self._allocate()
+        self.tree = SumTree(capacity) if prioritized else None
+        if self.tree is not None and self.size > 0:
+            self.tree.rebuild(self.priorities[:self.size].astype(np.float64) ** self.alpha)
+
+    # ------------------------------ 存储 ------------------------------
+    def _allocate(self):
+        shapes = {
+            'states': ((self.capacity, self.cells), np.int8),
+            'next_states': ((self.capacity, self.cells), np.int8),
+            'actions': ((self.capacity,), np.int16),
+            'rewards': ((self.capacity,), np.float32),
+            'dones': ((self.capacity,), np.uint8),
+            'priorities': ((self.capacity,), np.float32)
+        }
+        if not self.path:
+            for name, (shape, dtype) in shapes.items():
+                setattr(self, name, np.zeros(shape, dtype=dtype))
+            return
+        os.makedirs(self.path, exist_ok=True)
+        meta = self._load_meta()
+        reuse = meta is not None and meta.get('capacity') == self.capacity and meta.get('cells') == self.cells
+        for name, (shape, dtype) in shapes.items():
+            file_path = os.path.join(self.path, f"{name}.npy")
+            if reuse and os.path.exists(file_path):
+                array = np.lib.format.open_memmap(file_path, mode='r+')
+            else:
+                array = np.lib.format.open_memmap(file_path, mode='w+', dtype=dtype, shape=shape)
+            setattr(self, name, array)
+        if reuse:
+            self.position, self.size = meta['position'], meta['size']
+            self.max_priority = meta.get('max_priority', 1.0)
+            self.logger.info(f"加载持久化经验回放池：{self.path}，{self.size}/{self.capacity}条")
+        elif meta is not None:
+            self.logger.warning(f"经验回放池容量或棋盘大小变化，重新创建：{self.path}")
+
+    def _load_meta(self) -> Optional[dict]:
+        meta_path = os.path.join(self.path, 'meta.json')
+        if not os.path.exists(meta_path):
+            return None
+        try:
+            with open(meta_path, 'r', encoding='utf-8') as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return None
+
+    def flush(self):
+        """把内存映射数组与写指针落盘（未指定path时无操作）"""
+        if not self.path:
+            return
+        for name in self.FIELDS:
+            getattr(self, name).flush()
+        meta = {'capacity': self.capacity, 'cells': self.cells, 'position': self.position,
+                'size': self.size, 'max_priority': self.max_priority}
+        with open(os.path.join(self.path, 'meta.json'), 'w', encoding='utf-8') as f:
+            json.dump(meta, f)
+
+    def __len__(self) -> int:
+        return self.size
+
+    # ------------------------------ 写入 ------------------------------
+    def add(self, state: np.ndarray, action: int, reward: float, next_state: np.ndarray, done: bool):
+        """写入一条经验（覆盖最旧的一条），新经验取当前最大优先级"""
+        i = self.position
+        self.states[i] = state
+        self.next_states[i] = next_state
+        self.actions[i] = action
+        self.rewards[i] = reward
+        self.dones[i] = done
+        self.priorities[i] = self.max_priority
+        if self.tree is not None:
+            self.tree.update(np.array([i]), np.array([self.max_priority ** self.alpha]))
+        self.position = (i + 1) % self.capacity
+        self.size = min(self.size + 1, self.capacity)
+
+    def add_batch(self, states: np.ndarray, actions: np.ndarray, rewards: np.ndarray, next_states: np.ndarray, dones: np.ndarray):
+        """批量写入（按环形位置一次赋值）"""
+        count = len(actions)
+        if count == 0:
+            return
+        if count > self.capacity:
+            states, actions, rewards, next_states, dones = (a[-self.capacity:] for a in (states, actions, rewards, next_states, dones))
+            count = self.capacity
+        idx = (self.position + np.arange(count)) % self.capacity
+        self.states[idx] = states
+        self.next_states[idx] = next_states
+        self.actions[idx] = actions
+        self.rewards[idx] = rewards
+        self.dones[idx] = dones
+        self.priorities[idx] = self.max_priority
+        if self.tree is not None:
+            self.tree.update(idx, np.full(count, self.max_priority ** self.alpha))
+        self.position = int((self.position + count) % self.capacity)
+        self.size = min(self.size + count, self.capacity)
+
+    # ------------------------------ 采样 ------------------------------
+    def sample(self, batch_size: int) -> Tuple[np.ndarray, ...]:
+        """采样一批经验，返回(下标, 局面, 动作, 奖励, 下一局面, 终局, 重要性权重)
+
+        开启对称增强时每条样本随机取8种对称之一：局面按置换表一次gather取出（不先拷贝原局面），
+        动作下标同步映射。均匀采样时重要性权重全为1。
+        """
+        if self.tree is not None:
+            total = self.tree.total
+            # 分层采样：把总优先级均分为batch_size段，每段取一点
+            prefix = (np.arange(batch_size) + np.random.random(batch_size)) * (total / batch_size)
+            indices = np.minimum(self.tree.find(prefix), self.size - 1)
+            probs = self.tree.tree[indices + self.tree.leaves] / max(total, 1e-12)
+            weights = (self.size * np.maximum(probs, 1e-12)) ** (-self.beta)
+            weights = (weights / weights.max()).astype(np.float32)
+        else:
+            indices = np.random.randint(0, self.size, size=batch_size)
+            weights = np.ones(batch_size, dtype=np.float32)
+
+        actions = self.actions[indices].astype(np.int64)
+        if self.augment:
+            syms = np.random.randint(0, 8, size=batch_size)
+            flat = indices[:, None] * self.cells + self.gather[syms]
+            states = self.states.reshape(-1)[flat]
+            next_states = self.next_states.reshape(-1)[flat]
+            actions = self.scatter[syms, actions]
+        else:
+            states = self.states[indices]
+            next_states = self.next_states[indices]
+        return indices, states, actions, self.rewards[indices], next_states, self.dones[indices], weights
+
+    def update_priorities(self, indices: np.ndarray, td_errors: np.ndarray):
+        """按TD误差更新采样到的经验的优先级（仅优先级模式）"""
+        if self.tree is None:
+            return
+        priorities = np.abs(td_errors).astype(np.float32) + 1e-3
+        self.priorities[indices] = priorities
+        self.max_priority = max(self.max_priority, float(priorities.max()))
+        self.tree.update(indices, priorities.astype(np.float64) ** self.alpha)
@@ -2,18 +2,23 @@ import torch
 import torch.nn as nn
 import torch.optim as optim
 import numpy as np
+import os
+import copy
 import random
-from collections import deque
+import time
 from typing import List, Tuple, Dict, Optional, Callable
 from Common.constants import PIECE_COLORS, AI_LEVELS, EVAL_WEIGHTS
 from Common.config import Config
 from Common.logger import Logger
+from Common.metrics import SearchMetrics
 from AI.base_ai import BaseAI
 from AI.evaluator import BoardEvaluator
+from AI.replay_buffer import ReplayBuffer
+from AI.model_registry import ModelRegistry
 from Compute.cpp_interface import CppCore
 from Compute.gpu_accelerator import GPUAccelerator
+from Compute.inference_server import InferenceServer
 from Storage.model_storage import ModelStorage
-from Storage.train_data_storage import TrainDataStorage
 
 class DQNNetwork(nn.Module):
     """深度Q网络（强化学习核心）"""
@@ -54,18 +59,16 @@ class RLAI(BaseAI):
         self.gpu_accelerator = GPUAccelerator()
         self.device = self.gpu_accelerator.get_device()
         self.model_storage = ModelStorage()
-        self.train_data_storage = TrainDataStorage()
 
         # 网络参数
         self.input_size = self.board_size ** 2
         self.hidden_size = self.config.get_int('AI', 'rl_hidden_size', 512)
         self.output_size = self.board_size ** 2
 
-        # 初始化DQN网络
-        self.policy_net = DQNNetwork(self.input_size, self.hidden_size, self.output_size).to(self.device)
-        self.target_net = DQNNetwork(self.input_size, self.hidden_size, self.output_size).to(self.device)
-        self.target_net.load_state_dict(self.policy_net.state_dict())
-        self.target_net.eval()
+        # DQN网络：对弈时直接使用注册表中共享的只读策略网络，目标网络与优化器在首次训练时才建立
+        self._target_net: Optional[DQNNetwork] = None
+        self._optimizer: Optional[optim.Optimizer] = None
+        self._trainable = False
 
         # 训练参数
         self.gamma = 0.99  # 折扣因子
@@ -73,10 +76,9 @@ class RLAI(BaseAI):
         self.learning_rate = self.config.get_float('AI', 'rl_learning_rate', 1e-4)
         self.batch_size = self.config.get_int('AI', 'rl_batch_size', 64)
         self.target_update = self.config.get_int('AI', 'rl_target_update', 100)  # 目标网络更新频率
-        self.memory = deque(maxlen=self.config.get_int('AI', 'rl_memory_size', 100000))  # 经验回放池
+        self._memory: Optional[ReplayBuffer] = None  # 经验回放池（首次训练时创建，对弈用实例不占内存）
 
-        # 优化器与损失函数
-        self.optimizer = optim.Adam(self.policy_net.parameters(), lr=self.learning_rate)
+        # 损失函数
         self.criterion = nn.MSELoss()
         self.scaler = torch.cuda.amp.GradScaler() if self.gpu_accelerator.use_gpu else None
 
@@ -86,33 +88,100 @@ class RLAI(BaseAI):
         self.best_win_rate = 0.0
         self.running = True
 
-        # 加载预训练模型
+        # 加载预训练模型（进程内同一检查点只加载一次）
+        self._inference: Optional[InferenceServer] = None
         self.load_best_model()
 
+    def _build_network(self) -> DQNNetwork:
+        return DQNNetwork(self.input_size, self.hidden_size, self.output_size)
+
+    @property
+    def target_net(self) -> DQNNetwork:
+        self._ensure_trainable()
+        return self._target_net
+
+    @property
+    def optimizer(self) -> optim.Optimizer:
+        self._ensure_trainable()
+        return self._optimizer
+
+    def _ensure_trainable(self):
+        """首次训练时把共享的只读策略网络拷贝为本实例私有的可训练副本，并建立目标网络与优化器（恢复检查点中的状态）"""
+        if self._trainable:
+            return
+        self.policy_net = copy.deepcopy(self._handle.module).requires_grad_(True)
+        self._target_net = copy.deepcopy(self.policy_net).requires_grad_(False)
+        self._target_net.eval()
+        self._optimizer = optim.Adam(self.policy_net.parameters(), lr=self.learning_rate)
+        if self._handle.path and self._handle.path.endswith('.pth'):
+            checkpoint = torch.load(self._handle.path, map_location=self.device)
+            if 'target_net_state_dict' in checkpoint:
+                self._target_net.load_state_dict(checkpoint['target_net_state_dict'])
+            if 'optimizer_state_dict' in checkpoint:
+                self._optimizer.load_state_dict(checkpoint['optimizer_state_dict'])
+        self._inference = None  # 训练中的网络不再与对弈实例共用推理服务
+        self._trainable = True
+
+    @property
+    def memory(self) -> ReplayBuffer:
+        """经验回放池（预分配int8环形缓冲区，按配置可落盘复用、可选优先级采样与对称增强）"""
+        if self._memory is None:
+            self._memory = self._create_replay_buffer()
+        return self._memory
+
+    def _create_replay_buffer(self) -> ReplayBuffer:
+        path = None
+        if self.config.get_bool('AI', 'rl_replay_persist', True):
+            train_data_dir = self.config.get('PATH', 'train_data_dir', os.path.join(os.getcwd(), 'data', 'train_data'))
+            path = os.path.join(train_data_dir, f"replay_{self.board_size}")
+        return ReplayBuffer(
+            self.config.get_int('AI', 'rl_memory_size', 100000), self.board_size, path=path,
+            prioritized=self.config.get_bool('AI', 'rl_prioritized_replay', False),
+            augment=self.config.get_bool('AI', 'rl_replay_augment', True)
+        )
+
+    def _to_device(self, array: np.ndarray) -> torch.Tensor:
+        """numpy批次→设备张量（GPU时经锁页内存异步拷贝，int8局面到设备后再转float）"""
+        tensor = torch.from_numpy(np.ascontiguousarray(array))
+        if self.gpu_accelerator.use_gpu:
+            tensor = tensor.pin_memory().to(self.device, non_blocking=True)
+        return tensor
+
+    @property
+    def inference(self) -> InferenceServer:
+        """批量推理服务（同一策略网络的所有请求攒批前向，首次使用时启动）"""
+        if self._inference is None:
+            self._inference = InferenceServer.for_model(self.policy_net, self.device)
+        return self._inference
+
+    def _board_vector(self, board: List[List[int]]) -> np.ndarray:
+        """棋盘→网络输入向量：己方1，对手-1，空位0"""
+        board_np = np.array(board, dtype=np.float32)
+        vector = np.zeros_like(board_np)
+        vector[board_np == self.color] = 1.0
+        vector[board_np == self.opponent_color] = -1.0
+        return vector.flatten()
+
     def _preprocess_board(self, board: List[List[int]]) -> torch.Tensor:
         """预处理棋盘：转换为网络输入"""
-        board_np = np.array(board, dtype=np.float32)
-        board_np[board_np == self.color] = 1.0
-        board_np[board_np == self.opponent_color] = -1.0
-        board_np[board_np == PIECE_COLORS['EMPTY']] = 0.0
-        return torch.tensor(board_np.flatten(), dtype=torch.float32).unsqueeze(0).to(self.device)
-
-    def _get_action(self, board: List[List[int]], training: bool = False) -> Tuple[int, int]:
-        """获取落子动作（探索/利用）"""
-        state = self._preprocess_board(board)
+        return torch.from_numpy(self._board_vector(board)).unsqueeze(0).to(self.device)
+
+    def _q_values(self, board: List[List[int]]) -> np.ndarray:
+        """全盘Q值（经批量推理服务，与其他对局/线程的请求合批）"""
+        return self.inference.infer(self._board_vector(board))
+
+    def _get_action(self, board: List[List[int]], training: bool = False, q_values: Optional[np.ndarray] = None) -> Tuple[int, int]:
+        """获取落子动作（探索/利用；q_values为已算好的全盘Q值，可省一次推理）"""
         # 探索：随机落子
         if training and random.random() < self.epsilon:
-            empty_pos = self._get_empty_positions(board)
-            return random.choice(empty_pos)
+            return random.choice(self._get_candidates(board))
         # 利用：网络预测
-        with torch.no_grad():
-            q_values = self.policy_net(state)
-            q_values = q_values.cpu().numpy()[0]
-            # 过滤已落子位置
-            board_flat = np.array(board).flatten()
-            q_values[board_flat != PIECE_COLORS['EMPTY']] = -float('inf')
-            best_idx = np.argmax(q_values)
-            return self._idx_to_move(best_idx)
+        q_values = (self._q_values(board) if q_values is None else q_values).copy()
+        # 过滤已落子位置
+        board_flat = np.array(board).flatten()
+        q_values[board_flat != PIECE_COLORS['EMPTY']] = -float('inf')
+        best_idx = np.argmax(q_values)
+        return self._idx_to_move(best_idx)
 
     def _idx_to_move(self, idx: int) -> Tuple[int, int]:
         """索引→落子坐标"""
@@ -138,23 +207,23 @@ class RLAI(BaseAI):
 
     def store_experience(self, state: List[List[int]], action: Tuple[int, int], reward: float, next_state: List[List[int]], done: bool):
         """存储经验到回放池"""
-        state_tensor = self._preprocess_board(state)
-        next_state_tensor = self._preprocess_board(next_state)
-        action_idx = self._move_to_idx(action)
-        self.memory.append((state_tensor, action_idx, reward, next_state_tensor, done))
+        self.memory.add(self._board_vector(state).astype(np.int8), self._move_to_idx(action), reward,
+                        self._board_vector(next_state).astype(np.int8), done)
 
     def train_batch(self) -> Optional[float]:
         """批量训练网络（GPU加速+混合精度）"""
+        self._ensure_trainable()
         if len(self.memory) < self.batch_size:
             return None
 
-        # 采样批次
-        batch = random.sample(self.memory, self.batch_size)
-        state_batch = torch.cat([exp[0] for exp in batch])
-        action_batch = torch.tensor([exp[1] for exp in batch], dtype=torch.long).to(self.device)
-        reward_batch = torch.tensor([exp[2] for exp in batch], dtype=torch.float32).to(self.device)
-        next_state_batch = torch.cat([exp[3] for exp in batch])
-        done_batch = torch.tensor([exp[4] for exp in batch], dtype=torch.float32).to(self.device)
+        # 采样批次（整批一次gather，每个字段一次拷贝到设备）
+        indices, states, actions, rewards, next_states, dones, weights = self.memory.sample(self.batch_size)
+        state_batch = self._to_device(states).float()
+        action_batch = self._to_device(actions)
+        reward_batch = self._to_device(rewards)
+        next_state_batch = self._to_device(next_states).float()
+        done_batch = self._to_device(dones).float()
+        weight_batch = self._to_device(weights)
 
         # 混合精度训练
         if self.gpu_accelerator.use_gpu and self.scaler:
@@ -163,7 +232,8 @@ class RLAI(BaseAI):
                 with torch.no_grad():
                     q_next = self.target_net(next_state_batch).max(1)[0]
                     q_target = reward_batch + self.gamma * q_next * (1 - done_batch)
-                loss = self.criterion(q_current, q_target)
+                td_error = q_current.float() - q_target.float()
+                loss = (weight_batch * td_error.pow(2)).mean()
             # 反向传播
             self.optimizer.zero_grad()
             self.scaler.scale(loss).backward()
@@ -174,11 +244,16 @@ class RLAI(BaseAI):
             with torch.no_grad():
                 q_next = self.target_net(next_state_batch).max(1)[0]
                 q_target = reward_batch + self.gamma * q_next * (1 - done_batch)
-            loss = self.criterion(q_current, q_target)
+            td_error = q_current - q_target
+            loss = (weight_batch * td_error.pow(2)).mean()
             self.optimizer.zero_grad()
             loss.backward()
             self.optimizer.step()
 
+        # 优先级模式：按TD误差更新采样经验的优先级
+        if self.memory.prioritized:
+            self.memory.update_priorities(indices, td_error.detach().cpu().numpy())
+
         # 更新目标网络
         self.train_step += 1
         if self.train_step % self.target_update == 0:
@@ -188,10 +263,22 @@ class RLAI(BaseAI):
         return loss.item()
 
     def self_play(self, num_games: int = 100):
-        """自我对弈训练"""
+        """自我对弈训练（配置了执行者进程数时走多进程执行者池，否则本进程串行对弈）"""
+        num_actors = self.config.get_int('AI', 'rl_self_play_actors', 2)
+        if num_actors > 0 and self.cpp_core:
+            return self._parallel_self_play(num_games, num_actors)
+
+        self._ensure_trainable()
         self.policy_net.train()
         total_loss = 0.0
         total_wins = 0
+        # 对手：镜像AI（浅拷贝自身后换执子颜色，权重与推理服务共用，不再重新构造RLAI）
+        opponent_ai = copy.copy(self)
+        BaseAI.__init__(opponent_ai, self.opponent_color, self.level)
+        opponent_ai._inference = self.inference
+        # 己方落子流式写入自我对弈二进制数据集（与TrainingManager生成的数据同一数据集，预处理/统计一并读取）
+        from AI.training_manager import TrainingManager
+        writer = TrainingManager()._writer(board_size=self.board_size)
 
         for game_idx in range(num_games):
             board = [[PIECE_COLORS['EMPTY'] for _ in range(self.board_size)] for _ in range(self.board_size)]
@@ -205,13 +292,11 @@ class RLAI(BaseAI):
                 if current_color == self.color:
                     action = self._get_action(board, training=True)
                 else:
-                    # 对手：镜像AI
-                    opponent_ai = RLAI(self.opponent_color, self.level, use_cpp=False)
-                    opponent_ai.policy_net.load_state_dict(self.policy_net.state_dict())
                     action = opponent_ai._get_action(board, training=True)
 
                 # 执行落子
                 x, y = action
+                state = [row.copy() for row in board]
                 board[x][y] = current_color
                 move_count += 1
 
@@ -224,7 +309,8 @@ class RLAI(BaseAI):
                 reward = self._get_reward(board, done)
                 if current_color == self.color:
                     next_board = [row.copy() for row in board]
-                    game_memory.append((board, action, reward, next_board, done))
+                    self.store_experience(state, action, reward, next_board, done)
+                    game_memory.append((state, action))
                     # 批量训练
                     loss = self.train_batch()
                     if loss is not None:
@@ -237,6 +323,14 @@ class RLAI(BaseAI):
             if ai_win:
                 total_wins += 1
             self.self_play_games += 1
+            result = 'win' if ai_win else 'lose' if opponent_win else 'draw'
+            game_id = f"rl_self_play_{int(time.time())}_{game_idx}"
+            for state, (x, y) in game_memory:
+                analysis = self.evaluator.analyze_move_quality(state, x, y, self.color)
+                writer.append({'move': (x, y), 'color': self.color, 'pattern': analysis['pattern'],
+                               'score': round(analysis['score'], 2), 'quality': analysis['quality'],
+                               'position_weight': round(analysis['position_weight'], 2), 'result': result,
+                               'game_id': game_id}, board=state)
 
             # 进度日志
             if (game_idx + 1) % 10 == 0:
@@ -245,22 +339,73 @@ class RLAI(BaseAI):
                 self.logger.info(f"自我对弈进度：{game_idx+1}/{num_games}，平均损失：{avg_loss:.4f}，胜率：{win_rate:.2%}")
                 total_loss = 0.0
 
+        writer.close()
+
         # 保存最优模型
         final_win_rate = total_wins / num_games
         if final_win_rate > self.best_win_rate:
             self.best_win_rate = final_win_rate
             self.save_model(f"rl_best_model_winrate_{final_win_rate:.2%}.pth")
-            # 保存训练数据
-            self.train_data_storage.save_self_play_data([
-                {'board': DataUtils.board_to_str(exp[0]), 'move': exp[1], 'score': exp[2], 'result': 'win' if ai_win else 'lose', 'timestamp': time.time()}
-                for exp in game_memory
-            ])
 
         self.logger.info(f"自我对弈完成：{num_games}局，总胜率：{final_win_rate:.2%}")
 
+    def _parallel_self_play(self, num_games: int, num_actors: int):
+        """多进程自我对弈：执行者进程产生对局经验，本进程作为学习者持续训练并定期广播权重"""
+        from AI.self_play_pool import SelfPlayPool
+        publish_steps = self.config.get_int('AI', 'rl_weight_publish_steps', 50)  # 每训练多少步广播一次权重
+        pool = SelfPlayPool(
+            self.board_size, num_actors, self.hidden_size, self.epsilon,
+            games_in_flight=self.config.get_int('AI', 'rl_actor_games_in_flight', 4),
+            mcts_iterations=self.config.get_int('AI', 'rl_actor_mcts_iterations', 0)
+        )
+        self._ensure_trainable()
+        self.policy_net.train()
+        total_loss, loss_count, wins, games_done = 0.0, 0, 0, 0
+        last_publish = self.train_step
+        pool.start(self.policy_net, num_games)
+        try:
+            while self.running:
+                actors_done = pool.finished()  # 先判断再取：执行者退出前写入的经验与对局在退出循环前全部取完
+                batch = pool.poll_experiences()
+                if batch is not None:
+                    self.memory.add_batch(*batch)
+                    # 每条新经验训练一步（与串行自我对弈的样本/训练比一致）
+                    for _ in range(len(batch[1])):
+                        loss = self.train_batch()
+                        if loss is None:
+                            break
+                        total_loss += loss
+                        loss_count += 1
+                    if self.train_step - last_publish >= publish_steps:
+                        pool.publish_weights(self.policy_net)
+                        last_publish = self.train_step
+
+                games = pool.poll_games()
+                if batch is None and not games:
+                    if actors_done:
+                        break
+                    time.sleep(0.005)
+                for game in games:
+                    games_done += 1
+                    wins += game['winner'] == self.color
+                    self.self_play_games += 1
+                    if games_done % 10 == 0:
+                        self.logger.info(f"自我对弈进度：{games_done}/{num_games}，平均损失：{total_loss / max(loss_count, 1):.4f}，"
+                                         f"胜率：{wins / games_done:.2%}，经验池：{len(self.memory)}")
+                        total_loss, loss_count = 0.0, 0
+        finally:
+            pool.stop()
+
+        final_win_rate = wins / max(games_done, 1)
+        if games_done and final_win_rate > self.best_win_rate:
+            self.best_win_rate = final_win_rate
+            self.save_model(f"rl_best_model_winrate_{final_win_rate:.2%}.pth")
+        self.logger.info(f"多进程自我对弈完成：{games_done}局（{num_actors}个执行者），执方胜率：{final_win_rate:.2%}")
+
     def move(self, board: List[List[int]], thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
         """AI落子（DQN+MCTS优化）"""
         self.thinking_callback = thinking_callback
+        probe = SearchMetrics.get_instance().begin_move('rl')
 
         # 思维可视化数据
         thinking_data = {
@@ -273,43 +418,54 @@ class RLAI(BaseAI):
         }
         self._notify_thinking(thinking_data)
 
-        # 检查必胜落子（C++快速判断）
+        # 检查必胜落子（C++威胁空间搜索：成五/VCF/VCT，命中则跳过整棵搜索）
         if self.cpp_core:
-            winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
+            with probe.phase('win_check'):
+                winning_move = self.cpp_core.find_winning_move(board, self.color, self.board_size)
             if winning_move:
                 thinking_data['best_move'] = winning_move
                 self._notify_thinking(thinking_data)
+                probe.finish(move=winning_move, source='win_check')
                 return winning_move
 
-        # DQN预测落子
+        # 查开局库（前若干步命中则直接落子，不占搜索预算）
+        with probe.phase('book'):
+            book_move = self._book_move(board)
+        if book_move:
+            thinking_data['best_move'] = book_move
+            self._notify_thinking(thinking_data)
+            probe.finish(move=book_move, source='book')
+            return book_move
+
+        # DQN预测落子（一次推理，热力图复用同一组Q值）
         self.policy_net.eval()
-        init_move = self._get_action(board, training=False)
+        with probe.phase('inference'):
+            q_values = self._q_values(board)
+        init_move = self._get_action(board, training=False, q_values=q_values)
 
         # C++ MCTS优化落子
         if self.cpp_core:
             mcts_depth = 6 if self.level == AI_LEVELS['EXPERT'] else 4
-            best_move = self.cpp_core.mcts_optimize(
-                board=board,
-                init_move=init_move,
-                color=self.color,
-                depth=mcts_depth,
-                iterations=1000
-            )
+            with probe.phase('search'):
+                best_move = self.cpp_core.mcts_optimize(
+                    board=board,
+                    init_move=init_move,
+                    color=self.color,
+                    depth=mcts_depth,
+                    iterations=1000
+                )
         else:
             best_move = init_move
 
         # 思维可视化：更新评分热力图
-        empty_pos = self._get_empty_positions(board)[:10]
+        empty_pos = self._get_candidates(board, threat_first=True)[:10]
         for (x, y) in empty_pos:
-            state = self._preprocess_board(board)
-            with torch.no_grad():
-                q_values = self.policy_net(state).cpu().numpy()[0]
-                idx = self._move_to_idx((x, y))
-                thinking_data['scores'][x][y] = q_values[idx] * 20
+            thinking_data['scores'][x][y] = q_values[self._move_to_idx((x, y))] * 20
         thinking_data['best_move'] = best_move
         thinking_data['considering_moves'] = empty_pos[:5]
         thinking_data['value_estimate'] = self._evaluate(board, self.color)
         self._notify_thinking(thinking_data)
+        probe.finish(move=best_move, source='search' if self.cpp_core else 'policy', depth=thinking_data['depth'])
 
         return best_move
 
@@ -328,7 +484,7 @@ class RLAI(BaseAI):
             metadata={
                 'model_type': 'rl_dqn',
                 'win_rate': self.best_win_rate,
-                'train_data_count': len(self.memory),
+                'train_data_count': len(self._memory) if self._memory is not None else 0,
                 'train_params': {
                     'gamma': self.gamma,
                     'epsilon': self.epsilon,
@@ -337,20 +493,31 @@ class RLAI(BaseAI):
             }
         )
         self.logger.info(f"模型保存成功：{model_path[0]}")
+        ModelRegistry.get_instance().invalidate('rl')
+        if self._memory is not None:
+            self._memory.flush()
+
+    def load_model(self, model_path: Optional[str] = None):
+        """加载模型（经进程级注册表共享，model_path为空时取最优模型）"""
+        self._handle = ModelRegistry.get_instance().get('rl', self._build_network, self.device, model_path,
+                                                        state_keys=('policy_net_state_dict',))
+        self.policy_net = self._handle.module
+        self._target_net = self._optimizer = None
+        self._trainable = False
+        self._inference = None
+        meta = self._handle.meta
+        self.train_step = meta.get('train_step', 0)
+        self.self_play_games = meta.get('self_play_games', 0)
+        self.best_win_rate = meta.get('best_win_rate', 0.0)
+        if self._handle.path:
+            self.logger.info(f"加载RL模型成功：{self._handle.path}，胜率：{self.best_win_rate:.2%}")
 
     def load_best_model(self):
         """加载最优模型"""
-        best_model_path = self.model_storage.find_best_model('rl')
-        if best_model_path:
-            checkpoint = torch.load(best_model_path, map_location=self.device)
-            self.policy_net.load_state_dict(checkpoint['policy_net_state_dict'])
-            self.target_net.load_state_dict(checkpoint['target_net_state_dict'])
-            self.optimizer.load_state_dict(checkpoint['optimizer_state_dict'])
-            self.train_step = checkpoint['train_step']
-            self.self_play_games = checkpoint['self_play_games']
-            self.best_win_rate = checkpoint['best_win_rate']
-            self.logger.info(f"加载最优RL模型成功：{best_model_path}，胜率：{self.best_win_rate:.2%}")
+        self.load_model()
 
     def stop_training(self):
         """停止训练"""
-        self.running = False
\ No newline at end of file
+        self.running = False
+        if self._memory is not None:
+            self._memory.flush()
\ No newline at end of file
@@ -0,0 +1,343 @@
+import time
+import random
+import threading
+import multiprocessing as mp
+from multiprocessing import shared_memory
+import numpy as np
+from typing import List, Tuple, Dict, Optional
+from Common.constants import PIECE_COLORS
+from Common.logger import Logger
+
+class ExperienceRing:
+    """跨进程单生产者/单消费者经验环形队列（共享内存，无pickle）
+
+    每条经验为(落子前局面, 落子下标, 奖励, 落子后局面, 是否终局)，局面按落子方视角存int8（己方1、对方-1、空0）。
+    生产者写完数据后再推进tail，消费者读完后推进head；计数器带锁，锁同时充当跨进程的内存屏障。
+    """
+    def __init__(self, ctx, capacity: int, cells: int):
+        self.capacity = capacity
+        self.cells = cells
+        self._shm = shared_memory.SharedMemory(create=True, size=self._nbytes(capacity, cells))
+        self._owner = True
+        self.head = ctx.Value('q', 0)  # 已消费条数
+        self.tail = ctx.Value('q', 0)  # 已写入条数
+        self._bind()
+
+    @staticmethod
+    def _nbytes(capacity: int, cells: int) -> int:
+        return capacity * (2 * cells + 2 + 4 + 1)
+
+    def _bind(self):
+        cap, cells = self.capacity, self.cells
+        buf = self._shm.buf
+        offset = 0
+        self.states = np.ndarray((cap, cells), dtype=np.int8, buffer=buf, offset=offset)
+        offset += cap * cells
+        self.next_states = np.ndarray((cap, cells), dtype=np.int8, buffer=buf, offset=offset)
+        offset += cap * cells
+        self.actions = np.ndarray((cap,), dtype=np.int16, buffer=buf, offset=offset)
+        offset += cap * 2
+        self.rewards = np.ndarray((cap,), dtype=np.float32, buffer=buf, offset=offset)
+        offset += cap * 4
+        self.dones = np.ndarray((cap,), dtype=np.uint8, buffer=buf, offset=offset)
+
+    def __getstate__(self):
+        return {'capacity': self.capacity, 'cells': self.cells, 'name': self._shm.name, 'head': self.head, 'tail': self.tail}
+
+    def __setstate__(self, state):
+        self.capacity, self.cells = state['capacity'], state['cells']
+        self.head, self.tail = state['head'], state['tail']
+        self._shm = shared_memory.SharedMemory(name=state['name'])
+        self._owner = False
+        self._bind()
+
+    def put(self, states: np.ndarray, actions: np.ndarray, rewards: np.ndarray, next_states: np.ndarray,
+            dones: np.ndarray, stop_event=None) -> bool:
+        """写入一批经验（队列满时等待消费者），被stop_event中止时返回False"""
+        count = len(actions)
+        while self.tail.value + count - self.head.value > self.capacity:
+            if stop_event is not None and stop_event.is_set():
+                return False
+            time.sleep(0.001)
+        idx = (self.tail.value + np.arange(count)) % self.capacity
+        self.states[idx] = states
+        self.next_states[idx] = next_states
+        self.actions[idx] = actions
+        self.rewards[idx] = rewards
+        self.dones[idx] = dones
+        with self.tail.get_lock():
+            self.tail.value += count
+        return True
+
+    def get(self, max_count: int) -> Optional[Tuple[np.ndarray, ...]]:
+        """取出至多max_count条经验（拷贝），队列空时返回None"""
+        head = self.head.value
+        count = min(self.tail.value - head, max_count)
+        if count <= 0:
+            return None
+        idx = (head + np.arange(count)) % self.capacity
+        batch = (self.states[idx], self.actions[idx], self.rewards[idx], self.next_states[idx], self.dones[idx])
+        with self.head.get_lock():
+            self.head.value += count
+        return batch
+
+    def close(self):
+        # 先释放numpy视图，否则共享内存无法关闭
+        self.states = self.next_states = self.actions = self.rewards = self.dones = None
+        self._shm.close()
+        if self._owner:
+            self._shm.unlink()
+
+class WeightBoard:
+    """跨进程权重广播板（共享内存中的一块扁平float32参数 + 版本号），学习者写入、执行者按版本拉取"""
+    def __init__(self, ctx, model):
+        self.layout = [(name, tuple(tensor.shape)) for name, tensor in model.state_dict().items()]
+        self.size = sum(int(np.prod(shape)) for _, shape in self.layout)
+        self._shm = shared_memory.SharedMemory(create=True, size=max(self.size, 1) * 4)
+        self._owner = True
+        self.version = ctx.Value('q', 0)  # 其锁同时保护参数区的读写
+        self._bind()
+        self.publish(model)
+
+    def _bind(self):
+        self.params = np.ndarray((self.size,), dtype=np.float32, buffer=self._shm.buf)
+
+    def __getstate__(self):
+        return {'layout': self.layout, 'size': self.size, 'name': self._shm.name, 'version': self.version}
+
+    def __setstate__(self, state):
+        self.layout, self.size, self.version = state['layout'], state['size'], state['version']
+        self._shm = shared_memory.SharedMemory(name=state['name'])
+        self._owner = False
+        self._bind()
+
+    def publish(self, model):
+        """写入最新权重并推进版本号"""
+        state = model.state_dict()
+        flat = np.concatenate([state[name].detach().float().cpu().numpy().ravel() for name, _ in self.layout]) if self.layout else np.zeros(0, np.float32)
+        with self.version.get_lock():
+            self.params[:] = flat
+            self.version.value += 1
+
+    def pull(self, model, known_version: int) -> int:
+        """版本比known_version新时把权重原地拷入model（推理线程可能同时在跑，允许读到新旧混合的权重），返回当前版本"""
+        import torch
+        with self.version.get_lock():
+            version = self.version.value
+            if version == known_version:
+                return version
+            flat = self.params.copy()
+        state = model.state_dict()
+        offset = 0
+        with torch.no_grad():
+            for name, shape in self.layout:
+                count = int(np.prod(shape))
+                state[name].copy_(torch.from_numpy(flat[offset:offset + count].reshape(shape)))
+                offset += count
+        return version
+
+    def close(self):
+        self.params = None
+        self._shm.close()
+        if self._owner:
+            self._shm.unlink()
+
+def _board_vector(board: List[List[int]], color: int) -> np.ndarray:
+    """落子方视角的int8局面向量（己方1、对方-1、空0）"""
+    board_np = np.array(board, dtype=np.int8)
+    opponent = PIECE_COLORS['WHITE'] if color == PIECE_COLORS['BLACK'] else PIECE_COLORS['BLACK']
+    return ((board_np == color).astype(np.int8) - (board_np == opponent).astype(np.int8)).ravel()
+
+def _actor_main(actor_id: int, settings: Dict, ring: ExperienceRing, weights: WeightBoard, games_left, game_queue, stop_event):
+    """执行者进程：若干对局线程共用一个本进程推理服务（对局之间合批），对局走C++规则/必胜检查，经验写入共享环形队列"""
+    import torch
+    from AI.rl_ai import DQNNetwork
+    from Compute.cpp_interface import CppCore
+    from Compute.inference_server import InferenceServer
+    torch.set_num_threads(1)
+    n = settings['board_size']
+    cells = n * n
+    net = DQNNetwork(cells, settings['hidden_size'], cells)
+    net.eval()
+    version = weights.pull(net, -1)
+    server = InferenceServer(net, 'cpu', max_batch=settings['games_in_flight'], max_latency_ms=1.0)
+    cpp_core = CppCore()
+    rng = random.Random(settings['seed'] + actor_id)
+    state_lock = threading.Lock()  # 多个对局线程共用一个单生产者队列与权重版本
+
+    def next_game() -> bool:
+        with games_left.get_lock():
+            if games_left.value <= 0:
+                return False
+            games_left.value -= 1
+            return True
+
+    def pick_move(board, color, engine, empty_count) -> Tuple[int, int]:
+        winning = cpp_core.find_winning_move(board, color, n, settings['threat_budget']) if cpp_core else None
+        if winning:
+            return winning
+        with state_lock:
+            explore = rng.random() < settings['epsilon']
+        if explore or empty_count == cells:
+            candidates = cpp_core.create_search_board(board).candidates(color)
+            with state_lock:
+                return rng.choice(candidates)
+        if engine is not None:
+            move = engine.search(board, color, settings['mcts_iterations'], 1.414, None, rng.getrandbits(64))
+            if move is not None:
+                return move
+        q_values = server.infer(_board_vector(board, color).astype(np.float32)).copy()
+        q_values[np.array(board).ravel() != PIECE_COLORS['EMPTY']] = -np.inf
+        idx = int(np.argmax(q_values))
+        return (idx // n, idx % n)
+
+    def play_games():
+        nonlocal version
+        engine = cpp_core.create_mcts_engine(8) if settings['mcts_iterations'] > 0 else None
+        while not stop_event.is_set() and next_game():
+            with state_lock:
+                version = weights.pull(net, version)
+            board = [[PIECE_COLORS['EMPTY']] * n for _ in range(n)]
+            color = PIECE_COLORS['BLACK']
+            empty_count = cells
+            states, actions, rewards, next_states, dones, moves = [], [], [], [], [], []
+            winner = PIECE_COLORS['EMPTY']
+            while empty_count > 0:
+                x, y = pick_move(board, color, engine, empty_count)
+                states.append(_board_vector(board, color))
+                board[x][y] = color
+                empty_count -= 1
+                actions.append(x * n + y)
+                next_states.append(_board_vector(board, color))
+                rewards.append(0.0)
+                dones.append(0)
+                moves.append((x, y, color))
+                result = cpp_core.check_game_end_from(board, x, y, color, empty_count)
+                if result['is_end']:
+                    winner = result['winner']
+                    break
+                color = PIECE_COLORS['WHITE'] if color == PIECE_COLORS['BLACK'] else PIECE_COLORS['BLACK']
+            # 终局奖励：胜方最后一步+10、负方最后一步-10，平局双方各0.5
+            rewards[-1], dones[-1] = (10.0 if winner else 0.5), 1
+            if len(rewards) >= 2:
+                rewards[-2], dones[-2] = (-10.0 if winner else 0.5), 1
+            with state_lock:
+                if not ring.put(np.stack(states), np.array(actions, np.int16), np.array(rewards, np.float32),
+                                np.stack(next_states), np.array(dones, np.uint8), stop_event):
+                    return
+            game_queue.put({'actor': actor_id, 'moves': moves, 'winner': winner, 'weights_version': version})
+
+    threads = [threading.Thread(target=play_games, daemon=True) for _ in range(settings['games_in_flight'])]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    server.stop()
+    ring.close()
+    weights.close()
+
+class SelfPlayPool:
+    """多进程自我对弈执行者池（N个执行者进程产生对局，经共享内存环形队列把经验交给学习者，学习者定期广播权重）"""
+    def __init__(self, board_size: int, num_actors: int, hidden_size: int, epsilon: float = 0.1,
+                 games_in_flight: int = 4, mcts_iterations: int = 0, ring_capacity: int = 65536):
+        self.logger = Logger.get_instance()
+        self.board_size = board_size
+        self.num_actors = max(num_actors, 1)
+        self.ctx = mp.get_context('spawn')  # Windows只支持spawn；也避免fork后继承CUDA上下文
+        self.settings = {
+            'board_size': board_size,
+            'hidden_size': hidden_size,
+            'epsilon': epsilon,
+            'games_in_flight': max(games_in_flight, 1),
+            'mcts_iterations': mcts_iterations,
+            'threat_budget': 2000,
+            'seed': random.getrandbits(32)
+        }
+        self.ring_capacity = max(ring_capacity, board_size * board_size * 2)
+        self.rings: List[ExperienceRing] = []
+        self.weights: Optional[WeightBoard] = None
+        self.games_left = None
+        self.game_queue = None
+        self.stop_event = None
+        self.processes = []
+        self.games_done = 0
+        self.failed_actors: List[Tuple[int, int]] = []  # 异常退出的执行者：(编号, 退出码)
+        self._exit_checked = False
+
+    def start(self, model, num_games: int):
+        """启动执行者进程（model为学习者的策略网络，先广播一次初始权重）"""
+        self.weights = WeightBoard(self.ctx, model)
+        self.games_left = self.ctx.Value('q', num_games)
+        self.game_queue = self.ctx.Queue()
+        self.stop_event = self.ctx.Event()
+        self.games_done = 0
+        self.failed_actors = []
+        self._exit_checked = False
+        cells = self.board_size * self.board_size
+        self.rings = [ExperienceRing(self.ctx, self.ring_capacity, cells) for _ in range(self.num_actors)]
+        for actor_id, ring in enumerate(self.rings):
+            process = self.ctx.Process(target=_actor_main, daemon=True,
+                                       args=(actor_id, self.settings, ring, self.weights, self.games_left, self.game_queue, self.stop_event))
+            process.start()
+            self.processes.append(process)
+        self.num_games = num_games
+        self.logger.info(f"自我对弈执行者池启动：{self.num_actors}个进程×{self.settings['games_in_flight']}局并发，共{num_games}局")
+
+    def publish_weights(self, model):
+        """向所有执行者广播最新权重（执行者在下一局开始前拉取）"""
+        self.weights.publish(model)
+
+    def poll_experiences(self, max_count: int = 4096) -> Optional[Tuple[np.ndarray, ...]]:
+        """从各执行者队列取经验并拼接，没有新经验时返回None"""
+        parts = []
+        per_ring = max(max_count // len(self.rings), 1)
+        for ring in self.rings:
+            batch = ring.get(per_ring)
+            if batch is not None:
+                parts.append(batch)
+        if not parts:
+            return None
+        return tuple(np.concatenate([part[i] for part in parts]) for i in range(5))
+
+    def poll_games(self) -> List[Dict]:
+        """取已完成对局的摘要（落子序列、胜方、所用权重版本）"""
+        games = []
+        while True:
+            try:
+                games.append(self.game_queue.get_nowait())
+            except Exception:
+                break
+        self.games_done += len(games)
+        return games
+
+    def finished(self) -> bool:
+        """执行者已全部退出（对局全部完成，或执行者异常退出后不会再有新对局）
+
+        返回True后执行者写入的经验与对局摘要仍可能留在队列中，调用方应再取到空为止。
+        """
+        if any(process.is_alive() for process in self.processes):
+            return False
+        if not self._exit_checked:
+            self._exit_checked = True
+            self.failed_actors = [(actor_id, process.exitcode) for actor_id, process in enumerate(self.processes)
+                                  if process.exitcode]
+            if self.failed_actors:
+                self.logger.error(f"自我对弈执行者异常退出：{self.failed_actors}（编号, 退出码），"
+                                  f"已完成{self.games_done}/{self.num_games}局")
+        return True
+
+    def stop(self):
+        """停止执行者并释放共享内存"""
+        if self.stop_event is not None:
+            self.stop_event.set()
+        for process in self.processes:
+            process.join(timeout=5)
+            if process.is_alive():
+                process.terminate()
+        self.processes = []
+        for ring in self.rings:
+            ring.close()
+        self.rings = []
+        if self.weights is not None:
+            self.weights.close()
+            self.weights = None
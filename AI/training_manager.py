@@ -2,13 +2,19 @@ import os
 import json
 import csv
 import time
-from typing import List, Dict, Optional
+import shutil
+from typing import List, Dict, Optional, Tuple
+import numpy as np
 from Common.constants import PIECE_COLORS
+from Common.config import Config
 from Common.logger import Logger
 from Common.data_utils import DataUtils  # 补充数据工具类依赖
+from Common.position_file import PositionWriter, PositionReader, RESULT_CODES
 from Storage.train_data_storage import TrainDataStorage
 from AI.base_ai import BaseAI
 from AI.evaluator import BoardEvaluator
+from AI.data_pipeline import OnlineStats, chunk_statistics, chunk_features, map_chunks, default_workers, release_readers
+from AI.opening_book import OpeningBookBuilder
 
 class TrainingManager:
     """训练数据管理器（自我对弈/人工数据/数据预处理/统计）"""
@@ -17,12 +23,78 @@ class TrainingManager:
         self.train_data_storage = TrainDataStorage()
         self.evaluator = BoardEvaluator()
         self.data_dir = self.train_data_storage.base_dir
+        config = Config.get_instance()
+        self.compression = config.get('AI', 'train_data_compression', 'none')  # none / zstd / zlib
+        self.chunk_records = config.get_int('AI', 'train_data_chunk_records', 65536)
+        self.workers = config.get_int('AI', 'train_data_workers', 0) or default_workers()  # 分块处理进程数（0为自动）
+
+    # ------------------------------ 二进制数据集 ------------------------------
+    def _dataset_path(self, user_id: Optional[str] = None) -> str:
+        """数据集目录：自我对弈数据共用一个，人工数据按用户分开"""
+        return os.path.join(self.data_dir, 'self_play.gbd' if user_id is None else f"user_{user_id}.gbd")
+
+    def _writer(self, user_id: Optional[str] = None, board_size: int = 15) -> PositionWriter:
+        return PositionWriter(self._dataset_path(user_id), board_size, self.chunk_records, self.compression)
+
+    def _reader(self, user_id: Optional[str] = None) -> Optional[PositionReader]:
+        path = self._dataset_path(user_id)
+        return PositionReader(path) if os.path.exists(os.path.join(path, 'meta.json')) else None
+
+    LEGACY_MARKER = 'legacy_migrated'  # 数据集meta中的标记：旧版数据已转存过，不再重复导入
+
+    def migrate_legacy_data(self, user_id: str) -> int:
+        """把旧版CSV/JSON训练数据（棋盘字符串）流式转存为二进制数据集，返回转存条数
+
+        每个目标数据集只转存一次（转存后在其meta中记标记）；预处理与统计前自动调用。
+        """
+        count = 0
+        for load, target in ((self.train_data_storage.load_self_play_data, None),
+                             (lambda: self.train_data_storage.load_train_data(user_id), user_id)):
+            reader = self._reader(target)
+            if reader is not None and reader.meta.get(self.LEGACY_MARKER):
+                continue
+            legacy = [item for item in map(self._normalize_legacy, load() or []) if item is not None]
+            if not legacy:
+                if reader is not None:  # 没有旧版数据：直接记标记，之后不再加载旧版文件
+                    with self._writer(target, reader.board_size) as writer:
+                        writer.meta[self.LEGACY_MARKER] = True
+                continue
+            board_size = len(DataUtils.str_to_board(legacy[0]['board']))
+            with self._writer(target, board_size) as writer:
+                writer.extend(legacy)
+                writer.meta[self.LEGACY_MARKER] = True
+            count += len(legacy)
+        if count:
+            self.logger.info(f"旧版训练数据转存完成：用户{user_id}，{count}条")
+        return count
+
+    @staticmethod
+    def _normalize_legacy(item: Dict) -> Optional[Dict]:
+        """旧版记录补齐二进制数据集需要的字段：落子统一为"x,y"，缺执子颜色时按棋盘黑白子数推断；无法解析返回None"""
+        try:
+            board = DataUtils.str_to_board(item['board'])
+            move = item['move']
+            if isinstance(move, str):
+                move = move.strip('()[] ').split(',')
+            x, y = (int(v) for v in move)
+        except Exception:
+            return None
+        item = dict(item, move=f"{x},{y}")
+        if 'color' not in item:
+            black = sum(row.count(PIECE_COLORS['BLACK']) for row in board)
+            white = sum(row.count(PIECE_COLORS['WHITE']) for row in board)
+            item['color'] = PIECE_COLORS['BLACK'] if black <= white else PIECE_COLORS['WHITE']
+        return item
 
     def generate_self_play_data(self, ai: BaseAI, num_games: int = 100, user_id: str = 'system') -> List[Dict]:
         """生成自我对弈训练数据（对接AI自我对弈逻辑）"""
         total_data = []
         self.logger.info(f"启动自我对弈数据生成：{num_games}局，AI类型：{ai.__class__.__name__}")
+        num_actors = Config.get_instance().get_int('AI', 'rl_self_play_actors', 2)
+        if num_actors > 0 and hasattr(ai, 'policy_net'):
+            return self._parallel_self_play_data(ai, num_games, num_actors, user_id)
 
+        writer = self._writer(board_size=ai.board_size)
         for game_idx in range(num_games):
             board = [[PIECE_COLORS['EMPTY'] for _ in range(ai.board_size)] for _ in range(ai.board_size)]
             current_color = PIECE_COLORS['BLACK']
@@ -78,19 +150,75 @@ class TrainingManager:
                 data['game_id'] = f"self_play_{user_id}_{int(time.time())}_{game_idx}"
                 total_data.append(data)
 
-            # 增量保存（每10局保存一次，避免数据丢失）
+            # 流式写入数据集（攒满一块自动落盘），每10局输出进度
+            writer.extend(game_data)
             if (game_idx + 1) % 10 == 0:
-                self.train_data_storage.save_self_play_data(game_data)
                 self.logger.info(
                     f"自我对弈数据生成进度：{game_idx+1}/{num_games}局，"
                     f"本局步数：{move_count}，累计数据：{len(total_data)}条"
                 )
 
-        # 最终保存完整数据
-        self.train_data_storage.save_self_play_data(game_data)
+        writer.close()
         self.logger.info(f"自我对弈数据生成完成：共{num_games}局，累计{len(total_data)}条训练数据")
         return total_data
 
+    def _parallel_self_play_data(self, ai: BaseAI, num_games: int, num_actors: int, user_id: str) -> List[Dict]:
+        """多进程执行者池生成对局，本进程只回放落子序列做落子分析与存储"""
+        from AI.self_play_pool import SelfPlayPool
+        pool = SelfPlayPool(ai.board_size, num_actors, ai.hidden_size, ai.epsilon,
+                            games_in_flight=Config.get_instance().get_int('AI', 'rl_actor_games_in_flight', 4))
+        total_data = []
+        games_done = 0
+        writer = self._writer(board_size=ai.board_size)
+        pool.start(ai.policy_net, num_games)
+        try:
+            while True:
+                actors_done = pool.finished()  # 先判断再取：执行者退出前完成的对局在退出循环前全部取完
+                pool.poll_experiences(1 << 20)  # 只要对局摘要，丢弃经验以免执行者因队列满而阻塞
+                games = pool.poll_games()
+                if not games:
+                    if actors_done:
+                        break
+                    time.sleep(0.01)
+                    continue
+                for game in games:
+                    game_data = self._replay_game_record(game, ai, f"self_play_{user_id}_{int(time.time())}_{games_done}")
+                    games_done += 1
+                    total_data.extend(game_data)
+                    writer.extend(game_data)
+                    if games_done % 10 == 0:
+                        self.logger.info(f"自我对弈数据生成进度：{games_done}/{num_games}局，本局步数：{len(game['moves'])}，累计数据：{len(total_data)}条")
+        finally:
+            pool.stop()
+            writer.close()
+        self.logger.info(f"自我对弈数据生成完成：共{games_done}局（{num_actors}个执行者），累计{len(total_data)}条训练数据")
+        return total_data
+
+    def _replay_game_record(self, game: Dict, ai: BaseAI, game_id: str) -> List[Dict]:
+        """按落子序列重放一局，生成与串行自我对弈相同格式的单步数据"""
+        board = [[PIECE_COLORS['EMPTY'] for _ in range(ai.board_size)] for _ in range(ai.board_size)]
+        if game['winner'] == PIECE_COLORS['EMPTY']:
+            result = 'draw'
+        else:
+            result = 'win' if game['winner'] == ai.color else 'lose'
+        game_data = []
+        for x, y, color in game['moves']:
+            move_analysis = self.evaluator.analyze_move_quality(board, x, y, color)
+            game_data.append({
+                'board': DataUtils.board_to_str(board),
+                'move': f"{x},{y}",
+                'color': color,
+                'pattern': move_analysis['pattern'],
+                'score': round(move_analysis['score'], 2),
+                'quality': move_analysis['quality'],
+                'position_weight': round(move_analysis['position_weight'], 2),
+                'timestamp': time.time(),
+                'result': result,
+                'game_id': game_id
+            })
+            board[x][y] = color
+        return game_data
+
     def import_manual_data(self, file_path: str, user_id: str) -> bool:
         """导入人工标注数据（CSV格式，支持批量导入）"""
         if not os.path.exists(file_path):
@@ -124,8 +252,11 @@ class TrainingManager:
                     item['game_id'] = f"manual_{user_id}_{int(time.time())}_{len(cleaned_data)}"
                     cleaned_data.append(item)
 
-                # 保存到本地存储
-                self.train_data_storage.save_train_data(user_id, cleaned_data)
+                # 追加到用户的二进制数据集
+                if cleaned_data:
+                    board_size = len(DataUtils.str_to_board(cleaned_data[0]['board']))
+                    with self._writer(user_id, board_size) as writer:
+                        writer.extend(cleaned_data)
                 self.logger.info(f"人工数据导入成功：{file_path}，有效数据{len(cleaned_data)}/{len(data)}条")
                 return True
 
@@ -133,58 +264,48 @@ class TrainingManager:
             self.logger.error(f"人工数据导入失败：{str(e)}")
             return False
 
-    def preprocess_data(self, user_id: str, output_file: str = "processed_train_data.csv") -> bool:
-        """预处理训练数据（归一化、特征提取、格式标准化）"""
-        # 加载用户训练数据（合并自我对弈和人工数据）
-        self_play_data = self.train_data_storage.load_self_play_data() or []
-        user_train_data = self.train_data_storage.load_train_data(user_id) or []
-        total_data = self_play_data + user_train_data
+    def _chunk_tasks(self, user_id: str) -> List[Tuple[str, Dict, str]]:
+        """待处理的数据块列表：(数据集路径, 该块的meta条目, 来源)，来源为self_play或manual（先转存尚未转存的旧版数据）"""
+        self.migrate_legacy_data(user_id)
+        tasks = []
+        for source, owner in (('self_play', None), ('manual', user_id)):
+            reader = self._reader(owner)
+            if reader is not None:
+                tasks.extend((reader.path, chunk, source) for chunk in reader.meta['chunks'])
+        return tasks
 
-        if not total_data:
+    def preprocess_data(self, user_id: str, output_file: str = "processed_train_data.csv") -> bool:
+        """预处理训练数据（归一化、特征提取、格式标准化；按块流式处理，多进程并行，内存占用与数据量无关）"""
+        tasks = self._chunk_tasks(user_id)
+        if not tasks:
             self.logger.warning(f"无可用训练数据：用户{user_id}")
             return False
 
         try:
-            # 特征提取与归一化
-            processed_data = []
-            # 全局得分归一化（按最大值缩放）
-            all_scores = [float(item['score']) for item in total_data]
-            max_score = max(all_scores) if all_scores else 1.0
-            min_score = min(all_scores) if all_scores else 0.0
-
-            for item in total_data:
-                # 解析落子坐标
-                x, y = map(int, item['move'].split(','))
-                # 归一化得分（0-1区间）
-                normalized_score = (float(item['score']) - min_score) / (max_score - min_score) if max_score > min_score else 0.5
-                # 提取棋盘特征：空位置占比
-                board = DataUtils.str_to_board(item['board'])
-                empty_count = sum(row.count(PIECE_COLORS['EMPTY']) for row in board)
-                empty_ratio = empty_count / (len(board) * len(board))
-                # 结果标签化（1=胜，0=负，0.5=平）
-                result_label = 1.0 if item['result'] == 'win' else 0.0 if item['result'] == 'lose' else 0.5
-
-                processed_data.append({
-                    'game_id': item.get('game_id', f"processed_{int(time.time())}"),
-                    'x': x,
-                    'y': y,
-                    'color': item['color'],
-                    'normalized_score': round(normalized_score, 4),
-                    'quality': round(float(item['quality']), 2),
-                    'empty_ratio': round(empty_ratio, 4),
-                    'pattern': item['pattern'],
-                    'result_label': result_label,
-                    'timestamp': item.get('timestamp', time.time())
-                })
-
-            # 保存预处理后的数据（CSV格式）
+            start_time = time.time()
+            # 全局得分范围：由各块写入时记录的统计量合并（缺失时补算该块）
+            score_stats = OnlineStats()
+            for path, chunk, _ in tasks:
+                score_stats.merge(OnlineStats.from_dict(chunk['score']) if 'score' in chunk else chunk_statistics(path, chunk)['score'])
+            min_score, max_score = score_stats.min, score_stats.max
+
+            # 逐块提取特征并流式写出
             output_path = os.path.join(self.data_dir, output_file)
+            fieldnames = ['game_id', 'x', 'y', 'color', 'normalized_score', 'quality', 'empty_ratio',
+                          'pattern', 'result_label', 'timestamp']
+            feature_tasks = [(path, chunk, min_score, max_score, f"{source}_{user_id}_" if source == 'manual' else "self_play_")
+                             for path, chunk, source in tasks]
+            total = 0
             with open(output_path, 'w', newline='', encoding='utf-8') as f:
-                writer = csv.DictWriter(f, fieldnames=processed_data[0].keys())
-                writer.writeheader()
-                writer.writerows(processed_data)
-
-            self.logger.info(f"训练数据预处理完成：{output_path}，处理数据{len(processed_data)}条")
+                writer = csv.writer(f)
+                writer.writerow(fieldnames)
+                for features in map_chunks(feature_tasks, chunk_features, self.workers):
+                    writer.writerows(zip(*(features[name].tolist() for name in fieldnames)))
+                    total += len(features['x'])
+
+            self.logger.info(f"训练数据预处理完成：{output_path}，处理数据{total}条（{len(tasks)}块，"
+                             f"{self.workers}进程），得分均值{score_stats.mean:.2f}±{score_stats.variance ** 0.5:.2f}，"
+                             f"耗时{time.time() - start_time:.2f}s")
             return True
 
         except Exception as e:
@@ -192,18 +313,29 @@ class TrainingManager:
             return False
 
     def get_data_statistics(self, user_id: str) -> Dict:
-        """获取用户训练数据统计报告"""
-        # 加载所有相关数据
-        self_play_data = self.train_data_storage.load_self_play_data() or []
-        user_train_data = self.train_data_storage.load_train_data(user_id) or []
-        total_data = self_play_data + user_train_data
-
-        if not total_data:
+        """获取用户训练数据统计报告（单遍流式：各块并行统计后合并）"""
+        tasks = self._chunk_tasks(user_id)
+        counts = {'self_play': 0, 'manual': 0}
+        score_stats, quality_stats = OnlineStats(), OnlineStats()
+        result_counts = np.zeros(3, dtype=np.int64)
+        pattern_counts: Dict[str, int] = {}
+        coverage = None
+        for (_, _, source), stats in zip(tasks, map_chunks([task[:2] for task in tasks], chunk_statistics, self.workers)):
+            counts[source] += stats['count']
+            score_stats.merge(stats['score'])
+            quality_stats.merge(stats['quality'])
+            result_counts += stats['results']
+            for pattern, count in stats['patterns'].items():
+                pattern_counts[pattern] = pattern_counts.get(pattern, 0) + count
+            coverage = stats['coverage'] if coverage is None else coverage | stats['coverage']
+
+        total_count = counts['self_play'] + counts['manual']
+        if total_count == 0:
             return {
                 'user_id': user_id,
                 'total_count': 0,
-                'self_play_count': len(self_play_data),
-                'manual_count': len(user_train_data),
+                'self_play_count': counts['self_play'],
+                'manual_count': counts['manual'],
                 'win_count': 0,
                 'lose_count': 0,
                 'draw_count': 0,
@@ -213,68 +345,79 @@ class TrainingManager:
                 'data_coverage': "0%"
             }
 
-        # 基础统计
-        win_count = len([item for item in total_data if item['result'] == 'win'])
-        lose_count = len([item for item in total_data if item['result'] == 'lose'])
-        draw_count = len([item for item in total_data if item['result'] == 'draw'])
-        avg_quality = sum(float(item['quality']) for item in total_data) / len(total_data)
-        avg_score = sum(float(item['score']) for item in total_data) / len(total_data)
-
-        # 棋型分布统计
-        pattern_counts = {}
-        for item in total_data:
-            pattern = item['pattern']
-            pattern_counts[pattern] = pattern_counts.get(pattern, 0) + 1
+        win_count = int(result_counts[RESULT_CODES['win']])
         most_common_pattern = max(pattern_counts.items(), key=lambda x: x[1])[0] if pattern_counts else 'None'
 
-        # 数据覆盖率（棋盘位置覆盖）
-        covered_positions = set()
-        for item in total_data:
-            x, y = map(int, item['move'].split(','))
-            covered_positions.add((x, y))
-        board_size = self.evaluator.board_size
-        data_coverage = f"{len(covered_positions) / (board_size * board_size) * 100:.1f}%"
-
         return {
             'user_id': user_id,
-            'total_count': len(total_data),
-            'self_play_count': len(self_play_data),
-            'manual_count': len(user_train_data),
+            'total_count': total_count,
+            'self_play_count': counts['self_play'],
+            'manual_count': counts['manual'],
             'win_count': win_count,
-            'lose_count': lose_count,
-            'draw_count': draw_count,
-            'win_rate': round(win_count / len(total_data) * 100, 2) if len(total_data) > 0 else 0.0,
-            'avg_quality': round(avg_quality, 2),
-            'avg_score': round(avg_score, 2),
+            'lose_count': int(result_counts[RESULT_CODES['lose']]),
+            'draw_count': int(result_counts[RESULT_CODES['draw']]),
+            'win_rate': round(win_count / total_count * 100, 2),
+            'avg_quality': round(quality_stats.mean, 2),
+            'avg_score': round(score_stats.mean, 2),
             'most_common_pattern': most_common_pattern,
             'pattern_distribution': pattern_counts,
-            'data_coverage': data_coverage,
+            'data_coverage': f"{coverage.sum() / len(coverage) * 100:.1f}%",
             'last_updated': time.strftime("%Y-%m-%d %H:%M:%S", time.localtime())
         }
 
     def clear_old_data(self, user_id: str, days: int = 30) -> bool:
-        """清理过期训练数据（默认30天）"""
+        """清理过期训练数据（默认30天；按块过滤写入新数据集后整体替换）"""
         try:
             cutoff_time = time.time() - days * 86400
-            user_data = self.train_data_storage.load_train_data(user_id) or []
-            kept_data = []
-            deleted_count = 0
-
-            for item in user_data:
-                item_time = float(item.get('timestamp', 0))
-                if item_time >= cutoff_time:
-                    kept_data.append(item)
-                else:
-                    deleted_count += 1
-
-            # 保存保留数据
+            reader = self._reader(user_id)
+            if reader is None:
+                self.logger.info(f"无过期训练数据需要清理：用户{user_id}")
+                return True
+            path = self._dataset_path(user_id)
+            tmp_path = path + '.tmp'
+            if os.path.exists(tmp_path):
+                shutil.rmtree(tmp_path)
+            kept_count, deleted_count = 0, 0
+            # 沿用棋型编码与对局序号，保留的记录可直接整块拷贝
+            writer = PositionWriter(tmp_path, reader.board_size, self.chunk_records, self.compression, reader.patterns)
+            writer.meta['games'] = reader.meta.get('games', 0)
+            if reader.meta.get(self.LEGACY_MARKER):
+                writer.meta[self.LEGACY_MARKER] = True  # 已转存的旧版数据不因清理而重新导入
+            for records in reader.chunks():
+                keep = records['timestamp'] >= cutoff_time
+                kept_count += int(keep.sum())
+                deleted_count += int(len(records) - keep.sum())
+                writer.append_records(records[keep])
+            writer.close()
+            # 释放指向旧分块的内存映射（Windows下文件被映射时无法删除）
+            records = reader = None
+            release_readers(path)
+
+            # 替换原数据集
             if deleted_count > 0:
-                self.train_data_storage.save_train_data(user_id, kept_data)
-                self.logger.info(f"清理过期训练数据：用户{user_id}，删除{deleted_count}条，保留{len(kept_data)}条")
+                shutil.rmtree(path)
+                os.replace(tmp_path, path)
+                self.logger.info(f"清理过期训练数据：用户{user_id}，删除{deleted_count}条，保留{kept_count}条")
             else:
+                shutil.rmtree(tmp_path)
                 self.logger.info(f"无过期训练数据需要清理：用户{user_id}")
 
             return True
         except Exception as e:
             self.logger.error(f"清理过期训练数据失败：{str(e)}")
-            return False
\ No newline at end of file
+            return False
+
+    def build_opening_book(self, game_records: Optional[List[Dict]] = None, user_id: Optional[str] = None,
+                           board_size: int = 15) -> Optional[str]:
+        """由对战记录与训练数据集构建开局库（写入model_dir，供各AI开局查库），返回文件路径"""
+        try:
+            builder = OpeningBookBuilder(board_size)
+            for record in game_records or []:
+                builder.add_game_record(record)
+            for path in {self._dataset_path(), self._dataset_path(user_id)}:
+                if os.path.exists(path):
+                    builder.add_dataset(path)
+            return builder.save(min_count=Config.get_instance().get_int('AI', 'book_min_count', 3))
+        except Exception as e:
+            self.logger.error(f"构建开局库失败：{str(e)}")
+            return None
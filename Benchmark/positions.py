@@ -0,0 +1,72 @@
+"""基准测试局面库（15路，固定不变，基线对比的前提）
+
+局面用落子序列表示（黑先、黑白交替），序列长度的奇偶决定走子方。
+开局/中局没有唯一解，不给出答案；战术与VCF局面给出goal与expected（正确应手）：
+- goal为win：走子方一步成五或连续冲四必胜，C++必胜搜索应找到（expected为求解器找到的首手，可能还有其他必胜首手）；
+- goal为defend：对方已成冲四，expected为唯一的防守点。
+"""
+from typing import Dict, List, Optional, Tuple
+from Common.constants import PIECE_COLORS
+
+POSITIONS: List[Dict] = [
+    # ------------------------------ 开局 ------------------------------
+    {'name': 'open_empty', 'category': 'opening', 'moves': []},
+    {'name': 'open_1', 'category': 'opening', 'moves': [(7, 7)]},
+    {'name': 'open_3', 'category': 'opening', 'moves': [(7, 7), (6, 8), (8, 8)]},
+    {'name': 'open_6', 'category': 'opening', 'moves': [(7, 7), (7, 8), (6, 7), (5, 7), (6, 8), (6, 6)]},
+    # ------------------------------ 中局（双方均无强制胜） ------------------------------
+    {'name': 'mid_14', 'category': 'midgame',
+     'moves': [(7, 7), (7, 8), (6, 7), (5, 7), (6, 8), (6, 6), (4, 8), (9, 5), (4, 10), (5, 9), (5, 6), (4, 9),
+               (3, 9), (5, 11)]},
+    {'name': 'mid_30a', 'category': 'midgame',
+     'moves': [(7, 7), (8, 7), (7, 6), (7, 5), (8, 6), (9, 6), (6, 8), (9, 5), (5, 9), (4, 10), (8, 5), (6, 9),
+               (7, 8), (9, 8), (7, 10), (7, 9), (9, 4), (6, 7), (11, 2), (9, 9), (10, 9), (10, 3), (5, 8), (8, 8),
+               (9, 7), (4, 8), (5, 7), (5, 10), (4, 11), (5, 6)]},
+    {'name': 'mid_30b', 'category': 'midgame',
+     'moves': [(7, 7), (7, 8), (8, 7), (5, 7), (10, 7), (11, 7), (6, 8), (8, 6), (6, 7), (6, 5), (6, 10), (9, 7),
+               (6, 11), (6, 9), (7, 5), (5, 9), (7, 9), (5, 6), (5, 8), (3, 8), (7, 6), (4, 9), (4, 7), (8, 5),
+               (7, 3), (7, 4), (3, 9), (5, 11), (9, 2), (5, 10)]},
+    # ------------------------------ 战术 ------------------------------
+    {'name': 'win_in_1_14', 'category': 'tactical', 'goal': 'win', 'expected': [(6, 8)],
+     'moves': [(7, 7), (7, 6), (8, 6), (5, 9), (10, 4), (12, 2), (9, 5), (8, 7), (6, 5), (7, 5), (9, 8), (11, 3),
+               (9, 6), (9, 9)]},
+    {'name': 'win_in_1_22', 'category': 'tactical', 'goal': 'win', 'expected': [(6, 4)],
+     'moves': [(7, 7), (8, 7), (8, 6), (10, 4), (6, 8), (9, 5), (12, 2), (7, 8), (9, 6), (4, 10), (6, 6), (6, 9),
+               (5, 6), (7, 6), (4, 11), (9, 9), (6, 5), (5, 5), (6, 7), (4, 7), (4, 6), (2, 6)]},
+    {'name': 'defend_four_14', 'category': 'tactical', 'goal': 'defend', 'expected': [(4, 6)],
+     'moves': [(7, 7), (7, 6), (8, 7), (9, 7), (5, 7), (4, 7), (8, 8), (8, 6), (9, 6), (7, 5), (10, 8), (6, 6),
+               (5, 3), (5, 6)]},
+    {'name': 'defend_four_22', 'category': 'tactical', 'goal': 'defend', 'expected': [(9, 4)],
+     'moves': [(7, 7), (7, 8), (6, 7), (5, 7), (8, 7), (8, 8), (6, 8), (9, 7), (6, 5), (6, 9), (9, 8), (7, 6),
+               (6, 4), (6, 6), (7, 5), (10, 6), (7, 9), (9, 6), (8, 6), (9, 5), (11, 5), (9, 3)]},
+    # ------------------------------ 连续冲四必胜 ------------------------------
+    {'name': 'vcf_3', 'category': 'vcf', 'goal': 'win', 'expected': [(7, 10)],
+     'moves': [(7, 7), (6, 7), (7, 8), (7, 6), (8, 5), (7, 9), (5, 8), (8, 8), (10, 6), (6, 8), (6, 9), (8, 7),
+               (8, 11), (6, 5)]},
+    {'name': 'vcf_5a', 'category': 'vcf', 'goal': 'win', 'expected': [(9, 10)],
+     'moves': [(7, 7), (8, 7), (7, 8), (7, 10), (8, 8), (5, 8), (5, 5), (7, 6), (9, 8), (6, 8), (9, 9), (6, 6),
+               (10, 10), (11, 8), (12, 12), (6, 9), (6, 7), (11, 11), (4, 7), (3, 7), (5, 6), (4, 5)]},
+    {'name': 'vcf_5b', 'category': 'vcf', 'goal': 'win', 'expected': [(8, 8)],
+     'moves': [(7, 7), (6, 7), (7, 8), (7, 10), (7, 6), (7, 9), (7, 11), (7, 5), (6, 9), (9, 6), (8, 7), (4, 11),
+               (6, 5), (10, 9), (4, 3), (5, 4), (8, 9), (9, 7), (8, 6), (9, 5), (9, 8), (8, 10)]},
+    {'name': 'vcf_5c', 'category': 'vcf', 'goal': 'win', 'expected': [(10, 7)],
+     'moves': [(7, 7), (7, 8), (8, 7), (6, 7), (9, 10), (4, 5), (8, 9), (8, 6), (5, 6), (8, 8), (6, 8), (9, 7),
+               (10, 8), (7, 9), (6, 10), (11, 5), (7, 10), (5, 10), (10, 6), (10, 10), (9, 8), (6, 11)]},
+]
+
+CATEGORIES = ('opening', 'midgame', 'tactical', 'vcf')
+
+def build_board(moves: List[Tuple[int, int]], board_size: int = 15) -> List[List[int]]:
+    """落子序列 → 棋盘（黑先交替）"""
+    board = [[PIECE_COLORS.EMPTY] * board_size for _ in range(board_size)]
+    for i, (x, y) in enumerate(moves):
+        board[x][y] = PIECE_COLORS.BLACK if i % 2 == 0 else PIECE_COLORS.WHITE
+    return board
+
+def side_to_move(moves: List[Tuple[int, int]]) -> int:
+    return PIECE_COLORS.BLACK if len(moves) % 2 == 0 else PIECE_COLORS.WHITE
+
+def select_positions(categories: Optional[List[str]] = None, names: Optional[List[str]] = None) -> List[Dict]:
+    """按类别/名称筛选局面（都为空时返回全部）"""
+    return [position for position in POSITIONS
+            if (not categories or position['category'] in categories) and (not names or position['name'] in names)]
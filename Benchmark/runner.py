@@ -0,0 +1,407 @@
+"""引擎基准测试（在仓库根目录运行：python -m Benchmark.runner）
+
+对固定局面库逐个引擎测量：每步耗时、节点/秒、达到各深度的时间、模拟次数/秒、推理QPS、冷启动耗时、
+内存高水位，以及C++原生原语（胜负判断/落子评估/必胜搜索）的调用吞吐。
+每个引擎默认在独立的子进程中运行，内存高水位只反映该引擎自己（同进程连续跑时高水位只增不减，
+后跑的引擎会继承先跑引擎的峰值，--no-isolate时只记录增量rss_growth_kb，结果依赖引擎顺序）。
+结果写成JSON报告；给定基线报告时逐项对比，超出容差的退化以非零退出码返回（可接入CI）。
+"""
+import os
+import sys
+import json
+import time
+import argparse
+import platform
+import tracemalloc
+import multiprocessing as mp
+from concurrent.futures import ProcessPoolExecutor
+from typing import Callable, Dict, List, Optional, Tuple
+from Common.config import Config
+from Common.constants import PIECE_COLORS
+from Common.logger import Logger
+from Benchmark.positions import CATEGORIES, build_board, select_positions, side_to_move
+
+try:
+    import resource
+except ImportError:  # Windows
+    resource = None
+
+def peak_rss_kb() -> Optional[int]:
+    """进程常驻内存高水位（KB；取不到时返回None）"""
+    if resource is not None:
+        peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        return peak // 1024 if sys.platform == 'darwin' else peak  # macOS单位为字节，Linux为KB
+    try:
+        import ctypes
+        import ctypes.wintypes
+
+        class _ProcessMemoryCounters(ctypes.Structure):
+            _fields_ = [('cb', ctypes.wintypes.DWORD), ('PageFaultCount', ctypes.wintypes.DWORD),
+                        ('PeakWorkingSetSize', ctypes.c_size_t), ('WorkingSetSize', ctypes.c_size_t),
+                        ('QuotaPeakPagedPoolUsage', ctypes.c_size_t), ('QuotaPagedPoolUsage', ctypes.c_size_t),
+                        ('QuotaPeakNonPagedPoolUsage', ctypes.c_size_t), ('QuotaNonPagedPoolUsage', ctypes.c_size_t),
+                        ('PagefileUsage', ctypes.c_size_t), ('PeakPagefileUsage', ctypes.c_size_t)]
+        counters = _ProcessMemoryCounters()
+        counters.cb = ctypes.sizeof(counters)
+        handle = ctypes.windll.kernel32.GetCurrentProcess()
+        if ctypes.windll.psapi.GetProcessMemoryInfo(handle, ctypes.byref(counters), counters.cb):
+            return counters.PeakWorkingSetSize // 1024
+    except (AttributeError, OSError):
+        pass
+    return None
+
+def _inference_requests() -> int:
+    """进程内全部推理服务的累计请求数（未加载torch时为0）"""
+    if 'Compute.inference_server' not in sys.modules:
+        return 0
+    from Compute.inference_server import InferenceServer
+    return sum(server.total_requests for server in InferenceServer.servers())
+
+def _create_minimax(color: int, level: str):
+    from AI.minimax_ai import MinimaxAI
+    return MinimaxAI(color, level)
+
+def _create_mcts(color: int, level: str):
+    from AI.mcts_ai import MCTSAI
+    return MCTSAI(color, level)
+
+def _create_rl(color: int, level: str):
+    from AI.rl_ai import RLAI
+    return RLAI(color, level)
+
+def _create_nn(color: int, level: str):
+    from AI.nn_ai import NNAI
+    return NNAI(color, level)
+
+def _create_fleet(color: int, level: str):
+    from AI.ai_fleet import AIFleet
+    return AIFleet(color, level)
+
+# 指标方向：对比基线时高者为优/低者为优
+HIGHER_BETTER = ('solved_rate', 'nps', 'avg_depth', 'playouts_per_s', 'inference_qps', 'ops_per_s')
+LOWER_BETTER = ('avg_time_s', 'cold_start_s', 'rss_peak_kb', 'tracemalloc_peak_kb')
+
+def _run_engine_isolated(level: str, move_time: float, positions: List[Dict], trace_memory: bool, name: str) -> Dict:
+    """子进程入口：本进程只跑这一个引擎"""
+    runner = BenchmarkRunner(level, move_time, positions, trace_memory)
+    runner.dedicated_process = True
+    return runner.run_engine(name)
+
+class BenchmarkRunner:
+    """按引擎跑局面库，汇总为可对比的JSON报告"""
+    ENGINE_FACTORIES: Dict[str, Callable] = {
+        'minimax': _create_minimax,
+        'mcts': _create_mcts,
+        'rl': _create_rl,
+        'nn': _create_nn,
+        'fleet': _create_fleet
+    }
+    NATIVE_KERNELS = ('check_game_end', 'evaluate_move', 'find_winning_move')
+    NATIVE_MIN_TIME = 0.2  # 每个原生原语至少计时的秒数（循环调用直到超过）
+
+    def __init__(self, level: str = 'hard', move_time: float = 1.0, positions: Optional[List[Dict]] = None,
+                 trace_memory: bool = False, isolate: bool = True):
+        self.config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self.board_size = self.config.board_size
+        self.level = level
+        self.move_time = move_time  # 每步思考时间（秒），覆盖各引擎自身的时间预算
+        self.positions = positions if positions is not None else select_positions()
+        self.trace_memory = trace_memory  # tracemalloc统计Python堆峰值（会明显拖慢搜索，默认关闭）
+        self.isolate = isolate  # 每个引擎在新的子进程中运行
+        self.dedicated_process = False  # 本进程只跑一个引擎（此时进程内存高水位即该引擎的高水位）
+
+    # ------------------------------ 引擎 ------------------------------
+    def _prepare(self, ai):
+        """关闭开局库（基准测的是搜索本身），时间预算统一为move_time"""
+        for member in [ai] + list(getattr(ai, 'members', {}).values()):
+            member._book_move = lambda board: None
+        if hasattr(ai, 'time_budget'):
+            ai.time_budget = self.move_time
+
+    def _timed_move(self, ai, board: List[List[int]]) -> Dict:
+        """走一步并采集该步指标"""
+        depth_times: Dict[int, float] = {}
+        start = time.perf_counter()
+
+        def on_thinking(data: Dict):
+            depth = data.get('depth', 0)
+            if depth and depth not in depth_times:
+                depth_times[depth] = round(time.perf_counter() - start, 4)
+
+        requests_before = _inference_requests()
+        if not hasattr(ai, 'members'):
+            ai.deadline = time.time() + self.move_time  # AIFleet自行给成员下发截止时间
+        move = ai.move(board, on_thinking)
+        elapsed = max(time.perf_counter() - start, 1e-9)
+        if not hasattr(ai, 'members'):
+            ai.deadline = None
+
+        record = {'move': list(move) if move else None, 'time_s': round(elapsed, 4)}
+        nodes = getattr(ai, 'nodes', None)
+        if nodes is not None:
+            record['nodes'] = nodes
+            record['nps'] = int(nodes / elapsed)
+        if depth_times:
+            record['depth'] = max(depth_times)
+            record['time_to_depth'] = {str(depth): t for depth, t in sorted(depth_times.items())}
+        playouts = getattr(ai, 'playouts', None)
+        if playouts is not None:
+            record['playouts'] = playouts
+            record['playouts_per_s'] = int(playouts / elapsed)
+        requests = _inference_requests() - requests_before
+        if requests:
+            record['inference_requests'] = requests
+            record['inference_qps'] = int(requests / elapsed)
+        return record
+
+    def run_engine(self, name: str) -> Dict:
+        """跑一个引擎的全部局面（每个颜色各建一个实例，局面之间清理跨回合状态）"""
+        factory = self.ENGINE_FACTORIES[name]
+        rss_before = peak_rss_kb()
+        if self.trace_memory:
+            tracemalloc.start()
+        engines: Dict[int, object] = {}
+        cold_start = None
+        moves = []
+        try:
+            for position in self.positions:
+                color = side_to_move(position['moves'])
+                board = build_board(position['moves'], self.board_size)
+                first = color not in engines
+                start = time.perf_counter()
+                if first:
+                    engines[color] = factory(color, self.level)
+                    self._prepare(engines[color])
+                ai = engines[color]
+                ai.on_new_game()
+                record = self._timed_move(ai, board)
+                if cold_start is None:
+                    cold_start = time.perf_counter() - start  # 构造（含模型加载）+首步
+                record.update(position=position['name'], category=position['category'])
+                if position.get('expected'):
+                    record['solved'] = record['move'] is not None and tuple(record['move']) in position['expected']
+                moves.append(record)
+                self.logger.info(f"基准[{name}] {position['name']}：{record['move']}，{record['time_s']:.3f}s")
+        except Exception as e:
+            self.logger.error(f"基准[{name}]运行失败：{str(e)}")
+            return {'error': f"{type(e).__name__}: {str(e)}", 'moves': moves}
+        finally:
+            tracemalloc_peak = tracemalloc.get_traced_memory()[1] // 1024 if self.trace_memory else None
+            if self.trace_memory:
+                tracemalloc.stop()
+            for ai in engines.values():
+                if hasattr(ai, 'shutdown'):
+                    ai.shutdown()  # AIFleet的成员线程池
+
+        result = {'moves': moves, 'summary': self._summarize(moves)}
+        result['summary']['cold_start_s'] = round(cold_start, 4) if cold_start is not None else None
+        rss_after = peak_rss_kb()
+        if rss_after is not None:
+            if self.dedicated_process:
+                result['summary']['rss_peak_kb'] = rss_after
+            result['summary']['rss_growth_kb'] = rss_after - rss_before
+        if tracemalloc_peak is not None:
+            result['summary']['tracemalloc_peak_kb'] = tracemalloc_peak
+        return result
+
+    @staticmethod
+    def _summarize(moves: List[Dict]) -> Dict:
+        total_time = sum(m['time_s'] for m in moves) or 1e-9
+        summary = {'positions': len(moves), 'avg_time_s': round(total_time / max(len(moves), 1), 4)}
+        solved = [m['solved'] for m in moves if 'solved' in m]
+        if solved:
+            summary['solved_rate'] = round(sum(solved) / len(solved), 4)
+        for metric, total_key in (('nps', 'nodes'), ('playouts_per_s', 'playouts'), ('inference_qps', 'inference_requests')):
+            timed = [m for m in moves if total_key in m]
+            if timed:
+                summary[metric] = int(sum(m[total_key] for m in timed) / (sum(m['time_s'] for m in timed) or 1e-9))
+        depths = [m['depth'] for m in moves if 'depth' in m]
+        if depths:
+            summary['avg_depth'] = round(sum(depths) / len(depths), 2)
+        return summary
+
+    # ------------------------------ 原生原语 ------------------------------
+    def run_native(self) -> Dict:
+        """C++原语吞吐：每个原语对全部局面循环调用至少NATIVE_MIN_TIME秒"""
+        from Compute.cpp_interface import CppCore
+        core = CppCore()
+        boards = [(position, build_board(position['moves'], self.board_size), side_to_move(position['moves']))
+                  for position in self.positions]
+        def call_check(board, color):
+            core.check_game_end(board, self.board_size)
+            return 1
+        def call_evaluate(board, color):
+            count = 0
+            for x in range(self.board_size):
+                for y in range(self.board_size):
+                    if board[x][y] == PIECE_COLORS.EMPTY:
+                        core.evaluate_move(board, x, y, color)
+                        count += 1
+            return count
+        def call_winning(board, color):
+            core.find_winning_move(board, color, self.board_size)
+            return 1
+        kernels = {'check_game_end': call_check, 'evaluate_move': call_evaluate, 'find_winning_move': call_winning}
+
+        result = {'native': core.is_native}
+        for kernel in self.NATIVE_KERNELS:
+            calls, start = 0, time.perf_counter()
+            while True:
+                for _, board, color in boards:
+                    calls += kernels[kernel](board, color)
+                elapsed = time.perf_counter() - start
+                if elapsed >= self.NATIVE_MIN_TIME:
+                    break
+            result[kernel] = {'calls': calls, 'ops_per_s': int(calls / elapsed)}
+
+        # 必胜搜索的正确性：goal为win的局面都应找到必胜点
+        wins = [(position, board, color) for position, board, color in boards if position.get('goal') == 'win']
+        if wins:
+            found = sum(1 for position, board, color in wins
+                        if core.find_winning_move(board, color, self.board_size) is not None)
+            result['find_winning_move']['solved_rate'] = round(found / len(wins), 4)
+        return result
+
+    # ------------------------------ 报告 ------------------------------
+    def run(self, engines: List[str]) -> Dict:
+        report = {
+            'meta': {
+                'time': time.strftime('%Y-%m-%d %H:%M:%S'),
+                'python': platform.python_version(),
+                'platform': platform.platform(),
+                'cpu_count': os.cpu_count(),
+                'level': self.level,
+                'move_time': self.move_time,
+                'isolated': self.isolate,
+                'positions': [position['name'] for position in self.positions]
+            },
+            'results': {}
+        }
+        for name in engines:
+            if name == 'native':
+                report['results'][name] = self.run_native()
+                report['meta']['native'] = report['results'][name]['native']
+            elif self.isolate:
+                report['results'][name] = self._run_isolated(name)
+            else:
+                report['results'][name] = self.run_engine(name)
+        return report
+
+    def _run_isolated(self, name: str) -> Dict:
+        """在新的子进程（spawn）中跑一个引擎；子进程崩溃时记为运行失败"""
+        try:
+            with ProcessPoolExecutor(max_workers=1, mp_context=mp.get_context('spawn')) as executor:
+                return executor.submit(_run_engine_isolated, self.level, self.move_time, self.positions,
+                                       self.trace_memory, name).result()
+        except Exception as e:
+            self.logger.error(f"基准[{name}]子进程运行失败：{str(e)}")
+            return {'error': f"{type(e).__name__}: {str(e)}", 'moves': []}
+
+def _flatten_metrics(report: Dict) -> Dict[Tuple[str, str], float]:
+    """报告 → {(引擎, 指标): 数值}（原生原语按"native.原语名"展开）"""
+    metrics = {}
+    for engine, result in report.get('results', {}).items():
+        if engine == 'native':
+            for kernel, values in result.items():
+                if isinstance(values, dict):
+                    for metric, value in values.items():
+                        metrics[(f"native.{kernel}", metric)] = value
+        else:
+            for metric, value in result.get('summary', {}).items():
+                metrics[(engine, metric)] = value
+    return metrics
+
+def compare_reports(current: Dict, baseline: Dict, tolerance: float = 0.10) -> List[Dict]:
+    """逐项对比当前报告与基线：变化超过tolerance（相对值）标记为regression/improvement，缺失标记为missing"""
+    current_metrics, baseline_metrics = _flatten_metrics(current), _flatten_metrics(baseline)
+    comparisons = []
+    for (engine, metric), base in sorted(baseline_metrics.items()):
+        if engine.split('.')[0] not in current.get('results', {}):
+            continue  # 本次没有跑的引擎不参与对比
+        value = current_metrics.get((engine, metric))
+        if metric in HIGHER_BETTER:
+            sign = 1
+        elif metric in LOWER_BETTER:
+            sign = -1
+        else:
+            continue
+        if not isinstance(base, (int, float)):
+            continue
+        if not isinstance(value, (int, float)):
+            # 基线有而本次没有（引擎运行失败或指标缺失），按退化处理
+            comparisons.append({'engine': engine, 'metric': metric, 'baseline': base, 'current': None,
+                                'change': None, 'status': 'missing'})
+            continue
+        change = (value - base) / base if base else (0.0 if value == base else float('inf'))
+        status = 'ok'
+        if change * sign < -tolerance:
+            status = 'regression'
+        elif change * sign > tolerance:
+            status = 'improvement'
+        comparisons.append({'engine': engine, 'metric': metric, 'baseline': base, 'current': value,
+                            'change': round(change, 4), 'status': status})
+    return comparisons
+
+def _print_summary(report: Dict, comparisons: Optional[List[Dict]]):
+    for engine, result in report['results'].items():
+        if 'error' in result:
+            print(f"{engine:10s} 失败：{result['error']}")
+            continue
+        if engine == 'native':
+            print(f"{engine:10s} " + "，".join(f"{kernel} {values['ops_per_s']}/s"
+                                               for kernel, values in result.items() if isinstance(values, dict)))
+            continue
+        print(f"{engine:10s} " + "，".join(f"{metric}={value}" for metric, value in result['summary'].items()))
+    for item in comparisons or []:
+        if item['status'] != 'ok':
+            change = f"（{item['change']:+.1%}）" if item['change'] is not None else ''
+            print(f"[{item['status']}] {item['engine']}.{item['metric']}：{item['baseline']} → {item['current']}{change}")
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description="五子棋引擎基准测试")
+    parser.add_argument('--engines', default='minimax,mcts,rl,nn,fleet,native',
+                        help=f"逗号分隔，可选：{','.join(list(BenchmarkRunner.ENGINE_FACTORIES) + ['native'])}")
+    parser.add_argument('--categories', default='', help=f"局面类别（逗号分隔，默认全部）：{','.join(CATEGORIES)}")
+    parser.add_argument('--positions', default='', help="只跑指定名称的局面（逗号分隔）")
+    parser.add_argument('--level', default='hard', help="AI难度")
+    parser.add_argument('--move-time', type=float, default=1.0, help="每步思考时间（秒）")
+    parser.add_argument('--output', default='', help="报告路径（默认写入benchmark_dir下带时间戳的文件）")
+    parser.add_argument('--baseline', default='', help="基线报告路径（默认benchmark_dir/baseline.json，存在时对比）")
+    parser.add_argument('--save-baseline', action='store_true', help="把本次结果保存为基线")
+    parser.add_argument('--tolerance', type=float, default=0.10, help="对比容差（相对变化）")
+    parser.add_argument('--tracemalloc', action='store_true', help="统计Python堆峰值（显著变慢）")
+    parser.add_argument('--no-isolate', action='store_true',
+                        help="所有引擎在本进程内依次运行（不记录rss_peak_kb，rss_growth_kb依赖引擎顺序）")
+    args = parser.parse_args(argv)
+
+    config = Config.get_instance()
+    benchmark_dir = config.get('PATH', 'benchmark_dir', os.path.join(os.getcwd(), 'data', 'benchmark'))
+    os.makedirs(benchmark_dir, exist_ok=True)
+    positions = select_positions([c for c in args.categories.split(',') if c], [p for p in args.positions.split(',') if p])
+    runner = BenchmarkRunner(args.level, args.move_time, positions, args.tracemalloc, not args.no_isolate)
+    report = runner.run([engine.strip() for engine in args.engines.split(',') if engine.strip()])
+
+    baseline_path = args.baseline or os.path.join(benchmark_dir, 'baseline.json')
+    comparisons = None
+    if os.path.exists(baseline_path) and not args.save_baseline:
+        with open(baseline_path, 'r', encoding='utf-8') as f:
+            baseline = json.load(f)
+        for key in ('positions', 'move_time', 'level', 'cpu_count', 'isolated'):
+            if baseline.get('meta', {}).get(key) != report['meta'].get(key):
+                Logger.get_instance().warning(f"基线的{key}与本次不同，对比结果仅供参考")
+        comparisons = compare_reports(report, baseline, args.tolerance)
+        report['comparison'] = {'baseline': baseline_path, 'tolerance': args.tolerance, 'items': comparisons}
+
+    output = args.output or os.path.join(benchmark_dir, f"benchmark_{time.strftime('%Y%m%d_%H%M%S')}.json")
+    with open(output, 'w', encoding='utf-8') as f:
+        json.dump(report, f, ensure_ascii=False, indent=2)
+    if args.save_baseline:
+        with open(baseline_path, 'w', encoding='utf-8') as f:
+            json.dump(report, f, ensure_ascii=False, indent=2)
+    _print_summary(report, comparisons)
+    print(f"报告：{output}")
+    return 1 if comparisons and any(item['status'] in ('regression', 'missing') for item in comparisons) else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
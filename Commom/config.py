@@ -62,6 +62,7 @@ class Config:
             'game_record_dir': os.path.join(os.getcwd(), 'data', 'game_record'),
             'ranking_dir': os.path.join(os.getcwd(), 'data', 'ranking'),
             'live_replay_dir': os.path.join(os.getcwd(), 'data', 'live_replay'),
+            'benchmark_dir': os.path.join(os.getcwd(), 'data', 'benchmark'),
             'log_dir': os.path.join(os.getcwd(), 'data', 'log')
         }
         self.ini_config['WINDOW'] = {
@@ -77,23 +78,69 @@ class Config:
             'CELL_SIZE': '40',
             'WIN_CONDITION': '5',
             'ELO_K_FACTOR': '32',
-            'BASE_RATING': '1500'
+            'BASE_RATING': '1500',
+            'REPLAY_WORKERS': '4',
+            'REPLAY_BLOCK_SIZE': '8',
+            'MAX_SESSIONS': '500',
+            'SESSION_AI_WORKERS': '8',
+            'SESSION_TT_SIZE_MB': '8',
+            'SESSION_PONDER': 'False',
+            'EVENT_ASYNC': 'True',
+            'EVENT_QUEUE_SIZE': '1024',
+            'RANKING_COMPACT_THRESHOLD': '10000'
         }
         self.ini_config['SERVER'] = {
             'HOST': '0.0.0.0',
             'PORT': '8888',
             'MAX_CLIENTS': '50',
             'TIMEOUT': '30',
-            'LIVE_PORT': '9999'
+            'LIVE_PORT': '9999',
+            'METRICS_HOST': '127.0.0.1',
+            'METRICS_PORT': '0'
         }
         self.ini_config['AI'] = {
             'DEFAULT_LEVEL': 'HARD',
             'MINIMAX_MAX_DEPTH': '6',
             'MCTS_ITERATIONS': '1000',
+            'TT_SIZE_MB': '64',
+            'MCTS_ARENA_MB': '32',
+            'MCTS_PARALLEL_WORKERS': '4',
+            'MCTS_PARALLEL_MODE': 'tree',
+            'MCTS_TREE_REUSE': 'True',
+            'PONDER_ENABLED': 'True',
+            'PONDER_CPU_CAP': '0.5',
+            'INFER_MAX_BATCH': '64',
+            'INFER_MAX_LATENCY_MS': '2',
+            'INFER_REPORT_INTERVAL': '60',
+            'PUCT_C': '1.5',
+            'PUCT_LEAF_BATCH': '16',
+            'BOOK_ENABLED': 'True',
+            'BOOK_MAX_PLIES': '10',
+            'BOOK_MIN_COUNT': '3',
+            'FLEET_MEMBERS': 'minimax,mcts,rl,nn',
+            'FLEET_WEIGHTS': '1.0,1.0,0.8,0.6',
+            'FLEET_TIME_BUDGET': '4.0',
+            'METRICS_ENABLED': 'True',
+            'METRICS_TIMING': 'True',
+            'METRICS_RECENT_MOVES': '256',
+            'METRICS_TRACE': 'False',
+            'METRICS_TRACE_SAMPLE': '1',
+            'METRICS_TRACE_MAX_EVENTS': '200000',
+            'MODEL_EXPORT_SAFETENSORS': 'True',
             'RL_HIDDEN_SIZE': '512',
             'RL_BATCH_SIZE': '64',
             'RL_MEMORY_SIZE': '100000',
+            'RL_REPLAY_PERSIST': 'True',
+            'RL_PRIORITIZED_REPLAY': 'False',
+            'RL_REPLAY_AUGMENT': 'True',
             'RL_TARGET_UPDATE': '100',
+            'RL_SELF_PLAY_ACTORS': '2',
+            'RL_ACTOR_GAMES_IN_FLIGHT': '4',
+            'RL_ACTOR_MCTS_ITERATIONS': '0',
+            'RL_WEIGHT_PUBLISH_STEPS': '50',
+            'TRAIN_DATA_COMPRESSION': 'none',
+            'TRAIN_DATA_CHUNK_RECORDS': '65536',
+            'TRAIN_DATA_WORKERS': '0',
             'LEARNING_RATE': '0.001',
             'MAX_EPOCHS': '50',
             'BATCH_SIZE': '32'
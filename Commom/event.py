@@ -1,4 +1,7 @@
-from typing import Dict, Callable, List, Any
+import time
+import threading
+from collections import deque
+from typing import Dict, Callable, List, Any, Optional, Tuple, Hashable
 from Common.logger import Logger
 
 class Event:
@@ -10,7 +13,6 @@ class Event:
 
     def _get_timestamp(self) -> int:
         """获取事件时间戳"""
-        import time
         return int(time.time() * 1000)
 
     def to_dict(self) -> Dict:
@@ -21,52 +23,204 @@ class Event:
             'timestamp': self.timestamp
         }
 
+class _QueuedEvent:
+    """队列中的一条事件（合并时就地替换event，保留原来的排队位置）"""
+    __slots__ = ('seq', 'event', 'key')
+
+    def __init__(self, seq: int, event: Event, key: Optional[Hashable]):
+        self.seq = seq
+        self.event = event
+        self.key = key
+
+def ui_update_coalesce_key(event: Event) -> Optional[Hashable]:
+    """ui_update的默认合并键：只合并高频的进度/思维热力图推送，落子、结算等其余子类型逐条送达"""
+    sub_type = event.data.get('type')
+    return sub_type if sub_type in EventManager.COALESCED_UI_TYPES else None
+
 class EventManager:
-    """事件管理器（发布-订阅模式）"""
-    def __init__(self):
+    """事件管理器（发布-订阅模式）
+
+    监听器表写时复制：register/unregister持锁生成新表，emit只读取当前快照，不加锁。
+    异步模式下emit只把事件放进该事件类型的有界队列，由一个分发线程按发布顺序（跨类型全局有序）
+    调用监听器；队列满时发布方等待（分发线程内的嵌套emit直接同步执行，不会自锁），
+    持有监听器也会获取的锁时应以block=False发布：队列满时丢弃该事件并记警告，不等待。
+    设置了合并键的事件类型，队列里尚未分发的同键事件会被新事件替换（只送达最新一条）。
+    """
+    COALESCED_UI_TYPES = ('train_progress', 'ai_thinking')  # 默认合并的ui_update子类型
+
+    def __init__(self, async_dispatch: Optional[bool] = None, queue_size: Optional[int] = None):
+        from Common.config import Config
+        config = Config.get_instance()
         self.logger = Logger.get_instance()
-        self.event_listeners: Dict[str, List[Callable[[Event], None]]] = {}
-        self.lock = __import__('threading').Lock()
+        self.event_listeners: Dict[str, Tuple[Callable[[Event], None], ...]] = {}  # 写时复制的只读快照
+        self.lock = threading.Lock()  # 只保护监听器表的写入
+        self.async_dispatch = config.get_bool('GAME', 'event_async', True) if async_dispatch is None else async_dispatch
+        self.queue_size = queue_size or config.get_int('GAME', 'event_queue_size', 1024)  # 每种事件类型的队列上限
+        self._coalesce: Dict[str, Callable[[Event], Optional[Hashable]]] = {'ui_update': ui_update_coalesce_key}
+        # 异步分发状态（_cond保护下列全部字段）
+        self._cond = threading.Condition()
+        self._queues: Dict[str, deque] = {}
+        self._pending: Dict[Tuple[str, Hashable], _QueuedEvent] = {}  # 可合并的未分发事件
+        self._seq = 0
+        self._busy = False  # 分发线程正在执行监听器
+        self._running = False
+        self._thread: Optional[threading.Thread] = None
+        self._stats = {'emitted': 0, 'dispatched': 0, 'coalesced': 0, 'blocked': 0, 'dropped': 0}
+        self._max_depth: Dict[str, int] = {}
+        if self.async_dispatch:
+            self.start()
 
+    # ------------------------------ 监听器 ------------------------------
     def register(self, event_type: str, listener: Callable[[Event], None]):
         """注册事件监听器"""
         with self.lock:
-            if event_type not in self.event_listeners:
-                self.event_listeners[event_type] = []
-            self.event_listeners[event_type].append(listener)
+            listeners = dict(self.event_listeners)
+            listeners[event_type] = listeners.get(event_type, ()) + (listener,)
+            self.event_listeners = listeners
             self.logger.debug(f"注册事件监听器：{event_type}")
 
     def unregister(self, event_type: str, listener: Callable[[Event], None]):
         """注销事件监听器"""
         with self.lock:
-            if event_type in self.event_listeners:
-                if listener in self.event_listeners[event_type]:
-                    self.event_listeners[event_type].remove(listener)
-                    self.logger.debug(f"注销事件监听器：{event_type}")
-                if not self.event_listeners[event_type]:
-                    del self.event_listeners[event_type]
-
-    def emit(self, event: Event):
-        """发布事件"""
-        with self.lock:
-            event_type = event.type
-            if event_type not in self.event_listeners:
-                self.logger.debug(f"无监听器的事件：{event_type}")
+            current = self.event_listeners.get(event_type, ())
+            if listener not in current:
                 return
-            # 触发所有监听器
-            for listener in self.event_listeners[event_type]:
-                try:
-                    listener(event)
-                except Exception as e:
-                    self.logger.error(f"事件{event_type}监听器执行失败：{str(e)}")
+            listeners = dict(self.event_listeners)
+            remaining = tuple(l for l in current if l != listener)
+            if remaining:
+                listeners[event_type] = remaining
+            else:
+                del listeners[event_type]
+            self.event_listeners = listeners
+            self.logger.debug(f"注销事件监听器：{event_type}")
+
+    def set_coalescing(self, event_type: str, key_fn: Optional[Callable[[Event], Optional[Hashable]]]):
+        """设置事件类型的合并键函数（返回None的事件不合并；key_fn为None取消合并）"""
+        with self._cond:
+            if key_fn is None:
+                self._coalesce.pop(event_type, None)
+            else:
+                self._coalesce[event_type] = key_fn
+
+    # ------------------------------ 发布/分发 ------------------------------
+    def emit(self, event: Event, block: bool = True):
+        """发布事件（异步模式下只入队，立即返回）；block为False时队列满则丢弃（可合并的事件仍照常合并）"""
+        if event.type not in self.event_listeners:
+            self.logger.debug(f"无监听器的事件：{event.type}")
+            return
+        if not self._running or threading.current_thread() is self._thread:
+            self._dispatch(event)
+            return
+        key_fn = self._coalesce.get(event.type)
+        key = key_fn(event) if key_fn else None
+        with self._cond:
+            self._stats['emitted'] += 1
+            if key is not None:
+                queued = self._pending.get((event.type, key))
+                if queued is not None:
+                    queued.event = event
+                    self._stats['coalesced'] += 1
+                    return
+            queue = self._queues.setdefault(event.type, deque())
+            if len(queue) >= self.queue_size:
+                if not block:
+                    self._stats['dropped'] += 1
+                    self.logger.warning(f"事件队列已满，丢弃事件：{event.type}")
+                    return
+                self._stats['blocked'] += 1
+                self._cond.wait_for(lambda: len(queue) < self.queue_size or not self._running)
+                if not self._running:
+                    self._dispatch(event)
+                    return
+            self._seq += 1
+            queued = _QueuedEvent(self._seq, event, key)
+            queue.append(queued)
+            if key is not None:
+                self._pending[(event.type, key)] = queued
+            self._max_depth[event.type] = max(self._max_depth.get(event.type, 0), len(queue))
+            self._cond.notify_all()
+
+    def _dispatch(self, event: Event):
+        """调用当前快照中的全部监听器（单个监听器异常不影响其他监听器）"""
+        for listener in self.event_listeners.get(event.type, ()):
+            try:
+                listener(event)
+            except Exception as e:
+                self.logger.error(f"事件{event.type}监听器执行失败：{str(e)}")
+
+    def _next_event(self) -> Optional[Event]:
+        """取出全局最早发布的事件（各类型队首比较序号）；调用方持有_cond"""
+        head_type, head = None, None
+        for event_type, queue in self._queues.items():
+            if queue and (head is None or queue[0].seq < head.seq):
+                head_type, head = event_type, queue[0]
+        if head is None:
+            return None
+        self._queues[head_type].popleft()
+        if head.key is not None:
+            self._pending.pop((head_type, head.key), None)
+        return head.event
+
+    def _run(self):
+        while True:
+            with self._cond:
+                self._busy = False
+                self._cond.notify_all()
+                self._cond.wait_for(lambda: not self._running or any(self._queues.values()))
+                event = self._next_event()
+                if event is None:
+                    return  # 已停止且队列为空
+                self._busy = True
+                self._cond.notify_all()  # 唤醒因队列满而等待的发布方
+                self._stats['dispatched'] += 1
+            self._dispatch(event)
+
+    def start(self):
+        """启动异步分发线程"""
+        with self._cond:
+            if self._running:
+                return
+            self._running = True
+            self._thread = threading.Thread(target=self._run, name='event_dispatch', daemon=True)
+        self._thread.start()
+
+    def flush(self, timeout: Optional[float] = None) -> bool:
+        """等待已入队事件全部分发完成，返回是否在超时前完成"""
+        if not self._running or threading.current_thread() is self._thread:
+            return True
+        with self._cond:
+            return self._cond.wait_for(lambda: not any(self._queues.values()) and not self._busy, timeout)
+
+    def stop(self, timeout: Optional[float] = 5.0):
+        """分发完剩余事件后停止分发线程（之后emit退回同步分发）"""
+        with self._cond:
+            if not self._running:
+                return
+            self._running = False
+            self._cond.notify_all()
+        if self._thread is not threading.current_thread():
+            self._thread.join(timeout)
+
+    # ------------------------------ 指标 ------------------------------
+    def queue_depths(self) -> Dict[str, int]:
+        """各事件类型当前排队数"""
+        with self._cond:
+            return {event_type: len(queue) for event_type, queue in self._queues.items() if queue}
+
+    def stats(self) -> Dict[str, Any]:
+        """分发统计：发布/分发/合并/因队列满等待/丢弃次数、当前与历史最大队列深度"""
+        with self._cond:
+            return dict(self._stats,
+                        depth={event_type: len(queue) for event_type, queue in self._queues.items()},
+                        max_depth=dict(self._max_depth),
+                        async_dispatch=self._running)
 
     def clear(self):
         """清空所有监听器"""
         with self.lock:
-            self.event_listeners.clear()
+            self.event_listeners = {}
             self.logger.debug("清空所有事件监听器")
 
     def get_listener_count(self, event_type: str) -> int:
         """获取事件监听器数量"""
-        with self.lock:
-            return len(self.event_listeners.get(event_type, []))
\ No newline at end of file
+        return len(self.event_listeners.get(event_type, ()))
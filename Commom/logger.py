@@ -1,11 +1,34 @@
 import os
+import json
+import queue
+import atexit
 import logging
-from logging.handlers import RotatingFileHandler
-from typing import Optional
+from logging.handlers import RotatingFileHandler, QueueHandler, QueueListener
+from typing import Dict, Optional
 from Common.config import Config
 
+class _DeferredQueueHandler(QueueHandler):
+    """入队时不格式化消息（标准QueueHandler会在调用线程上格式化），格式化与写文件都在日志线程完成。
+    调用方传入的参数在入队后不得再修改"""
+    def prepare(self, record: logging.LogRecord) -> logging.LogRecord:
+        return record
+
+class _JsonMessage:
+    """延迟序列化的JSON日志参数（在日志线程上才转成字符串）"""
+    __slots__ = ('data',)
+
+    def __init__(self, data: Dict):
+        self.data = data
+
+    def __str__(self) -> str:
+        return json.dumps(self.data, ensure_ascii=False, default=str)
+
 class Logger:
-    """日志管理器（单例模式，支持控制台+文件输出）"""
+    """日志管理器（单例模式，支持控制台+文件输出）
+
+    日志调用只把记录放进队列，由后台日志线程格式化并写控制台/轮转文件，
+    搜索线程上的逐步统计日志不再等待磁盘写入；进程退出时写完剩余日志。
+    """
     _instance = None
     _lock = __import__('threading').Lock()
 
@@ -45,7 +68,6 @@ class Logger:
         console_handler = logging.StreamHandler()
         console_handler.setLevel(logging.INFO)
         console_handler.setFormatter(formatter)
-        logger.addHandler(console_handler)
 
         # 文件处理器（轮转日志，最大100MB/个，保留10个）
         log_file = os.path.join(self.log_dir, 'gobang_ai.log')
@@ -57,10 +79,38 @@ class Logger:
         )
         file_handler.setLevel(logging.DEBUG)
         file_handler.setFormatter(formatter)
-        logger.addHandler(file_handler)
+
+        # 异步写入：记录经队列交给日志线程，由它按各处理器的级别分发
+        self._queue: 'queue.Queue[logging.LogRecord]' = queue.Queue()
+        self._handlers = (console_handler, file_handler)
+        self._queue_handler = _DeferredQueueHandler(self._queue)
+        logger.addHandler(self._queue_handler)
+        self._start_listener()
+        atexit.register(self.shutdown)
+        if hasattr(os, 'register_at_fork'):
+            os.register_at_fork(after_in_child=self._after_fork)
 
         return logger
 
+    def _start_listener(self):
+        self._listener = QueueListener(self._queue, *self._handlers, respect_handler_level=True)
+        self._listener.start()
+
+    def _after_fork(self):
+        """子进程不继承日志线程：换一个空队列（父进程未写出的记录由父进程自己写）并重启日志线程"""
+        self._queue = queue.Queue()
+        self._queue_handler.queue = self._queue
+        self._start_listener()
+
+    def flush(self):
+        """等待已入队的日志全部写出"""
+        self._queue.join()
+
+    def shutdown(self):
+        """写完剩余日志并停止日志线程（之后的日志仍会入队，但不再写出）"""
+        if self._listener._thread is not None:
+            self._listener.stop()
+
     def debug(self, message: str):
         """调试日志"""
         self.logger.debug(message)
@@ -85,6 +135,16 @@ class Logger:
         """异常日志"""
         self.logger.exception(message, exc_info=exc_info)
 
+    def move_stats(self, record: Dict):
+        """逐步搜索统计（调试级别，只写文件；JSON序列化在日志线程完成，record入队后不得再修改）"""
+        if self.logger.isEnabledFor(logging.DEBUG):
+            self.logger.debug('搜索统计：%s', _JsonMessage(record))
+
+    def metrics(self, recent: int = 20) -> Dict:
+        """当前搜索指标快照（见Common.metrics.SearchMetrics.snapshot）"""
+        from Common.metrics import SearchMetrics
+        return SearchMetrics.get_instance().snapshot(recent)
+
     @staticmethod
     def get_instance() -> 'Logger':
         """获取单例实例"""
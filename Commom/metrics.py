@@ -0,0 +1,310 @@
+"""搜索指标（低开销：计数线程私有、读取时汇总）
+
+- 计数：incr只写调用线程自己的计数块（不加锁），counters读取时把全部线程的计数块相加；
+  原生核心另有一套同样方式的计数器（CppCore.metrics_snapshot），两者在snapshot中一并给出；
+- 逐步记录：引擎每步用begin_move取一个MoveProbe，结束时finish生成一条结构化记录（节点/模拟数、
+  置换表命中与截断率、分支因子、有效深度、各阶段耗时、分配量），进入最近记录环形缓冲、
+  汇总计数并异步写日志；
+- trace：start_trace后按采样间隔记录阶段区间，export_trace导出Chrome trace格式（chrome://tracing、Perfetto可直接打开）；
+- 指标接口：[SERVER] METRICS_PORT大于0时start_server启动HTTP服务，GET /metrics返回snapshot，GET /metrics/trace返回trace。
+"""
+import os
+import sys
+import json
+import time
+import itertools
+import threading
+from collections import deque
+from contextlib import contextmanager, nullcontext
+from typing import Any, Dict, List, Optional
+from Common.logger import Logger
+
+# 原生阶段耗时计数 → 阶段名
+_NATIVE_PHASES = (('movegen', 'movegen_ns'), ('eval', 'eval_ns'), ('win_check', 'win_check_ns'))
+
+class MoveProbe:
+    """一步搜索的指标采集（由搜索线程独占使用）"""
+    __slots__ = ('metrics', 'engine', 'thread_only', 'start', 'spans', '_native_before', '_blocks_before')
+
+    def __init__(self, metrics: 'SearchMetrics', engine: str, thread_only: bool):
+        self.metrics = metrics
+        self.engine = engine
+        # 为True时原生计数取搜索线程自己的；搜索在共享原生线程池上时为False，此时线程计数会混入
+        # 其他会话的搜索，不采用原生计数，分支因子与节点池分配数由引擎按自身搜索传入
+        self.thread_only = thread_only
+        self.spans: Dict[str, float] = {}  # Python侧计时的阶段（秒）
+        self._native_before = metrics.native_counters(True) if thread_only else {}
+        self._blocks_before = sys.getallocatedblocks()
+        self.start = time.perf_counter()
+
+    @contextmanager
+    def phase(self, name: str):
+        """计时一个阶段（同名多次累加；开启trace时记录区间）"""
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            duration = time.perf_counter() - start
+            self.spans[name] = self.spans.get(name, 0.0) + duration
+            self.metrics.trace_event(name, start, duration, self.engine)
+
+    def finish(self, **fields) -> Dict[str, Any]:
+        """生成本步记录并交给SearchMetrics.record_move
+
+        fields为引擎自己统计的量（None不记录），其中以下键参与派生指标：
+        nodes、playouts、tt_probes/tt_hits/tt_cutoffs、expanded/children（分支因子）、nodes_allocated、
+        native_nodes（原生节点池分配数，thread_only为False时由引擎传入）
+        """
+        elapsed = max(time.perf_counter() - self.start, 1e-9)
+        native: Dict[str, int] = {}
+        if self.thread_only:
+            after = self.metrics.native_counters(True)
+            native = {key: value - self._native_before.get(key, 0) for key, value in after.items()
+                      if value != self._native_before.get(key, 0)}
+        record: Dict[str, Any] = {'engine': self.engine, 'timestamp': time.time(), 'time_s': round(elapsed, 6)}
+        record.update((key, value) for key, value in fields.items() if value is not None)
+
+        # 节点/模拟速度（原生MCTS的模拟数取原生计数）
+        if 'playouts' not in record and native.get('mcts_playouts'):
+            record['playouts'] = native['mcts_playouts']
+        if record.get('nodes'):
+            record['nps'] = int(record['nodes'] / elapsed)
+        if record.get('playouts'):
+            record['playouts_per_s'] = int(record['playouts'] / elapsed)
+        # 置换表
+        probes = record.pop('tt_probes', 0)
+        hits = record.pop('tt_hits', 0)
+        cutoffs = record.pop('tt_cutoffs', 0)
+        if probes:
+            record['tt'] = {'probes': probes, 'hits': hits, 'cutoffs': cutoffs,
+                            'hit_rate': round(hits / probes, 4), 'cutoff_rate': round(cutoffs / probes, 4)}
+        # 分支因子：每个展开节点实际搜索/扩展的子节点数
+        expanded = record.pop('expanded', 0) or native.get('mcts_expansions', 0)
+        children = record.pop('children', 0) or native.get('mcts_children', 0)
+        if expanded:
+            record['branching'] = round(children / expanded, 2)
+        # 阶段耗时：原生候选点生成/评估/胜负判断（计时开启时）+ Python侧推理，剩余为搜索本身
+        phases = {name: native[key] / 1e9 for name, key in _NATIVE_PHASES if native.get(key)}
+        if 'inference' in self.spans:
+            phases['inference'] = self.spans['inference']
+        if phases:
+            phases['other'] = max(elapsed - sum(phases.values()), 0.0)
+            record['phases'] = {name: round(value, 6) for name, value in phases.items()}
+        if self.spans:
+            record['spans'] = {name: round(value, 6) for name, value in self.spans.items()}
+        # 分配：Python堆块净增量、原生节点池分配数、引擎自己统计的对象数
+        allocs = {'py_blocks': sys.getallocatedblocks() - self._blocks_before}
+        native_nodes = record.pop('native_nodes', 0) or native.get('node_allocs', 0)
+        if native_nodes:
+            allocs['native_nodes'] = native_nodes
+        if 'nodes_allocated' in record:
+            allocs['py_nodes'] = record.pop('nodes_allocated')
+        record['allocs'] = allocs
+        if native:
+            record['native'] = native
+        self.metrics.trace_event('move', self.start, elapsed, self.engine,
+                                 {key: record[key] for key in ('move', 'depth', 'nodes', 'playouts') if key in record})
+        self.metrics.record_move(record)
+        return record
+
+class _NullProbe:
+    """指标关闭时的空采集（引擎不必判断是否开启）"""
+    def phase(self, name: str):
+        return nullcontext()
+
+    def finish(self, **fields) -> Dict[str, Any]:
+        return {}
+
+_NULL_PROBE = _NullProbe()
+
+class SearchMetrics:
+    """进程级搜索指标（单例）"""
+    _instance = None
+    _instance_lock = threading.Lock()
+
+    def __init__(self):
+        from Common.config import Config
+        from Compute.cpp_interface import CppCore
+        config = Config.get_instance()
+        self.config = config
+        self.logger = Logger.get_instance()
+        self.cpp_core = CppCore()
+        self.enabled = config.get_bool('AI', 'metrics_enabled', True)  # 关闭后begin_move返回空采集
+        self.timing = config.get_bool('AI', 'metrics_timing', True)  # 原生阶段计时（每次调用两次时钟读取）
+        self.cpp_core.set_metrics_timing(self.timing)
+        self.recent_moves: deque = deque(maxlen=config.get_int('AI', 'metrics_recent_moves', 256))
+        self.trace_sample = max(config.get_int('AI', 'metrics_trace_sample', 1), 1)  # 每个区间名每N次记录1次
+        self.trace_max_events = config.get_int('AI', 'metrics_trace_max_events', 200000)
+        self._local = threading.local()
+        self._blocks: List[Dict[str, float]] = []  # 各线程的计数块（线程退出后保留，计数不丢）
+        self._blocks_lock = threading.Lock()
+        self._trace: Optional[deque] = None
+        self._trace_counts: Dict[str, Any] = {}
+        self._thread_names: Dict[int, str] = {}
+        self._server = None
+        if config.get_bool('AI', 'metrics_trace', False):
+            self.start_trace()
+
+    @classmethod
+    def get_instance(cls) -> 'SearchMetrics':
+        if cls._instance is None:
+            with cls._instance_lock:
+                if cls._instance is None:
+                    cls._instance = cls()
+        return cls._instance
+
+    # ------------------------------ 计数 ------------------------------
+    def _block(self) -> Dict[str, float]:
+        block = getattr(self._local, 'block', None)
+        if block is None:
+            block = self._local.block = {}
+            with self._blocks_lock:
+                self._blocks.append(block)
+        return block
+
+    def incr(self, name: str, value: float = 1):
+        """调用线程的计数加value（不加锁）"""
+        block = self._block()
+        block[name] = block.get(name, 0) + value
+
+    def counters(self) -> Dict[str, float]:
+        """全部线程的Python侧计数之和"""
+        with self._blocks_lock:
+            blocks = list(self._blocks)
+        total: Dict[str, float] = {}
+        for block in blocks:
+            for name, value in dict(block).items():  # dict()在GIL下整体复制，不受所属线程并发写入影响
+                total[name] = total.get(name, 0) + value
+        return total
+
+    def native_counters(self, current_thread_only: bool = False) -> Dict[str, int]:
+        return self.cpp_core.metrics_snapshot(current_thread_only)
+
+    # ------------------------------ 逐步记录 ------------------------------
+    def begin_move(self, engine: str, thread_only: bool = True):
+        """开始采集一步（指标关闭时返回空采集）；搜索在共享原生线程池上进行时thread_only传False（不采用原生计数）"""
+        if not self.enabled:
+            return _NULL_PROBE
+        return MoveProbe(self, engine, thread_only)
+
+    def record_move(self, record: Dict[str, Any]):
+        self.recent_moves.append(record)
+        engine = record['engine']
+        self.incr(f"{engine}.moves")
+        self.incr(f"{engine}.time_s", record['time_s'])
+        for key in ('nodes', 'playouts'):
+            if key in record:
+                self.incr(f"{engine}.{key}", record[key])
+        self.logger.move_stats(record)
+
+    def snapshot(self, recent: int = 20) -> Dict[str, Any]:
+        """指标快照：Python/原生计数汇总、最近recent步记录、推理服务利用率、trace状态"""
+        snapshot = {
+            'timestamp': time.time(),
+            'counters': self.counters(),
+            'native': self.native_counters(),
+            'timing': self.timing,
+            'recent_moves': list(self.recent_moves)[-recent:] if recent > 0 else [],
+            'trace': {'enabled': self._trace is not None, 'events': len(self._trace or ())}
+        }
+        if 'Compute.inference_server' in sys.modules:
+            from Compute.inference_server import InferenceServer
+            snapshot['inference'] = [server.stats() for server in InferenceServer.servers()]
+        return snapshot
+
+    # ------------------------------ trace ------------------------------
+    @property
+    def tracing(self) -> bool:
+        return self._trace is not None
+
+    def start_trace(self, sample_every: Optional[int] = None, max_events: Optional[int] = None):
+        """开始记录trace区间（超过max_events时丢弃最早的）"""
+        if sample_every:
+            self.trace_sample = max(int(sample_every), 1)
+        self._trace_counts = {}
+        self._trace = deque(maxlen=max_events or self.trace_max_events)
+
+    def stop_trace(self) -> Dict:
+        """停止记录，返回已记录的trace"""
+        document = self.trace_document()
+        self._trace = None
+        return document
+
+    def trace_event(self, name: str, start: float, duration: float, category: str = 'search',
+                    args: Optional[Dict] = None):
+        """记录一个完整区间（start为time.perf_counter()，秒）；未开启trace时直接返回"""
+        trace = self._trace
+        if trace is None:
+            return
+        counter = self._trace_counts.get(name)
+        if counter is None:
+            counter = self._trace_counts.setdefault(name, itertools.count())
+        if next(counter) % self.trace_sample:
+            return
+        tid = threading.get_ident()
+        if tid not in self._thread_names:
+            self._thread_names[tid] = threading.current_thread().name
+        trace.append({'name': name, 'cat': category, 'ph': 'X', 'ts': start * 1e6, 'dur': duration * 1e6,
+                      'pid': os.getpid(), 'tid': tid, 'args': args or {}})
+
+    def trace_document(self) -> Dict:
+        """Chrome trace格式（JSON对象形式，附线程名元数据）"""
+        pid = os.getpid()
+        events = [{'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': tid, 'args': {'name': name}}
+                  for tid, name in list(self._thread_names.items())]
+        events.extend(list(self._trace or ()))
+        return {'traceEvents': events, 'displayTimeUnit': 'ms'}
+
+    def export_trace(self, path: str) -> int:
+        """把当前trace写入文件，返回区间数"""
+        document = self.trace_document()
+        with open(path, 'w', encoding='utf-8') as f:
+            json.dump(document, f)
+        self.logger.info(f"trace已导出：{path}（{len(document['traceEvents'])}条）")
+        return len(document['traceEvents'])
+
+    # ------------------------------ 指标接口 ------------------------------
+    def start_server(self, host: Optional[str] = None, port: Optional[int] = None) -> Optional[int]:
+        """启动指标HTTP服务（后台线程），返回实际端口；端口配置为0时不启动"""
+        from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+        if self._server is not None:
+            return self._server.server_address[1]
+        host = host or self.config.get('SERVER', 'metrics_host', '127.0.0.1')
+        port = self.config.get_int('SERVER', 'metrics_port', 0) if port is None else port
+        if port <= 0:
+            return None
+        metrics = self
+
+        class _MetricsHandler(BaseHTTPRequestHandler):
+            def do_GET(self):
+                path, _, query = self.path.partition('?')
+                if path == '/metrics':
+                    params = dict(item.partition('=')[::2] for item in query.split('&') if item)
+                    recent = params.get('recent', '20')
+                    body = metrics.snapshot(int(recent) if recent.isdigit() else 20)
+                elif path == '/metrics/trace':
+                    body = metrics.trace_document()
+                else:
+                    self.send_error(404)
+                    return
+                data = json.dumps(body, ensure_ascii=False, default=str).encode('utf-8')
+                self.send_response(200)
+                self.send_header('Content-Type', 'application/json; charset=utf-8')
+                self.send_header('Content-Length', str(len(data)))
+                self.end_headers()
+                self.wfile.write(data)
+
+            def log_message(self, format, *args):
+                metrics.logger.debug(f"指标接口：{format % args}")
+
+        self._server = ThreadingHTTPServer((host, port), _MetricsHandler)
+        self._server.daemon_threads = True
+        threading.Thread(target=self._server.serve_forever, name='metrics_http', daemon=True).start()
+        self.logger.info(f"指标接口已启动：http://{host}:{self._server.server_address[1]}/metrics")
+        return self._server.server_address[1]
+
+    def stop_server(self):
+        if self._server is not None:
+            self._server.shutdown()
+            self._server.server_close()
+            self._server = None
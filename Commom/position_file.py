@@ -0,0 +1,250 @@
+import os
+import json
+import time
+import zlib
+import numpy as np
+from typing import Dict, Iterator, List, Optional, Tuple
+from Common.constants import PIECE_COLORS
+from Common.logger import Logger
+from Common.error_handler import StorageError
+
+try:
+    import zstandard
+except ImportError:
+    zstandard = None
+
+RESULT_CODES = {'lose': 0, 'win': 1, 'draw': 2}
+RESULT_NAMES = {code: name for name, code in RESULT_CODES.items()}
+FORMAT_VERSION = 1
+
+def record_dtype(board_size: int) -> np.dtype:
+    """定长记录：黑/白两块位棋盘 + 落子、执子方、棋型编码、得分、质量、位置权重、结果、对局序号、时间戳（紧凑排列，无对齐填充）"""
+    board_bytes = (board_size * board_size + 7) // 8
+    return np.dtype([
+        ('black', np.uint8, (board_bytes,)),
+        ('white', np.uint8, (board_bytes,)),
+        ('x', np.uint8),
+        ('y', np.uint8),
+        ('color', np.uint8),
+        ('pattern', np.uint8),  # 棋型名在meta.json的patterns表中的下标
+        ('result', np.uint8),  # 0负 1胜 2平
+        ('score', np.float32),
+        ('quality', np.float32),
+        ('position_weight', np.float32),
+        ('game', np.uint32),  # 数据集内的对局序号（同一对局的记录连续存放）
+        ('timestamp', np.float64)
+    ])
+
+def pack_boards(boards: np.ndarray) -> Tuple[np.ndarray, np.ndarray]:
+    """(N, n, n)棋盘数组 → (黑位棋盘, 白位棋盘)，每格各1位"""
+    flat = boards.reshape(len(boards), -1)
+    return np.packbits(flat == PIECE_COLORS.BLACK, axis=1), np.packbits(flat == PIECE_COLORS.WHITE, axis=1)
+
+def unpack_boards(records: np.ndarray, board_size: int) -> np.ndarray:
+    """记录 → (N, n, n)的int8棋盘（空0、黑1、白2），整批向量化解包"""
+    cells = board_size * board_size
+    black = np.unpackbits(records['black'], axis=1, count=cells).astype(np.int8)
+    white = np.unpackbits(records['white'], axis=1, count=cells).astype(np.int8)
+    return (black * PIECE_COLORS.BLACK + white * PIECE_COLORS.WHITE).reshape(len(records), board_size, board_size)
+
+class PositionWriter:
+    """二进制训练数据集的流式追加写入器
+
+    数据集是一个目录：meta.json（棋盘大小、棋型表、分块列表）+ 若干分块文件。未压缩分块为记录数组的原始字节，
+    可直接np.memmap；压缩分块（zstd，未安装时退回zlib）整块解压后np.frombuffer。写入按块缓冲，攒满chunk_records
+    条即落盘一个分块并更新meta.json，内存占用与数据集大小无关；已有数据集直接在末尾追加新分块。
+    """
+    def __init__(self, path: str, board_size: int = 15, chunk_records: int = 65536, compression: str = 'none',
+                 patterns: Optional[List[str]] = None):
+        self.logger = Logger.get_instance()
+        self.path = path
+        self.chunk_records = chunk_records
+        self.compression = compression
+        if compression == 'zstd' and zstandard is None:
+            self.logger.warning("未安装zstandard，训练数据分块改用zlib压缩")
+            self.compression = 'zlib'
+        os.makedirs(path, exist_ok=True)
+        self.meta = _load_meta(path) or {
+            'version': FORMAT_VERSION,
+            'board_size': board_size,
+            'patterns': list(patterns or []),  # 新建数据集时可沿用已有数据集的棋型编码
+            'chunks': [],
+            'games': 0
+        }
+        if self.meta['board_size'] != board_size:
+            raise StorageError(f"训练数据集棋盘大小不一致：{path}（{self.meta['board_size']}≠{board_size}）", 6003)
+        self.board_size = board_size
+        self.dtype = record_dtype(board_size)
+        self._pattern_index = {name: i for i, name in enumerate(self.meta['patterns'])}
+        self._buffer = np.empty(chunk_records, dtype=self.dtype)
+        self._boards = np.empty((chunk_records, board_size, board_size), dtype=np.int8)  # 落盘时整块打包成位棋盘
+        self._buffered = 0
+        self._game_ids: Dict[str, int] = {}
+
+    def _pattern_code(self, pattern: str) -> int:
+        code = self._pattern_index.get(pattern)
+        if code is None:
+            if len(self.meta['patterns']) >= 255:
+                raise StorageError("棋型种类超过255种，无法编码", 6003)
+            code = len(self.meta['patterns'])
+            self.meta['patterns'].append(pattern)
+            self._pattern_index[pattern] = code
+        return code
+
+    def _game_number(self, game_id: str) -> int:
+        number = self._game_ids.get(game_id)
+        if number is None:
+            number = self.meta['games']
+            self.meta['games'] += 1
+            self._game_ids[game_id] = number
+        return number
+
+    def append(self, item: Dict, board: Optional[List[List[int]]] = None):
+        """追加一条记录（字段同TrainingManager的单步数据；board为落子前棋盘，缺省时解析item['board']字符串）"""
+        if board is None:
+            board = [list(map(int, row.split(','))) for row in item['board'].split(';')]
+        x, y = item['move'] if isinstance(item['move'], tuple) else map(int, str(item['move']).split(','))
+        self._boards[self._buffered] = board
+        record = self._buffer[self._buffered]
+        record['x'], record['y'] = x, y
+        record['color'] = int(item['color'])
+        record['pattern'] = self._pattern_code(str(item.get('pattern', 'None')))
+        record['result'] = RESULT_CODES.get(item.get('result', 'draw'), 2)
+        record['score'] = float(item.get('score', 0.0))
+        record['quality'] = float(item.get('quality', 0.0))
+        record['position_weight'] = float(item.get('position_weight', 0.0))
+        record['game'] = self._game_number(str(item.get('game_id', '')))
+        record['timestamp'] = float(item.get('timestamp', time.time()))
+        self._buffered += 1
+        if self._buffered == self.chunk_records:
+            self._flush_chunk()
+
+    def extend(self, items: List[Dict]):
+        for item in items:
+            self.append(item)
+
+    def _flush_chunk(self):
+        if self._buffered == 0:
+            return
+        records = self._buffer[:self._buffered]
+        records['black'], records['white'] = pack_boards(self._boards[:self._buffered])
+        self._write_chunk(records)
+        self._buffered = 0
+
+    def append_records(self, records: np.ndarray):
+        """追加已编码的记录数组（同一棋型表下整块拷贝，不经过逐条编码）"""
+        self._flush_chunk()
+        for start in range(0, len(records), self.chunk_records):
+            self._write_chunk(np.ascontiguousarray(records[start:start + self.chunk_records]))
+
+    def _write_chunk(self, records: np.ndarray):
+        if len(records) == 0:
+            return
+        data = records.tobytes()
+        index = len(self.meta['chunks'])
+        if self.compression == 'zstd':
+            name, data = f"chunk_{index:05d}.bin.zst", zstandard.ZstdCompressor(level=3).compress(data)
+        elif self.compression == 'zlib':
+            name, data = f"chunk_{index:05d}.bin.z", zlib.compress(data, level=3)
+        else:
+            name = f"chunk_{index:05d}.bin"
+        # 先写临时文件再改名，写到一半中断不会留下残缺分块
+        tmp_path = os.path.join(self.path, name + '.tmp')
+        with open(tmp_path, 'wb') as f:
+            f.write(data)
+        os.replace(tmp_path, os.path.join(self.path, name))
+        # 分块得分统计量写入meta，预处理无需为归一化再扫一遍数据
+        scores = records['score'].astype(np.float64)
+        score_stats = {'count': len(scores), 'mean': float(scores.mean()), 'm2': float(((scores - scores.mean()) ** 2).sum()),
+                       'min': float(scores.min()), 'max': float(scores.max())}
+        self.meta['chunks'].append({'file': name, 'records': len(records), 'compression': self.compression, 'score': score_stats})
+        _save_meta(self.path, self.meta)
+
+    def close(self):
+        """写出未满的最后一块"""
+        self._flush_chunk()
+        _save_meta(self.path, self.meta)
+
+    def __enter__(self) -> 'PositionWriter':
+        return self
+
+    def __exit__(self, exc_type, exc, tb):
+        self.close()
+
+class PositionReader:
+    """二进制训练数据集读取器（按块迭代：未压缩块零拷贝memmap，压缩块整块解压；记录总加载耗时）"""
+    def __init__(self, path: str):
+        self.logger = Logger.get_instance()
+        self.path = path
+        self.meta = _load_meta(path)
+        if self.meta is None:
+            raise StorageError(f"训练数据集不存在：{path}", 6003)
+        self.board_size = self.meta['board_size']
+        self.patterns: List[str] = self.meta['patterns']
+        self.dtype = record_dtype(self.board_size)
+        self.load_seconds = 0.0  # 累计加载/解压耗时（不含调用方处理时间）
+
+    def __len__(self) -> int:
+        return sum(chunk['records'] for chunk in self.meta['chunks'])
+
+    def _load_chunk(self, chunk: Dict) -> np.ndarray:
+        file_path = os.path.join(self.path, chunk['file'])
+        if chunk['compression'] == 'none':
+            return np.memmap(file_path, dtype=self.dtype, mode='r', shape=(chunk['records'],))
+        with open(file_path, 'rb') as f:
+            data = f.read()
+        if chunk['compression'] == 'zstd':
+            if zstandard is None:
+                raise StorageError(f"读取zstd分块需要安装zstandard：{file_path}", 6003)
+            data = zstandard.ZstdDecompressor().decompress(data)
+        else:
+            data = zlib.decompress(data)
+        return np.frombuffer(data, dtype=self.dtype, count=chunk['records'])
+
+    def chunks(self) -> Iterator[np.ndarray]:
+        """逐块产出记录数组（只读）"""
+        for chunk in self.meta['chunks']:
+            start = time.perf_counter()
+            records = self._load_chunk(chunk)
+            self.load_seconds += time.perf_counter() - start
+            yield records
+
+    def read_all(self) -> np.ndarray:
+        """读入全部记录（小数据集用；大数据集请用chunks()流式处理）"""
+        parts = list(self.chunks())
+        records = np.concatenate(parts) if parts else np.empty(0, dtype=self.dtype)
+        self.logger.info(f"加载训练数据集：{self.path}，{len(records)}条，耗时{self.load_seconds * 1000:.1f}ms")
+        return records
+
+    def boards(self, records: np.ndarray) -> np.ndarray:
+        """记录 → (N, n, n)棋盘"""
+        return unpack_boards(records, self.board_size)
+
+    def to_dicts(self, records: np.ndarray) -> List[Dict]:
+        """记录 → 旧版字典格式（board为"0,1,2;..."字符串，供尚未迁移的调用方使用）"""
+        boards = self.boards(records)
+        return [{
+            'board': ';'.join(','.join(map(str, row)) for row in board.tolist()),
+            'move': f"{int(r['x'])},{int(r['y'])}",
+            'color': int(r['color']),
+            'pattern': self.patterns[r['pattern']] if r['pattern'] < len(self.patterns) else 'None',
+            'score': float(r['score']),
+            'quality': float(r['quality']),
+            'position_weight': float(r['position_weight']),
+            'result': RESULT_NAMES.get(int(r['result']), 'draw'),
+            'game_id': f"game_{int(r['game'])}",
+            'timestamp': float(r['timestamp'])
+        } for board, r in zip(boards, records)]
+
+def _load_meta(path: str) -> Optional[Dict]:
+    meta_path = os.path.join(path, 'meta.json')
+    if not os.path.exists(meta_path):
+        return None
+    with open(meta_path, 'r', encoding='utf-8') as f:
+        return json.load(f)
+
+def _save_meta(path: str, meta: Dict):
+    tmp_path = os.path.join(path, 'meta.json.tmp')
+    with open(tmp_path, 'w', encoding='utf-8') as f:
+        json.dump(meta, f, ensure_ascii=False)
+    os.replace(tmp_path, os.path.join(path, 'meta.json'))
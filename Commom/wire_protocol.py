@@ -0,0 +1,377 @@
+"""联机/P2P/直播共用的二进制帧协议
+
+帧格式：[类型1字节][负载长度varint][负载]，varint为无符号LEB128。
+- MOVES：起始序号 + 步数 + 每步varint(格子下标<<3 | is_ai<<2 | 颜色)，序号即该步是本局第几手（从1开始）
+- SNAPSHOT：序号 + 棋盘大小 + 下一手颜色 + 黑/白两块位棋盘（每格1位）+ 获胜线，用于加入房间与断档重同步
+- CHAT：一批弹幕/聊天（条数 + 每条用户名、内容的UTF-8长度前缀字符串）
+- RESYNC：接收方发现序号断档，携带已应用的最后序号请求快照
+- CONTROL：其余低频消息（加入房间、结束、断线等）的JSON
+"""
+import json
+import time
+import threading
+from typing import Callable, Dict, List, Optional, Tuple
+from Common.constants import PIECE_COLORS
+from Common.logger import Logger
+from Common.error_handler import NetworkError
+
+FRAME_MOVES = 1
+FRAME_SNAPSHOT = 2
+FRAME_CHAT = 3
+FRAME_RESYNC = 4
+FRAME_CONTROL = 5
+
+MAX_FRAME_SIZE = 1 << 20  # 单帧负载上限（超出视为流损坏）
+
+# ------------------------------ varint ------------------------------
+def encode_varint(value: int, out: bytearray):
+    """无符号LEB128编码（每字节7位，最高位表示后面还有字节）"""
+    if value < 0:
+        raise NetworkError(f"varint不支持负数：{value}", 5008)
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+def decode_varint(buf, pos: int) -> Tuple[int, int]:
+    """从buf[pos:]解码一个varint，返回(值, 新位置)；数据不完整时抛IndexError"""
+    value, shift = 0, 0
+    while True:
+        byte = buf[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+        if shift > 63:
+            raise NetworkError("varint过长，帧数据损坏", 5008)
+
+def _encode_str(text: str, out: bytearray):
+    data = text.encode('utf-8')
+    encode_varint(len(data), out)
+    out += data
+
+def _decode_str(buf, pos: int) -> Tuple[str, int]:
+    length, pos = decode_varint(buf, pos)
+    return bytes(buf[pos:pos + length]).decode('utf-8'), pos + length
+
+def _frame(frame_type: int, payload: bytearray) -> bytes:
+    out = bytearray([frame_type])
+    encode_varint(len(payload), out)
+    out += payload
+    return bytes(out)
+
+# ------------------------------ 编码 ------------------------------
+def encode_moves(start_seq: int, moves: List[Dict], board_size: int) -> bytes:
+    """落子增量帧：moves为连续的若干步（含x/y/color/is_ai），第一步的序号为start_seq"""
+    payload = bytearray()
+    encode_varint(start_seq, payload)
+    encode_varint(len(moves), payload)
+    for move in moves:
+        cell = move['x'] * board_size + move['y']
+        encode_varint(cell << 3 | (4 if move.get('is_ai') else 0) | int(move['color']), payload)
+    return _frame(FRAME_MOVES, payload)
+
+def encode_snapshot(board: List[List[int]], seq: int, current_player: int,
+                    win_line: Optional[List[Tuple[int, int]]] = None) -> bytes:
+    """位棋盘快照帧（15路棋盘每块29字节，整帧约70字节，远小于board_to_str的字符串）"""
+    board_size = len(board)
+    black = white = 0
+    for x, row in enumerate(board):
+        for y, cell in enumerate(row):
+            if cell == PIECE_COLORS.BLACK:
+                black |= 1 << (x * board_size + y)
+            elif cell == PIECE_COLORS.WHITE:
+                white |= 1 << (x * board_size + y)
+    board_bytes = (board_size * board_size + 7) // 8
+    payload = bytearray()
+    encode_varint(seq, payload)
+    encode_varint(board_size, payload)
+    encode_varint(current_player, payload)
+    payload += black.to_bytes(board_bytes, 'little')
+    payload += white.to_bytes(board_bytes, 'little')
+    win_line = win_line or []
+    encode_varint(len(win_line), payload)
+    for x, y in win_line:
+        encode_varint(x * board_size + y, payload)
+    return _frame(FRAME_SNAPSHOT, payload)
+
+def encode_chat_batch(messages: List[Dict]) -> bytes:
+    """弹幕/聊天批量帧（每条含user_name、content）"""
+    payload = bytearray()
+    encode_varint(len(messages), payload)
+    for message in messages:
+        _encode_str(message.get('user_name', ''), payload)
+        _encode_str(message.get('content', ''), payload)
+    return _frame(FRAME_CHAT, payload)
+
+def encode_resync(seq: int) -> bytes:
+    """重同步请求帧（seq为接收方已连续应用的最后一手）"""
+    payload = bytearray()
+    encode_varint(seq, payload)
+    return _frame(FRAME_RESYNC, payload)
+
+def encode_control(message: Dict) -> bytes:
+    """低频控制消息帧（JSON）"""
+    return _frame(FRAME_CONTROL, bytearray(json.dumps(message, ensure_ascii=False).encode('utf-8')))
+
+# ------------------------------ 解码 ------------------------------
+class FrameDecoder:
+    """流式帧解码器：feed()接收任意切分的字节流，返回已完整到达的消息（字典）
+
+    MOVES帧的格子下标按当前棋盘大小还原坐标，收到SNAPSHOT帧时随之更新棋盘大小。
+    """
+    def __init__(self, board_size: int = 15):
+        self.board_size = board_size
+        self._buffer = bytearray()
+
+    def feed(self, data: bytes) -> List[Dict]:
+        self._buffer += data
+        messages, pos = [], 0
+        while pos < len(self._buffer):
+            try:
+                frame_type = self._buffer[pos]
+                length, start = decode_varint(self._buffer, pos + 1)
+            except IndexError:
+                break  # 帧头未收全
+            if length > MAX_FRAME_SIZE:
+                self._buffer.clear()
+                raise NetworkError(f"帧长度异常：{length}", 5008)
+            if start + length > len(self._buffer):
+                break  # 负载未收全
+            messages.append(self.decode_frame(frame_type, bytes(self._buffer[start:start + length])))
+            pos = start + length
+        del self._buffer[:pos]
+        return messages
+
+    def decode_frame(self, frame_type: int, payload) -> Dict:
+        """解码单个帧的负载"""
+        try:
+            if frame_type == FRAME_MOVES:
+                return self._decode_moves(payload)
+            if frame_type == FRAME_SNAPSHOT:
+                return self._decode_snapshot(payload)
+            if frame_type == FRAME_CHAT:
+                count, pos = decode_varint(payload, 0)
+                messages = []
+                for _ in range(count):
+                    user_name, pos = _decode_str(payload, pos)
+                    content, pos = _decode_str(payload, pos)
+                    messages.append({'user_name': user_name, 'content': content})
+                return {'type': 'chat_batch', 'messages': messages}
+            if frame_type == FRAME_RESYNC:
+                return {'type': 'resync', 'seq': decode_varint(payload, 0)[0]}
+            if frame_type == FRAME_CONTROL:
+                return json.loads(bytes(payload).decode('utf-8'))
+        except (IndexError, ValueError) as e:
+            raise NetworkError(f"帧解码失败（类型{frame_type}）：{str(e)}", 5008)
+        raise NetworkError(f"未知的帧类型：{frame_type}", 5008)
+
+    def _decode_moves(self, payload) -> Dict:
+        start_seq, pos = decode_varint(payload, 0)
+        count, pos = decode_varint(payload, pos)
+        moves = []
+        for i in range(count):
+            code, pos = decode_varint(payload, pos)
+            x, y = divmod(code >> 3, self.board_size)
+            moves.append({'seq': start_seq + i, 'x': x, 'y': y, 'color': code & 3, 'is_ai': bool(code & 4)})
+        return {'type': 'moves', 'seq': start_seq, 'moves': moves}
+
+    def _decode_snapshot(self, payload) -> Dict:
+        seq, pos = decode_varint(payload, 0)
+        board_size, pos = decode_varint(payload, pos)
+        current_player, pos = decode_varint(payload, pos)
+        board_bytes = (board_size * board_size + 7) // 8
+        black = int.from_bytes(payload[pos:pos + board_bytes], 'little')
+        white = int.from_bytes(payload[pos + board_bytes:pos + 2 * board_bytes], 'little')
+        pos += 2 * board_bytes
+        board = [[PIECE_COLORS.EMPTY] * board_size for _ in range(board_size)]
+        for bits, color in ((black, PIECE_COLORS.BLACK), (white, PIECE_COLORS.WHITE)):
+            while bits:
+                low = bits & -bits
+                x, y = divmod(low.bit_length() - 1, board_size)
+                board[x][y] = color
+                bits ^= low
+        count, pos = decode_varint(payload, pos)
+        win_line = []
+        for _ in range(count):
+            cell, pos = decode_varint(payload, pos)
+            win_line.append(divmod(cell, board_size))
+        self.board_size = board_size
+        return {'type': 'snapshot', 'seq': seq, 'board': board, 'current_player': current_player, 'win_line': win_line}
+
+def decode_snapshot(data: bytes) -> Dict:
+    """解码单个完整的快照帧（加入房间时随join_success下发）"""
+    messages = FrameDecoder().feed(data)
+    if not messages or messages[0].get('type') != 'snapshot':
+        raise NetworkError("快照数据无效", 5008)
+    return messages[0]
+
+# ------------------------------ 收发辅助 ------------------------------
+class MoveSequencer:
+    """接收端的落子排序：按序号应用增量，重复的丢弃，乱序的暂存等待补齐，断档过久/过长时要求重同步"""
+    def __init__(self, max_pending: int = 32, resync_after: float = 1.0):
+        self.max_pending = max_pending
+        self.resync_after = resync_after  # 断档持续多久（秒）后请求快照
+        self.seq = 0  # 已连续应用的最后一手
+        self._pending: Dict[int, Dict] = {}
+        self._gap_since: Optional[float] = None
+
+    def reset(self, seq: int = 0):
+        """新对局或应用快照后从seq继续"""
+        self.seq = seq
+        self._pending = {}
+        self._gap_since = None
+
+    def advance(self) -> int:
+        """本端自己落子：序号加一并返回"""
+        self.seq += 1
+        return self.seq
+
+    def push(self, moves: List[Dict]) -> List[Dict]:
+        """收到一批带序号的落子，返回现在可以按顺序应用的落子"""
+        for move in moves:
+            if move['seq'] > self.seq:
+                self._pending[move['seq']] = move
+        ready = []
+        while self.seq + 1 in self._pending:
+            self.seq += 1
+            ready.append(self._pending.pop(self.seq))
+        if self._pending:
+            if self._gap_since is None:
+                self._gap_since = time.time()
+        else:
+            self._gap_since = None
+        return ready
+
+    @property
+    def needs_resync(self) -> bool:
+        if not self._pending:
+            return False
+        return len(self._pending) >= self.max_pending or time.time() - self._gap_since >= self.resync_after
+
+class ChatBatcher:
+    """弹幕/聊天合批：攒够max_messages条或距第一条超过max_delay秒时出一帧（高峰期逐条发包的开销摊薄）"""
+    def __init__(self, max_messages: int = 32, max_delay: float = 0.1):
+        self.max_messages = max_messages
+        self.max_delay = max_delay
+        self._messages: List[Dict] = []
+        self._first_at = 0.0
+        self._lock = threading.Lock()
+
+    def add(self, user_name: str, content: str) -> Optional[bytes]:
+        """加入一条消息，需要发送时返回编码好的批量帧"""
+        with self._lock:
+            if not self._messages:
+                self._first_at = time.time()
+            self._messages.append({'user_name': user_name, 'content': content})
+            if len(self._messages) >= self.max_messages:
+                return self._take()
+        return None
+
+    def flush(self, force: bool = False) -> Optional[bytes]:
+        """定时调用：已到期（或force）时返回批量帧"""
+        with self._lock:
+            if self._messages and (force or time.time() - self._first_at >= self.max_delay):
+                return self._take()
+        return None
+
+    def _take(self) -> bytes:
+        frame = encode_chat_batch(self._messages)
+        self._messages = []
+        return frame
+
+class LiveFanout:
+    """直播间服务端扇出：每个事件只编码一次，同一个bytes对象写给全部观众
+
+    LiveStreamManager每个房间持有一个实例。新观众加入时收到缓存的快照帧（局面变化后才重新编码），
+    之后只收增量帧；观众发来重同步请求时同样回缓存快照。send回调只负责把字节写进各自的连接缓冲，
+    单个观众发送失败会被移出房间，不影响其他观众。
+    """
+    def __init__(self, board_size: int = 15):
+        self.logger = Logger.get_instance()
+        self.board_size = board_size
+        self.board = [[PIECE_COLORS.EMPTY] * board_size for _ in range(board_size)]
+        self.seq = 0
+        self.current_player = PIECE_COLORS.BLACK
+        self.win_line: List[Tuple[int, int]] = []
+        self.viewers: Dict[str, Callable[[bytes], None]] = {}
+        self.chat = ChatBatcher()
+        self._snapshot: Optional[bytes] = None  # 当前局面的快照帧缓存
+        self._lock = threading.Lock()
+        self.bytes_sent = 0
+
+    def add_viewer(self, viewer_id: str, send: Callable[[bytes], None]):
+        with self._lock:
+            self.viewers[viewer_id] = send
+            snapshot = self._snapshot_frame()
+        self._send(viewer_id, send, snapshot)
+
+    def remove_viewer(self, viewer_id: str):
+        with self._lock:
+            self.viewers.pop(viewer_id, None)
+
+    def reset(self, board_size: Optional[int] = None):
+        """新对局：清空局面并向全体观众推送空棋盘快照"""
+        with self._lock:
+            self.board_size = board_size or self.board_size
+            self.board = [[PIECE_COLORS.EMPTY] * self.board_size for _ in range(self.board_size)]
+            self.seq = 0
+            self.current_player = PIECE_COLORS.BLACK
+            self.win_line = []
+            self._snapshot = None
+            frame = self._snapshot_frame()
+        self.broadcast(frame)
+
+    def publish_moves(self, moves: List[Dict], win_line: Optional[List[Tuple[int, int]]] = None):
+        """主播端的新落子（按顺序）：更新房间局面，编码一帧增量后扇出"""
+        with self._lock:
+            frame = encode_moves(self.seq + 1, moves, self.board_size)
+            for move in moves:
+                self.board[move['x']][move['y']] = move['color']
+                self.current_player = PIECE_COLORS.WHITE if move['color'] == PIECE_COLORS.BLACK else PIECE_COLORS.BLACK
+            self.seq += len(moves)
+            if win_line:
+                self.win_line = list(win_line)
+            self._snapshot = None
+        self.broadcast(frame)
+
+    def publish_chat(self, user_name: str, content: str):
+        frame = self.chat.add(user_name, content)
+        if frame:
+            self.broadcast(frame)
+
+    def tick(self):
+        """定时调用（如每50ms）：发出到期的弹幕批"""
+        frame = self.chat.flush()
+        if frame:
+            self.broadcast(frame)
+
+    def handle_resync(self, viewer_id: str):
+        """观众请求重同步：回缓存快照"""
+        with self._lock:
+            send = self.viewers.get(viewer_id)
+            snapshot = self._snapshot_frame()
+        if send:
+            self._send(viewer_id, send, snapshot)
+
+    def broadcast(self, frame: bytes):
+        """同一帧写给全部观众（不逐人重新序列化）"""
+        with self._lock:
+            viewers = list(self.viewers.items())
+        for viewer_id, send in viewers:
+            self._send(viewer_id, send, frame)
+
+    def _snapshot_frame(self) -> bytes:
+        """调用方持有_lock"""
+        if self._snapshot is None:
+            self._snapshot = encode_snapshot(self.board, self.seq, self.current_player, self.win_line)
+        return self._snapshot
+
+    def _send(self, viewer_id: str, send: Callable[[bytes], None], frame: bytes):
+        try:
+            send(frame)
+            self.bytes_sent += len(frame)
+        except Exception as e:
+            self.logger.warning(f"直播观众{viewer_id}发送失败，移出房间：{str(e)}")
+            self.remove_viewer(viewer_id)
@@ -0,0 +1,245 @@
+import numpy as np
+from typing import List, Tuple, Dict, Optional, Callable
+from Common.constants import PIECE_COLORS, EVAL_WEIGHTS
+from Common.logger import Logger
+
+try:
+    from Compute import _gomoku_core as _native
+except ImportError:  # 未编译C++扩展（见Compute/setup.py）
+    _native = None
+
+class CppCore:
+    """C++计算核心接口（位棋盘引擎，未编译扩展时自动降级为Python实现）
+
+    布尔值表示C++扩展是否可用，调用方可据此选择自己的Python降级路径：
+        self.cpp_core = CppCore() if use_cpp else None
+        if self.cpp_core: ...
+    """
+    _warned = False
+    # MCTS并行方式（与_gomoku_core.MCTS_*常量一致）
+    MCTS_TREE_PARALLEL = 0
+    MCTS_ROOT_PARALLEL = 1
+    # (接口名, 棋盘尺寸) -> 编译期特化版本（如check_game_end_15），进程内共享
+    _kernels: Optional[Dict[Tuple[str, int], Callable]] = None
+
+    def __init__(self):
+        self.logger = Logger.get_instance()
+        self.native = _native
+        if self.native is None and not CppCore._warned:
+            CppCore._warned = True
+            self.logger.warning("C++核心扩展未编译，使用Python降级实现（编译：cd Compute && python setup.py build_ext --inplace）")
+
+    def __bool__(self) -> bool:
+        return self.native is not None
+
+    @property
+    def is_native(self) -> bool:
+        """C++扩展是否可用"""
+        return self.native is not None
+
+    def _kernel(self, name: str, board_size: int) -> Callable:
+        """按棋盘尺寸选择C++实现：15/19路走编译期特化版本，其余尺寸走通用版本"""
+        if CppCore._kernels is None:
+            CppCore._kernels = {
+                (kernel, size): getattr(self.native, f'{kernel}_{size}')
+                for size in getattr(self.native, 'SPECIALIZED_SIZES', ())
+                for kernel in ('validate_move', 'check_game_end', 'evaluate_board', 'evaluate_moves_batch')
+                if hasattr(self.native, f'{kernel}_{size}')
+            }
+        return CppCore._kernels.get((name, board_size)) or getattr(self.native, name)
+
+    # ------------------------------ 规则相关 ------------------------------
+    def validate_move(self, board: List[List[int]], x: int, y: int, current_player: int, board_size: int = 15) -> Tuple[bool, str]:
+        """校验落子合法性：返回(是否合法, 原因)"""
+        if self.native:
+            return self._kernel('validate_move', board_size)(board, x, y, current_player, board_size)
+        if x < 0 or x >= board_size or y < 0 or y >= board_size:
+            return (False, 'invalid_position')
+        if board[x][y] != PIECE_COLORS.EMPTY:
+            return (False, 'occupied')
+        black_count = sum(row.count(PIECE_COLORS.BLACK) for row in board)
+        white_count = sum(row.count(PIECE_COLORS.WHITE) for row in board)
+        if current_player == PIECE_COLORS.BLACK and black_count > white_count:
+            return (False, 'black_turn_invalid')
+        if current_player == PIECE_COLORS.WHITE and white_count > black_count:
+            return (False, 'white_turn_invalid')
+        return (True, 'success')
+
+    def check_game_end(self, board: List[List[int]], board_size: int = 15) -> Dict:
+        """检查游戏是否结束：{'is_end', 'winner', 'win_line'}"""
+        if self.native:
+            return self._kernel('check_game_end', board_size)(board, board_size)
+        directions = [(0, 1), (1, 0), (1, 1), (1, -1)]
+        for x in range(board_size):
+            for y in range(board_size):
+                color = board[x][y]
+                if color == PIECE_COLORS.EMPTY:
+                    continue
+                for dx, dy in directions:
+                    line = [(x + k * dx, y + k * dy) for k in range(5)]
+                    if all(0 <= nx < board_size and 0 <= ny < board_size and board[nx][ny] == color for nx, ny in line):
+                        return {'is_end': True, 'winner': color, 'win_line': line}
+        if all(board[x][y] != PIECE_COLORS.EMPTY for x in range(board_size) for y in range(board_size)):
+            return {'is_end': True, 'winner': 0, 'win_line': []}
+        return {'is_end': False, 'winner': 0, 'win_line': []}
+
+    def check_game_end_from(self, board: List[List[int]], x: int, y: int, color: int, empty_count: Optional[int] = None) -> Dict:
+        """增量胜负判断：只检查过(x,y)的四条线，empty_count为落子后剩余空位数（None时全盘计数）"""
+        if self.native:
+            return self.native.check_game_end_from(board, x, y, color, -1 if empty_count is None else empty_count)
+        board_size = len(board)
+        for dx, dy in [(0, 1), (1, 0), (1, 1), (1, -1)]:
+            line = [(x + k * dx, y + k * dy) for k in range(-4, 5)]
+            run = []
+            for (nx, ny) in line:
+                if 0 <= nx < board_size and 0 <= ny < board_size and ((nx, ny) == (x, y) or board[nx][ny] == color):
+                    run.append((nx, ny))
+                    if len(run) == 5:
+                        return {'is_end': True, 'winner': color, 'win_line': run}
+                else:
+                    run = []
+        if empty_count is None:
+            empty_count = sum(row.count(PIECE_COLORS.EMPTY) for row in board)
+        return {'is_end': empty_count <= 0, 'winner': 0, 'win_line': []}
+
+    def place_piece(self, board: List[List[int]], x: int, y: int, color: int) -> List[List[int]]:
+        """执行落子，返回新棋盘"""
+        if self.native:
+            return self.native.place_piece(board, x, y, color)
+        new_board = [row.copy() for row in board]
+        new_board[x][y] = color
+        return new_board
+
+    # ------------------------------ 搜索相关 ------------------------------
+    def create_search_board(self, board: List[List[int]], weights: Optional[Dict[str, float]] = None):
+        """创建搜索用有状态棋盘（make_move/unmake_move原地落子，增量维护Zobrist哈希与棋型计数）"""
+        weights = weights or EVAL_WEIGHTS
+        if self.native:
+            return self.native.SearchBoard(board, weights)
+        from Compute.search_board import PySearchBoard
+        return PySearchBoard(board, weights)
+
+    def create_transposition_table(self, size_mb: int = 64):
+        """创建Zobrist置换表（固定大小，条目含深度/边界类型/最佳落子，按深度+代数替换）"""
+        if self.native:
+            return self.native.TranspositionTable(size_mb)
+        from Compute.transposition_table import PyTranspositionTable
+        return PyTranspositionTable(size_mb)
+
+    def create_mcts_engine(self, arena_mb: int = 32):
+        """创建C++ MCTS引擎（连续节点池，整棵树O(1)释放）；未编译扩展时返回None，由调用方走Python实现"""
+        if self.native:
+            return self.native.MCTSEngine(arena_mb)
+        return None
+
+    # ------------------------------ 评估相关 ------------------------------
+    def thread_pool_size(self) -> int:
+        """原生共享线程池的线程数（MCTS等原生并行都从这个池取线程）；降级实现返回0"""
+        if self.native:
+            return self.native.thread_pool_size()
+        return 0
+
+    def metrics_snapshot(self, current_thread_only: bool = False) -> Dict[str, int]:
+        """原生搜索计数器（各线程私有计数的汇总：候选点生成/评估/胜负判断的次数与耗时、MCTS扩展与模拟等）；
+        current_thread_only为True时只取调用线程自己的计数（原生线程池上的计数不在其中）；降级实现返回空字典"""
+        if self.native:
+            return self.native.metrics_snapshot(current_thread_only)
+        return {}
+
+    def set_metrics_timing(self, enabled: bool):
+        """开关原生阶段计时（关闭后只计次数）"""
+        if self.native:
+            self.native.set_metrics_timing(enabled)
+
+    def evaluate_move(self, board: List[List[int]], x: int, y: int, color: int, weights: Optional[Dict[str, float]] = None) -> float:
+        """评估(x,y)落color后的棋型得分（四个方向棋型得分之和）"""
+        weights = weights or EVAL_WEIGHTS
+        if self.native:
+            return self.native.evaluate_move(board, x, y, color, weights)
+        board_size = len(board)
+        score = 0.0
+        for dx, dy in [(0, 1), (1, 0), (1, 1), (1, -1)]:
+            count = 1
+            blocked = 0
+            for sign in (1, -1):
+                nx, ny = x + sign * dx, y + sign * dy
+                while 0 <= nx < board_size and 0 <= ny < board_size and board[nx][ny] == color:
+                    count += 1
+                    nx += sign * dx
+                    ny += sign * dy
+                if not (0 <= nx < board_size and 0 <= ny < board_size) or board[nx][ny] != PIECE_COLORS.EMPTY:
+                    blocked += 1
+            if count >= 5:
+                score += weights['FIVE']
+            elif blocked == 2:
+                continue
+            elif count == 4:
+                score += weights['FOUR'] if blocked == 0 else weights['BLOCKED_FOUR']
+            elif count == 3:
+                score += weights['THREE'] if blocked == 0 else weights['BLOCKED_THREE']
+            elif count == 2:
+                score += weights['TWO'] if blocked == 0 else weights['BLOCKED_TWO']
+            else:
+                score += weights['ONE']
+        return score
+
+    def evaluate_board(self, board: List[List[int]], color: int, weights: Optional[Dict[str, float]] = None) -> float:
+        """局面静态评分（color视角：己方棋子棋型得分之和减去对方）"""
+        weights = weights or EVAL_WEIGHTS
+        if self.native:
+            return self._kernel('evaluate_board', len(board))(board, color, weights)
+        score = 0.0
+        for x, row in enumerate(board):
+            for y, c in enumerate(row):
+                if c == PIECE_COLORS.EMPTY:
+                    continue
+                s = self.evaluate_move(board, x, y, c, weights)
+                score += s if c == color else -s
+        return score
+
+    def evaluate_moves_batch(self, board: List[List[int]], color: int, weights: Optional[Dict[str, float]] = None) -> np.ndarray:
+        """一次算出color在所有空位落子的棋型得分（与逐点evaluate_move一致），返回(n, n)的float32数组，已落子格为0
+
+        C++：按线SIMD计算（AVX2/NEON，其余平台标量），整盘只跨一次语言边界。
+        """
+        weights = weights or EVAL_WEIGHTS
+        board_size = len(board)
+        if self.native:
+            buffer = self._kernel('evaluate_moves_batch', board_size)(board, color, weights)
+            return np.frombuffer(buffer, dtype=np.float32).reshape(board_size, board_size)
+        scores = np.zeros((board_size, board_size), dtype=np.float32)
+        for x in range(board_size):
+            for y in range(board_size):
+                if board[x][y] == PIECE_COLORS.EMPTY:
+                    scores[x][y] = self.evaluate_move(board, x, y, color, weights)
+        return scores
+
+    def find_winning_move(self, board: List[List[int]], color: int, board_size: int = 15, node_budget: int = 20000) -> Optional[Tuple[int, int]]:
+        """查找必胜落子（C++：一步成五→VCF→VCT威胁空间搜索；降级实现只查一步成五；无则返回None）"""
+        if self.native:
+            return self.native.find_winning_move(board, color, board_size, node_budget)
+        return self._find_five_move(board, color, board_size)
+
+    def solve_threats(self, board: List[List[int]], color: int, vcf_only: bool = False, max_depth: int = 11, node_budget: int = 20000) -> Dict:
+        """威胁空间搜索：返回{'proof': WIN/FAIL/UNKNOWN, 'move', 'depth', 'nodes'}（降级实现只查一步成五）"""
+        if self.native:
+            mode = self.native.THREAT_VCF if vcf_only else self.native.THREAT_VCT
+            return self.native.solve_threats(board, color, mode, max_depth, node_budget)
+        move = self._find_five_move(board, color, len(board))
+        return {'proof': 'WIN' if move else 'UNKNOWN', 'move': move, 'depth': 1 if move else 0, 'nodes': 0}
+
+    def _find_five_move(self, board: List[List[int]], color: int, board_size: int) -> Optional[Tuple[int, int]]:
+        """Python降级：查找一步成五的落子点"""
+        for x in range(board_size):
+            for y in range(board_size):
+                if board[x][y] != PIECE_COLORS.EMPTY:
+                    continue
+                if self.evaluate_move(board, x, y, color) >= EVAL_WEIGHTS['FIVE']:
+                    return (x, y)
+        return None
+
+    def mcts_optimize(self, board: List[List[int]], init_move: Tuple[int, int], color: int, depth: int = 4, iterations: int = 1000) -> Tuple[int, int]:
+        """以init_move为先验做MCTS优化，返回最优落子（Python降级时直接返回init_move）"""
+        if self.native:
+            return self.native.mcts_optimize(board, init_move[0], init_move[1], color, depth, iterations, EVAL_WEIGHTS)
+        return init_move
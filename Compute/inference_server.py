@@ -0,0 +1,178 @@
+import time
+import queue
+import threading
+import numpy as np
+from concurrent.futures import Future
+from typing import Dict, List, Optional, Tuple, Union
+from Common.config import Config
+from Common.logger import Logger
+from Common.metrics import SearchMetrics
+
+class InferenceServer:
+    """批量推理服务（同一模型的所有调用方共享：对局、MCTS工作线程的单局面请求攒成微批，一次前向传播）
+
+    调用方提交单个局面的输入（numpy数组，不含batch维），拿到Future；服务线程在收到第一条请求后
+    最多等待max_latency_ms，或凑满max_batch条即执行一次批量前向，再按行把结果分发给各Future。
+    模型输出为张量或张量元组（策略+价值双头），结果对应为单行数组或数组元组。
+    """
+    _servers: Dict[int, 'InferenceServer'] = {}  # id(model) -> 服务实例，进程内共享
+    _servers_lock = threading.Lock()
+
+    def __init__(self, model, device, max_batch: Optional[int] = None, max_latency_ms: Optional[float] = None):
+        config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self.model = model
+        self.device = device
+        self.max_batch = max_batch or config.get_int('AI', 'infer_max_batch', 64)
+        self.max_latency = (max_latency_ms if max_latency_ms is not None else config.get_float('AI', 'infer_max_latency_ms', 2.0)) / 1000.0
+        self.report_interval = config.get_float('AI', 'infer_report_interval', 60.0)  # 利用率日志间隔（秒）
+        self._queue: 'queue.Queue[Optional[Tuple[np.ndarray, Future, float]]]' = queue.Queue()
+        self._stats_lock = threading.Lock()
+        self.total_requests = 0  # 累计请求数（不随利用率日志清零，基准测试按区间差值计算QPS）
+        self._reset_stats()
+        self._submit_lock = threading.Lock()  # 入队与stop互斥：stop之后不会再有请求排在停止标记后面
+        self._running = True
+        self._thread = threading.Thread(target=self._serve, daemon=True)
+        self._thread.start()
+
+    @classmethod
+    def for_model(cls, model, device) -> 'InferenceServer':
+        """获取模型对应的共享服务（同一模型对象只启动一个服务线程）"""
+        with cls._servers_lock:
+            server = cls._servers.get(id(model))
+            if server is None or server.model is not model or not server._running:
+                server = cls(model, device)
+                cls._servers[id(model)] = server
+            return server
+
+    @classmethod
+    def servers(cls) -> List['InferenceServer']:
+        """当前进程内全部共享服务的快照"""
+        with cls._servers_lock:
+            return list(cls._servers.values())
+
+    # ------------------------------ 调用接口 ------------------------------
+    def submit(self, x: np.ndarray) -> Future:
+        """提交单个输入（不含batch维），返回Future"""
+        future: Future = Future()
+        x = np.asarray(x, dtype=np.float32)
+        with self._submit_lock:
+            if self._running:
+                self._queue.put((x, future, time.perf_counter()))
+                return future
+        future.set_exception(RuntimeError("inference server stopped"))
+        return future
+
+    def infer(self, x: np.ndarray) -> Union[np.ndarray, Tuple[np.ndarray, ...]]:
+        """同步推理（submit+等待结果）"""
+        return self.submit(x).result()
+
+    def infer_many(self, xs: List[np.ndarray]) -> List[Union[np.ndarray, Tuple[np.ndarray, ...]]]:
+        """一次提交多个输入（与其他调用方的请求一起成批），按顺序返回结果"""
+        futures = [self.submit(x) for x in xs]
+        return [future.result() for future in futures]
+
+    def stop(self):
+        """停止服务线程（未处理的请求以异常结束）"""
+        with self._submit_lock:
+            self._running = False
+            self._queue.put(None)
+        self._thread.join()
+        with InferenceServer._servers_lock:
+            if InferenceServer._servers.get(id(self.model)) is self:
+                del InferenceServer._servers[id(self.model)]
+
+    # ------------------------------ 利用率统计 ------------------------------
+    def _reset_stats(self):
+        self._stats = {'requests': 0, 'batches': 0, 'max_batch': 0, 'busy_time': 0.0, 'wait_time': 0.0}
+        self._stats_start = time.perf_counter()
+
+    def stats(self) -> Dict[str, float]:
+        """利用率报告：请求数、批次数、平均批大小、设备忙碌占比、平均排队时延（毫秒）"""
+        with self._stats_lock:
+            stats = dict(self._stats)
+            elapsed = max(time.perf_counter() - self._stats_start, 1e-9)
+        batches = max(stats['batches'], 1)
+        requests = max(stats['requests'], 1)
+        return {
+            'requests': stats['requests'],
+            'batches': stats['batches'],
+            'avg_batch': stats['requests'] / batches,
+            'max_batch': stats['max_batch'],
+            'utilization': stats['busy_time'] / elapsed,
+            'avg_wait_ms': stats['wait_time'] / requests * 1000.0,
+            'requests_per_sec': stats['requests'] / elapsed
+        }
+
+    def _report(self):
+        stats = self.stats()
+        self.logger.info(f"推理服务利用率：{stats['utilization']:.1%}，平均批大小：{stats['avg_batch']:.1f}"
+                         f"（最大{stats['max_batch']}），请求/秒：{stats['requests_per_sec']:.0f}，平均排队：{stats['avg_wait_ms']:.2f}ms")
+        with self._stats_lock:
+            self._reset_stats()
+
+    # ------------------------------ 服务线程 ------------------------------
+    def _collect(self) -> List[Tuple[np.ndarray, Future, float]]:
+        """取一批请求：阻塞等第一条，之后在截止时间前尽量凑满max_batch"""
+        first = self._queue.get()
+        if first is None:
+            return []
+        batch = [first]
+        deadline = time.perf_counter() + self.max_latency
+        while len(batch) < self.max_batch:
+            timeout = deadline - time.perf_counter()
+            try:
+                item = self._queue.get_nowait() if timeout <= 0 else self._queue.get(timeout=timeout)
+            except queue.Empty:
+                break
+            if item is None:
+                self._running = False
+                break
+            batch.append(item)
+        return batch
+
+    def _forward(self, inputs: np.ndarray):
+        import torch
+        with torch.no_grad():
+            output = self.model(torch.from_numpy(inputs).to(self.device))
+        if isinstance(output, (tuple, list)):
+            return tuple(o.float().cpu().numpy() for o in output)
+        return output.float().cpu().numpy()
+
+    def _serve(self):
+        last_report = time.perf_counter()
+        while self._running:
+            batch = self._collect()
+            if not batch:
+                break
+            start = time.perf_counter()
+            try:
+                output = self._forward(np.stack([item[0] for item in batch]))
+            except Exception as e:
+                self.logger.error(f"批量推理失败：{str(e)}")
+                for _, future, _ in batch:
+                    future.set_exception(e)
+                continue
+            end = time.perf_counter()
+            SearchMetrics.get_instance().trace_event('inference_batch', start, end - start, 'inference',
+                                                     {'batch': len(batch)})
+            for row, (_, future, submitted) in enumerate(batch):
+                future.set_result(tuple(o[row] for o in output) if isinstance(output, tuple) else output[row])
+            with self._stats_lock:
+                self._stats['requests'] += len(batch)
+                self.total_requests += len(batch)
+                self._stats['batches'] += 1
+                self._stats['max_batch'] = max(self._stats['max_batch'], len(batch))
+                self._stats['busy_time'] += end - start
+                self._stats['wait_time'] += sum(start - item[2] for item in batch)
+            if end - last_report >= self.report_interval:
+                self._report()
+                last_report = end
+        # 退出时丢弃的请求以异常结束，避免调用方永久等待
+        while True:
+            try:
+                item = self._queue.get_nowait()
+            except queue.Empty:
+                break
+            if item is not None:
+                item[1].set_exception(RuntimeError("inference server stopped"))
@@ -0,0 +1,162 @@
+#include "batch_eval.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GOMOKU_BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GOMOKU_TARGET_AVX2
+#else
+#define GOMOKU_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GOMOKU_BATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace gomoku {
+
+namespace {
+
+// 一条线上各位置的得分：out[p]为在位置p落子时该方向的棋型权重（p < n，out按8对齐留足空间）
+using LineKernel = void (*)(uint32_t own, uint32_t empty, int n, const float* weights, const uint8_t* table,
+                            float* out);
+
+constexpr int kLineBuffer = kMaxBoardSize;  // 8和4的倍数，向量内核可以整块写入
+static_assert(kLineBuffer % 8 == 0, "line buffer must hold whole AVX2 blocks");
+
+inline uint32_t window_index(uint32_t own, uint32_t empty, int p) {
+  const uint32_t o = ((own >> p) & kWindowMask) | kCenterBit;
+  const uint32_t e = (empty >> p) & kWindowMask & ~kCenterBit;
+  return (o << 9) | e;
+}
+
+void line_scores_scalar(uint32_t own, uint32_t empty, int n, const float* weights, const uint8_t* table,
+                        float* out) {
+  for (int p = 0; p < n; ++p) out[p] = weights[table[window_index(own, empty, p)]];
+}
+
+#if defined(GOMOKU_BATCH_X86)
+
+GOMOKU_TARGET_AVX2 void line_scores_avx2(uint32_t own, uint32_t empty, int n, const float* weights,
+                                         const uint8_t* table, float* out) {
+  const __m256i vown = _mm256_set1_epi32(static_cast<int>(own));
+  const __m256i vempty = _mm256_set1_epi32(static_cast<int>(empty));
+  const __m256i window = _mm256_set1_epi32(static_cast<int>(kWindowMask));
+  const __m256i center = _mm256_set1_epi32(static_cast<int>(kCenterBit));
+  const __m256i low_byte = _mm256_set1_epi32(0xFF);
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  for (int p = 0; p < n; p += 8) {
+    const __m256i shift = _mm256_add_epi32(_mm256_set1_epi32(p), lanes);
+    const __m256i o = _mm256_or_si256(_mm256_and_si256(_mm256_srlv_epi32(vown, shift), window), center);
+    const __m256i e = _mm256_andnot_si256(center, _mm256_and_si256(_mm256_srlv_epi32(vempty, shift), window));
+    const __m256i index = _mm256_or_si256(_mm256_slli_epi32(o, 9), e);
+    // 棋型表是字节表：按32位gather后取低字节（表尾有3字节填充）
+    const __m256i shape =
+        _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 1), low_byte);
+    _mm256_storeu_ps(out + p, _mm256_i32gather_ps(weights, shape, 4));
+  }
+}
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#elif defined(GOMOKU_BATCH_NEON)
+
+void line_scores_neon(uint32_t own, uint32_t empty, int n, const float* weights, const uint8_t* table,
+                      float* out) {
+  const uint32x4_t vown = vdupq_n_u32(own);
+  const uint32x4_t vempty = vdupq_n_u32(empty);
+  const uint32x4_t window = vdupq_n_u32(kWindowMask);
+  const uint32x4_t center = vdupq_n_u32(kCenterBit);
+  const int32_t lane_init[4] = {0, -1, -2, -3};
+  const int32x4_t lanes = vld1q_s32(lane_init);
+  uint32_t index[4];
+  for (int p = 0; p < n; p += 4) {
+    // NEON没有右移指令的变长版本，用负数左移代替
+    const int32x4_t shift = vsubq_s32(lanes, vdupq_n_s32(p));
+    const uint32x4_t o = vorrq_u32(vandq_u32(vshlq_u32(vown, shift), window), center);
+    const uint32x4_t e = vbicq_u32(vandq_u32(vshlq_u32(vempty, shift), window), center);
+    vst1q_u32(index, vorrq_u32(vshlq_n_u32(o, 9), e));
+    // 没有gather，逐通道查表
+    for (int k = 0; k < 4; ++k) out[p + k] = weights[table[index[k]]];
+  }
+}
+
+#endif
+
+LineKernel select_kernel(const char** name) {
+#if defined(GOMOKU_BATCH_X86)
+  if (cpu_has_avx2()) {
+    *name = "avx2";
+    return line_scores_avx2;
+  }
+#elif defined(GOMOKU_BATCH_NEON)
+  *name = "neon";
+  return line_scores_neon;
+#endif
+  *name = "scalar";
+  return line_scores_scalar;
+}
+
+struct KernelChoice {
+  const char* name = "scalar";
+  LineKernel kernel = nullptr;
+  KernelChoice() { kernel = select_kernel(&name); }
+};
+
+const KernelChoice& kernel_choice() {
+  static const KernelChoice choice;
+  return choice;
+}
+
+}  // namespace
+
+const char* batch_kernel_name() { return kernel_choice().name; }
+
+template <class Board>
+void evaluate_moves_batch(const Board& board, int color, const ShapeWeights& weights, float* out) {
+  const int n = board.size();
+  std::fill(out, out + n * n, 0.0f);
+  // gather的下标最大为SHAPE_FIVE，权重表补齐到8个通道
+  alignas(32) float w[16] = {};
+  for (int s = 0; s < SHAPE_COUNT; ++s) w[s] = static_cast<float>(weights.value[s]);
+  const LineKernel kernel = kernel_choice().kernel;
+  const uint8_t* table = ShapeTable::instance().data();
+  alignas(32) float scores[kLineBuffer];
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    for (int i = 0; i < board.lines_in(d); ++i) {
+      const uint32_t empty = board.line(EMPTY, d, i);
+      uint32_t cells = empty >> kPad;  // 本线上的空位
+      if (!cells) continue;
+      kernel(board.line(color, d, i), empty, n, w, table, scores);
+      for (; cells; cells &= cells - 1) {
+        const int p = lowest_bit(cells);
+        int x, y;
+        board.pos_to_cell(d, i, p, x, y);
+        out[x * n + y] += scores[p];
+      }
+    }
+  }
+}
+
+template void evaluate_moves_batch<LineBoard>(const LineBoard&, int, const ShapeWeights&, float*);
+template void evaluate_moves_batch<LineBoard15>(const LineBoard15&, int, const ShapeWeights&, float*);
+template void evaluate_moves_batch<LineBoard19>(const LineBoard19&, int, const ShapeWeights&, float*);
+
+}  // namespace gomoku
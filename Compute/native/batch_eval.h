@@ -0,0 +1,22 @@
+// 全盘落子评分批量计算
+//
+// 一次调用算出color在每个空位落子的棋型得分，与逐点evaluate_move的结果一致：
+//     out[x * n + y] = Σ_d weights[shape_at(board, x, y, color, d)]，已落子格为0
+// 按线计算：线上位置p的查表下标为 ((own >> p) & 0x1FF | 中心位) << 9 | ((empty >> p) & 0x1FF & ~中心位)，
+// 同一条线的各个位置互不依赖，AVX2一次算8个位置（变长移位 + gather查棋型表和权重表），
+// NEON一次算4个位置（向量移位，逐通道查表），其余平台使用标量实现。运行时按CPU能力选择。
+#pragma once
+
+#include "line_board.h"
+#include "shape.h"
+
+namespace gomoku {
+
+// out至少容纳board.size()^2个float
+template <class Board>
+void evaluate_moves_batch(const Board& board, int color, const ShapeWeights& weights, float* out);
+
+// 当前使用的内核："avx2"、"neon"或"scalar"
+const char* batch_kernel_name();
+
+}  // namespace gomoku
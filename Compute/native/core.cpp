@@ -0,0 +1,279 @@
+#include "core.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace gomoku {
+
+template <class Board>
+const char* validate_move(const Board& board, int x, int y, int current_player) {
+  if (!board.in_bounds(x, y)) return "invalid_position";
+  if (board.at(x, y) != EMPTY) return "occupied";
+  // 通过棋子数量判断回合（黑棋先手，最多比白棋多1颗）
+  int black = 0, white = 0;
+  for (int i = 0; i < board.lines_in(DIR_ROW); ++i) {
+    black += popcount32(board.line(BLACK, DIR_ROW, i));
+    white += popcount32(board.line(WHITE, DIR_ROW, i));
+  }
+  if (current_player == BLACK && black > white) return "black_turn_invalid";
+  if (current_player == WHITE && white > black) return "white_turn_invalid";
+  return nullptr;
+}
+
+template <class Board>
+bool find_five(const Board& board, int color, GameEnd& result) {
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    for (int i = 0; i < board.lines_in(d); ++i) {
+      const uint32_t runs = five_runs(board.line(color, d, i));
+      if (!runs) continue;
+      const int start = lowest_bit(runs) - kPad;
+      result.is_end = true;
+      result.winner = color;
+      result.win_line_len = 5;
+      for (int k = 0; k < 5; ++k) {
+        board.pos_to_cell(d, i, start + k, result.win_line[k][0], result.win_line[k][1]);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class Board>
+GameEnd check_game_end(const Board& board) {
+  GameEnd result;
+  if (find_five(board, BLACK, result) || find_five(board, WHITE, result)) return result;
+  if (board.empty_count() == 0) result.is_end = true;  // 棋盘已满，平局
+  return result;
+}
+
+GameEnd check_game_end_from(const uint32_t own_windows[DIR_COUNT], int x, int y, int color, int empty_count) {
+  GameEnd result;
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    const uint32_t runs = five_runs(own_windows[d] | kCenterBit);
+    if (!runs) continue;
+    // 窗口第k位对应沿方向偏移k-4的格子
+    const int start = lowest_bit(runs) - kPad;
+    result.is_end = true;
+    result.winner = color;
+    result.win_line_len = 5;
+    for (int k = 0; k < 5; ++k) {
+      result.win_line[k][0] = x + (start + k) * kDirDx[d];
+      result.win_line[k][1] = y + (start + k) * kDirDy[d];
+    }
+    return result;
+  }
+  if (empty_count <= 0) result.is_end = true;
+  return result;
+}
+
+template <class Board>
+GameEnd check_game_end_from(const Board& board, int x, int y, int color) {
+  uint32_t windows[DIR_COUNT];
+  for (int d = 0; d < DIR_COUNT; ++d) windows[d] = board.window(color, d, x, y);
+  return check_game_end_from(windows, x, y, color, board.empty_count());
+}
+
+template <class Board>
+double evaluate_move(const Board& board, int x, int y, int color, const ShapeWeights& weights) {
+  double score = 0.0;
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    score += weights.value[shape_at(board, x, y, color, d)];
+  }
+  return score;
+}
+
+template <class Board>
+double evaluate_board(const Board& board, int color, const ShapeWeights& weights) {
+  const int n = board.size();
+  double score = 0.0;
+  for (int x = 0; x < n; ++x) {
+    for (int y = 0; y < n; ++y) {
+      const int c = board.at(x, y);
+      if (c == EMPTY) continue;
+      const double s = evaluate_move(board, x, y, c, weights);
+      score += (c == color) ? s : -s;
+    }
+  }
+  return score;
+}
+
+template <class Board>
+bool find_winning_move(const Board& board, int color, int& out_x, int& out_y) {
+  const int n = board.size();
+  for (int x = 0; x < n; ++x) {
+    for (int y = 0; y < n; ++y) {
+      if (board.at(x, y) != EMPTY) continue;
+      for (int d = 0; d < DIR_COUNT; ++d) {
+        if (five_runs(board.window(color, d, x, y) | kCenterBit)) {
+          out_x = x;
+          out_y = y;
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+template <class Board>
+void collect_candidates(const Board& board, int radius, std::vector<int>& out) {
+  const int n = board.size();
+  out.clear();
+  if (board.empty_count() == n * n) {
+    out.push_back((n / 2) * n + n / 2);
+    return;
+  }
+  for (int x = 0; x < n; ++x) {
+    for (int y = 0; y < n; ++y) {
+      if (board.at(x, y) != EMPTY) continue;
+      bool near = false;
+      for (int dx = -radius; dx <= radius && !near; ++dx) {
+        for (int dy = -radius; dy <= radius; ++dy) {
+          const int nx = x + dx, ny = y + dy;
+          if (board.in_bounds(nx, ny) && board.at(nx, ny) != EMPTY) {
+            near = true;
+            break;
+          }
+        }
+      }
+      if (near) out.push_back(x * n + y);
+    }
+  }
+}
+
+#define GOMOKU_INSTANTIATE_CORE(Board)                                                               \
+  template const char* validate_move<Board>(const Board&, int, int, int);                            \
+  template bool find_five<Board>(const Board&, int, GameEnd&);                                       \
+  template GameEnd check_game_end<Board>(const Board&);                                              \
+  template GameEnd check_game_end_from<Board>(const Board&, int, int, int);                          \
+  template double evaluate_move<Board>(const Board&, int, int, int, const ShapeWeights&);            \
+  template double evaluate_board<Board>(const Board&, int, const ShapeWeights&);                     \
+  template bool find_winning_move<Board>(const Board&, int, int&, int&);                             \
+  template void collect_candidates<Board>(const Board&, int, std::vector<int>&);
+
+GOMOKU_INSTANTIATE_CORE(LineBoard)
+GOMOKU_INSTANTIATE_CORE(LineBoard15)
+GOMOKU_INSTANTIATE_CORE(LineBoard19)
+
+#undef GOMOKU_INSTANTIATE_CORE
+
+namespace {
+
+// 快速走子：能成五就成五，能挡五就挡五，否则在候选点中随机落子
+int rollout_move(const LineBoard& board, const std::vector<int>& candidates, int color, FastRng& rng) {
+  const int n = board.size();
+  int block = -1;
+  for (int idx : candidates) {
+    const int x = idx / n, y = idx % n;
+    if (board.at(x, y) != EMPTY) continue;
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      if (five_runs(board.window(color, d, x, y) | kCenterBit)) return idx;
+      if (block < 0 && five_runs(board.window(opponent(color), d, x, y) | kCenterBit)) block = idx;
+    }
+  }
+  if (block >= 0) return block;
+  for (int tries = 0; tries < 8; ++tries) {
+    const int idx = candidates[rng.below(static_cast<uint32_t>(candidates.size()))];
+    if (board.at(idx / n, idx % n) == EMPTY) return idx;
+  }
+  for (int idx : candidates) {
+    if (board.at(idx / n, idx % n) == EMPTY) return idx;
+  }
+  return -1;
+}
+
+}  // namespace
+
+void mcts_optimize(const LineBoard& board, int init_x, int init_y, int color, int depth, int iterations,
+                   const ShapeWeights& weights, int& out_x, int& out_y) {
+  const int n = board.size();
+  out_x = init_x;
+  out_y = init_y;
+
+  // 必胜/必防点直接返回
+  int wx, wy;
+  if (find_winning_move(board, color, wx, wy) || find_winning_move(board, opponent(color), wx, wy)) {
+    out_x = wx;
+    out_y = wy;
+    return;
+  }
+
+  std::vector<int> candidates;
+  collect_candidates(board, 2, candidates);
+  if (candidates.empty()) return;
+  const int init_idx = board.in_bounds(init_x, init_y) && board.at(init_x, init_y) == EMPTY ? init_x * n + init_y : -1;
+  if (init_idx >= 0) {
+    bool found = false;
+    for (int idx : candidates) found = found || (idx == init_idx);
+    if (!found) candidates.push_back(init_idx);
+  }
+
+  const size_t arms = candidates.size();
+  std::vector<double> wins(arms, 0.0);
+  std::vector<int> visits(arms, 0);
+  // 先验落子给予初始访问量
+  for (size_t i = 0; i < arms; ++i) {
+    if (candidates[i] == init_idx) {
+      visits[i] = 2;
+      wins[i] = 1.5;
+    }
+  }
+  int total = 0;
+  for (int v : visits) total += v;
+
+  FastRng rng(static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+  const double scale = weights.value[SHAPE_FOUR] > 0 ? weights.value[SHAPE_FOUR] : 1.0;
+
+  for (int it = 0; it < iterations; ++it) {
+    // UCB1选臂（未访问优先）
+    size_t arm = 0;
+    double best_ucb = -1.0;
+    const double log_total = std::log(static_cast<double>(total + 1));
+    for (size_t i = 0; i < arms; ++i) {
+      const double ucb = visits[i] == 0 ? 1e9 : wins[i] / visits[i] + 1.414 * std::sqrt(log_total / visits[i]);
+      if (ucb > best_ucb) {
+        best_ucb = ucb;
+        arm = i;
+      }
+    }
+
+    LineBoard sim = board;
+    const int idx = candidates[arm];
+    sim.place(idx / n, idx % n, color);
+    double result;
+    if (sim.five_through(idx / n, idx % n, color)) {
+      result = 1.0;
+    } else {
+      result = -1.0;
+      int to_move = opponent(color);
+      for (int ply = 0; ply < depth && sim.empty_count() > 0; ++ply) {
+        const int m = rollout_move(sim, candidates, to_move, rng);
+        if (m < 0) break;
+        sim.place(m / n, m % n, to_move);
+        if (sim.five_through(m / n, m % n, to_move)) {
+          result = to_move == color ? 1.0 : 0.0;
+          break;
+        }
+        to_move = opponent(to_move);
+      }
+      if (result < 0.0) {
+        // 未分胜负：用静态评分折算胜率
+        const double eval = evaluate_board(sim, color, weights) / scale;
+        result = 1.0 / (1.0 + std::exp(-eval));
+      }
+    }
+    wins[arm] += result;
+    visits[arm] += 1;
+    total += 1;
+  }
+
+  size_t best = 0;
+  for (size_t i = 1; i < arms; ++i) {
+    if (visits[i] > visits[best]) best = i;
+  }
+  out_x = candidates[best] / n;
+  out_y = candidates[best] % n;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,74 @@
+// 无状态核心算法（规则校验、胜负判断、棋型评估、必胜点、MCTS优化）
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "line_board.h"
+#include "shape.h"
+
+namespace gomoku {
+
+// 扫描类核心算法按棋盘类型模板化，在core.cpp中对LineBoard（运行时尺寸）、
+// LineBoard15、LineBoard19显式实例化，其他棋盘类型无法链接。
+
+struct GameEnd {
+  bool is_end = false;
+  int winner = EMPTY;
+  int win_line[5][2] = {};
+  int win_line_len = 0;
+};
+
+// 轻量随机数（xorshift64*，rollout使用）
+struct FastRng {
+  uint64_t state;
+  explicit FastRng(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+  uint64_t next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1Dull;
+  }
+  uint32_t below(uint32_t n) { return static_cast<uint32_t>((next() >> 32) % n); }
+  double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// 落子校验：合法返回nullptr，否则返回与Python侧一致的原因字符串
+template <class Board>
+const char* validate_move(const Board& board, int x, int y, int current_player);
+
+// 查找color的五连，找到时填充result
+template <class Board>
+bool find_five(const Board& board, int color, GameEnd& result);
+
+// 全盘胜负/平局判断
+template <class Board>
+GameEnd check_game_end(const Board& board);
+
+// 增量胜负判断：只看过(x,y)的四条线。own_windows为color在四个方向上的9格窗口
+// （第4位为(x,y)本身），empty_count为落子后剩余空位数（用于判平局）
+GameEnd check_game_end_from(const uint32_t own_windows[DIR_COUNT], int x, int y, int color, int empty_count);
+template <class Board>
+GameEnd check_game_end_from(const Board& board, int x, int y, int color);
+
+// (x,y)落color后的棋型得分（四个方向之和）
+template <class Board>
+double evaluate_move(const Board& board, int x, int y, int color, const ShapeWeights& weights);
+
+// 局面静态评分（color视角）
+template <class Board>
+double evaluate_board(const Board& board, int color, const ShapeWeights& weights);
+
+// 一步成五的落子点，找不到返回false
+template <class Board>
+bool find_winning_move(const Board& board, int color, int& out_x, int& out_y);
+
+// 已有棋子radius范围内的空位（空棋盘返回天元）
+template <class Board>
+void collect_candidates(const Board& board, int radius, std::vector<int>& out);
+
+// 以init_move为先验的MCTS落子优化，返回最优落子
+void mcts_optimize(const LineBoard& board, int init_x, int init_y, int color, int depth, int iterations,
+                   const ShapeWeights& weights, int& out_x, int& out_y);
+
+}  // namespace gomoku
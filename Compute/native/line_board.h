@@ -0,0 +1,172 @@
+// 位棋盘（按行/列/正对角/反对角四个方向保存每条线的掩码）
+//
+// 坐标约定与Python侧一致：board[x][y]，x为行，y为列。
+// 每条线用一个uint32_t掩码表示，线上位置pos存放在第(pos + kPad)位，
+// 两端各留kPad位空白，这样任意格子的9格窗口都可以用一次移位取出：
+//     window = (mask >> pos) & kWindowMask   // 第4位即为该格本身
+// 列、正对角、反对角三个方向的位置统一取行号x，便于后续按行批量计算。
+//
+// 棋盘尺寸是模板参数：BasicLineBoard<15>/<19>在编译期确定尺寸、线数与循环边界，
+// 便于编译器展开和向量化；BasicLineBoard<0>（即LineBoard）为运行时尺寸的通用实现。
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace gomoku {
+
+enum Color : int { EMPTY = 0, BLACK = 1, WHITE = 2 };
+
+inline int opponent(int color) { return color == BLACK ? WHITE : BLACK; }
+
+enum Direction : int { DIR_ROW = 0, DIR_COL = 1, DIR_DIAG = 2, DIR_ANTI = 3, DIR_COUNT = 4 };
+
+// 与Python侧directions = [(0, 1), (1, 0), (1, 1), (1, -1)]保持同序
+constexpr int kDirDx[DIR_COUNT] = {0, 1, 1, 1};
+constexpr int kDirDy[DIR_COUNT] = {1, 0, 1, -1};
+
+constexpr int kPad = 4;                       // 窗口半径（9格窗口）
+constexpr int kMaxBoardSize = 32 - 2 * kPad;  // 单条线必须放得进uint32_t
+constexpr int kMaxLines = 2 * kMaxBoardSize - 1;
+constexpr int kMaxCells = kMaxBoardSize * kMaxBoardSize;
+constexpr uint32_t kWindowMask = 0x1FF;
+constexpr uint32_t kCenterBit = 1u << kPad;
+
+inline int popcount32(uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcount(v);
+#else
+  int n = 0;
+  for (; v; v &= v - 1) ++n;
+  return n;
+#endif
+}
+
+inline int lowest_bit(uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz(v);
+#else
+  int n = 0;
+  while (!(v & 1u)) { v >>= 1; ++n; }
+  return n;
+#endif
+}
+
+// 掩码中是否存在连续5个置位（移位与运算）
+inline uint32_t five_runs(uint32_t m) {
+  return m & (m >> 1) & (m >> 2) & (m >> 3) & (m >> 4);
+}
+
+template <int N>
+class BasicLineBoard {
+ public:
+  static_assert(N == 0 || (N >= 5 && N <= kMaxBoardSize), "unsupported board size");
+  static constexpr int kFixedSize = N;
+  static constexpr int kLines = N > 0 ? 2 * N - 1 : kMaxLines;
+  static constexpr int kCells = N > 0 ? N * N : kMaxCells;
+
+  explicit BasicLineBoard(int size = N > 0 ? N : 15) { reset(size); }
+
+  // 固定尺寸版本忽略参数
+  void reset(int size) {
+    if (N == 0) size_ = size;
+    size = this->size();
+    std::memset(cells_, 0, sizeof(cells_));
+    std::memset(lines_, 0, sizeof(lines_));
+    // 空位掩码初始化为本条线上所有合法格子
+    for (int x = 0; x < size; ++x) {
+      for (int y = 0; y < size; ++y) {
+        for (int d = 0; d < DIR_COUNT; ++d) {
+          lines_[EMPTY][d][line_index(d, x, y)] |= bit(d, x, y);
+        }
+      }
+    }
+    empty_count_ = size * size;
+  }
+
+  int size() const { return N > 0 ? N : size_; }
+  int empty_count() const { return empty_count_; }
+  int lines_in(int d) const { return d <= DIR_COL ? size() : 2 * size() - 1; }
+
+  bool in_bounds(int x, int y) const { return x >= 0 && x < size() && y >= 0 && y < size(); }
+  int at(int x, int y) const { return cells_[x * size() + y]; }
+
+  // 落子（调用方保证该格为空）
+  void place(int x, int y, int color) {
+    cells_[x * size() + y] = static_cast<uint8_t>(color);
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      const int line = line_index(d, x, y);
+      const uint32_t b = bit(d, x, y);
+      lines_[EMPTY][d][line] &= ~b;
+      lines_[color][d][line] |= b;
+    }
+    --empty_count_;
+  }
+
+  // 提子（place的逆操作）
+  void remove(int x, int y) {
+    const int color = at(x, y);
+    cells_[x * size() + y] = EMPTY;
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      const int line = line_index(d, x, y);
+      const uint32_t b = bit(d, x, y);
+      lines_[color][d][line] &= ~b;
+      lines_[EMPTY][d][line] |= b;
+    }
+    ++empty_count_;
+  }
+
+  int line_index(int d, int x, int y) const {
+    switch (d) {
+      case DIR_ROW: return x;
+      case DIR_COL: return y;
+      case DIR_DIAG: return x - y + size() - 1;
+      default: return x + y;
+    }
+  }
+
+  // 格子在所在线上的位置（行方向为列号，其余方向为行号）
+  static int line_pos(int d, int x, int y) { return d == DIR_ROW ? y : x; }
+  static uint32_t bit(int d, int x, int y) { return 1u << (line_pos(d, x, y) + kPad); }
+
+  uint32_t line(int color, int d, int index) const { return lines_[color][d][index]; }
+
+  // 取(x,y)在方向d上的9格窗口：own为该颜色棋子，empty为空位（越界视为阻挡）
+  uint32_t window(int color, int d, int x, int y) const {
+    return (lines_[color][d][line_index(d, x, y)] >> line_pos(d, x, y)) & kWindowMask;
+  }
+
+  // 线上位置pos还原为棋盘坐标
+  void pos_to_cell(int d, int index, int pos, int& x, int& y) const {
+    switch (d) {
+      case DIR_ROW: x = index; y = pos; break;
+      case DIR_COL: x = pos; y = index; break;
+      case DIR_DIAG: x = pos; y = pos - (index - size() + 1); break;
+      default: x = pos; y = index - pos; break;
+    }
+  }
+
+  // 过(x,y)的四条线上color是否成五
+  bool five_through(int x, int y, int color) const {
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      if (five_runs(window(color, d, x, y)) != 0) return true;
+    }
+    return false;
+  }
+
+ private:
+  int size_ = N;
+  int empty_count_ = 0;
+  uint8_t cells_[kCells];
+  // lines_[EMPTY]为空位掩码，lines_[BLACK]/lines_[WHITE]为各自棋子掩码
+  uint32_t lines_[3][DIR_COUNT][kLines];
+};
+
+using LineBoard = BasicLineBoard<0>;
+using LineBoard15 = BasicLineBoard<15>;
+using LineBoard19 = BasicLineBoard<19>;
+
+// 有编译期特化的棋盘尺寸（标准15路与19路）
+constexpr int kSpecializedSizes[] = {15, 19};
+
+}  // namespace gomoku
@@ -0,0 +1,565 @@
+#include "mcts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "metrics.h"
+#include "thread_pool.h"
+
+namespace gomoku {
+
+namespace {
+
+// 32位下标可寻址的最大节点数
+constexpr size_t kMaxArenaNodes = static_cast<size_t>(std::numeric_limits<int32_t>::max());
+
+size_t clamp_arena(size_t nodes) { return std::min(std::max<size_t>(nodes, 1), kMaxArenaNodes); }
+
+}  // namespace
+
+// 节点不做值初始化（原子量在C++17下默认构造为未初始化），池内存直到被分配时才真正写入
+MctsEngine::MctsEngine(size_t arena_nodes)
+    : nodes_(new Node[clamp_arena(arena_nodes)]), capacity_(clamp_arena(arena_nodes)) {}
+
+void MctsEngine::clear() {
+  used_.store(0, std::memory_order_relaxed);
+  node_count_ = 0;
+  max_depth_ = 0;
+  reusable_ = false;
+  reused_visits_ = 0;
+  puct_ = false;
+  pending_.clear();
+}
+
+void MctsEngine::reset_search_stats() {
+  stat_playouts_.store(0, std::memory_order_relaxed);
+  stat_expansions_.store(0, std::memory_order_relaxed);
+  stat_children_.store(0, std::memory_order_relaxed);
+}
+
+void MctsEngine::add_search_stats(const MctsSearchStats& stats) {
+  stat_playouts_.fetch_add(stats.playouts, std::memory_order_relaxed);
+  stat_expansions_.fetch_add(stats.expansions, std::memory_order_relaxed);
+  stat_children_.fetch_add(stats.children, std::memory_order_relaxed);
+}
+
+MctsSearchStats MctsEngine::search_stats() const {
+  MctsSearchStats stats;
+  stats.playouts = stat_playouts_.load(std::memory_order_relaxed);
+  stats.expansions = stat_expansions_.load(std::memory_order_relaxed);
+  stats.children = stat_children_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+int32_t MctsEngine::allocate(int count) {
+  if (count <= 0) return -1;
+  const size_t first = used_.fetch_add(static_cast<size_t>(count), std::memory_order_relaxed);
+  // 池已满：超出的部分不回收，clear时一并归零
+  if (first + static_cast<size_t>(count) > capacity_) return -1;
+  metric_add(METRIC_NODE_ALLOCS, static_cast<uint64_t>(count));
+  return static_cast<int32_t>(first);
+}
+
+void MctsEngine::init_node(int32_t index, int32_t parent, int move, int mover) {
+  Node& node = nodes_[index];
+  node.parent = parent;
+  node.first_child = -1;
+  node.child_count = 0;
+  node.move = static_cast<int16_t>(move);
+  node.mover = static_cast<uint8_t>(mover);
+  node.state.store(0, std::memory_order_relaxed);
+  node.visits.store(0, std::memory_order_relaxed);
+  node.half_wins.store(0, std::memory_order_relaxed);
+}
+
+bool MctsEngine::expand(int32_t index, Worker& worker, bool threat_first) {
+  Node& node = nodes_[index];
+  uint8_t expected = 0;
+  if (!node.state.compare_exchange_strong(expected, kExpanding, std::memory_order_acq_rel)) {
+    // 别的线程已经扩展完成时可以继续向下；正在扩展或无法扩展时当作叶子
+    return (expected & kExpanded) != 0;
+  }
+  const int to_move = opponent(node.mover);
+  worker.board.candidates(to_move, threat_first, worker.scratch);
+  const int count = static_cast<int>(worker.scratch.size());
+  const int32_t first = allocate(count);
+  if (first < 0) {
+    node.state.store(kLeaf, std::memory_order_release);
+    return false;
+  }
+  for (int i = 0; i < count; ++i) init_node(first + i, index, worker.scratch[i], to_move);
+  node.first_child = first;
+  node.child_count = static_cast<uint16_t>(count);
+  node.state.store(kExpanded, std::memory_order_release);
+  metric_add(METRIC_MCTS_EXPANSIONS);
+  metric_add(METRIC_MCTS_CHILDREN, static_cast<uint64_t>(count));
+  ++worker.stats.expansions;
+  worker.stats.children += static_cast<uint64_t>(count);
+  return true;
+}
+
+int32_t MctsEngine::select_child(int32_t index, double exploration, FastRng& rng) const {
+  const Node& node = nodes_[index];
+  const int32_t parent_visits = node.visits.load(std::memory_order_relaxed);
+  const double log_visits = std::log(static_cast<double>(std::max(parent_visits, 1)));
+  int32_t best = -1;
+  double best_score = -std::numeric_limits<double>::infinity();
+  for (int32_t i = node.first_child; i < node.first_child + node.child_count; ++i) {
+    const Node& child = nodes_[i];
+    const int32_t visits = child.visits.load(std::memory_order_relaxed);
+    // 未访问的子节点优先，多个时随机挑一个；虚拟损失计入访问次数，拉低正在被搜索的分支
+    double score;
+    if (visits == 0) {
+      score = 1e9 + rng.uniform();
+    } else {
+      const double q = child.half_wins.load(std::memory_order_relaxed) / (2.0 * visits);
+      score = q + exploration * std::sqrt(log_visits / visits);
+    }
+    if (score > best_score) {
+      best_score = score;
+      best = i;
+    }
+  }
+  return best;
+}
+
+int MctsEngine::rollout(SearchBoard& board, int to_move) {
+  int played = 0;
+  int winner = EMPTY;
+  while (board.empty_count() > 0) {
+    const int cell = board.best_move(to_move);
+    if (cell < 0) break;
+    ++played;
+    if (board.make_move(cell / board.size(), cell % board.size(), to_move)) {
+      winner = to_move;
+      break;
+    }
+    to_move = opponent(to_move);
+  }
+  for (int i = 0; i < played; ++i) board.unmake_move();
+  metric_add(METRIC_ROLLOUT_PLIES, static_cast<uint64_t>(played));
+  return winner;
+}
+
+void MctsEngine::backpropagate(int32_t index, int winner) {
+  for (; index >= 0; index = nodes_[index].parent) {
+    Node& node = nodes_[index];
+    // 选择时已加过kVirtualLoss次访问，这里补足为1次
+    if (kVirtualLoss != 1) node.visits.fetch_add(1 - kVirtualLoss, std::memory_order_relaxed);
+    const int32_t points = winner == EMPTY ? 1 : (winner == node.mover ? 2 : 0);
+    if (points) node.half_wins.fetch_add(points, std::memory_order_relaxed);
+  }
+}
+
+void MctsEngine::iterate(Worker& worker, double exploration) {
+  SearchBoard& board = worker.board;
+  const int n = board.size();
+  int32_t index = 0;
+  int depth = 0;
+  nodes_[0].visits.fetch_add(kVirtualLoss, std::memory_order_relaxed);
+  // 选择+扩展：沿UCT走到第一个未访问的节点
+  for (;;) {
+    const uint8_t state = nodes_[index].state.load(std::memory_order_acquire);
+    if (state & (kTerminal | kLeaf | kExpanding)) break;
+    if (!(state & kExpanded) && !expand(index, worker, index == 0)) break;
+    index = select_child(index, exploration, worker.rng);
+    Node& child = nodes_[index];
+    const int32_t before = child.visits.fetch_add(kVirtualLoss, std::memory_order_relaxed);
+    ++depth;
+    // 每个经过的线程都自己判终局，终局标志与胜方的写入是幂等的
+    if (board.make_move(child.move / n, child.move % n, child.mover)) {
+      const uint8_t terminal = static_cast<uint8_t>(kTerminal | (child.mover << kWinnerShift));
+      child.state.fetch_or(terminal, std::memory_order_relaxed);
+    } else if (board.empty_count() == 0) {
+      child.state.fetch_or(kTerminal, std::memory_order_relaxed);  // 平局，胜方位为EMPTY
+    }
+    if (before == 0) break;
+  }
+  worker.max_depth = std::max(worker.max_depth, depth);
+
+  // 模拟
+  const Node& leaf = nodes_[index];
+  const uint8_t state = leaf.state.load(std::memory_order_relaxed);
+  const int winner = (state & kTerminal) ? (state >> kWinnerShift) & 3 : rollout(board, opponent(leaf.mover));
+
+  // 还原到根局面并回溯
+  for (int i = 0; i < depth; ++i) board.unmake_move();
+  backpropagate(index, winner);
+  metric_add(METRIC_MCTS_PLAYOUTS);
+  ++worker.stats.playouts;
+}
+
+void MctsEngine::run_tree(const SearchBoard& root, int iterations, double exploration, uint64_t seed, int threads,
+                          Clock::time_point deadline) {
+  std::atomic<int> remaining{iterations};
+  std::atomic<int> depth{max_depth_};
+  ThreadPool::shared().run(threads, [&](int t) {
+    Worker worker(root, seed + 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(t + 1));
+    while (!should_stop(deadline) && remaining.fetch_sub(1, std::memory_order_relaxed) > 0) iterate(worker, exploration);
+    add_search_stats(worker.stats);
+    int current = depth.load(std::memory_order_relaxed);
+    while (worker.max_depth > current && !depth.compare_exchange_weak(current, worker.max_depth)) {
+    }
+  });
+  max_depth_ = depth.load();
+}
+
+void MctsEngine::run_root_parallel(const SearchBoard& root, int color, int iterations, double exploration,
+                                   uint64_t seed, int threads, Clock::time_point deadline) {
+  // 每个线程一棵独立的树，节点池按线程均分；子引擎共用本引擎的停止信号与截止时间
+  std::vector<std::unique_ptr<MctsEngine>> trees;
+  for (int t = 0; t < threads; ++t) {
+    trees.emplace_back(new MctsEngine(capacity_ / threads));
+    trees.back()->stop_flag_ = &stop_;
+  }
+  ThreadPool::shared().run(threads, [&](int t) {
+    const int share = iterations / threads + (t < iterations % threads ? 1 : 0);
+    MctsEngine& tree = *trees[t];
+    const int32_t root_index = tree.allocate(1);
+    tree.init_node(root_index, -1, -1, opponent(color));
+    tree.run_tree(root, share, exploration, seed + 0x9E3779B97F4A7C15ull * static_cast<uint64_t>(t + 1), 1, deadline);
+    tree.node_count_ = std::min(tree.used_.load(std::memory_order_relaxed), tree.capacity_);
+  });
+
+  // 按落子合并各棵树根节点的子节点统计
+  std::vector<int> slot(kMaxCells, -1);
+  std::vector<int> cells;
+  std::vector<int32_t> visits, half_wins;
+  int32_t root_visits = 0;
+  std::vector<MctsChildStat> stats;
+  for (const auto& tree : trees) {
+    root_visits += tree->root_visits();
+    node_count_ += tree->node_count();
+    add_search_stats(tree->search_stats());
+    max_depth_ = std::max(max_depth_, tree->max_depth());
+    tree->root_children(stats);
+    for (const MctsChildStat& stat : stats) {
+      if (slot[stat.cell] < 0) {
+        slot[stat.cell] = static_cast<int>(cells.size());
+        cells.push_back(stat.cell);
+        visits.push_back(0);
+        half_wins.push_back(0);
+      }
+      visits[slot[stat.cell]] += stat.visits;
+      half_wins[slot[stat.cell]] += static_cast<int32_t>(std::lround(stat.value * 2));
+    }
+  }
+  const int32_t root_index = allocate(1);
+  init_node(root_index, -1, -1, opponent(color));
+  Node& merged = nodes_[root_index];
+  merged.visits.store(root_visits, std::memory_order_relaxed);
+  const int32_t first = allocate(static_cast<int>(cells.size()));
+  if (first < 0) return;
+  for (size_t i = 0; i < cells.size(); ++i) {
+    Node& child = nodes_[first + static_cast<int32_t>(i)];
+    init_node(first + static_cast<int32_t>(i), root_index, cells[i], color);
+    child.visits.store(visits[i], std::memory_order_relaxed);
+    child.half_wins.store(half_wins[i], std::memory_order_relaxed);
+  }
+  merged.first_child = first;
+  merged.child_count = static_cast<uint16_t>(cells.size());
+  merged.state.store(kExpanded, std::memory_order_release);
+}
+
+int32_t MctsEngine::find_descendant(const LineBoard& board, int color) const {
+  if (!reusable_ || used_.load(std::memory_order_relaxed) == 0 || board.size() != root_size_) return -1;
+  const int n = root_size_;
+  // 新局面必须包含旧根的全部棋子，多出来的棋子就是从旧根走下来的路径
+  std::vector<int> extra;
+  for (int cell = 0; cell < n * n; ++cell) {
+    const int c = board.at(cell / n, cell % n);
+    if (root_cells_[cell] != EMPTY && root_cells_[cell] != c) return -1;
+    if (root_cells_[cell] == EMPTY && c != EMPTY) extra.push_back(cell);
+  }
+  int32_t index = 0;
+  int to_move = root_color_;
+  while (!extra.empty()) {
+    const Node& node = nodes_[index];
+    if (!(node.state.load(std::memory_order_acquire) & kExpanded)) return -1;
+    int32_t next = -1;
+    for (int32_t i = node.first_child; i < node.first_child + node.child_count && next < 0; ++i) {
+      const int cell = nodes_[i].move;
+      if (board.at(cell / n, cell % n) != to_move) continue;
+      for (size_t k = 0; k < extra.size(); ++k) {
+        if (extra[k] != cell) continue;
+        extra[k] = extra.back();
+        extra.pop_back();
+        next = i;
+        break;
+      }
+    }
+    if (next < 0) return -1;
+    index = next;
+    to_move = opponent(to_move);
+  }
+  return to_move == color ? index : -1;
+}
+
+void MctsEngine::promote(int32_t node) {
+  const size_t used = std::min(used_.load(std::memory_order_relaxed), capacity_);
+  // remap[i]为节点i整理后的下标，-1表示丢弃（父节点下标总小于子节点，一趟顺序扫描即可）
+  std::vector<int32_t> remap(used, -1);
+  int32_t kept = 0;
+  for (size_t i = static_cast<size_t>(node); i < used; ++i) {
+    const int32_t parent = nodes_[i].parent;
+    if (static_cast<int32_t>(i) == node || (parent >= node && remap[parent] >= 0)) remap[i] = kept++;
+  }
+  for (size_t i = static_cast<size_t>(node); i < used; ++i) {
+    if (remap[i] < 0) continue;
+    Node& src = nodes_[i];
+    Node& dst = nodes_[remap[i]];
+    dst.parent = static_cast<int32_t>(i) == node ? -1 : remap[src.parent];
+    dst.first_child = src.first_child >= 0 ? remap[src.first_child] : -1;
+    dst.child_count = src.child_count;
+    dst.move = static_cast<int32_t>(i) == node ? -1 : src.move;
+    dst.mover = src.mover;
+    // 池满时被标成叶子的节点在整理出空间后可以重新扩展
+    const uint8_t state = src.state.load(std::memory_order_relaxed);
+    dst.state.store(state == kLeaf ? 0 : state, std::memory_order_relaxed);
+    dst.visits.store(src.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    dst.half_wins.store(src.half_wins.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    if (puct_) {
+      prior_[remap[i]] = prior_[i];
+      value_sum_[remap[i]] = value_sum_[i];
+    }
+  }
+  used_.store(static_cast<size_t>(kept), std::memory_order_relaxed);
+}
+
+void MctsEngine::remember_root(const LineBoard& board, int color, bool reusable) {
+  const int n = board.size();
+  root_size_ = n;
+  root_color_ = color;
+  root_cells_.resize(static_cast<size_t>(n * n));
+  for (int cell = 0; cell < n * n; ++cell) root_cells_[cell] = static_cast<uint8_t>(board.at(cell / n, cell % n));
+  reusable_ = reusable;
+}
+
+void MctsEngine::search(const SearchBoard& root, int color, int iterations, double exploration, uint64_t seed,
+                        int threads, MctsMode mode, bool reuse, double time_limit) {
+  threads = std::max(threads, 1);
+  stop_.store(false, std::memory_order_relaxed);
+  reset_search_stats();
+  const Clock::time_point deadline =
+      time_limit > 0.0 ? Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(time_limit))
+                       : Clock::time_point::max();
+  const bool tree_mode = mode != MCTS_ROOT_PARALLEL || threads == 1;
+  const int32_t reused = reuse && tree_mode && !puct_ ? find_descendant(root.board(), color) : -1;
+  if (reused >= 0 && nodes_[reused].visits.load(std::memory_order_relaxed) > 0) {
+    promote(reused);
+    reused_visits_ = nodes_[0].visits.load(std::memory_order_relaxed);
+    max_depth_ = 0;
+  } else {
+    clear();
+    if (!tree_mode) {
+      run_root_parallel(root, color, iterations, exploration, seed, threads, deadline);
+      remember_root(root.board(), color, false);
+      return;
+    }
+    const int32_t root_index = allocate(1);
+    init_node(root_index, -1, -1, opponent(color));
+  }
+  run_tree(root, iterations, exploration, seed, threads, deadline);
+  node_count_ = std::min(used_.load(std::memory_order_relaxed), capacity_);
+  remember_root(root.board(), color, true);
+}
+
+bool MctsEngine::puct_begin(const SearchBoard& root, int color, bool reuse) {
+  if (prior_.size() != capacity_) {
+    prior_.assign(capacity_, 0.0f);
+    value_sum_.assign(capacity_, 0.0f);
+  }
+  pending_.clear();
+  reset_search_stats();
+  puct_board_.reset(new SearchBoard(root));
+  const int32_t reused = reuse && puct_ ? find_descendant(root.board(), color) : -1;
+  const bool hit = reused >= 0 && nodes_[reused].visits.load(std::memory_order_relaxed) > 0;
+  if (hit) {
+    promote(reused);
+    reused_visits_ = nodes_[0].visits.load(std::memory_order_relaxed);
+  } else {
+    clear();
+    const int32_t root_index = allocate(1);
+    init_node(root_index, -1, -1, opponent(color));
+    prior_[root_index] = 1.0f;
+    value_sum_[root_index] = 0.0f;
+  }
+  puct_ = true;
+  max_depth_ = 0;
+  node_count_ = std::min(used_.load(std::memory_order_relaxed), capacity_);
+  remember_root(root.board(), color, true);
+  return hit;
+}
+
+int32_t MctsEngine::puct_child(int32_t index, double c_puct) const {
+  const Node& node = nodes_[index];
+  const double sqrt_visits = std::sqrt(static_cast<double>(std::max(node.visits.load(std::memory_order_relaxed), 1)));
+  int32_t best = -1;
+  double best_score = -std::numeric_limits<double>::infinity();
+  for (int32_t i = node.first_child; i < node.first_child + node.child_count; ++i) {
+    const int32_t visits = nodes_[i].visits.load(std::memory_order_relaxed);
+    // 未访问子节点的Q取0（中性），由先验项决定先后
+    const double q = visits > 0 ? value_sum_[i] / visits : 0.0;
+    const double score = q + c_puct * prior_[i] * sqrt_visits / (1 + visits);
+    if (score > best_score) {
+      best_score = score;
+      best = i;
+    }
+  }
+  return best;
+}
+
+void MctsEngine::puct_backpropagate(int32_t index, double value) {
+  for (; index >= 0; index = nodes_[index].parent) {
+    // 选择时已记1次访问并按负1计入价值（虚拟损失），这里补回
+    value_sum_[index] += static_cast<float>(1.0 + value);
+    value = -value;
+  }
+}
+
+int MctsEngine::puct_select(int max_leaves, double c_puct, float* planes) {
+  SearchBoard& board = *puct_board_;
+  const int n = board.size();
+  const int cells = n * n;
+  std::vector<int> candidates;
+  for (int attempt = 0; attempt < max_leaves; ++attempt) {
+    int32_t index = 0;
+    int depth = 0;
+    // 选择：沿PUCT走到未扩展/终局节点，路径上每个节点加虚拟损失（访问+1，价值-1）
+    for (;;) {
+      Node& node = nodes_[index];
+      node.visits.fetch_add(1, std::memory_order_relaxed);
+      value_sum_[index] -= 1.0f;
+      if (depth > 0) {
+        if (board.make_move(node.move / n, node.move % n, node.mover)) {
+          node.state.fetch_or(static_cast<uint8_t>(kTerminal | (node.mover << kWinnerShift)), std::memory_order_relaxed);
+        } else if (board.empty_count() == 0) {
+          node.state.fetch_or(kTerminal, std::memory_order_relaxed);
+        }
+      }
+      const uint8_t state = node.state.load(std::memory_order_relaxed);
+      if (state & (kTerminal | kExpanding | kLeaf) || !(state & kExpanded)) break;
+      index = puct_child(index, c_puct);
+      ++depth;
+    }
+    max_depth_ = std::max(max_depth_, depth);
+
+    Node& leaf = nodes_[index];
+    const uint8_t state = leaf.state.load(std::memory_order_relaxed);
+    bool collided = false;
+    if (state & kTerminal) {
+      // 终局：走入方成五为胜，否则为平局
+      puct_backpropagate(index, ((state >> kWinnerShift) & 3) == leaf.mover ? 1.0 : 0.0);
+    } else if ((state & kExpanding) && !(state & kExpanded)) {
+      // 本批已选中的叶子：撤销这条路径的虚拟损失，结束本批
+      for (int32_t i = index; i >= 0; i = nodes_[i].parent) {
+        nodes_[i].visits.fetch_sub(1, std::memory_order_relaxed);
+        value_sum_[i] += 1.0f;
+      }
+      collided = true;
+    } else {
+      // 待评估叶子：先分配子节点（先验在puct_apply写入），池满时只评估不扩展。
+      // 有成五/堵五的必走点时只展开必走点，其余交给网络先验
+      if (state == 0) {
+        const int to_move = opponent(leaf.mover);
+        board.forced_moves(to_move, candidates);
+        if (candidates.empty()) board.candidates(to_move, false, candidates);
+        const int count = static_cast<int>(candidates.size());
+        const int32_t first = allocate(count);
+        if (first < 0) {
+          leaf.state.store(kLeaf, std::memory_order_relaxed);
+        } else {
+          for (int i = 0; i < count; ++i) init_node(first + i, index, candidates[i], to_move);
+          leaf.first_child = first;
+          leaf.child_count = static_cast<uint16_t>(count);
+          leaf.state.store(kExpanding, std::memory_order_relaxed);
+          metric_add(METRIC_MCTS_EXPANSIONS);
+          metric_add(METRIC_MCTS_CHILDREN, static_cast<uint64_t>(count));
+          stat_expansions_.fetch_add(1, std::memory_order_relaxed);
+          stat_children_.fetch_add(static_cast<uint64_t>(count), std::memory_order_relaxed);
+        }
+      }
+      // 导出输入：通道0为走子方棋子，通道1为对方棋子
+      const int to_move = opponent(leaf.mover);
+      float* out = planes + static_cast<size_t>(pending_.size()) * 2 * cells;
+      for (int cell = 0; cell < cells; ++cell) {
+        const int c = board.at(cell / n, cell % n);
+        out[cell] = c == to_move ? 1.0f : 0.0f;
+        out[cells + cell] = c != EMPTY && c != to_move ? 1.0f : 0.0f;
+      }
+      pending_.push_back(index);
+    }
+    for (int i = 0; i < depth; ++i) board.unmake_move();
+    if (collided) break;
+  }
+  return static_cast<int>(pending_.size());
+}
+
+void MctsEngine::puct_apply(const float* policies, const float* values) {
+  const int cells = puct_board_->size() * puct_board_->size();
+  for (size_t k = 0; k < pending_.size(); ++k) {
+    const int32_t index = pending_[k];
+    Node& leaf = nodes_[index];
+    const float* policy = policies + k * cells;
+    if (leaf.state.load(std::memory_order_relaxed) == kExpanding) {
+      // 先验按候选点归一化，网络输出全为0或非法时退化为均匀分布
+      double sum = 0.0;
+      for (int32_t i = leaf.first_child; i < leaf.first_child + leaf.child_count; ++i) {
+        const float p = policy[nodes_[i].move];
+        if (std::isfinite(p) && p > 0.0f) sum += p;
+      }
+      for (int32_t i = leaf.first_child; i < leaf.first_child + leaf.child_count; ++i) {
+        const float p = policy[nodes_[i].move];
+        prior_[i] = sum > 0.0 ? static_cast<float>((std::isfinite(p) && p > 0.0f ? p : 0.0f) / sum)
+                              : 1.0f / leaf.child_count;
+        value_sum_[i] = 0.0f;
+      }
+      leaf.state.store(kExpanded, std::memory_order_relaxed);
+    }
+    // 网络价值是走子方视角，走入该叶子的一方取反
+    const double value = std::isfinite(values[k]) ? std::min(std::max<double>(values[k], -1.0), 1.0) : 0.0;
+    puct_backpropagate(index, -value);
+  }
+  metric_add(METRIC_MCTS_PLAYOUTS, pending_.size());
+  stat_playouts_.fetch_add(pending_.size(), std::memory_order_relaxed);
+  pending_.clear();
+  node_count_ = std::min(used_.load(std::memory_order_relaxed), capacity_);
+}
+
+int MctsEngine::root_visits() const {
+  return used_.load(std::memory_order_relaxed) > 0 ? nodes_[0].visits.load(std::memory_order_relaxed) : 0;
+}
+
+int MctsEngine::best_move() const {
+  if (used_.load(std::memory_order_relaxed) == 0) return -1;
+  const Node& root = nodes_[0];
+  if (!(root.state.load(std::memory_order_acquire) & kExpanded)) return -1;
+  int32_t best = -1;
+  int32_t best_visits = -1;
+  for (int32_t i = root.first_child; i < root.first_child + root.child_count; ++i) {
+    const int32_t visits = nodes_[i].visits.load(std::memory_order_relaxed);
+    if (visits > best_visits) {
+      best = i;
+      best_visits = visits;
+    }
+  }
+  return best < 0 ? -1 : nodes_[best].move;
+}
+
+void MctsEngine::root_children(std::vector<MctsChildStat>& out) const {
+  out.clear();
+  if (used_.load(std::memory_order_relaxed) == 0) return;
+  const Node& root = nodes_[0];
+  if (!(root.state.load(std::memory_order_acquire) & kExpanded)) return;
+  for (int32_t i = root.first_child; i < root.first_child + root.child_count; ++i) {
+    MctsChildStat stat;
+    stat.cell = nodes_[i].move;
+    stat.visits = nodes_[i].visits.load(std::memory_order_relaxed);
+    // PUCT树按[-1,1]累计价值换算成胜点（胜1、平0.5、负0），与UCT树口径一致
+    stat.value = puct_ ? (value_sum_[i] + stat.visits) / 2.0 : nodes_[i].half_wins.load(std::memory_order_relaxed) / 2.0;
+    out.push_back(stat);
+  }
+}
+
+}  // namespace gomoku
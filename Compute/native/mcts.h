@@ -0,0 +1,176 @@
+// 蒙特卡洛树搜索引擎（连续节点池 + 下标链接，多线程无锁并行）
+//
+// 所有节点放在一块预分配的节点池里，父子关系用32位下标表示：
+//   - 节点扩展时一次性为全部候选点分配子节点，占用池中连续的一段[first_child, first_child + child_count)
+//   - 节点不保存棋盘，每次迭代从根局面沿路径make_move重放，结束后unmake回到根
+//   - 统计量只有访问次数和累计胜点（以走入该节点的一方为视角，按半点计数：胜2、平1、负0）
+// 整棵树的释放就是把池的已用计数归零（O(1)），池内存在多次搜索之间复用；池用完后不再扩展，
+// 后续迭代在叶子上直接模拟。
+//
+// 并行方式（均在原生线程上运行，调用方释放GIL）：
+//   - 树并行：所有线程共享一棵树。访问次数/胜点为原子计数；选择路径时先加虚拟损失
+//     （只加访问不加胜点），让其他线程倾向于走别的分支，回溯时扣回；
+//     扩展用状态位CAS抢占，抢到的线程分配并初始化子节点后以release发布，
+//     没抢到的线程不等待，直接把该节点当叶子模拟。节点池分配是一次fetch_add。
+//   - 根并行：每个线程在自己的节点池里独立建树，结束后按根节点子节点合并访问次数与胜点（对照用）。
+//
+// 树复用：引擎记住上次搜索的根局面。下一次搜索的局面如果是它沿树走几步（通常是己方落子+对方应手）
+// 得到的，就把对应的孙节点提升为新根，整理节点池只保留这棵子树（其余兄弟分支释放），继续累加统计；
+// 局面对不上时重新建树。
+//
+// PUCT模式（AlphaZero式，神经网络引导）：不做模拟，叶子由外部（Python批量推理服务）评估。
+// puct_select按PUCT沿树选出一批叶子（路径上加虚拟损失），为每个叶子分配子节点并导出双通道输入；
+// 调用方批量前向后把策略（先验）和价值交给puct_apply，写入先验、发布扩展并回溯价值。
+// 先验和累计价值存放在与节点池平行的两个float数组里（首次使用PUCT时分配），不增大节点本身；
+// PUCT搜索由单个调用线程驱动，并行来自批量推理。
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core.h"
+#include "search_board.h"
+
+namespace gomoku {
+
+enum MctsMode { MCTS_TREE_PARALLEL = 0, MCTS_ROOT_PARALLEL = 1 };
+
+struct MctsChildStat {
+  int cell = -1;
+  int visits = 0;
+  double value = 0.0;  // 累计胜点（走入该子节点一方的视角）
+};
+
+// 本引擎最近一次搜索（search或puct_begin之后）的计数，不含同进程其他引擎的搜索
+struct MctsSearchStats {
+  uint64_t playouts = 0;
+  uint64_t expansions = 0;
+  uint64_t children = 0;  // 扩展出的子节点数（即节点池分配的节点数，不含根）
+};
+
+class MctsEngine {
+ public:
+  // arena_nodes为节点池容量（每个节点24字节）
+  explicit MctsEngine(size_t arena_nodes);
+
+  // 从root局面（color先走）搜索iterations次迭代，用threads个线程（取自共享线程池）；
+  // reuse为true时尽量复用上次的树；time_limit>0时到时即停（秒），已完成的迭代照常生效
+  void search(const SearchBoard& root, int color, int iterations, double exploration, uint64_t seed,
+              int threads = 1, MctsMode mode = MCTS_TREE_PARALLEL, bool reuse = false, double time_limit = 0.0);
+  // 让正在进行的search尽快结束（可从其他线程调用；下一次search开始时复位）
+  void request_stop() { stop_.store(true, std::memory_order_relaxed); }
+  // 释放整棵树（O(1)）
+  void clear();
+
+  // 根节点访问次数最多的子节点，没有子节点返回-1
+  int best_move() const;
+  // 根节点各子节点的统计（按扩展顺序）
+  void root_children(std::vector<MctsChildStat>& out) const;
+  int root_visits() const;
+  size_t node_count() const { return node_count_; }
+  size_t capacity() const { return capacity_; }
+  int max_depth() const { return max_depth_; }
+  // 本次搜索开始时从上次的树继承的根访问次数（0表示重新建树）
+  int reused_visits() const { return reused_visits_; }
+  MctsSearchStats search_stats() const;
+
+  // PUCT：以root局面（color先走）开始一次搜索，reuse为true时尽量复用上次的PUCT树，返回是否复用
+  bool puct_begin(const SearchBoard& root, int color, bool reuse);
+  // 选出至多max_leaves个待评估叶子，输入写入planes（每个叶子2*n*n个float：走子方棋子、对方棋子），
+  // 返回叶子数。途中遇到的终局节点直接回溯；遇到本批已选中的叶子时提前结束本批
+  int puct_select(int max_leaves, double c_puct, float* planes);
+  // 按puct_select返回的顺序提交评估结果：policies为每个叶子n*n个先验，values为走子方视角的价值[-1,1]
+  void puct_apply(const float* policies, const float* values);
+  int puct_pending() const { return static_cast<int>(pending_.size()); }
+  // 当前树是否为puct_begin建立的PUCT树（UCT搜索或clear之后为false）
+  bool puct_active() const { return puct_ && puct_board_ != nullptr; }
+
+ private:
+  // 状态位：低4位为标志，第4-5位为终局胜方
+  enum : uint8_t { kExpanding = 1, kExpanded = 2, kTerminal = 4, kLeaf = 8 };
+  static constexpr int kWinnerShift = 4;
+  static constexpr int32_t kVirtualLoss = 1;
+  using Clock = std::chrono::steady_clock;
+
+  struct Node {
+    int32_t parent;
+    int32_t first_child;  // 子节点字段在kExpanded发布前写好
+    uint16_t child_count;
+    int16_t move;   // 走入该节点的落子（格子编号），根节点为-1
+    uint8_t mover;  // 走入该节点的一方
+    std::atomic<uint8_t> state;
+    std::atomic<int32_t> visits;     // 含进行中的虚拟损失
+    std::atomic<int32_t> half_wins;  // 累计胜点×2
+  };
+  static_assert(sizeof(Node) == 24, "keep MCTS nodes compact");
+
+  // 线程私有的迭代状态
+  struct Worker {
+    SearchBoard board;
+    FastRng rng;
+    std::vector<int> scratch;
+    int max_depth = 0;
+    MctsSearchStats stats;  // 线程私有，run_tree结束时并入引擎
+    Worker(const SearchBoard& root, uint64_t seed) : board(root), rng(seed) {}
+  };
+
+  // 分配count个连续节点，池不够时返回-1
+  int32_t allocate(int count);
+  void init_node(int32_t index, int32_t parent, int move, int mover);
+  // 抢占并扩展node；返回后可以继续向下选择时返回true
+  bool expand(int32_t node, Worker& worker, bool threat_first);
+  int32_t select_child(int32_t node, double exploration, FastRng& rng) const;
+  // 快速走子到终局（双方都走进攻+防守得分最高的点），返回胜方，走完后撤销全部模拟落子
+  static int rollout(SearchBoard& board, int to_move);
+  void backpropagate(int32_t node, int winner);
+  void iterate(Worker& worker, double exploration);
+  // threads个线程共享本节点池跑完iterations次迭代（或到deadline、收到停止请求）
+  void run_tree(const SearchBoard& root, int iterations, double exploration, uint64_t seed, int threads,
+                Clock::time_point deadline);
+  void run_root_parallel(const SearchBoard& root, int color, int iterations, double exploration, uint64_t seed,
+                         int threads, Clock::time_point deadline);
+  bool should_stop(Clock::time_point deadline) const {
+    return stop_flag_->load(std::memory_order_relaxed) || Clock::now() >= deadline;
+  }
+  // 在上次的树里找到board（color先走）对应的节点，找不到返回-1
+  int32_t find_descendant(const LineBoard& board, int color) const;
+  // 只保留以node为根的子树，整理到节点池开头（子节点下标总是大于父节点，可以原地前移）
+  void promote(int32_t node);
+  void remember_root(const LineBoard& board, int color, bool reusable);
+  int32_t puct_child(int32_t node, double c_puct) const;
+  // PUCT回溯：value为走入index一方视角的价值，逐层取反；同时扣回选择时加的虚拟损失
+  void puct_backpropagate(int32_t index, double value);
+
+  std::unique_ptr<Node[]> nodes_;
+  size_t capacity_ = 0;
+  std::atomic<size_t> used_{0};
+  size_t node_count_ = 0;  // 搜索结束后的节点数（根并行时为各线程之和）
+  int max_depth_ = 0;
+  // 上次搜索的根局面
+  std::vector<uint8_t> root_cells_;
+  int root_size_ = 0;
+  int root_color_ = EMPTY;
+  bool reusable_ = false;
+  int reused_visits_ = 0;
+  // 本次搜索的计数（search/puct_begin时清零；树并行的各线程结束时并入）
+  std::atomic<uint64_t> stat_playouts_{0};
+  std::atomic<uint64_t> stat_expansions_{0};
+  std::atomic<uint64_t> stat_children_{0};
+  void reset_search_stats();
+  void add_search_stats(const MctsSearchStats& stats);
+  // 停止信号：根并行的子引擎指向父引擎的信号
+  std::atomic<bool> stop_{false};
+  const std::atomic<bool>* stop_flag_ = &stop_;
+  // PUCT状态：当前树是否为PUCT树、与节点池平行的先验/累计价值、根局面棋盘和本批待评估叶子
+  bool puct_ = false;
+  std::vector<float> prior_;
+  std::vector<float> value_sum_;
+  std::unique_ptr<SearchBoard> puct_board_;
+  std::vector<int32_t> pending_;
+};
+
+}  // namespace gomoku
@@ -0,0 +1,59 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace gomoku {
+
+const char* const kMetricNames[METRIC_COUNT] = {
+    "movegen_calls", "movegen_ns",  "eval_calls",     "eval_ns",         "win_check_calls",
+    "win_check_ns",  "threat_nodes", "mcts_playouts", "mcts_expansions", "mcts_children",
+    "rollout_plies", "node_allocs"};
+
+std::atomic<bool> g_metrics_timing{true};
+
+namespace {
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<MetricBlock*> blocks;
+  uint64_t retired[METRIC_COUNT] = {};
+};
+
+// 有意泄漏：线程退出（含进程退出时的静态析构之后）仍可能注销
+Registry& registry() {
+  static Registry* instance = new Registry;
+  return *instance;
+}
+
+}  // namespace
+
+MetricSlot::MetricSlot() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.blocks.push_back(&block);
+}
+
+MetricSlot::~MetricSlot() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (int m = 0; m < METRIC_COUNT; ++m) r.retired[m] += block.value[m].load(std::memory_order_relaxed);
+  r.blocks.erase(std::remove(r.blocks.begin(), r.blocks.end(), &block), r.blocks.end());
+}
+
+void metrics_snapshot(uint64_t out[METRIC_COUNT], bool current_thread_only) {
+  if (current_thread_only) {
+    const MetricBlock& block = thread_metrics();
+    for (int m = 0; m < METRIC_COUNT; ++m) out[m] = block.value[m].load(std::memory_order_relaxed);
+    return;
+  }
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (int m = 0; m < METRIC_COUNT; ++m) out[m] = r.retired[m];
+  for (const MetricBlock* block : r.blocks) {
+    for (int m = 0; m < METRIC_COUNT; ++m) out[m] += block->value[m].load(std::memory_order_relaxed);
+  }
+}
+
+}  // namespace gomoku
@@ -0,0 +1,96 @@
+// 搜索计数器（线程私有，读取时汇总）
+//
+// 每个线程第一次计数时在全局登记一块计数器。计数只由所属线程写入（relaxed的load+store，
+// 编译为普通加法，不加锁也不争用缓存行），读取方持锁遍历全部登记块求和；线程退出时计数并入
+// 已退出线程的累计值，总量不丢失。
+//
+// 阶段耗时（*_NS）只在打开计时开关后记录（每次两次steady_clock读取），调用次数总是记录。
+// 阶段嵌套时（如必胜搜索内部生成候选点）耗时只计入最外层阶段，各阶段耗时之和不超过墙钟时间。
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace gomoku {
+
+enum Metric {
+  METRIC_MOVEGEN_CALLS,   // 候选点生成/排序
+  METRIC_MOVEGEN_NS,
+  METRIC_EVAL_CALLS,      // 局面/落子评估（O(1)的增量评分只计次数）
+  METRIC_EVAL_NS,
+  METRIC_WIN_CHECK_CALLS,  // 胜负判断、必胜点与威胁空间搜索
+  METRIC_WIN_CHECK_NS,
+  METRIC_THREAT_NODES,     // 威胁空间搜索节点数
+  METRIC_MCTS_PLAYOUTS,
+  METRIC_MCTS_EXPANSIONS,
+  METRIC_MCTS_CHILDREN,    // 扩展出的子节点数（除以扩展次数即分支因子）
+  METRIC_ROLLOUT_PLIES,
+  METRIC_NODE_ALLOCS,      // 节点池分配的节点数
+  METRIC_COUNT
+};
+
+extern const char* const kMetricNames[METRIC_COUNT];
+
+struct MetricBlock {
+  std::atomic<uint64_t> value[METRIC_COUNT];
+  int phase_depth = 0;  // 当前线程正在计时的阶段嵌套层数（只由所属线程读写）
+  MetricBlock() {
+    for (auto& v : value) v.store(0, std::memory_order_relaxed);
+  }
+};
+
+// 线程退出时注销并把计数并入累计值
+struct MetricSlot {
+  MetricBlock block;
+  MetricSlot();
+  ~MetricSlot();
+};
+
+inline MetricBlock& thread_metrics() {
+  thread_local MetricSlot slot;
+  return slot.block;
+}
+
+inline void metric_add(Metric m, uint64_t n = 1) {
+  std::atomic<uint64_t>& v = thread_metrics().value[m];
+  v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+extern std::atomic<bool> g_metrics_timing;
+
+inline bool metrics_timing() { return g_metrics_timing.load(std::memory_order_relaxed); }
+inline void set_metrics_timing(bool enabled) { g_metrics_timing.store(enabled, std::memory_order_relaxed); }
+
+// 汇总计数：current_thread_only为true时只取调用线程自己的计数
+void metrics_snapshot(uint64_t out[METRIC_COUNT], bool current_thread_only);
+
+// 计一次阶段调用；计时开关打开且不在其他阶段内时累计本阶段耗时
+class ScopedMetric {
+ public:
+  ScopedMetric(Metric calls, Metric ns) : block_(thread_metrics()), ns_(ns) {
+    std::atomic<uint64_t>& v = block_.value[calls];
+    v.store(v.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    timed_ = block_.phase_depth++ == 0 && metrics_timing();
+    if (timed_) start_ = std::chrono::steady_clock::now();
+  }
+  ~ScopedMetric() {
+    --block_.phase_depth;
+    if (!timed_) return;
+    const auto elapsed = std::chrono::steady_clock::now() - start_;
+    std::atomic<uint64_t>& v = block_.value[ns_];
+    v.store(v.load(std::memory_order_relaxed) +
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+            std::memory_order_relaxed);
+  }
+  ScopedMetric(const ScopedMetric&) = delete;
+  ScopedMetric& operator=(const ScopedMetric&) = delete;
+
+ private:
+  MetricBlock& block_;
+  Metric ns_;
+  bool timed_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace gomoku
@@ -0,0 +1,323 @@
+// Python扩展模块入口（CPython C API，无第三方依赖）
+// 对外接口由Compute/cpp_interface.py中的CppCore封装，这里只做参数转换。
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "batch_eval.h"
+#include "core.h"
+#include "metrics.h"
+#include "py_helpers.h"
+#include "py_mcts.h"
+#include "py_search_board.h"
+#include "py_transposition_table.h"
+#include "thread_pool.h"
+#include "threat_solver.h"
+
+namespace {
+
+using namespace gomoku;
+
+// 扫描类接口按棋盘类型模板化：无后缀版本为运行时尺寸，_15/_19后缀为编译期特化版本
+template <class Board>
+PyObject* py_validate_move(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  int x, y, player, board_size;
+  if (!PyArg_ParseTuple(args, "Oiiii", &board_obj, &x, &y, &player, &board_size)) return nullptr;
+  Board board;
+  if (!parse_board(board_obj, board_size, board)) return nullptr;
+  const char* reason = validate_move(board, x, y, player);
+  return Py_BuildValue("(Os)", reason ? Py_False : Py_True, reason ? reason : "success");
+}
+
+template <class Board>
+PyObject* py_check_game_end(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  int board_size;
+  if (!PyArg_ParseTuple(args, "Oi", &board_obj, &board_size)) return nullptr;
+  Board board;
+  if (!parse_board(board_obj, board_size, board)) return nullptr;
+  ScopedMetric metric(METRIC_WIN_CHECK_CALLS, METRIC_WIN_CHECK_NS);
+  return game_end_to_dict(check_game_end(board));
+}
+
+template <class Board>
+PyObject* py_evaluate_board(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  PyObject* weights_obj = nullptr;
+  int color;
+  if (!PyArg_ParseTuple(args, "Oi|O", &board_obj, &color, &weights_obj)) return nullptr;
+  Board board;
+  ShapeWeights weights;
+  if (!parse_board(board_obj, 0, board) || !parse_weights(weights_obj, weights)) return nullptr;
+  ScopedMetric metric(METRIC_EVAL_CALLS, METRIC_EVAL_NS);
+  return PyFloat_FromDouble(evaluate_board(board, color, weights));
+}
+
+// 只读取过(x,y)的四条线（每条最多9格），不转换整张棋盘
+PyObject* py_check_game_end_from(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  int x, y, color, empty_count = -1;
+  if (!PyArg_ParseTuple(args, "Oiii|i", &board_obj, &x, &y, &color, &empty_count)) return nullptr;
+  PyObject* rows = PySequence_Fast(board_obj, "board must be a sequence of rows");
+  if (!rows) return nullptr;
+  const int n = static_cast<int>(PySequence_Fast_GET_SIZE(rows));
+  if (x < 0 || x >= n || y < 0 || y >= n) {
+    Py_DECREF(rows);
+    PyErr_Format(PyExc_ValueError, "invalid position: (%d, %d)", x, y);
+    return nullptr;
+  }
+  uint32_t windows[DIR_COUNT] = {0, 0, 0, 0};
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    for (int k = 0; k < 9; ++k) {
+      const int nx = x + (k - kPad) * kDirDx[d], ny = y + (k - kPad) * kDirDy[d];
+      if (k == kPad || nx < 0 || nx >= n || ny < 0 || ny >= n) continue;
+      PyObject* cell = PySequence_GetItem(PySequence_Fast_GET_ITEM(rows, nx), ny);
+      if (!cell) {
+        Py_DECREF(rows);
+        return nullptr;
+      }
+      if (PyLong_AsLong(cell) == color) windows[d] |= 1u << k;
+      Py_DECREF(cell);
+    }
+  }
+  // 调用方未提供空位计数时退化为全盘计数
+  if (empty_count < 0) {
+    empty_count = 0;
+    for (int i = 0; i < n; ++i) {
+      PyObject* row = PySequence_Fast(PySequence_Fast_GET_ITEM(rows, i), "board row must be a sequence");
+      if (!row) {
+        Py_DECREF(rows);
+        return nullptr;
+      }
+      for (Py_ssize_t j = 0; j < PySequence_Fast_GET_SIZE(row); ++j) {
+        if (PyLong_AsLong(PySequence_Fast_GET_ITEM(row, j)) == EMPTY) ++empty_count;
+      }
+      Py_DECREF(row);
+    }
+  }
+  Py_DECREF(rows);
+  if (PyErr_Occurred()) return nullptr;
+  metric_add(METRIC_WIN_CHECK_CALLS);  // 只看四条线，O(1)，只计次数
+  return game_end_to_dict(check_game_end_from(windows, x, y, color, empty_count));
+}
+
+PyObject* py_place_piece(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  int x, y, color;
+  if (!PyArg_ParseTuple(args, "Oiii", &board_obj, &x, &y, &color)) return nullptr;
+  LineBoard board;
+  if (!parse_board(board_obj, 0, board)) return nullptr;
+  if (!board.in_bounds(x, y) || board.at(x, y) != EMPTY || (color != BLACK && color != WHITE)) {
+    PyErr_Format(PyExc_ValueError, "invalid move: (%d, %d)", x, y);
+    return nullptr;
+  }
+  board.place(x, y, color);
+  return board_to_list(board);
+}
+
+PyObject* py_evaluate_move(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  PyObject* weights_obj = nullptr;
+  int x, y, color;
+  if (!PyArg_ParseTuple(args, "Oiii|O", &board_obj, &x, &y, &color, &weights_obj)) return nullptr;
+  LineBoard board;
+  ShapeWeights weights;
+  if (!parse_board(board_obj, 0, board) || !parse_weights(weights_obj, weights)) return nullptr;
+  if (!board.in_bounds(x, y)) {
+    PyErr_Format(PyExc_ValueError, "invalid position: (%d, %d)", x, y);
+    return nullptr;
+  }
+  ScopedMetric metric(METRIC_EVAL_CALLS, METRIC_EVAL_NS);
+  return PyFloat_FromDouble(evaluate_move(board, x, y, color, weights));
+}
+
+// 返回按行优先排列的float32字节数组（n*n个），由CppCore包装为NumPy数组，避免逐点跨语言调用
+template <class Board>
+PyObject* py_evaluate_moves_batch(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  PyObject* weights_obj = nullptr;
+  int color;
+  if (!PyArg_ParseTuple(args, "Oi|O", &board_obj, &color, &weights_obj)) return nullptr;
+  Board board;
+  ShapeWeights weights;
+  if (!parse_board(board_obj, 0, board) || !parse_weights(weights_obj, weights)) return nullptr;
+  const int n = board.size();
+  PyObject* out = PyByteArray_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(n) * n * sizeof(float));
+  if (!out) return nullptr;
+  float* scores = reinterpret_cast<float*>(PyByteArray_AS_STRING(out));
+  ScopedMetric metric(METRIC_EVAL_CALLS, METRIC_EVAL_NS);
+  Py_BEGIN_ALLOW_THREADS
+  evaluate_moves_batch(board, color, weights, scores);
+  Py_END_ALLOW_THREADS
+  return out;
+}
+
+// 每个线程一个求解器，证明表在多次调用之间复用
+ThreatSolver& thread_solver() {
+  thread_local ThreatSolver solver;
+  return solver;
+}
+
+constexpr int kVcfDepth = 25;
+constexpr int kVctDepth = 11;
+constexpr long kDefaultNodeBudget = 20000;
+
+PyObject* py_thread_pool_size(PyObject*, PyObject*) { return PyLong_FromLong(ThreadPool::shared().size()); }
+
+PyObject* py_find_winning_move(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  int color, board_size;
+  long node_budget = kDefaultNodeBudget;
+  if (!PyArg_ParseTuple(args, "Oii|l", &board_obj, &color, &board_size, &node_budget)) return nullptr;
+  LineBoard board;
+  if (!parse_board(board_obj, board_size, board)) return nullptr;
+  ScopedMetric metric(METRIC_WIN_CHECK_CALLS, METRIC_WIN_CHECK_NS);
+  int x, y;
+  if (find_winning_move(board, color, x, y)) return Py_BuildValue("(ii)", x, y);
+  if (node_budget <= 0) Py_RETURN_NONE;
+  // 直接成五之外，先证VCF（便宜），再证VCT，各自独立预算
+  ThreatResult result;
+  Py_BEGIN_ALLOW_THREADS
+  result = thread_solver().solve(board, color, THREAT_VCF, kVcfDepth, node_budget);
+  if (result.proof != PROOF_WIN) result = thread_solver().solve(board, color, THREAT_VCT, kVctDepth, node_budget);
+  Py_END_ALLOW_THREADS
+  if (result.proof != PROOF_WIN) Py_RETURN_NONE;
+  return Py_BuildValue("(ii)", result.x, result.y);
+}
+
+PyObject* py_solve_threats(PyObject*, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"board", "color", "mode", "max_depth", "node_budget", nullptr};
+  PyObject* board_obj;
+  int color, mode = THREAT_VCT, max_depth = kVctDepth;
+  long node_budget = kDefaultNodeBudget;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|iil", const_cast<char**>(kwlist), &board_obj, &color, &mode,
+                                   &max_depth, &node_budget))
+    return nullptr;
+  if (mode != THREAT_VCF && mode != THREAT_VCT) {
+    PyErr_Format(PyExc_ValueError, "invalid mode: %d", mode);
+    return nullptr;
+  }
+  LineBoard board;
+  if (!parse_board(board_obj, 0, board)) return nullptr;
+  ScopedMetric metric(METRIC_WIN_CHECK_CALLS, METRIC_WIN_CHECK_NS);
+  ThreatResult result;
+  Py_BEGIN_ALLOW_THREADS
+  result = thread_solver().solve(board, color, static_cast<ThreatMode>(mode), max_depth, node_budget);
+  Py_END_ALLOW_THREADS
+  static const char* kProofNames[] = {"FAIL", "WIN", "UNKNOWN"};
+  if (result.proof == PROOF_WIN) {
+    return Py_BuildValue("{s:s,s:(ii),s:i,s:l}", "proof", kProofNames[result.proof], "move", result.x, result.y,
+                         "depth", result.depth, "nodes", result.nodes);
+  }
+  return Py_BuildValue("{s:s,s:O,s:i,s:l}", "proof", kProofNames[result.proof], "move", Py_None, "depth",
+                       result.depth, "nodes", result.nodes);
+}
+
+// 汇总计数器：{名称: 值}，current_thread_only为真时只取调用线程（原生线程池的计数不在其中）
+PyObject* py_metrics_snapshot(PyObject*, PyObject* args) {
+  int current_thread_only = 0;
+  if (!PyArg_ParseTuple(args, "|p", &current_thread_only)) return nullptr;
+  uint64_t values[METRIC_COUNT];
+  metrics_snapshot(values, current_thread_only != 0);
+  PyObject* out = PyDict_New();
+  if (!out) return nullptr;
+  for (int m = 0; m < METRIC_COUNT; ++m) {
+    PyObject* v = PyLong_FromUnsignedLongLong(values[m]);
+    if (!v || PyDict_SetItemString(out, kMetricNames[m], v) < 0) {
+      Py_XDECREF(v);
+      Py_DECREF(out);
+      return nullptr;
+    }
+    Py_DECREF(v);
+  }
+  return out;
+}
+
+PyObject* py_set_metrics_timing(PyObject*, PyObject* args) {
+  int enabled;
+  if (!PyArg_ParseTuple(args, "p", &enabled)) return nullptr;
+  set_metrics_timing(enabled != 0);
+  Py_RETURN_NONE;
+}
+
+PyObject* py_mcts_optimize(PyObject*, PyObject* args) {
+  PyObject* board_obj;
+  PyObject* weights_obj = nullptr;
+  int init_x, init_y, color, depth, iterations;
+  if (!PyArg_ParseTuple(args, "Oiiiii|O", &board_obj, &init_x, &init_y, &color, &depth, &iterations,
+                        &weights_obj))
+    return nullptr;
+  LineBoard board;
+  ShapeWeights weights;
+  if (!parse_board(board_obj, 0, board) || !parse_weights(weights_obj, weights)) return nullptr;
+  int x, y;
+  Py_BEGIN_ALLOW_THREADS
+  mcts_optimize(board, init_x, init_y, color, depth, iterations, weights, x, y);
+  Py_END_ALLOW_THREADS
+  return Py_BuildValue("(ii)", x, y);
+}
+
+PyMethodDef kMethods[] = {
+    {"validate_move", py_validate_move<LineBoard>, METH_VARARGS, "validate_move(board, x, y, player, board_size)"},
+    {"validate_move_15", py_validate_move<LineBoard15>, METH_VARARGS, "validate_move for 15x15 boards"},
+    {"validate_move_19", py_validate_move<LineBoard19>, METH_VARARGS, "validate_move for 19x19 boards"},
+    {"check_game_end", py_check_game_end<LineBoard>, METH_VARARGS, "check_game_end(board, board_size)"},
+    {"check_game_end_15", py_check_game_end<LineBoard15>, METH_VARARGS, "check_game_end for 15x15 boards"},
+    {"check_game_end_19", py_check_game_end<LineBoard19>, METH_VARARGS, "check_game_end for 19x19 boards"},
+    {"evaluate_board", py_evaluate_board<LineBoard>, METH_VARARGS, "evaluate_board(board, color, weights=None)"},
+    {"evaluate_board_15", py_evaluate_board<LineBoard15>, METH_VARARGS, "evaluate_board for 15x15 boards"},
+    {"evaluate_board_19", py_evaluate_board<LineBoard19>, METH_VARARGS, "evaluate_board for 19x19 boards"},
+    {"evaluate_moves_batch", py_evaluate_moves_batch<LineBoard>, METH_VARARGS,
+     "evaluate_moves_batch(board, color, weights=None) -> bytearray of n*n float32 move scores"},
+    {"evaluate_moves_batch_15", py_evaluate_moves_batch<LineBoard15>, METH_VARARGS,
+     "evaluate_moves_batch for 15x15 boards"},
+    {"evaluate_moves_batch_19", py_evaluate_moves_batch<LineBoard19>, METH_VARARGS,
+     "evaluate_moves_batch for 19x19 boards"},
+    {"check_game_end_from", py_check_game_end_from, METH_VARARGS,
+     "check_game_end_from(board, x, y, color, empty_count=-1)"},
+    {"place_piece", py_place_piece, METH_VARARGS, "place_piece(board, x, y, color)"},
+    {"evaluate_move", py_evaluate_move, METH_VARARGS, "evaluate_move(board, x, y, color, weights=None)"},
+    {"find_winning_move", py_find_winning_move, METH_VARARGS,
+     "find_winning_move(board, color, board_size, node_budget=20000): immediate five, then VCF, then VCT"},
+    {"solve_threats", reinterpret_cast<PyCFunction>(py_solve_threats), METH_VARARGS | METH_KEYWORDS,
+     "solve_threats(board, color, mode=THREAT_VCT, max_depth=11, node_budget=20000) -> dict"},
+    {"mcts_optimize", py_mcts_optimize, METH_VARARGS,
+     "mcts_optimize(board, init_x, init_y, color, depth, iterations, weights=None)"},
+    {"thread_pool_size", py_thread_pool_size, METH_NOARGS, "worker threads in the shared native pool"},
+    {"metrics_snapshot", py_metrics_snapshot, METH_VARARGS,
+     "metrics_snapshot(current_thread_only=False) -> dict of search counters summed over threads"},
+    {"set_metrics_timing", py_set_metrics_timing, METH_VARARGS, "set_metrics_timing(enabled): record phase times"},
+    {nullptr, nullptr, 0, nullptr}};
+
+PyModuleDef kModule = {PyModuleDef_HEAD_INIT, "_gomoku_core", "Gomoku bitboard core", -1, kMethods,
+                       nullptr, nullptr, nullptr, nullptr};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit__gomoku_core(void) {
+  PyObject* m = PyModule_Create(&kModule);
+  if (!m) return nullptr;
+  PyModule_AddIntConstant(m, "MAX_BOARD_SIZE", kMaxBoardSize);
+  PyObject* sizes = PyTuple_New(sizeof(kSpecializedSizes) / sizeof(kSpecializedSizes[0]));
+  if (!sizes) {
+    Py_DECREF(m);
+    return nullptr;
+  }
+  for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(sizes); ++i) {
+    PyTuple_SET_ITEM(sizes, i, PyLong_FromLong(kSpecializedSizes[i]));
+  }
+  if (PyModule_AddObject(m, "SPECIALIZED_SIZES", sizes) < 0) {
+    Py_DECREF(sizes);
+    Py_DECREF(m);
+    return nullptr;
+  }
+  PyModule_AddStringConstant(m, "BATCH_KERNEL", batch_kernel_name());
+  PyModule_AddIntConstant(m, "THREAT_VCF", THREAT_VCF);
+  PyModule_AddIntConstant(m, "THREAT_VCT", THREAT_VCT);
+  if (!gomoku::register_search_board(m) || !gomoku::register_transposition_table(m) ||
+      !gomoku::register_mcts_engine(m)) {
+    Py_DECREF(m);
+    return nullptr;
+  }
+  return m;
+}
@@ -0,0 +1,95 @@
+// Python对象与原生结构之间的转换工具（各绑定文件共用）
+#pragma once
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "core.h"
+
+namespace gomoku {
+
+// List[List[int]] -> 棋盘，board_size<=0时按列表长度推断；固定尺寸棋盘要求尺寸一致
+template <class Board>
+inline bool parse_board(PyObject* obj, int board_size, Board& out) {
+  PyObject* rows = PySequence_Fast(obj, "board must be a sequence of rows");
+  if (!rows) return false;
+  const Py_ssize_t n = PySequence_Fast_GET_SIZE(rows);
+  const int size = board_size > 0 ? board_size : static_cast<int>(n);
+  if (size < 5 || size > kMaxBoardSize || n < size || (Board::kFixedSize > 0 && size != Board::kFixedSize)) {
+    Py_DECREF(rows);
+    PyErr_Format(PyExc_ValueError, "unsupported board size: %d", size);
+    return false;
+  }
+  out.reset(size);
+  for (int x = 0; x < size; ++x) {
+    PyObject* row = PySequence_Fast(PySequence_Fast_GET_ITEM(rows, x), "board row must be a sequence");
+    if (!row) {
+      Py_DECREF(rows);
+      return false;
+    }
+    if (PySequence_Fast_GET_SIZE(row) < size) {
+      Py_DECREF(row);
+      Py_DECREF(rows);
+      PyErr_SetString(PyExc_ValueError, "board row is shorter than board size");
+      return false;
+    }
+    for (int y = 0; y < size; ++y) {
+      const long c = PyLong_AsLong(PySequence_Fast_GET_ITEM(row, y));
+      if (c == -1 && PyErr_Occurred()) {
+        Py_DECREF(row);
+        Py_DECREF(rows);
+        return false;
+      }
+      if (c == BLACK || c == WHITE) out.place(x, y, static_cast<int>(c));
+    }
+    Py_DECREF(row);
+  }
+  Py_DECREF(rows);
+  return true;
+}
+
+// EVAL_WEIGHTS字典 -> ShapeWeights（缺省键保留默认值）
+inline bool parse_weights(PyObject* obj, ShapeWeights& out) {
+  if (obj == nullptr || obj == Py_None) return true;
+  if (!PyDict_Check(obj)) {
+    PyErr_SetString(PyExc_TypeError, "weights must be a dict");
+    return false;
+  }
+  for (int s = SHAPE_ONE; s < SHAPE_COUNT; ++s) {
+    PyObject* v = PyDict_GetItemString(obj, kShapeNames[s]);
+    if (!v) continue;
+    const double w = PyFloat_AsDouble(v);
+    if (w == -1.0 && PyErr_Occurred()) return false;
+    out.value[s] = w;
+  }
+  return true;
+}
+
+inline PyObject* board_to_list(const LineBoard& board) {
+  const int n = board.size();
+  PyObject* rows = PyList_New(n);
+  if (!rows) return nullptr;
+  for (int x = 0; x < n; ++x) {
+    PyObject* row = PyList_New(n);
+    if (!row) {
+      Py_DECREF(rows);
+      return nullptr;
+    }
+    for (int y = 0; y < n; ++y) PyList_SET_ITEM(row, y, PyLong_FromLong(board.at(x, y)));
+    PyList_SET_ITEM(rows, x, row);
+  }
+  return rows;
+}
+
+inline PyObject* game_end_to_dict(const GameEnd& end) {
+  PyObject* line = PyList_New(end.win_line_len);
+  if (!line) return nullptr;
+  for (int k = 0; k < end.win_line_len; ++k) {
+    PyList_SET_ITEM(line, k, Py_BuildValue("(ii)", end.win_line[k][0], end.win_line[k][1]));
+  }
+  PyObject* result = Py_BuildValue("{s:O,s:i,s:N}", "is_end", end.is_end ? Py_True : Py_False, "winner",
+                                   end.winner, "win_line", line);
+  return result;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,265 @@
+#include "py_mcts.h"
+
+#include <algorithm>
+#include <new>
+
+#include "py_helpers.h"
+
+namespace gomoku {
+
+namespace {
+
+PyObject* mcts_new(PyTypeObject* type, PyObject*, PyObject*) {
+  PyMctsEngine* self = reinterpret_cast<PyMctsEngine*>(type->tp_alloc(type, 0));
+  if (!self) return nullptr;
+  self->engine = nullptr;
+  self->board_size = 0;
+  return reinterpret_cast<PyObject*>(self);
+}
+
+int mcts_init(PyMctsEngine* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"arena_mb", nullptr};
+  Py_ssize_t arena_mb = 32;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", const_cast<char**>(kwlist), &arena_mb)) return -1;
+  if (arena_mb <= 0) {
+    PyErr_SetString(PyExc_ValueError, "arena_mb must be positive");
+    return -1;
+  }
+  delete self->engine;
+  // 节点固定24字节
+  const size_t nodes = static_cast<size_t>(arena_mb) * (1u << 20) / 24;
+  self->engine = new (std::nothrow) MctsEngine(nodes);
+  if (!self->engine) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  return 0;
+}
+
+void mcts_dealloc(PyMctsEngine* self) {
+  delete self->engine;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+PyObject* cell_to_tuple(int cell, int n) {
+  if (cell < 0 || n <= 0) Py_RETURN_NONE;
+  return Py_BuildValue("(ii)", cell / n, cell % n);
+}
+
+PyObject* mcts_search(PyMctsEngine* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"board", "color",   "iterations", "exploration", "weights",   "seed",
+                                 "threads", "mode", "reuse",      "time_limit",  nullptr};
+  PyObject* board_obj;
+  PyObject* weights_obj = nullptr;
+  int color, iterations;
+  double exploration = 1.414;
+  unsigned long long seed = 0;
+  int threads = 1, mode = MCTS_TREE_PARALLEL, reuse = 0;
+  double time_limit = 0.0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oii|dOKiipd", const_cast<char**>(kwlist), &board_obj, &color,
+                                   &iterations, &exploration, &weights_obj, &seed, &threads, &mode, &reuse,
+                                   &time_limit)) {
+    return nullptr;
+  }
+  if (color != BLACK && color != WHITE) {
+    PyErr_Format(PyExc_ValueError, "invalid color: %d", color);
+    return nullptr;
+  }
+  if (mode != MCTS_TREE_PARALLEL && mode != MCTS_ROOT_PARALLEL) {
+    PyErr_Format(PyExc_ValueError, "invalid mode: %d", mode);
+    return nullptr;
+  }
+  LineBoard board;
+  ShapeWeights weights;
+  if (!parse_board(board_obj, 0, board) || !parse_weights(weights_obj, weights)) return nullptr;
+  SearchBoard* root = new (std::nothrow) SearchBoard();
+  if (!root) return PyErr_NoMemory();
+  root->weights() = weights;
+  root->load(board);
+  Py_BEGIN_ALLOW_THREADS
+  self->engine->search(*root, color, iterations, exploration, seed, threads, static_cast<MctsMode>(mode),
+                       reuse != 0, time_limit);
+  Py_END_ALLOW_THREADS
+  delete root;
+  self->board_size = board.size();
+  return cell_to_tuple(self->engine->best_move(), self->board_size);
+}
+
+PyObject* mcts_root_children(PyMctsEngine* self, PyObject*) {
+  std::vector<MctsChildStat> stats;
+  self->engine->root_children(stats);
+  PyObject* list = PyList_New(static_cast<Py_ssize_t>(stats.size()));
+  if (!list) return nullptr;
+  const int n = self->board_size;
+  for (size_t i = 0; i < stats.size(); ++i) {
+    PyObject* item = Py_BuildValue("(iiid)", stats[i].cell / n, stats[i].cell % n, stats[i].visits, stats[i].value);
+    if (!item) {
+      Py_DECREF(list);
+      return nullptr;
+    }
+    PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+  }
+  return list;
+}
+
+PyObject* mcts_best_move(PyMctsEngine* self, PyObject*) {
+  return cell_to_tuple(self->engine->best_move(), self->board_size);
+}
+
+PyObject* mcts_root_visits(PyMctsEngine* self, PyObject*) { return PyLong_FromLong(self->engine->root_visits()); }
+
+PyObject* mcts_node_count(PyMctsEngine* self, PyObject*) { return PyLong_FromSize_t(self->engine->node_count()); }
+
+PyObject* mcts_capacity(PyMctsEngine* self, PyObject*) { return PyLong_FromSize_t(self->engine->capacity()); }
+
+PyObject* mcts_max_depth(PyMctsEngine* self, PyObject*) { return PyLong_FromLong(self->engine->max_depth()); }
+
+PyObject* mcts_reused_visits(PyMctsEngine* self, PyObject*) {
+  return PyLong_FromLong(self->engine->reused_visits());
+}
+
+PyObject* mcts_search_stats(PyMctsEngine* self, PyObject*) {
+  const MctsSearchStats stats = self->engine->search_stats();
+  return Py_BuildValue("{s:K,s:K,s:K}", "playouts", static_cast<unsigned long long>(stats.playouts), "expansions",
+                       static_cast<unsigned long long>(stats.expansions), "children",
+                       static_cast<unsigned long long>(stats.children));
+}
+
+PyObject* mcts_puct_begin(PyMctsEngine* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"board", "color", "reuse", nullptr};
+  PyObject* board_obj;
+  int color, reuse = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|p", const_cast<char**>(kwlist), &board_obj, &color, &reuse)) {
+    return nullptr;
+  }
+  if (color != BLACK && color != WHITE) {
+    PyErr_Format(PyExc_ValueError, "invalid color: %d", color);
+    return nullptr;
+  }
+  LineBoard board;
+  if (!parse_board(board_obj, 0, board)) return nullptr;
+  SearchBoard* root = new (std::nothrow) SearchBoard();
+  if (!root) return PyErr_NoMemory();
+  root->load(board);
+  bool reused;
+  Py_BEGIN_ALLOW_THREADS
+  reused = self->engine->puct_begin(*root, color, reuse != 0);
+  Py_END_ALLOW_THREADS
+  delete root;
+  self->board_size = board.size();
+  return PyBool_FromLong(reused);
+}
+
+PyObject* mcts_puct_select(PyMctsEngine* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"max_leaves", "c_puct", nullptr};
+  int max_leaves;
+  double c_puct = 1.5;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|d", const_cast<char**>(kwlist), &max_leaves, &c_puct)) {
+    return nullptr;
+  }
+  if (!self->engine->puct_active()) {
+    PyErr_SetString(PyExc_RuntimeError, "puct_begin must be called first");
+    return nullptr;
+  }
+  if (self->engine->puct_pending() > 0) {
+    PyErr_SetString(PyExc_RuntimeError, "previous batch has not been applied");
+    return nullptr;
+  }
+  max_leaves = std::max(max_leaves, 1);
+  const int cells = self->board_size * self->board_size;
+  PyObject* planes = PyByteArray_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(max_leaves) * 2 * cells * sizeof(float));
+  if (!planes) return nullptr;
+  float* out = reinterpret_cast<float*>(PyByteArray_AS_STRING(planes));
+  int count;
+  Py_BEGIN_ALLOW_THREADS
+  count = self->engine->puct_select(max_leaves, c_puct, out);
+  Py_END_ALLOW_THREADS
+  if (PyByteArray_Resize(planes, static_cast<Py_ssize_t>(count) * 2 * cells * sizeof(float)) < 0) {
+    Py_DECREF(planes);
+    return nullptr;
+  }
+  return Py_BuildValue("(iN)", count, planes);
+}
+
+PyObject* mcts_puct_apply(PyMctsEngine* self, PyObject* args) {
+  Py_buffer policies, values;
+  if (!PyArg_ParseTuple(args, "y*y*", &policies, &values)) return nullptr;
+  const Py_ssize_t count = self->engine->puct_pending();
+  const Py_ssize_t cells = static_cast<Py_ssize_t>(self->board_size) * self->board_size;
+  PyObject* result = nullptr;
+  if (policies.len != count * cells * static_cast<Py_ssize_t>(sizeof(float)) ||
+      values.len != count * static_cast<Py_ssize_t>(sizeof(float))) {
+    PyErr_Format(PyExc_ValueError, "expected %zd policies of %zd float32 and %zd float32 values", count, cells, count);
+  } else {
+    Py_BEGIN_ALLOW_THREADS
+    self->engine->puct_apply(static_cast<const float*>(policies.buf), static_cast<const float*>(values.buf));
+    Py_END_ALLOW_THREADS
+    result = Py_None;
+    Py_INCREF(result);
+  }
+  PyBuffer_Release(&policies);
+  PyBuffer_Release(&values);
+  return result;
+}
+
+PyObject* mcts_clear(PyMctsEngine* self, PyObject*) {
+  self->engine->clear();
+  Py_RETURN_NONE;
+}
+
+// search执行期间释放了GIL，其他Python线程可以借此让它提前结束
+PyObject* mcts_stop(PyMctsEngine* self, PyObject*) {
+  self->engine->request_stop();
+  Py_RETURN_NONE;
+}
+
+PyMethodDef kMctsEngineMethods[] = {
+    {"search", reinterpret_cast<PyCFunction>(mcts_search), METH_VARARGS | METH_KEYWORDS,
+     "search(board, color, iterations, exploration=1.414, weights=None, seed=0, threads=1, "
+     "mode=MCTS_TREE_PARALLEL, reuse=False, time_limit=0.0) -> best move or None"},
+    {"root_children", reinterpret_cast<PyCFunction>(mcts_root_children), METH_NOARGS,
+     "root_children() -> [(x, y, visits, value)] in expansion order"},
+    {"best_move", reinterpret_cast<PyCFunction>(mcts_best_move), METH_NOARGS, "most visited root move or None"},
+    {"root_visits", reinterpret_cast<PyCFunction>(mcts_root_visits), METH_NOARGS, "root visit count"},
+    {"node_count", reinterpret_cast<PyCFunction>(mcts_node_count), METH_NOARGS, "nodes allocated in the arena"},
+    {"capacity", reinterpret_cast<PyCFunction>(mcts_capacity), METH_NOARGS, "arena capacity in nodes"},
+    {"max_depth", reinterpret_cast<PyCFunction>(mcts_max_depth), METH_NOARGS, "deepest selection path"},
+    {"reused_visits", reinterpret_cast<PyCFunction>(mcts_reused_visits), METH_NOARGS,
+     "root visits inherited from the previous search (0 for a fresh tree)"},
+    {"search_stats", reinterpret_cast<PyCFunction>(mcts_search_stats), METH_NOARGS,
+     "search_stats() -> {'playouts', 'expansions', 'children'} of this engine's latest search only"},
+    {"puct_begin", reinterpret_cast<PyCFunction>(mcts_puct_begin), METH_VARARGS | METH_KEYWORDS,
+     "puct_begin(board, color, reuse=False) -> whether the previous PUCT tree was reused"},
+    {"puct_select", reinterpret_cast<PyCFunction>(mcts_puct_select), METH_VARARGS | METH_KEYWORDS,
+     "puct_select(max_leaves, c_puct=1.5) -> (count, bytearray of count*2*n*n float32 input planes)"},
+    {"puct_apply", reinterpret_cast<PyCFunction>(mcts_puct_apply), METH_VARARGS,
+     "puct_apply(policies, values): float32 buffers of count*n*n priors and count side-to-move values"},
+    {"clear", reinterpret_cast<PyCFunction>(mcts_clear), METH_NOARGS, "free the whole tree in O(1)"},
+    {"stop", reinterpret_cast<PyCFunction>(mcts_stop), METH_NOARGS,
+     "ask a search running on another thread to finish early"},
+    {nullptr, nullptr, 0, nullptr}};
+
+}  // namespace
+
+PyTypeObject PyMctsEngineType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+bool register_mcts_engine(PyObject* module) {
+  PyMctsEngineType.tp_name = "_gomoku_core.MCTSEngine";
+  PyMctsEngineType.tp_basicsize = sizeof(PyMctsEngine);
+  PyMctsEngineType.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyMctsEngineType.tp_doc = "Arena-allocated UCT search engine (lock-free tree-parallel or root-parallel)";
+  PyMctsEngineType.tp_new = mcts_new;
+  PyMctsEngineType.tp_init = reinterpret_cast<initproc>(mcts_init);
+  PyMctsEngineType.tp_dealloc = reinterpret_cast<destructor>(mcts_dealloc);
+  PyMctsEngineType.tp_methods = kMctsEngineMethods;
+  if (PyType_Ready(&PyMctsEngineType) < 0) return false;
+  Py_INCREF(&PyMctsEngineType);
+  if (PyModule_AddObject(module, "MCTSEngine", reinterpret_cast<PyObject*>(&PyMctsEngineType)) < 0) {
+    Py_DECREF(&PyMctsEngineType);
+    return false;
+  }
+  return PyModule_AddIntConstant(module, "MCTS_TREE_PARALLEL", MCTS_TREE_PARALLEL) == 0 &&
+         PyModule_AddIntConstant(module, "MCTS_ROOT_PARALLEL", MCTS_ROOT_PARALLEL) == 0;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,22 @@
+// MctsEngine的Python类型封装
+#pragma once
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "mcts.h"
+
+namespace gomoku {
+
+struct PyMctsEngine {
+  PyObject_HEAD
+  MctsEngine* engine;
+  int board_size;
+};
+
+extern PyTypeObject PyMctsEngineType;
+
+// 注册到模块，失败返回false
+bool register_mcts_engine(PyObject* module);
+
+}  // namespace gomoku
@@ -0,0 +1,296 @@
+#include "py_search_board.h"
+
+#include <new>
+#include <vector>
+
+#include "py_helpers.h"
+
+namespace gomoku {
+
+namespace {
+
+PyObject* cell_to_tuple(int cell, int n) { return Py_BuildValue("(ii)", cell / n, cell % n); }
+
+PyObject* cells_to_list(const std::vector<int>& cells, int n) {
+  PyObject* list = PyList_New(static_cast<Py_ssize_t>(cells.size()));
+  if (!list) return nullptr;
+  for (size_t i = 0; i < cells.size(); ++i) PyList_SET_ITEM(list, i, cell_to_tuple(cells[i], n));
+  return list;
+}
+
+bool check_cell(const SearchBoard& sb, int x, int y) {
+  if (sb.board().in_bounds(x, y)) return true;
+  PyErr_Format(PyExc_ValueError, "invalid position: (%d, %d)", x, y);
+  return false;
+}
+
+PyObject* sb_new(PyTypeObject* type, PyObject*, PyObject*) {
+  PySearchBoard* self = reinterpret_cast<PySearchBoard*>(type->tp_alloc(type, 0));
+  if (!self) return nullptr;
+  self->board = new (std::nothrow) SearchBoard();
+  if (!self->board) {
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+  return reinterpret_cast<PyObject*>(self);
+}
+
+int sb_init(PySearchBoard* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"board", "weights", nullptr};
+  PyObject* board_obj;
+  PyObject* weights_obj = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(kwlist), &board_obj, &weights_obj))
+    return -1;
+  LineBoard board;
+  ShapeWeights weights;
+  if (!parse_board(board_obj, 0, board) || !parse_weights(weights_obj, weights)) return -1;
+  self->board->weights() = weights;
+  self->board->load(board);
+  return 0;
+}
+
+void sb_dealloc(PySearchBoard* self) {
+  delete self->board;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+PyObject* sb_make_move(PySearchBoard* self, PyObject* args) {
+  int x, y, color;
+  if (!PyArg_ParseTuple(args, "iii", &x, &y, &color)) return nullptr;
+  if (!check_cell(*self->board, x, y)) return nullptr;
+  if (self->board->at(x, y) != EMPTY || (color != BLACK && color != WHITE)) {
+    PyErr_Format(PyExc_ValueError, "invalid move: (%d, %d)", x, y);
+    return nullptr;
+  }
+  return PyBool_FromLong(self->board->make_move(x, y, color));
+}
+
+PyObject* sb_unmake_move(PySearchBoard* self, PyObject*) { return PyBool_FromLong(self->board->unmake_move()); }
+
+PyObject* sb_zobrist_hash(PySearchBoard* self, PyObject*) {
+  return PyLong_FromUnsignedLongLong(self->board->hash());
+}
+
+PyObject* sb_size(PySearchBoard* self, PyObject*) { return PyLong_FromLong(self->board->size()); }
+
+PyObject* sb_move_count(PySearchBoard* self, PyObject*) { return PyLong_FromLong(self->board->move_count()); }
+
+PyObject* sb_empty_count(PySearchBoard* self, PyObject*) { return PyLong_FromLong(self->board->empty_count()); }
+
+PyObject* sb_last_move(PySearchBoard* self, PyObject*) {
+  const int cell = self->board->last_move();
+  if (cell < 0) Py_RETURN_NONE;
+  return cell_to_tuple(cell, self->board->size());
+}
+
+PyObject* sb_moves(PySearchBoard* self, PyObject*) {
+  std::vector<int> cells;
+  for (int i = 0; i < self->board->move_count(); ++i) cells.push_back(self->board->move_at(i));
+  return cells_to_list(cells, self->board->size());
+}
+
+PyObject* sb_at(PySearchBoard* self, PyObject* args) {
+  int x, y;
+  if (!PyArg_ParseTuple(args, "ii", &x, &y)) return nullptr;
+  if (!check_cell(*self->board, x, y)) return nullptr;
+  return PyLong_FromLong(self->board->at(x, y));
+}
+
+PyObject* sb_pattern_counts(PySearchBoard* self, PyObject* args) {
+  int color;
+  if (!PyArg_ParseTuple(args, "i", &color)) return nullptr;
+  if (color != BLACK && color != WHITE) {
+    PyErr_SetString(PyExc_ValueError, "color must be BLACK or WHITE");
+    return nullptr;
+  }
+  PyObject* result = PyDict_New();
+  if (!result) return nullptr;
+  for (int s = SHAPE_ONE; s < SHAPE_COUNT; ++s) {
+    PyObject* v = PyLong_FromLong(self->board->pattern_count(color, s));
+    if (!v || PyDict_SetItemString(result, kShapeNames[s], v) < 0) {
+      Py_XDECREF(v);
+      Py_DECREF(result);
+      return nullptr;
+    }
+    Py_DECREF(v);
+  }
+  return result;
+}
+
+PyObject* sb_evaluate(PySearchBoard* self, PyObject* args) {
+  int color;
+  if (!PyArg_ParseTuple(args, "i", &color)) return nullptr;
+  return PyFloat_FromDouble(self->board->evaluate(color));
+}
+
+PyObject* sb_evaluate_move(PySearchBoard* self, PyObject* args) {
+  int x, y, color;
+  if (!PyArg_ParseTuple(args, "iii", &x, &y, &color)) return nullptr;
+  if (!check_cell(*self->board, x, y)) return nullptr;
+  return PyFloat_FromDouble(self->board->move_score(x, y, color));
+}
+
+PyObject* sb_evaluate_delta(PySearchBoard* self, PyObject* args) {
+  int x, y, color;
+  if (!PyArg_ParseTuple(args, "iii", &x, &y, &color)) return nullptr;
+  if (!check_cell(*self->board, x, y)) return nullptr;
+  if (self->board->at(x, y) != EMPTY || (color != BLACK && color != WHITE)) {
+    PyErr_Format(PyExc_ValueError, "invalid move: (%d, %d)", x, y);
+    return nullptr;
+  }
+  return PyFloat_FromDouble(self->board->evaluate_delta(x, y, color));
+}
+
+PyObject* sb_sorted_moves(PySearchBoard* self, PyObject* args) {
+  int color, limit = 0;
+  if (!PyArg_ParseTuple(args, "i|i", &color, &limit)) return nullptr;
+  std::vector<int> cells;
+  self->board->sorted_moves(color, limit, cells);
+  return cells_to_list(cells, self->board->size());
+}
+
+PyObject* sb_candidates(PySearchBoard* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"color", "threat_first", nullptr};
+  int color, threat_first = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|p", const_cast<char**>(kwlist), &color, &threat_first))
+    return nullptr;
+  std::vector<int> cells;
+  self->board->candidates(color, threat_first != 0, cells);
+  return cells_to_list(cells, self->board->size());
+}
+
+PyObject* sb_best_shape(PySearchBoard* self, PyObject* args) {
+  int x, y, color;
+  if (!PyArg_ParseTuple(args, "iii", &x, &y, &color)) return nullptr;
+  if (!check_cell(*self->board, x, y)) return nullptr;
+  if (color != BLACK && color != WHITE) {
+    PyErr_SetString(PyExc_ValueError, "color must be BLACK or WHITE");
+    return nullptr;
+  }
+  Shape best = SHAPE_NONE;
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    const Shape s = shape_at(self->board->board(), x, y, color, d);
+    if (s > best) best = s;
+  }
+  return PyUnicode_FromString(kShapeNames[best]);
+}
+
+PyObject* sb_scan_candidates(PySearchBoard* self, PyObject* args) {
+  int color;
+  if (!PyArg_ParseTuple(args, "i", &color)) return nullptr;
+  if (color != BLACK && color != WHITE) {
+    PyErr_SetString(PyExc_ValueError, "color must be BLACK or WHITE");
+    return nullptr;
+  }
+  struct Scan {
+    int cell;
+    double delta;
+    double score;
+    Shape shape;
+  };
+  SearchBoard& sb = *self->board;
+  const int n = sb.size();
+  std::vector<int> cells;
+  std::vector<Scan> scans;
+  // 逐点make/unmake只动本对象，计算期间释放GIL，多个线程可各自扫描自己的棋盘
+  Py_BEGIN_ALLOW_THREADS
+  sb.candidates(color, true, cells);
+  scans.reserve(cells.size());
+  for (int cell : cells) {
+    const int x = cell / n, y = cell % n;
+    Shape best = SHAPE_NONE;
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      const Shape s = shape_at(sb.board(), x, y, color, d);
+      if (s > best) best = s;
+    }
+    scans.push_back({cell, sb.evaluate_delta(x, y, color), sb.move_score(x, y, color), best});
+  }
+  Py_END_ALLOW_THREADS
+  PyObject* list = PyList_New(static_cast<Py_ssize_t>(scans.size()));
+  if (!list) return nullptr;
+  for (size_t i = 0; i < scans.size(); ++i) {
+    const Scan& scan = scans[i];
+    PyObject* item = Py_BuildValue("(iidds)", scan.cell / n, scan.cell % n, scan.delta, scan.score, kShapeNames[scan.shape]);
+    if (!item) {
+      Py_DECREF(list);
+      return nullptr;
+    }
+    PyList_SET_ITEM(list, i, item);
+  }
+  return list;
+}
+
+PyObject* sb_empty_positions(PySearchBoard* self, PyObject*) {
+  const SearchBoard& sb = *self->board;
+  const int n = sb.size();
+  std::vector<int> cells;
+  for (int i = 0; i < n * n; ++i) {
+    if (sb.at(i / n, i % n) == EMPTY) cells.push_back(i);
+  }
+  return cells_to_list(cells, n);
+}
+
+PyObject* sb_to_list(PySearchBoard* self, PyObject*) { return board_to_list(self->board->board()); }
+
+PyMethodDef kSearchBoardMethods[] = {
+    {"make_move", reinterpret_cast<PyCFunction>(sb_make_move), METH_VARARGS,
+     "make_move(x, y, color) -> bool, returns whether the move makes five"},
+    {"unmake_move", reinterpret_cast<PyCFunction>(sb_unmake_move), METH_NOARGS, "undo the last move"},
+    {"zobrist_hash", reinterpret_cast<PyCFunction>(sb_zobrist_hash), METH_NOARGS, "64-bit Zobrist hash"},
+    {"size", reinterpret_cast<PyCFunction>(sb_size), METH_NOARGS, "board size"},
+    {"move_count", reinterpret_cast<PyCFunction>(sb_move_count), METH_NOARGS, "moves on the stack"},
+    {"empty_count", reinterpret_cast<PyCFunction>(sb_empty_count), METH_NOARGS, "remaining empty cells"},
+    {"last_move", reinterpret_cast<PyCFunction>(sb_last_move), METH_NOARGS, "last move or None"},
+    {"moves", reinterpret_cast<PyCFunction>(sb_moves), METH_NOARGS, "move stack"},
+    {"at", reinterpret_cast<PyCFunction>(sb_at), METH_VARARGS, "at(x, y) -> color"},
+    {"pattern_counts", reinterpret_cast<PyCFunction>(sb_pattern_counts), METH_VARARGS,
+     "pattern_counts(color) -> {shape: count}"},
+    {"evaluate", reinterpret_cast<PyCFunction>(sb_evaluate), METH_VARARGS, "evaluate(color) -> float"},
+    {"evaluate_move", reinterpret_cast<PyCFunction>(sb_evaluate_move), METH_VARARGS,
+     "evaluate_move(x, y, color) -> float"},
+    {"evaluate_delta", reinterpret_cast<PyCFunction>(sb_evaluate_delta), METH_VARARGS,
+     "evaluate_delta(x, y, color) -> change of evaluate(color) if color plays (x, y)"},
+    {"sorted_moves", reinterpret_cast<PyCFunction>(sb_sorted_moves), METH_VARARGS,
+     "sorted_moves(color, limit=0) -> [(x, y)]"},
+    {"candidates", reinterpret_cast<PyCFunction>(sb_candidates), METH_VARARGS | METH_KEYWORDS,
+     "candidates(color, threat_first=False) -> [(x, y)] within distance 2 of stones"},
+    {"best_shape", reinterpret_cast<PyCFunction>(sb_best_shape), METH_VARARGS,
+     "best_shape(x, y, color) -> strongest shape name over the four directions"},
+    {"scan_candidates", reinterpret_cast<PyCFunction>(sb_scan_candidates), METH_VARARGS,
+     "scan_candidates(color) -> [(x, y, evaluate_delta, evaluate_move, best_shape)] over candidates(color, True), "
+     "GIL released"},
+    {"empty_positions", reinterpret_cast<PyCFunction>(sb_empty_positions), METH_NOARGS, "all empty cells"},
+    {"to_list", reinterpret_cast<PyCFunction>(sb_to_list), METH_NOARGS, "board as List[List[int]]"},
+    {nullptr, nullptr, 0, nullptr}};
+
+}  // namespace
+
+PyTypeObject PySearchBoardType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+bool register_search_board(PyObject* module) {
+  PySearchBoardType.tp_name = "_gomoku_core.SearchBoard";
+  PySearchBoardType.tp_basicsize = sizeof(PySearchBoard);
+  PySearchBoardType.tp_flags = Py_TPFLAGS_DEFAULT;
+  PySearchBoardType.tp_doc = "Stateful search board with in-place make/unmake";
+  PySearchBoardType.tp_new = sb_new;
+  PySearchBoardType.tp_init = reinterpret_cast<initproc>(sb_init);
+  PySearchBoardType.tp_dealloc = reinterpret_cast<destructor>(sb_dealloc);
+  PySearchBoardType.tp_methods = kSearchBoardMethods;
+  if (PyType_Ready(&PySearchBoardType) < 0) return false;
+  Py_INCREF(&PySearchBoardType);
+  if (PyModule_AddObject(module, "SearchBoard", reinterpret_cast<PyObject*>(&PySearchBoardType)) < 0) {
+    Py_DECREF(&PySearchBoardType);
+    return false;
+  }
+  return true;
+}
+
+SearchBoard* unwrap_search_board(PyObject* obj) {
+  if (!PyObject_TypeCheck(obj, &PySearchBoardType)) {
+    PyErr_SetString(PyExc_TypeError, "expected a native SearchBoard");
+    return nullptr;
+  }
+  return reinterpret_cast<PySearchBoard*>(obj)->board;
+}
+
+}  // namespace gomoku
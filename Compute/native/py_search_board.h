@@ -0,0 +1,24 @@
+// SearchBoard的Python类型封装
+#pragma once
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "search_board.h"
+
+namespace gomoku {
+
+struct PySearchBoard {
+  PyObject_HEAD
+  SearchBoard* board;
+};
+
+extern PyTypeObject PySearchBoardType;
+
+// 注册到模块，失败返回false
+bool register_search_board(PyObject* module);
+
+// 从Python对象取出SearchBoard，类型不符时设置TypeError并返回nullptr
+SearchBoard* unwrap_search_board(PyObject* obj);
+
+}  // namespace gomoku
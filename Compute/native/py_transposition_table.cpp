@@ -0,0 +1,133 @@
+#include "py_transposition_table.h"
+
+#include <new>
+
+namespace gomoku {
+
+namespace {
+
+PyObject* tt_new(PyTypeObject* type, PyObject*, PyObject*) {
+  PyTranspositionTable* self = reinterpret_cast<PyTranspositionTable*>(type->tp_alloc(type, 0));
+  if (!self) return nullptr;
+  self->table = nullptr;
+  return reinterpret_cast<PyObject*>(self);
+}
+
+int tt_init(PyTranspositionTable* self, PyObject* args, PyObject* kwargs) {
+  static const char* kwlist[] = {"size_mb", nullptr};
+  Py_ssize_t size_mb = 64;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", const_cast<char**>(kwlist), &size_mb)) return -1;
+  if (size_mb <= 0) {
+    PyErr_SetString(PyExc_ValueError, "size_mb must be positive");
+    return -1;
+  }
+  delete self->table;
+  self->table = new (std::nothrow) TranspositionTable(static_cast<size_t>(size_mb));
+  if (!self->table) {
+    PyErr_NoMemory();
+    return -1;
+  }
+  return 0;
+}
+
+void tt_dealloc(PyTranspositionTable* self) {
+  delete self->table;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+bool parse_hash(PyObject* obj, uint64_t& hash) {
+  hash = PyLong_AsUnsignedLongLongMask(obj);
+  return !PyErr_Occurred();
+}
+
+PyObject* tt_probe(PyTranspositionTable* self, PyObject* arg) {
+  uint64_t hash;
+  if (!parse_hash(arg, hash)) return nullptr;
+  TTEntry entry;
+  if (!self->table->probe(hash, entry)) Py_RETURN_NONE;
+  if (entry.move == kNoMove) {
+    return Py_BuildValue("(iidO)", entry.depth, static_cast<int>(entry.bound), static_cast<double>(entry.score),
+                         Py_None);
+  }
+  return Py_BuildValue("(iid(ii))", entry.depth, static_cast<int>(entry.bound), static_cast<double>(entry.score),
+                       move_x(entry.move), move_y(entry.move));
+}
+
+PyObject* tt_store(PyTranspositionTable* self, PyObject* args) {
+  PyObject* hash_obj;
+  int depth, bound;
+  double score;
+  PyObject* move_obj = Py_None;
+  if (!PyArg_ParseTuple(args, "Oiid|O", &hash_obj, &depth, &bound, &score, &move_obj)) return nullptr;
+  uint64_t hash;
+  if (!parse_hash(hash_obj, hash)) return nullptr;
+  if (bound < BOUND_EXACT || bound > BOUND_UPPER) {
+    PyErr_Format(PyExc_ValueError, "invalid bound: %d", bound);
+    return nullptr;
+  }
+  int move = kNoMove;
+  if (move_obj != Py_None) {
+    int x, y;
+    if (!PyArg_ParseTuple(move_obj, "ii", &x, &y)) return nullptr;
+    if (x < 0 || x >= 32 || y < 0 || y >= 32) {
+      PyErr_Format(PyExc_ValueError, "invalid position: (%d, %d)", x, y);
+      return nullptr;
+    }
+    move = pack_move(x, y);
+  }
+  self->table->store(hash, depth, static_cast<Bound>(bound), static_cast<float>(score), move);
+  Py_RETURN_NONE;
+}
+
+PyObject* tt_new_search(PyTranspositionTable* self, PyObject*) {
+  self->table->new_search();
+  Py_RETURN_NONE;
+}
+
+PyObject* tt_clear(PyTranspositionTable* self, PyObject*) {
+  self->table->clear();
+  Py_RETURN_NONE;
+}
+
+PyObject* tt_hashfull(PyTranspositionTable* self, PyObject*) { return PyLong_FromLong(self->table->hashfull()); }
+
+PyObject* tt_size_mb(PyTranspositionTable* self, PyObject*) {
+  return PyLong_FromSize_t(self->table->size_mb());
+}
+
+PyMethodDef kTranspositionTableMethods[] = {
+    {"probe", reinterpret_cast<PyCFunction>(tt_probe), METH_O,
+     "probe(hash) -> (depth, bound, score, move) or None"},
+    {"store", reinterpret_cast<PyCFunction>(tt_store), METH_VARARGS,
+     "store(hash, depth, bound, score, move=None)"},
+    {"new_search", reinterpret_cast<PyCFunction>(tt_new_search), METH_NOARGS, "advance the entry age"},
+    {"clear", reinterpret_cast<PyCFunction>(tt_clear), METH_NOARGS, "drop all entries"},
+    {"hashfull", reinterpret_cast<PyCFunction>(tt_hashfull), METH_NOARGS, "current-age occupancy in permille"},
+    {"size_mb", reinterpret_cast<PyCFunction>(tt_size_mb), METH_NOARGS, "allocated size in MB"},
+    {nullptr, nullptr, 0, nullptr}};
+
+}  // namespace
+
+PyTypeObject PyTranspositionTableType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+bool register_transposition_table(PyObject* module) {
+  PyTranspositionTableType.tp_name = "_gomoku_core.TranspositionTable";
+  PyTranspositionTableType.tp_basicsize = sizeof(PyTranspositionTable);
+  PyTranspositionTableType.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyTranspositionTableType.tp_doc = "Fixed-size lock-free Zobrist transposition table";
+  PyTranspositionTableType.tp_new = tt_new;
+  PyTranspositionTableType.tp_init = reinterpret_cast<initproc>(tt_init);
+  PyTranspositionTableType.tp_dealloc = reinterpret_cast<destructor>(tt_dealloc);
+  PyTranspositionTableType.tp_methods = kTranspositionTableMethods;
+  if (PyType_Ready(&PyTranspositionTableType) < 0) return false;
+  Py_INCREF(&PyTranspositionTableType);
+  if (PyModule_AddObject(module, "TranspositionTable", reinterpret_cast<PyObject*>(&PyTranspositionTableType)) < 0) {
+    Py_DECREF(&PyTranspositionTableType);
+    return false;
+  }
+  return PyModule_AddIntConstant(module, "BOUND_EXACT", BOUND_EXACT) == 0 &&
+         PyModule_AddIntConstant(module, "BOUND_LOWER", BOUND_LOWER) == 0 &&
+         PyModule_AddIntConstant(module, "BOUND_UPPER", BOUND_UPPER) == 0;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,21 @@
+// TranspositionTable的Python类型封装
+#pragma once
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "transposition_table.h"
+
+namespace gomoku {
+
+struct PyTranspositionTable {
+  PyObject_HEAD
+  TranspositionTable* table;
+};
+
+extern PyTypeObject PyTranspositionTableType;
+
+// 注册到模块（含BOUND_*常量），失败返回false
+bool register_transposition_table(PyObject* module);
+
+}  // namespace gomoku
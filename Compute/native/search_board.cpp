@@ -0,0 +1,252 @@
+#include "search_board.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "metrics.h"
+
+namespace gomoku {
+
+void SearchBoard::reset(int size) {
+  board_.reset(size);
+  hash_ = 0;
+  move_count_ = 0;
+  std::memset(shapes_, 0, sizeof(shapes_));
+  std::memset(counts_, 0, sizeof(counts_));
+  std::memset(line_scores_, 0, sizeof(line_scores_));
+  scores_[BLACK] = scores_[WHITE] = 0.0;
+  std::memset(near_, 0, sizeof(near_));
+  std::memset(candidate_index_, -1, sizeof(candidate_index_));
+  candidate_count_ = 0;
+}
+
+void SearchBoard::load(const LineBoard& board) {
+  reset(board.size());
+  const int n = board.size();
+  const Zobrist& zobrist = Zobrist::instance();
+  for (int x = 0; x < n; ++x) {
+    for (int y = 0; y < n; ++y) {
+      const int c = board.at(x, y);
+      if (c == EMPTY) continue;
+      board_.place(x, y, c);
+      hash_ ^= zobrist.key(c, x * n + y);
+    }
+  }
+  for (int x = 0; x < n; ++x) {
+    for (int y = 0; y < n; ++y) {
+      const int c = board_.at(x, y);
+      if (c == EMPTY) continue;
+      for (int d = 0; d < DIR_COUNT; ++d) refresh_cell(x * n + y, d, shape_at(board_, x, y, c, d));
+      touch_neighbors(x, y, 1);
+    }
+  }
+}
+
+bool SearchBoard::make_move(int x, int y, int color) {
+  const int cell = x * size() + y;
+  board_.place(x, y, color);
+  hash_ ^= Zobrist::instance().key(color, cell);
+  moves_[move_count_++] = cell;
+  remove_candidate(cell);
+  touch_neighbors(x, y, 1);
+  refresh_around(x, y);
+  return board_.five_through(x, y, color);
+}
+
+bool SearchBoard::unmake_move() {
+  if (move_count_ == 0) return false;
+  const int cell = moves_[--move_count_];
+  const int x = cell / size(), y = cell % size();
+  const int color = board_.at(x, y);
+  hash_ ^= Zobrist::instance().key(color, cell);
+  // 先清掉被提棋子自身的棋型，再重算周边
+  for (int d = 0; d < DIR_COUNT; ++d) refresh_cell(cell, d, SHAPE_NONE, color);
+  board_.remove(x, y);
+  touch_neighbors(x, y, -1);
+  if (near_[cell] > 0) add_candidate(cell);
+  refresh_around(x, y);
+  return true;
+}
+
+void SearchBoard::touch_neighbors(int x, int y, int delta) {
+  const int n = size();
+  for (int nx = std::max(x - 2, 0); nx <= std::min(x + 2, n - 1); ++nx) {
+    for (int ny = std::max(y - 2, 0); ny <= std::min(y + 2, n - 1); ++ny) {
+      const int cell = nx * n + ny;
+      near_[cell] = static_cast<uint8_t>(near_[cell] + delta);
+      if (board_.at(nx, ny) != EMPTY) continue;
+      if (near_[cell] > 0) {
+        add_candidate(cell);
+      } else {
+        remove_candidate(cell);
+      }
+    }
+  }
+}
+
+void SearchBoard::add_candidate(int cell) {
+  if (candidate_index_[cell] >= 0) return;
+  candidate_index_[cell] = static_cast<int16_t>(candidate_count_);
+  candidates_[candidate_count_++] = static_cast<int16_t>(cell);
+}
+
+void SearchBoard::remove_candidate(int cell) {
+  const int index = candidate_index_[cell];
+  if (index < 0) return;
+  // 与末尾交换后删除
+  const int last = candidates_[--candidate_count_];
+  candidates_[index] = static_cast<int16_t>(last);
+  candidate_index_[last] = static_cast<int16_t>(index);
+  candidate_index_[cell] = -1;
+}
+
+void SearchBoard::refresh_cell(int cell, int d, Shape s) {
+  refresh_cell(cell, d, s, board_.at(cell / size(), cell % size()));
+}
+
+void SearchBoard::refresh_cell(int cell, int d, Shape s, int color) {
+  const Shape old = static_cast<Shape>(shapes_[cell][d]);
+  if (old == s) return;
+  if (old != SHAPE_NONE) counts_[color][old] -= 1;
+  if (s != SHAPE_NONE) counts_[color][s] += 1;
+  shapes_[cell][d] = s;
+  // 同步该棋子所在线的得分与总分
+  const double delta = weights_.value[s] - weights_.value[old];
+  line_scores_[color][d][board_.line_index(d, cell / size(), cell % size())] += delta;
+  scores_[color] += delta;
+}
+
+void SearchBoard::refresh_around(int x, int y) {
+  const int n = size();
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    for (int k = -kPad; k <= kPad; ++k) {
+      const int nx = x + k * kDirDx[d], ny = y + k * kDirDy[d];
+      if (!board_.in_bounds(nx, ny)) continue;
+      const int c = board_.at(nx, ny);
+      refresh_cell(nx * n + ny, d, c == EMPTY ? SHAPE_NONE : shape_at(board_, nx, ny, c, d));
+    }
+  }
+}
+
+double SearchBoard::evaluate(int color) const {
+  metric_add(METRIC_EVAL_CALLS);
+  return scores_[color] - scores_[opponent(color)];
+}
+
+double SearchBoard::evaluate_delta(int x, int y, int color) {
+  ScopedMetric metric(METRIC_EVAL_CALLS, METRIC_EVAL_NS);
+  // 落子只改变过(x,y)四条线上±4格内的棋型，make/unmake各查表36次
+  const double before = evaluate(color);
+  make_move(x, y, color);
+  const double after = evaluate(color);
+  unmake_move();
+  return after - before;
+}
+
+double SearchBoard::move_score(int x, int y, int color) const {
+  double score = 0.0;
+  for (int d = 0; d < DIR_COUNT; ++d) score += weights_.value[shape_at(board_, x, y, color, d)];
+  return score;
+}
+
+void SearchBoard::sorted_moves(int color, int limit, std::vector<int>& out) const {
+  ScopedMetric metric(METRIC_MOVEGEN_CALLS, METRIC_MOVEGEN_NS);
+  const int n = size();
+  const int opp = opponent(color);
+  const int center = n / 2;
+  std::vector<int> cells;
+  candidate_cells(cells);
+  std::vector<std::pair<double, int>> scored;
+  scored.reserve(cells.size());
+  for (int cell : cells) {
+    const int x = cell / n, y = cell % n;
+    // 得分相同时靠近天元优先
+    const double center_bias = -0.01 * (std::abs(x - center) + std::abs(y - center));
+    scored.emplace_back(move_score(x, y, color) + move_score(x, y, opp) + center_bias, cell);
+  }
+  const size_t keep = limit > 0 ? std::min(scored.size(), static_cast<size_t>(limit)) : scored.size();
+  std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                    [](const std::pair<double, int>& a, const std::pair<double, int>& b) { return a.first > b.first; });
+  out.clear();
+  for (size_t i = 0; i < keep; ++i) out.push_back(scored[i].second);
+}
+
+int SearchBoard::best_move(int color) const {
+  const int n = size();
+  if (candidate_count_ == 0) return empty_count() == n * n ? (n / 2) * n + n / 2 : -1;
+  const int opp = opponent(color);
+  const int center = n / 2;
+  int best = -1;
+  double best_score = 0.0;
+  for (int i = 0; i < candidate_count_; ++i) {
+    const int cell = candidates_[i];
+    const int x = cell / n, y = cell % n;
+    const double score = move_score(x, y, color) + move_score(x, y, opp) -
+                         0.01 * (std::abs(x - center) + std::abs(y - center));
+    // 同分取编号小的格子，保证结果确定
+    if (best < 0 || score > best_score || (score == best_score && cell < best)) {
+      best = cell;
+      best_score = score;
+    }
+  }
+  return best;
+}
+
+int SearchBoard::threat_rank(int cell, int color) const {
+  const int n = size();
+  const int opp = opponent(color);
+  const int x = cell / n, y = cell % n;
+  int best = 3;
+  for (int d = 0; d < DIR_COUNT; ++d) {
+    if (five_runs(board_.window(color, d, x, y) | kCenterBit)) return 0;
+    const uint32_t opp_own = board_.window(opp, d, x, y);
+    if (five_runs(opp_own | kCenterBit)) {
+      best = 1;
+    } else if (best > 2 && popcount32(opp_own) >= 3 &&
+               lookup_shape(opp_own | kCenterBit, board_.window(EMPTY, d, x, y) & ~kCenterBit) == SHAPE_FOUR) {
+      best = 2;
+    }
+  }
+  return best;
+}
+
+void SearchBoard::forced_moves(int color, std::vector<int>& out) const {
+  ScopedMetric metric(METRIC_MOVEGEN_CALLS, METRIC_MOVEGEN_NS);
+  out.clear();
+  int best = 1;
+  for (int i = 0; i < candidate_count_; ++i) {
+    const int rank = threat_rank(candidates_[i], color);
+    if (rank > best) continue;
+    if (rank < best) out.clear();
+    best = rank;
+    out.push_back(candidates_[i]);
+  }
+  std::sort(out.begin(), out.end());
+}
+
+void SearchBoard::candidate_cells(std::vector<int>& out) const {
+  const int n = size();
+  out.clear();
+  if (candidate_count_ == 0) {
+    if (empty_count() == n * n) out.push_back((n / 2) * n + n / 2);
+    return;
+  }
+  out.assign(candidates_, candidates_ + candidate_count_);
+  std::sort(out.begin(), out.end());
+}
+
+void SearchBoard::candidates(int color, bool threat_first, std::vector<int>& out) const {
+  ScopedMetric metric(METRIC_MOVEGEN_CALLS, METRIC_MOVEGEN_NS);
+  candidate_cells(out);
+  if (!threat_first || out.size() <= 1) return;
+  std::vector<std::pair<int, int>> ranked;
+  ranked.reserve(out.size());
+  for (int cell : out) ranked.emplace_back(threat_rank(cell, color), cell);
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; });
+  for (size_t i = 0; i < ranked.size(); ++i) out[i] = ranked[i].second;
+}
+
+}  // namespace gomoku
@@ -0,0 +1,97 @@
+// 搜索用有状态棋盘（原地make/unmake，不做任何堆分配）
+//
+// 在LineBoard之上增量维护：
+//   - Zobrist哈希
+//   - 落子栈
+//   - 每颗棋子在四个方向上的棋型（9格窗口查表），以及各颜色的棋型计数、每条线的得分和总分
+//   - 候选点集合：距离已有棋子2格以内（5x5邻域）的空位
+// 落子/提子只会影响过该点四条线上±4格内棋子的棋型，因此每步最多重算36个窗口；
+// 候选点集合靠每格的邻居计数维护，每步更新25格。
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "line_board.h"
+#include "shape.h"
+#include "zobrist.h"
+
+namespace gomoku {
+
+class SearchBoard {
+ public:
+  explicit SearchBoard(int size = 15) { reset(size); }
+
+  void reset(int size);
+  // 从普通棋盘加载（清空落子栈，已有棋子不入栈）
+  void load(const LineBoard& board);
+
+  const LineBoard& board() const { return board_; }
+  int size() const { return board_.size(); }
+  int at(int x, int y) const { return board_.at(x, y); }
+  int empty_count() const { return board_.empty_count(); }
+
+  // 落子，返回该步是否成五
+  bool make_move(int x, int y, int color);
+  // 撤销最后一步，栈空时返回false
+  bool unmake_move();
+
+  uint64_t hash() const { return hash_; }
+  int move_count() const { return move_count_; }
+  int move_at(int i) const { return moves_[i]; }
+  int last_move() const { return move_count_ > 0 ? moves_[move_count_ - 1] : -1; }
+
+  ShapeWeights& weights() { return weights_; }
+  const ShapeWeights& weights() const { return weights_; }
+
+  int pattern_count(int color, int shape) const { return counts_[color][shape]; }
+  Shape shape_of(int x, int y, int d) const { return static_cast<Shape>(shapes_[x * size() + y][d]); }
+
+  // 局面静态评分（color视角，己方总分-对方总分，O(1)）
+  double evaluate(int color) const;
+  // color在(x,y)落子带来的局面评分变化（只重算四条线上受影响的窗口）
+  double evaluate_delta(int x, int y, int color);
+  // 方向d第index条线上color棋子的棋型得分之和
+  double line_score(int color, int d, int index) const { return line_scores_[color][d][index]; }
+  // (x,y)落color后四个方向的棋型得分之和
+  double move_score(int x, int y, int color) const;
+  // 按进攻+防守得分降序返回候选点（limit<=0表示全部）
+  void sorted_moves(int color, int limit, std::vector<int>& out) const;
+  // sorted_moves(color, 1)的无分配版本（rollout走子用），没有候选点返回-1
+  int best_move(int color) const;
+  // 候选点（按格子编号升序；空棋盘返回天元）。threat_first为true时把color的应手排在最前：
+  // 己方成五点 > 堵对方成五点（冲四/活四） > 堵对方活三的活四点 > 其余
+  void candidates(int color, bool threat_first, std::vector<int>& out) const;
+  int candidate_count() const { return candidate_count_; }
+  // 必走点：color有成五点时为全部成五点，否则为堵对方成五的点；都没有时为空
+  void forced_moves(int color, std::vector<int>& out) const;
+
+ private:
+  // 候选点按格子编号升序（candidates的不计数版本，供内部复用）
+  void candidate_cells(std::vector<int>& out) const;
+  // 应手等级：0己方成五，1堵对方成五（冲四/活四），2堵对方活三的活四点，3其余
+  int threat_rank(int cell, int color) const;
+  void refresh_around(int x, int y);
+  void refresh_cell(int cell, int d, Shape s);
+  void refresh_cell(int cell, int d, Shape s, int color);
+  // 邻域计数加减，维护候选点集合
+  void touch_neighbors(int x, int y, int delta);
+  void add_candidate(int cell);
+  void remove_candidate(int cell);
+
+  LineBoard board_;
+  ShapeWeights weights_;
+  uint64_t hash_ = 0;
+  int move_count_ = 0;
+  int moves_[kMaxCells];
+  uint8_t shapes_[kMaxCells][DIR_COUNT];
+  int counts_[3][SHAPE_COUNT];
+  double line_scores_[3][DIR_COUNT][kMaxLines];
+  double scores_[3];
+  uint8_t near_[kMaxCells];           // 5x5邻域内的棋子数
+  int16_t candidate_index_[kMaxCells];  // 在candidates_中的下标，-1表示不在集合中
+  int16_t candidates_[kMaxCells];
+  int candidate_count_ = 0;
+};
+
+}  // namespace gomoku
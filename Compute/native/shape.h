@@ -0,0 +1,134 @@
+// 棋型识别（基于9格窗口的位运算）
+//
+// 窗口第4位为待评估的格子，own为己方棋子位，empty为空位，其余位视为阻挡。
+// 棋型按“再走一步能变成什么”递归定义：
+//   成五：窗口内存在连续5子
+//   活四/冲四：有>=2个/恰好1个空位可以成五
+//   活三/眠三：有空位可以形成活四/冲四
+//   活二/眠二：有空位可以形成活三/眠三
+#pragma once
+
+#include <cstdint>
+
+#include "line_board.h"
+
+namespace gomoku {
+
+// 与EVAL_WEIGHTS的键一一对应，数值越大棋型越强
+enum Shape : uint8_t {
+  SHAPE_NONE = 0,
+  SHAPE_ONE,
+  SHAPE_BLOCKED_TWO,
+  SHAPE_TWO,
+  SHAPE_BLOCKED_THREE,
+  SHAPE_THREE,
+  SHAPE_BLOCKED_FOUR,
+  SHAPE_FOUR,
+  SHAPE_FIVE,
+  SHAPE_COUNT
+};
+
+constexpr const char* kShapeNames[SHAPE_COUNT] = {
+    "NONE", "ONE", "BLOCKED_TWO", "TWO", "BLOCKED_THREE", "THREE", "BLOCKED_FOUR", "FOUR", "FIVE"};
+
+// 窗口内可成五的空位
+inline uint32_t win_points(uint32_t own, uint32_t empty) {
+  uint32_t points = 0;
+  for (uint32_t e = empty; e; e &= e - 1) {
+    const uint32_t b = e & (~e + 1);
+    if (five_runs(own | b)) points |= b;
+  }
+  return points;
+}
+
+// 四级棋型（成五/活四/冲四），不是四则返回SHAPE_NONE
+inline Shape four_shape(uint32_t own, uint32_t empty) {
+  if (five_runs(own)) return SHAPE_FIVE;
+  const int n = popcount32(win_points(own, empty));
+  if (n >= 2) return SHAPE_FOUR;
+  if (n == 1) return SHAPE_BLOCKED_FOUR;
+  return SHAPE_NONE;
+}
+
+// 三级及以上棋型
+inline Shape three_shape(uint32_t own, uint32_t empty) {
+  const Shape s = four_shape(own, empty);
+  if (s != SHAPE_NONE) return s;
+  Shape best = SHAPE_NONE;
+  for (uint32_t e = empty; e; e &= e - 1) {
+    const uint32_t b = e & (~e + 1);
+    const Shape next = four_shape(own | b, empty & ~b);
+    if (next == SHAPE_FOUR) return SHAPE_THREE;
+    if (next == SHAPE_BLOCKED_FOUR) best = SHAPE_BLOCKED_THREE;
+  }
+  return best;
+}
+
+// 完整棋型识别
+inline Shape classify_window(uint32_t own, uint32_t empty) {
+  own &= kWindowMask;
+  empty &= kWindowMask & ~own;
+  // 窗口内连成五的空间都没有，视为死棋
+  if (!five_runs(own | empty)) return SHAPE_NONE;
+  const Shape s = three_shape(own, empty);
+  if (s != SHAPE_NONE) return s;
+  Shape best = SHAPE_ONE;
+  for (uint32_t e = empty; e; e &= e - 1) {
+    const uint32_t b = e & (~e + 1);
+    const Shape next = three_shape(own | b, empty & ~b);
+    if (next == SHAPE_THREE) return SHAPE_TWO;
+    if (next == SHAPE_BLOCKED_THREE) best = SHAPE_BLOCKED_TWO;
+  }
+  return best;
+}
+
+// 9格窗口棋型查表：下标为 own<<9 | empty（两个9位掩码），只有3^9种合法组合，
+// 首次使用时用classify_window枚举填表（256KB），之后每次识别只需一次查表
+class ShapeTable {
+ public:
+  static const ShapeTable& instance() {
+    static const ShapeTable table;
+    return table;
+  }
+
+  Shape lookup(uint32_t own, uint32_t empty) const { return table_[(own << 9) | (empty & ~own)]; }
+
+  // 原始表（SIMD gather按32位读取，末尾留有填充）
+  const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(table_); }
+
+ private:
+  ShapeTable() {
+    for (uint32_t i = 0; i < kSize + 3; ++i) table_[i] = SHAPE_NONE;
+    // 逐格枚举空/己/阻挡三种状态
+    for (uint32_t code = 0; code < 19683; ++code) {
+      uint32_t own = 0, empty = 0, rest = code;
+      for (int k = 0; k < 9; ++k, rest /= 3) {
+        if (rest % 3 == 1) own |= 1u << k;
+        if (rest % 3 == 2) empty |= 1u << k;
+      }
+      table_[(own << 9) | empty] = classify_window(own, empty);
+    }
+  }
+
+  static constexpr uint32_t kSize = 1u << 18;
+  Shape table_[kSize + 3];
+};
+
+inline Shape lookup_shape(uint32_t own, uint32_t empty) {
+  return ShapeTable::instance().lookup(own & kWindowMask, empty & kWindowMask);
+}
+
+// (x,y)处落color后在方向d上的棋型
+template <class Board>
+inline Shape shape_at(const Board& board, int x, int y, int color, int d) {
+  const uint32_t own = board.window(color, d, x, y) | kCenterBit;
+  const uint32_t empty = board.window(EMPTY, d, x, y) & ~kCenterBit;
+  return lookup_shape(own, empty);
+}
+
+// 棋型权重表（下标为Shape）
+struct ShapeWeights {
+  double value[SHAPE_COUNT] = {0.0, 10.0, 50.0, 100.0, 500.0, 1000.0, 5000.0, 10000.0, 100000.0};
+};
+
+}  // namespace gomoku
@@ -0,0 +1,80 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace gomoku {
+
+struct ThreadPool::Batch {
+  const std::function<void(int)>* fn;
+  int count;
+  std::atomic<int> next{0};
+  int done = 0;  // 受mutex保护
+  std::mutex mutex;
+  std::condition_variable finished;
+
+  Batch(const std::function<void(int)>& f, int n) : fn(&f), count(n) {}
+
+  // 领取并执行本批剩余任务；批次结束后再领取只会拿到越界下标，不会访问fn
+  void drain() {
+    int index;
+    while ((index = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+      (*fn)(index);
+      std::lock_guard<std::mutex> lock(mutex);
+      if (++done == count) finished.notify_all();
+    }
+  }
+};
+
+ThreadPool::ThreadPool(int workers) {
+  for (int i = 0; i < workers; ++i) threads_.emplace_back([this]() { worker_loop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+  // 进程退出时不析构（静态析构阶段join线程可能与解释器收尾冲突）
+  static ThreadPool* pool = new ThreadPool(std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1));
+  return *pool;
+}
+
+void ThreadPool::run(int count, const std::function<void(int)>& fn) {
+  if (count <= 0) return;
+  if (count == 1 || threads_.empty()) {
+    for (int i = 0; i < count; ++i) fn(i);
+    return;
+  }
+  auto batch = std::make_shared<Batch>(fn, count);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int helpers = std::min(count - 1, size());
+    for (int i = 0; i < helpers; ++i) queue_.push_back(batch);
+  }
+  wake_.notify_all();
+  batch->drain();
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->finished.wait(lock, [&]() { return batch->done == count; });
+}
+
+void ThreadPool::worker_loop() {
+  for (;;) {
+    std::shared_ptr<Batch> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+      if (stopping_ && queue_.empty()) return;
+      batch = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    batch->drain();
+  }
+}
+
+}  // namespace gomoku
@@ -0,0 +1,45 @@
+// 进程级共享的原生线程池
+//
+// 多个搜索引擎（例如专家级AIFleet里同时运行的MCTS与各成员的原生计算）各自开线程会超额订阅CPU，
+// 因此所有原生并行都提交到同一个固定大小的池里。run(count, fn)把fn(0..count-1)作为一批任务：
+// 池中线程与调用线程一起按原子下标领取，调用线程领完剩余任务后等待本批结束。
+// 调用线程自己也会取任务，池被其他批次占满时不会死锁，只是退化为串行执行。
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gomoku {
+
+class ThreadPool {
+ public:
+  // workers为池中线程数（不含调用线程）
+  explicit ThreadPool(int workers);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // 进程共享的池（首次使用时按硬件线程数-1创建）
+  static ThreadPool& shared();
+
+  // 并行执行fn(0)...fn(count-1)，全部完成后返回
+  void run(int count, const std::function<void(int)>& fn);
+  int size() const { return static_cast<int>(threads_.size()); }
+
+ private:
+  struct Batch;
+  void worker_loop();
+
+  std::vector<std::thread> threads_;
+  std::deque<std::shared_ptr<Batch>> queue_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+};
+
+}  // namespace gomoku
@@ -0,0 +1,270 @@
+#include "threat_solver.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "metrics.h"
+#include "shape.h"
+
+namespace gomoku {
+
+namespace {
+
+// 证明表键的盐：区分模式、进攻方以及进攻/防守节点
+constexpr uint64_t kModeSalt[2] = {0x9AE16A3B2F90404Full, 0xC3A5C85C97CB3127ull};
+constexpr uint64_t kColorSalt = 0xB492B66FBE98F273ull;
+constexpr uint64_t kDefendSalt = 0x4CF5AD432745937Full;
+
+// 落子后的棋型（查表）
+inline Shape threat_shape(const LineBoard& board, int x, int y, int color, int d) {
+  const uint32_t own = board.window(color, d, x, y) | kCenterBit;
+  const uint32_t empty = board.window(EMPTY, d, x, y) & ~kCenterBit;
+  return lookup_shape(own, empty);
+}
+
+}  // namespace
+
+ThreatSolver::ThreatSolver(int table_bits) : table_(static_cast<size_t>(1) << table_bits) {}
+
+void ThreatSolver::clear() { std::fill(table_.begin(), table_.end(), Entry()); }
+
+ThreatSolver::Entry* ThreatSolver::lookup(uint64_t key) { return &table_[key & (table_.size() - 1)]; }
+
+void ThreatSolver::play(int cell, int color) {
+  board_.place(cell / size_, cell % size_, color);
+  hash_ ^= Zobrist::instance().key(color, cell);
+}
+
+void ThreatSolver::undo(int cell) {
+  const int x = cell / size_, y = cell % size_;
+  hash_ ^= Zobrist::instance().key(board_.at(x, y), cell);
+  board_.remove(x, y);
+}
+
+int ThreatSolver::five_points(int color, int limit, int* out) const {
+  int count = 0;
+  for (int cell = 0; cell < size_ * size_; ++cell) {
+    const int x = cell / size_, y = cell % size_;
+    if (board_.at(x, y) != EMPTY) continue;
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      if (five_runs(board_.window(color, d, x, y) | kCenterBit)) {
+        out[count++] = cell;
+        if (count >= limit) return count;
+        break;
+      }
+    }
+  }
+  return count;
+}
+
+void ThreatSolver::threat_moves(std::vector<int>& out) const {
+  std::vector<std::pair<int, int>> scored;
+  for (int cell = 0; cell < size_ * size_; ++cell) {
+    const int x = cell / size_, y = cell % size_;
+    if (board_.at(x, y) != EMPTY) continue;
+    int fours = 0, threes = 0;
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      const int own = popcount32(board_.window(attacker_, d, x, y));
+      if (own < 2 || (mode_ == THREAT_VCF && own < 3)) continue;
+      const Shape s = threat_shape(board_, x, y, attacker_, d);
+      if (s >= SHAPE_BLOCKED_FOUR) {
+        ++fours;
+      } else if (s == SHAPE_THREE && mode_ == THREAT_VCT) {
+        ++threes;
+      }
+    }
+    // 成四优先，其次是同时形成多个威胁的点
+    if (fours || threes) scored.emplace_back(fours * 16 + threes * 4, cell);
+  }
+  std::stable_sort(scored.begin(), scored.end(),
+                   [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first > b.first; });
+  out.clear();
+  for (const auto& item : scored) out.push_back(item.second);
+}
+
+bool ThreatSolver::three_defenses(std::vector<int>& out) const {
+  const int defender = opponent(attacker_);
+  std::vector<uint8_t> marked(static_cast<size_t>(size_ * size_), 0);
+  std::vector<int> far;
+  out.clear();
+  for (int cell = 0; cell < size_ * size_; ++cell) {
+    const int x = cell / size_, y = cell % size_;
+    if (board_.at(x, y) != EMPTY) continue;
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      if (popcount32(board_.window(attacker_, d, x, y)) < 3) continue;
+      if (threat_shape(board_, x, y, attacker_, d) != SHAPE_FOUR) continue;
+      // 活四点本身最常见，先试；同一线上±4格内的空位也可能破坏这个活四
+      if (!marked[cell]) {
+        marked[cell] = 1;
+        out.push_back(cell);
+      }
+      for (int k = -kPad; k <= kPad; ++k) {
+        const int nx = x + k * kDirDx[d], ny = y + k * kDirDy[d];
+        if (!board_.in_bounds(nx, ny) || board_.at(nx, ny) != EMPTY) continue;
+        const int ncell = nx * size_ + ny;
+        if (!marked[ncell]) {
+          marked[ncell] = 1;
+          far.push_back(ncell);
+        }
+      }
+    }
+  }
+  if (out.empty()) return false;
+  out.insert(out.end(), far.begin(), far.end());
+  // 防守方成四反击（迫使进攻方应对）
+  for (int cell = 0; cell < size_ * size_; ++cell) {
+    const int x = cell / size_, y = cell % size_;
+    if (marked[cell] || board_.at(x, y) != EMPTY) continue;
+    for (int d = 0; d < DIR_COUNT; ++d) {
+      if (popcount32(board_.window(defender, d, x, y)) < 3) continue;
+      if (threat_shape(board_, x, y, defender, d) >= SHAPE_BLOCKED_FOUR) {
+        out.push_back(cell);
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+Proof ThreatSolver::attack(int depth, int ply) {
+  if (++nodes_ > budget_) return PROOF_UNKNOWN;
+  if (depth < 1) return PROOF_FAIL;
+  int points[2];
+  if (five_points(attacker_, 1, points)) {
+    if (ply == 0) root_move_ = points[0];
+    return PROOF_WIN;
+  }
+  const uint64_t key = hash_ ^ kModeSalt[mode_] ^ (attacker_ == WHITE ? kColorSalt : 0);
+  Entry* entry = lookup(key);
+  if (entry->key == key) {
+    // 根节点需要给出落子，不直接使用必胜结论
+    if (ply > 0 && entry->win_depth && entry->win_depth <= depth) return PROOF_WIN;
+    if (entry->fail_depth >= depth) return PROOF_FAIL;
+  }
+
+  std::vector<int> moves;
+  const int blocks = five_points(opponent(attacker_), 2, points);
+  if (blocks == 1) {
+    moves.push_back(points[0]);  // 对方有成五点，只能先堵
+  } else if (blocks == 0) {
+    threat_moves(moves);
+  }
+
+  Proof result = PROOF_FAIL;
+  for (int cell : moves) {
+    play(cell, attacker_);
+    const Proof r = defend(depth - 1);
+    undo(cell);
+    if (r == PROOF_WIN) {
+      if (ply == 0) root_move_ = cell;
+      result = PROOF_WIN;
+      break;
+    }
+    if (r == PROOF_UNKNOWN) {
+      result = PROOF_UNKNOWN;
+      if (nodes_ > budget_) break;
+    }
+  }
+
+  if (result != PROOF_UNKNOWN) {
+    if (entry->key != key) *entry = Entry{key, 0, 0};
+    if (result == PROOF_WIN && (!entry->win_depth || depth < entry->win_depth)) {
+      entry->win_depth = static_cast<int16_t>(depth);
+    } else if (result == PROOF_FAIL && depth > entry->fail_depth) {
+      entry->fail_depth = static_cast<int16_t>(depth);
+    }
+  }
+  return result;
+}
+
+Proof ThreatSolver::defend(int depth) {
+  if (++nodes_ > budget_) return PROOF_UNKNOWN;
+  const int defender = opponent(attacker_);
+  int points[2];
+  if (five_points(defender, 1, points)) return PROOF_FAIL;  // 防守方直接成五
+  if (depth < 2) return PROOF_FAIL;
+  const int threats = five_points(attacker_, 2, points);
+  if (threats >= 2) return PROOF_WIN;  // 两个成五点堵不住
+
+  const uint64_t key = hash_ ^ kModeSalt[mode_] ^ (attacker_ == WHITE ? kColorSalt : 0) ^ kDefendSalt;
+  Entry* entry = lookup(key);
+  if (entry->key == key) {
+    if (entry->win_depth && entry->win_depth <= depth) return PROOF_WIN;
+    if (entry->fail_depth >= depth) return PROOF_FAIL;
+  }
+
+  std::vector<int> defenses;
+  if (threats == 1) {
+    defenses.push_back(points[0]);
+  } else if (mode_ != THREAT_VCT || !three_defenses(defenses)) {
+    return PROOF_FAIL;  // 进攻方已没有威胁
+  }
+
+  Proof result = PROOF_WIN;
+  for (int cell : defenses) {
+    play(cell, defender);
+    const Proof r = attack(depth - 1, 1);
+    undo(cell);
+    if (r == PROOF_FAIL) {
+      result = PROOF_FAIL;
+      break;
+    }
+    if (r == PROOF_UNKNOWN) {
+      result = PROOF_UNKNOWN;
+      if (nodes_ > budget_) break;
+    }
+  }
+
+  if (result != PROOF_UNKNOWN) {
+    if (entry->key != key) *entry = Entry{key, 0, 0};
+    if (result == PROOF_WIN && (!entry->win_depth || depth < entry->win_depth)) {
+      entry->win_depth = static_cast<int16_t>(depth);
+    } else if (result == PROOF_FAIL && depth > entry->fail_depth) {
+      entry->fail_depth = static_cast<int16_t>(depth);
+    }
+  }
+  return result;
+}
+
+ThreatResult ThreatSolver::solve(const LineBoard& board, int color, ThreatMode mode, int max_depth,
+                                 long node_budget) {
+  // 证明表按格子编号记录，棋盘尺寸变化时作废
+  if (board.size() != size_) {
+    clear();
+    size_ = board.size();
+  }
+  board_ = board;
+  hash_ = 0;
+  const Zobrist& zobrist = Zobrist::instance();
+  for (int cell = 0; cell < size_ * size_; ++cell) {
+    const int c = board_.at(cell / size_, cell % size_);
+    if (c != EMPTY) hash_ ^= zobrist.key(c, cell);
+  }
+  attacker_ = color;
+  mode_ = mode;
+  nodes_ = 0;
+  budget_ = node_budget;
+
+  ThreatResult result;
+  // 迭代加深（进攻方每步占两个半回合），优先找到最短的胜法
+  for (int depth = 1; depth <= max_depth; depth += 2) {
+    root_move_ = -1;
+    const Proof proof = attack(depth, 0);
+    if (proof == PROOF_WIN && root_move_ >= 0) {
+      result.proof = PROOF_WIN;
+      result.x = root_move_ / size_;
+      result.y = root_move_ % size_;
+      result.depth = depth;
+      break;
+    }
+    if (proof == PROOF_UNKNOWN) {
+      result.proof = PROOF_UNKNOWN;
+      break;
+    }
+  }
+  result.nodes = nodes_ > budget_ ? budget_ : nodes_;
+  metric_add(METRIC_THREAT_NODES, static_cast<uint64_t>(result.nodes));
+  return result;
+}
+
+}  // namespace gomoku
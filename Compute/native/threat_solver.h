@@ -0,0 +1,74 @@
+// 威胁空间搜索（VCF/VCT必胜求解）
+//
+// 进攻方只走威胁手，防守方只考虑能化解威胁的应手，做深度受限的与或树搜索：
+//   VCF：进攻方每步都必须成四（连续冲四取胜）
+//   VCT：进攻方每步成四或成活三（连续威胁取胜）
+// 防守方应手集合：
+//   对方有成五点：只能堵成五点（>=2个即必败）
+//   对方有活三：能走成活四的点及其所在线±4格内的空位，加上防守方自己的成四反击
+// 应手集合是真实防守的超集，因此证明出的胜局是可靠的；搜不完（超出节点预算）时返回未知。
+// 自带一张直接映射的证明表（按Zobrist哈希），记录“d步内必胜”和“d步内不能取胜”的结论。
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "line_board.h"
+#include "zobrist.h"
+
+namespace gomoku {
+
+enum ThreatMode { THREAT_VCF = 0, THREAT_VCT = 1 };
+
+enum Proof { PROOF_FAIL = 0, PROOF_WIN = 1, PROOF_UNKNOWN = 2 };
+
+struct ThreatResult {
+  Proof proof = PROOF_FAIL;
+  int x = -1;
+  int y = -1;
+  int depth = 0;  // 证明所用的进攻深度（半回合数）
+  long nodes = 0;
+};
+
+class ThreatSolver {
+ public:
+  explicit ThreatSolver(int table_bits = 16);
+
+  // 求解color在mode下max_depth半回合内的强制胜，最多搜索node_budget个节点
+  ThreatResult solve(const LineBoard& board, int color, ThreatMode mode, int max_depth, long node_budget);
+  void clear();
+
+ private:
+  struct Entry {
+    uint64_t key = 0;
+    int16_t win_depth = 0;   // 已证明该深度内必胜（0表示未知）
+    int16_t fail_depth = 0;  // 已证明该深度内不能取胜（0表示未知）
+  };
+
+  Proof attack(int depth, int ply);
+  Proof defend(int depth);
+
+  void play(int cell, int color);
+  void undo(int cell);
+
+  // color的成五点（最多收集limit个）
+  int five_points(int color, int limit, int* out) const;
+  // 进攻方威胁手：成四优先，VCT模式下追加成活三
+  void threat_moves(std::vector<int>& out) const;
+  // 防守方对活三威胁的应手，没有活三时返回false
+  bool three_defenses(std::vector<int>& out) const;
+
+  Entry* lookup(uint64_t key);
+
+  LineBoard board_;
+  std::vector<Entry> table_;
+  uint64_t hash_ = 0;
+  int size_ = 0;
+  int attacker_ = BLACK;
+  ThreatMode mode_ = THREAT_VCF;
+  long nodes_ = 0;
+  long budget_ = 0;
+  int root_move_ = -1;
+};
+
+}  // namespace gomoku
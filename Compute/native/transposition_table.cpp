@@ -0,0 +1,93 @@
+#include "transposition_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gomoku {
+
+void TranspositionTable::resize(size_t size_mb) {
+  size_t count = std::max<size_t>(size_mb, 1) * (1u << 20) / sizeof(Bucket);
+  size_t pow2 = 1;
+  while (pow2 * 2 <= count) pow2 *= 2;
+  buckets_.reset(new Bucket[pow2]);
+  bucket_count_ = pow2;
+  age_ = 1;
+}
+
+void TranspositionTable::clear() {
+  for (size_t i = 0; i < bucket_count_; ++i) {
+    for (Slot& slot : buckets_[i].slots) {
+      slot.check.store(0, std::memory_order_relaxed);
+      slot.data.store(0, std::memory_order_relaxed);
+    }
+  }
+  age_ = 1;
+}
+
+uint64_t TranspositionTable::pack(int depth, Bound bound, float score, int move, int age) {
+  uint32_t score_bits;
+  std::memcpy(&score_bits, &score, sizeof(score_bits));
+  const uint64_t d = static_cast<uint64_t>(std::min(std::max(depth, 0), 255));
+  return static_cast<uint64_t>(score_bits) | (static_cast<uint64_t>(move & 0xFFFF) << 32) | (d << 48) |
+         (static_cast<uint64_t>(bound & 3) << 56) | (static_cast<uint64_t>(age) << 58);
+}
+
+bool TranspositionTable::probe(uint64_t hash, TTEntry& out) const {
+  const Bucket& bucket = bucket_for(hash);
+  for (const Slot& slot : bucket.slots) {
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if (data == 0 || (check ^ data) != hash) continue;
+    const uint32_t score_bits = static_cast<uint32_t>(data);
+    std::memcpy(&out.score, &score_bits, sizeof(out.score));
+    out.move = data_move(data);
+    out.depth = data_depth(data);
+    out.bound = static_cast<Bound>((data >> 56) & 3);
+    return true;
+  }
+  return false;
+}
+
+void TranspositionTable::store(uint64_t hash, int depth, Bound bound, float score, int move) {
+  Bucket& bucket = bucket_for(hash);
+  Slot* victim = nullptr;
+  int victim_worth = 0;
+  for (Slot& slot : bucket.slots) {
+    const uint64_t data = slot.data.load(std::memory_order_relaxed);
+    if (data == 0) {
+      // 空条目：写入总是先占空位，其后不会再有同一局面
+      victim = &slot;
+      break;
+    }
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) == hash) {
+      // 同一局面：更深、精确值或旧代的结果才覆盖，没有新走法时保留旧走法
+      if (bound != BOUND_EXACT && depth < data_depth(data) && data_age(data) == age_) return;
+      if (move == kNoMove) move = data_move(data);
+      victim = &slot;
+      break;
+    }
+    // 替换价值：深度越浅、代数越旧越优先被替换
+    const int worth = data_depth(data) - 8 * age_distance(data_age(data));
+    if (!victim || worth < victim_worth) {
+      victim = &slot;
+      victim_worth = worth;
+    }
+  }
+  const uint64_t data = pack(depth, bound, score, move, age_);
+  victim->data.store(data, std::memory_order_relaxed);
+  victim->check.store(hash ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+  const size_t sample = std::min<size_t>(bucket_count_, 1000 / kBucketSize);
+  int used = 0;
+  for (size_t i = 0; i < sample; ++i) {
+    for (const Slot& slot : buckets_[i].slots) {
+      if (data_age(slot.data.load(std::memory_order_relaxed)) == age_) ++used;
+    }
+  }
+  return static_cast<int>(used * 1000 / (sample * kBucketSize));
+}
+
+}  // namespace gomoku
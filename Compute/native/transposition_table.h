@@ -0,0 +1,82 @@
+// Zobrist置换表（固定大小、无锁）
+//
+// 每个桶4个条目，正好一条64字节缓存行。条目存两个64位原子量：key^data 与 data，
+// 读取时校验 key^data^data == hash，并发写入撕裂的条目会自然校验失败（按未命中处理），
+// 因此多线程读写不需要加锁。
+//
+// data布局：
+//   bit  0-31  评分（float）
+//   bit 32-47  最佳落子（x<<5|y，0xFFFF表示无）
+//   bit 48-55  剩余深度
+//   bit 56-57  边界类型
+//   bit 58-63  代数（1-63循环，0表示空条目）
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace gomoku {
+
+enum Bound { BOUND_EXACT = 0, BOUND_LOWER = 1, BOUND_UPPER = 2 };
+
+constexpr int kNoMove = 0xFFFF;
+
+inline int pack_move(int x, int y) { return (x << 5) | y; }
+inline int move_x(int move) { return move >> 5; }
+inline int move_y(int move) { return move & 31; }
+
+struct TTEntry {
+  float score;
+  int move;  // pack_move编码，kNoMove表示无
+  int depth;
+  Bound bound;
+};
+
+class TranspositionTable {
+ public:
+  explicit TranspositionTable(size_t size_mb) { resize(size_mb); }
+
+  // 按MB重新分配（向下取2的幂个桶），会清空表
+  void resize(size_t size_mb);
+  void clear();
+  // 每次根搜索开始时调用，旧条目随代数增加逐渐让位
+  void new_search() { age_ = age_ % kMaxAge + 1; }
+
+  bool probe(uint64_t hash, TTEntry& out) const;
+  void store(uint64_t hash, int depth, Bound bound, float score, int move);
+
+  size_t bucket_count() const { return bucket_count_; }
+  size_t size_mb() const { return (bucket_count_ * sizeof(Bucket)) >> 20; }
+  // 抽样统计当代条目占用率（千分比）
+  int hashfull() const;
+
+ private:
+  static constexpr int kBucketSize = 4;
+  static constexpr int kMaxAge = 63;
+
+  struct Slot {
+    std::atomic<uint64_t> check{0};
+    std::atomic<uint64_t> data{0};
+  };
+  struct alignas(64) Bucket {
+    Slot slots[kBucketSize];
+  };
+
+  static uint64_t pack(int depth, Bound bound, float score, int move, int age);
+  static int data_age(uint64_t data) { return static_cast<int>(data >> 58); }
+  static int data_depth(uint64_t data) { return static_cast<int>((data >> 48) & 0xFF); }
+  static int data_move(uint64_t data) { return static_cast<int>((data >> 32) & 0xFFFF); }
+
+  // 距离当前代的代数差（越大越旧）
+  int age_distance(int age) const { return (age_ - age + kMaxAge) % kMaxAge; }
+
+  Bucket& bucket_for(uint64_t hash) const { return buckets_[hash & (bucket_count_ - 1)]; }
+
+  std::unique_ptr<Bucket[]> buckets_;
+  size_t bucket_count_ = 0;
+  int age_ = 1;
+};
+
+}  // namespace gomoku
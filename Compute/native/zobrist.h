@@ -0,0 +1,37 @@
+// Zobrist哈希键（固定种子，保证进程间/存盘后哈希一致）
+#pragma once
+
+#include <cstdint>
+
+#include "line_board.h"
+
+namespace gomoku {
+
+class Zobrist {
+ public:
+  static const Zobrist& instance() {
+    static const Zobrist table;
+    return table;
+  }
+
+  uint64_t key(int color, int cell) const { return keys_[color == WHITE ? 1 : 0][cell]; }
+
+ private:
+  Zobrist() {
+    uint64_t seed = 0x5EED60B0A1ull;
+    for (int c = 0; c < 2; ++c) {
+      for (int i = 0; i < kMaxCells; ++i) keys_[c][i] = splitmix64(seed);
+    }
+  }
+
+  static uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  uint64_t keys_[2][kMaxCells];
+};
+
+}  // namespace gomoku
@@ -0,0 +1,180 @@
+import random
+from typing import List, Tuple, Dict, Optional
+from Common.constants import PIECE_COLORS, EVAL_WEIGHTS
+
+class PySearchBoard:
+    """搜索棋盘Python降级实现（与C++ SearchBoard接口一致，原地落子/撤销）"""
+    _zobrist_keys: Dict[int, List[List[int]]] = {}
+
+    def __init__(self, board: List[List[int]], weights: Optional[Dict[str, float]] = None):
+        from Compute.cpp_interface import CppCore
+        self.board = [row.copy() for row in board]
+        self.board_size = len(board)
+        self.weights = weights or EVAL_WEIGHTS
+        self._core = CppCore()
+        self._keys = self._get_zobrist_keys(self.board_size)
+        self._moves: List[Tuple[int, int]] = []
+        self._empty_count = sum(row.count(PIECE_COLORS.EMPTY) for row in self.board)
+        self._hash = 0
+        for x in range(self.board_size):
+            for y in range(self.board_size):
+                if self.board[x][y] != PIECE_COLORS.EMPTY:
+                    self._hash ^= self._keys[self.board[x][y] - 1][x * self.board_size + y]
+
+    @classmethod
+    def _get_zobrist_keys(cls, board_size: int) -> List[List[int]]:
+        """Zobrist键（固定种子，按棋盘尺寸缓存）"""
+        if board_size not in cls._zobrist_keys:
+            rng = random.Random(0x5EED60B0A1)
+            cls._zobrist_keys[board_size] = [[rng.getrandbits(64) for _ in range(board_size ** 2)] for _ in range(2)]
+        return cls._zobrist_keys[board_size]
+
+    def make_move(self, x: int, y: int, color: int) -> bool:
+        """落子，返回该步是否成五"""
+        if self.board[x][y] != PIECE_COLORS.EMPTY:
+            raise ValueError(f"invalid move: ({x}, {y})")
+        self.board[x][y] = color
+        self._moves.append((x, y))
+        self._empty_count -= 1
+        self._hash ^= self._keys[color - 1][x * self.board_size + y]
+        return self._core.check_game_end_from(self.board, x, y, color, self._empty_count)['winner'] == color
+
+    def unmake_move(self) -> bool:
+        """撤销最后一步"""
+        if not self._moves:
+            return False
+        x, y = self._moves.pop()
+        self._hash ^= self._keys[self.board[x][y] - 1][x * self.board_size + y]
+        self.board[x][y] = PIECE_COLORS.EMPTY
+        self._empty_count += 1
+        return True
+
+    def zobrist_hash(self) -> int:
+        return self._hash
+
+    def size(self) -> int:
+        return self.board_size
+
+    def move_count(self) -> int:
+        return len(self._moves)
+
+    def empty_count(self) -> int:
+        return self._empty_count
+
+    def last_move(self) -> Optional[Tuple[int, int]]:
+        return self._moves[-1] if self._moves else None
+
+    def moves(self) -> List[Tuple[int, int]]:
+        return list(self._moves)
+
+    def at(self, x: int, y: int) -> int:
+        return self.board[x][y]
+
+    def pattern_counts(self, color: int) -> Dict[str, int]:
+        """各棋型数量（降级实现按需全盘统计）"""
+        counts = {name: 0 for name in EVAL_WEIGHTS}
+        for x in range(self.board_size):
+            for y in range(self.board_size):
+                if self.board[x][y] == color:
+                    score = self._core.evaluate_move(self.board, x, y, color, self.weights)
+                    name = max((n for n in EVAL_WEIGHTS if EVAL_WEIGHTS[n] <= score), key=lambda n: EVAL_WEIGHTS[n], default=None)
+                    if name:
+                        counts[name] += 1
+        return counts
+
+    def evaluate(self, color: int) -> float:
+        """局面静态评分（color视角）"""
+        score = 0.0
+        for x in range(self.board_size):
+            for y in range(self.board_size):
+                stone = self.board[x][y]
+                if stone != PIECE_COLORS.EMPTY:
+                    s = self._core.evaluate_move(self.board, x, y, stone, self.weights)
+                    score += s if stone == color else -s
+        return score
+
+    def evaluate_delta(self, x: int, y: int, color: int) -> float:
+        """color在(x,y)落子带来的局面评分变化"""
+        before = self.evaluate(color)
+        self.make_move(x, y, color)
+        after = self.evaluate(color)
+        self.unmake_move()
+        return after - before
+
+    def evaluate_move(self, x: int, y: int, color: int) -> float:
+        return self._core.evaluate_move(self.board, x, y, color, self.weights)
+
+    def sorted_moves(self, color: int, limit: int = 0) -> List[Tuple[int, int]]:
+        """按进攻+防守得分降序返回候选点"""
+        opponent = PIECE_COLORS.WHITE if color == PIECE_COLORS.BLACK else PIECE_COLORS.BLACK
+        center = self.board_size // 2
+        scored = [
+            (self.evaluate_move(x, y, color) + self.evaluate_move(x, y, opponent) - 0.01 * (abs(x - center) + abs(y - center)), (x, y))
+            for (x, y) in self.candidates(color)
+        ]
+        scored.sort(key=lambda item: item[0], reverse=True)
+        moves = [move for _, move in scored]
+        return moves[:limit] if limit > 0 else moves
+
+    def candidates(self, color: int, threat_first: bool = False) -> List[Tuple[int, int]]:
+        """候选点：距离已有棋子2格以内的空位（降级实现按需扫描；空棋盘返回天元）"""
+        n = self.board_size
+        near = set()
+        for x in range(n):
+            for y in range(n):
+                if self.board[x][y] == PIECE_COLORS.EMPTY:
+                    continue
+                for nx in range(max(x - 2, 0), min(x + 3, n)):
+                    for ny in range(max(y - 2, 0), min(y + 3, n)):
+                        if self.board[nx][ny] == PIECE_COLORS.EMPTY:
+                            near.add((nx, ny))
+        if not near:
+            return [(n // 2, n // 2)] if self._empty_count == n * n else []
+        moves = sorted(near)
+        if threat_first:
+            opponent = PIECE_COLORS.WHITE if color == PIECE_COLORS.BLACK else PIECE_COLORS.BLACK
+
+            def rank(move: Tuple[int, int]) -> int:
+                if self.best_shape(move[0], move[1], color) == 'FIVE':
+                    return 0
+                opp_shape = self.best_shape(move[0], move[1], opponent)
+                return 1 if opp_shape == 'FIVE' else 2 if opp_shape == 'FOUR' else 3
+            moves.sort(key=rank)
+        return moves
+
+    def best_shape(self, x: int, y: int, color: int) -> str:
+        """(x,y)落color后四个方向中最强的棋型（降级实现按连子数+两端阻挡判断）"""
+        order = ['NONE', 'ONE', 'BLOCKED_TWO', 'TWO', 'BLOCKED_THREE', 'THREE', 'BLOCKED_FOUR', 'FOUR', 'FIVE']
+        best = 0
+        for dx, dy in [(0, 1), (1, 0), (1, 1), (1, -1)]:
+            count = 1
+            blocked = 0
+            for sign in (1, -1):
+                nx, ny = x + sign * dx, y + sign * dy
+                while 0 <= nx < self.board_size and 0 <= ny < self.board_size and self.board[nx][ny] == color:
+                    count += 1
+                    nx += sign * dx
+                    ny += sign * dy
+                if not (0 <= nx < self.board_size and 0 <= ny < self.board_size) or self.board[nx][ny] != PIECE_COLORS.EMPTY:
+                    blocked += 1
+            if count >= 5:
+                shape = 'FIVE'
+            elif blocked == 2:
+                shape = 'NONE'
+            elif count == 1:
+                shape = 'ONE'
+            else:
+                shape = ({2: 'TWO', 3: 'THREE', 4: 'FOUR'} if blocked == 0 else {2: 'BLOCKED_TWO', 3: 'BLOCKED_THREE', 4: 'BLOCKED_FOUR'})[count]
+            best = max(best, order.index(shape))
+        return order[best]
+
+    def scan_candidates(self, color: int) -> List[Tuple[int, int, float, float, str]]:
+        """威胁优先候选点逐点的(x, y, 评分变化, 落子棋型得分, 最强棋型)"""
+        return [(x, y, self.evaluate_delta(x, y, color), self.evaluate_move(x, y, color), self.best_shape(x, y, color))
+                for (x, y) in self.candidates(color, threat_first=True)]
+
+    def empty_positions(self) -> List[Tuple[int, int]]:
+        return [(x, y) for x in range(self.board_size) for y in range(self.board_size) if self.board[x][y] == PIECE_COLORS.EMPTY]
+
+    def to_list(self) -> List[List[int]]:
+        return [row.copy() for row in self.board]
@@ -0,0 +1,48 @@
+"""C++核心扩展编译脚本
+
+在Compute目录下执行：python setup.py build_ext --inplace
+生成的_gomoku_core扩展由cpp_interface.CppCore自动加载，未编译时降级为Python实现。
+"""
+import os
+import sys
+from setuptools import setup, Extension
+
+NATIVE_DIR = 'native'
+SOURCES = [
+    'core.cpp',
+    'metrics.cpp',
+    'thread_pool.cpp',
+    'batch_eval.cpp',
+    'search_board.cpp',
+    'threat_solver.cpp',
+    'py_search_board.cpp',
+    'transposition_table.cpp',
+    'py_transposition_table.cpp',
+    'mcts.cpp',
+    'py_mcts.cpp',
+    'module.cpp',
+]
+
+if sys.platform == 'win32':
+    compile_args = ['/O2', '/std:c++17', '/EHsc']
+    link_args = []
+else:
+    # MCTS并行搜索使用共享原生线程池（std::thread）
+    compile_args = ['-O3', '-std=c++17', '-fvisibility=hidden', '-pthread']
+    link_args = ['-pthread']
+
+core_extension = Extension(
+    '_gomoku_core',
+    sources=[os.path.join(NATIVE_DIR, src) for src in SOURCES],
+    include_dirs=[NATIVE_DIR],
+    language='c++',
+    extra_compile_args=compile_args,
+    extra_link_args=link_args
+)
+
+setup(
+    name='gomoku_core',
+    version='1.0.0',
+    description='五子棋AI位棋盘计算核心',
+    ext_modules=[core_extension]
+)
@@ -0,0 +1,69 @@
+from typing import List, Tuple, Optional
+
+BOUND_EXACT = 0
+BOUND_LOWER = 1
+BOUND_UPPER = 2
+
+class PyTranspositionTable:
+    """置换表Python降级实现（与C++ TranspositionTable接口一致：按桶组织，深度+代数替换）"""
+    BUCKET_SIZE = 4
+    BUCKET_BYTES = 64  # 与C++一致：每桶4个16字节条目
+    MAX_AGE = 63
+
+    def __init__(self, size_mb: int = 64):
+        if size_mb <= 0:
+            raise ValueError("size_mb must be positive")
+        count = size_mb * (1 << 20) // self.BUCKET_BYTES
+        self.bucket_count = 1 << (count.bit_length() - 1)
+        self._mask = self.bucket_count - 1
+        self._buckets: List[Optional[List[list]]] = [None] * self.bucket_count  # 桶按需创建
+        self._age = 1
+
+    def new_search(self):
+        """每次根搜索开始时调用，旧条目随代数增加逐渐让位"""
+        self._age = self._age % self.MAX_AGE + 1
+
+    def clear(self):
+        self._buckets = [None] * self.bucket_count
+        self._age = 1
+
+    def probe(self, key: int) -> Optional[Tuple[int, int, float, Optional[Tuple[int, int]]]]:
+        """查询：命中返回(深度, 边界类型, 评分, 最佳落子)，未命中返回None"""
+        bucket = self._buckets[key & self._mask]
+        if bucket:
+            for entry in bucket:
+                if entry[0] == key:
+                    return entry[1], entry[2], entry[3], entry[4]
+        return None
+
+    def store(self, key: int, depth: int, bound: int, score: float, move: Optional[Tuple[int, int]] = None):
+        """写入：同局面仅在更深/精确/旧代时覆盖，满桶时替换最浅最旧的条目"""
+        depth = min(max(depth, 0), 255)
+        index = key & self._mask
+        bucket = self._buckets[index]
+        if bucket is None:
+            bucket = self._buckets[index] = []
+        for entry in bucket:
+            if entry[0] == key:
+                if bound != BOUND_EXACT and depth < entry[1] and entry[5] == self._age:
+                    return
+                entry[1:] = [depth, bound, score, move if move is not None else entry[4], self._age]
+                return
+        new_entry = [key, depth, bound, score, move, self._age]
+        if len(bucket) < self.BUCKET_SIZE:
+            bucket.append(new_entry)
+            return
+        victim = min(range(len(bucket)), key=lambda i: bucket[i][1] - 8 * self._age_distance(bucket[i][5]))
+        bucket[victim] = new_entry
+
+    def _age_distance(self, age: int) -> int:
+        return (self._age - age + self.MAX_AGE) % self.MAX_AGE
+
+    def hashfull(self) -> int:
+        """抽样统计当代条目占用率（千分比）"""
+        sample = min(self.bucket_count, 1000 // self.BUCKET_SIZE)
+        used = sum(1 for bucket in self._buckets[:sample] if bucket for entry in bucket if entry[5] == self._age)
+        return used * 1000 // (sample * self.BUCKET_SIZE)
+
+    def size_mb(self) -> int:
+        return self.bucket_count * self.BUCKET_BYTES >> 20
@@ -1,5 +1,5 @@
 import numpy as np
-from typing import List, Tuple, Dict, Optional
+from typing import List, Tuple, Dict, Optional, Callable
 from Common.constants import PIECE_COLORS, EVAL_WEIGHTS
 from Common.logger import Logger
 from Compute.cpp_interface import CppCore
@@ -16,25 +16,37 @@ class BoardAnalyzer:
 
     def analyze_move_quality(self, board: List[List[int]], x: int, y: int, color: int) -> Dict:
         """分析单步落子质量（0-100分）"""
+        search_board = self.cpp_core.create_search_board(board)
+        return self.move_quality(search_board, x, y, color, search_board.scan_candidates(color))
+
+    def analyze_board_situation(self, board: List[List[int]]) -> Dict:
+        """全局局势分析（双方优势评估）"""
+        search_board = self.cpp_core.create_search_board(board)
+        return self.board_situation(search_board, search_board.scan_candidates(PIECE_COLORS['BLACK']),
+                                    search_board.scan_candidates(PIECE_COLORS['WHITE']))
+
+    # ------------------------------ 基于搜索棋盘的分析（复盘引擎逐步复用同一块棋盘） ------------------------------
+    def move_quality(self, search_board, x: int, y: int, color: int, scan: List[Tuple]) -> Dict:
+        """落子质量（search_board为落子前局面，scan为落子方的scan_candidates结果）"""
         # 基础棋型得分
-        pattern, pattern_score = self.evaluator._recognize_pattern(board, x, y, color)
+        if self.evaluator.cpp_core:
+            pattern_score = search_board.evaluate_move(x, y, color)
+            pattern = self.evaluator.pattern_from_score(pattern_score)
+        else:
+            pattern, pattern_score = self.evaluator._python_recognize_pattern(search_board.to_list(), x, y, color)
 
         # 位置权重得分
         pos_weight = self.evaluator.position_weights[x][y]
 
-        # 局势影响得分（落子前后局势变化）
-        pre_score = self.evaluator.evaluate_board(board, color)
-        temp_board = [row.copy() for row in board]
-        temp_board[x][y] = color
-        post_score = self.evaluator.evaluate_board(temp_board, color)
-        impact_score = post_score - pre_score
+        # 局势影响得分（落子前后局势变化，增量计算）
+        impact_score = search_board.evaluate_delta(x, y, color)
 
         # 综合质量评分（归一化到0-100）
         total_score = (pattern_score * 0.5 + pos_weight * 20 + impact_score * 0.3)
         quality = min(100, max(0, total_score))
 
-        # 查找最优替代落子
-        best_move, best_score = self._find_best_move(board, color)
+        # 最优替代落子
+        best_move, best_score, _ = self._best_from_scan(scan)
 
         return {
             'move': (x, y),
@@ -48,20 +60,20 @@ class BoardAnalyzer:
             'quality_gap': round(best_score - quality, 2)
         }
 
-    def analyze_board_situation(self, board: List[List[int]]) -> Dict:
-        """全局局势分析（双方优势评估）"""
+    def board_situation(self, search_board, black_scan: List[Tuple], white_scan: List[Tuple]) -> Dict:
+        """局势分析（双方得分由搜索棋盘增量维护，威胁与关键点取自双方的候选点扫描）"""
         # 双方局势得分
-        black_score = self.evaluator.evaluate_board(board, PIECE_COLORS['BLACK'])
-        white_score = self.evaluator.evaluate_board(board, PIECE_COLORS['WHITE'])
+        black_score = search_board.evaluate(PIECE_COLORS['BLACK'])
+        white_score = search_board.evaluate(PIECE_COLORS['WHITE'])
         score_gap = black_score - white_score
 
         # 威胁检测（冲四、活三）
-        black_threats = self._detect_threats(board, PIECE_COLORS['BLACK'])
-        white_threats = self._detect_threats(board, PIECE_COLORS['WHITE'])
+        black_threats = self._threats_from_scan(black_scan)
+        white_threats = self._threats_from_scan(white_scan)
 
         # 关键落子点预测
-        black_best_move, _ = self._find_best_move(board, PIECE_COLORS['BLACK'])
-        white_best_move, _ = self._find_best_move(board, PIECE_COLORS['WHITE'])
+        black_best_move, _, _ = self._best_from_scan(black_scan)
+        white_best_move, _, _ = self._best_from_scan(white_scan)
 
         # 局势判断
         if len(black_threats) >= 2 or any(t['level'] == 'high' for t in black_threats):
@@ -92,45 +104,16 @@ class BoardAnalyzer:
             'description': desc
         }
 
-    def generate_replay_report(self, move_history: List[Dict], board_size: int) -> Dict:
-        """生成复盘报告（基于落子历史）"""
+    def generate_replay_report(self, move_history: List[Dict], board_size: int,
+                               progress_callback: Optional[Callable[[Dict], None]] = None) -> Dict:
+        """生成复盘报告（复盘引擎：增量棋盘重放一次，逐步分析并行执行，每步完成即回调progress_callback）"""
         if not move_history:
             return {'error': '无落子历史数据'}
 
-        # 初始化棋盘
-        board = [[PIECE_COLORS['EMPTY'] for _ in range(board_size)] for _ in range(board_size)]
-        move_qualities = []
-        threat_history = []
-
-        # 逐步分析
-        for move in move_history:
-            x, y = move['x'], move['y']
-            color = move['color']
-
-            # 分析落子质量
-            quality_info = self.analyze_move_quality(board, x, y, color)
-            move_qualities.append({
-                'move_idx': len(move_qualities) + 1,
-                'x': x,
-                'y': y,
-                'color': color,
-                'quality': quality_info['quality'],
-                'pattern': quality_info['pattern'],
-                'best_move': quality_info['best_move'],
-                'quality_gap': quality_info['quality_gap']
-            })
-
-            # 分析局势威胁
-            situation = self.analyze_board_situation(board)
-            threat_history.append({
-                'move_idx': len(threat_history) + 1,
-                'black_threats': len(situation['black_threats']),
-                'white_threats': len(situation['white_threats']),
-                'situation': situation['situation']
-            })
-
-            # 执行落子
-            board[x][y] = color
+        from Game.replay_engine import ReplayEngine
+        plies = ReplayEngine(self).analyze(move_history, board_size, progress_callback)
+        move_qualities = [ply['move_quality'] for ply in plies]
+        threat_history = [ply['threats'] for ply in plies]
 
         # 统计分析
         avg_quality = np.mean([mq['quality'] for mq in move_qualities])
@@ -150,53 +133,50 @@ class BoardAnalyzer:
         }
 
     # ------------------------------ 辅助方法 ------------------------------
-    def _find_best_move(self, board: List[List[int]], color: int) -> Tuple[Tuple[int, int], float]:
-        """查找当前棋盘的最优落子"""
-        empty_pos = self.evaluator._get_empty_positions(board)
-        if not empty_pos:
-            return ((0, 0), 0.0)
-
-        # 评估所有空位置
-        move_scores = []
-        for (x, y) in empty_pos:
-            score = self.evaluator.evaluate_move(board, x, y, color, EVAL_WEIGHTS)
+    def _best_from_scan(self, scan: List[Tuple]) -> Tuple[Tuple[int, int], float, float]:
+        """候选点扫描中的最优落子：返回(落子, 归一化得分0-100, 该点的evaluate_move得分)"""
+        if not scan:
+            return ((0, 0), 0.0, 0.0)
+        best_move, best_score, best_move_score = (0, 0), float('-inf'), 0.0
+        for (x, y, delta, _, _) in scan:
             pos_weight = self.evaluator.position_weights[x][y]
-            total_score = score * pos_weight
-            move_scores.append(((x, y), total_score))
-
-        # 选择得分最高的落子
-        best_move, best_score = max(move_scores, key=lambda x: x[1])
+            move_score = delta + pos_weight  # 同BoardEvaluator.evaluate_move
+            total_score = move_score * pos_weight
+            if total_score > best_score:
+                best_move, best_score, best_move_score = (x, y), total_score, move_score
         # 归一化得分到0-100
         normalized_score = min(100, max(0, (best_score / self.pattern_scores['FIVE']) * 100))
-        return (best_move, round(normalized_score, 2))
+        return (best_move, round(normalized_score, 2), best_move_score)
 
-    def _detect_threats(self, board: List[List[int]], color: int) -> List[Dict]:
-        """检测当前玩家的威胁（冲四、活三）"""
-        threats = []
-        empty_pos = self.evaluator._get_empty_positions(board)
-
-        for (x, y) in empty_pos:
-            temp_board = [row.copy() for row in board]
-            temp_board[x][y] = color
-            score = self.evaluator.evaluate_board(temp_board, color)
+    def _find_best_move(self, board: List[List[int]], color: int) -> Tuple[Tuple[int, int], float]:
+        """查找当前棋盘的最优落子"""
+        best_move, best_score, _ = self._best_from_scan(self.cpp_core.create_search_board(board).scan_candidates(color))
+        return (best_move, best_score)
 
-            if score >= self.pattern_scores['FOUR']:
+    def _threats_from_scan(self, scan: List[Tuple]) -> List[Dict]:
+        """从候选点扫描中挑出威胁点（冲四、活三）"""
+        threats = []
+        for (x, y, _, score, shape) in scan:
+            if shape in ('FIVE', 'FOUR', 'BLOCKED_FOUR'):
                 threats.append({
                     'position': (x, y),
                     'level': 'high',
                     'type': '冲四',
                     'score': score
                 })
-            elif score >= self.pattern_scores['THREE']:
+            elif shape == 'THREE':
                 threats.append({
                     'position': (x, y),
                     'level': 'medium',
                     'type': '活三',
                     'score': score
                 })
-
         return threats
 
+    def _detect_threats(self, board: List[List[int]], color: int) -> List[Dict]:
+        """检测当前玩家的威胁（冲四、活三）"""
+        return self._threats_from_scan(self.cpp_core.create_search_board(board).scan_candidates(color))
+
     def _identify_key_moments(self, threat_history: List[Dict], move_qualities: List[Dict]) -> List[Dict]:
         """识别对局关键节点（威胁变化、低质量落子）"""
         key_moments = []
@@ -8,11 +8,12 @@ from AI.rl_ai import RLAI
 from AI.mcts_ai import MCTSAI
 from AI.minimax_ai import MinimaxAI
 from AI.nn_ai import NNAI
+from AI.puct_ai import PUCTAI
 from Network.online_client import OnlineClient
 from Network.p2p_client import P2PClient
 
 class GameModeManager:
-    """游戏模式管理器（统一管理PVE/PVP/ONLINE/TRAIN模式）"""
+    """游戏模式管理器（统一管理PVE/PVP/ONLINE/TRAIN模式；game_core为所属的GameSession）"""
     def __init__(self, game_core):
         self.game_core = game_core
         self.logger = Logger.get_instance()
@@ -98,18 +99,24 @@ class GameModeManager:
             'mcts': MCTSAI,
             'minimax': MinimaxAI,
             'nn': NNAI,
+            'puct': PUCTAI,  # 策略价值网络引导的C++ PUCT搜索
             'rl+mcts': lambda c, l: RLAI(c, l)  # RL为主，MCTS优化落子
         }
         ai_cls = ai_map.get(self.game_core.ai_type, MCTSAI)
-        return ai_cls(color, self.game_core.ai_level)
+        # 经会话宿主创建：模型类AI共享已加载的权重，托管会话的Minimax使用较小的置换表
+        tt_size_mb = self.game_core.host.session_tt_size_mb if self.game_core.hosted else None
+        return self.game_core.resources.create_ai(ai_cls, color, self.game_core.ai_level, tt_size_mb)
 
     def _handle_online_message(self, data: Dict):
         """处理联机消息回调"""
         msg_type = data.get('type')
-        if msg_type == 'move':
-            # 接收对手落子
-            x, y = data['x'], data['y']
-            self.game_core.place_piece(x, y, is_ai=False)
+        if msg_type in ('moves', 'snapshot', 'resync'):
+            # 二进制帧（落子增量/局面快照/重同步请求）
+            self.game_core.apply_online_frame(data)
+        elif msg_type == 'move':
+            # 旧版逐步消息：没有序号时视为下一手，同样按序号应用（不再回发给对手）
+            seq = data.get('seq', self.game_core.online_sequencer.seq + 1)
+            self.game_core.apply_online_frame({'type': 'moves', 'moves': [{'seq': seq, 'x': data['x'], 'y': data['y']}]})
         elif msg_type == 'room_join':
             # 对手加入房间
             self.game_core.online_opponent_id = data['user_id']
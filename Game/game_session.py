@@ -0,0 +1,510 @@
+import time
+import threading
+from concurrent.futures import Future
+from typing import List, Tuple, Dict, Optional, Callable
+from Common.constants import PIECE_COLORS, GAME_MODES, AI_LEVELS
+from Common.config import Config
+from Common.logger import Logger
+from Common.error_handler import GameError
+from Common.event import EventManager, Event
+from Common.wire_protocol import MoveSequencer, encode_moves, encode_snapshot, encode_resync
+from AI.base_ai import BaseAI
+from AI.ai_fleet import AIFleet
+from AI.rl_ai import RLAI
+from AI.nn_ai import NNAI
+from AI.ponder import Ponderer
+from Game.game_mode import GameModeManager
+from Game.replay_engine import ReplayEngine
+
+class GameSession:
+    """单局游戏会话（事件驱动，统筹一局的落子/AI/结算逻辑）
+
+    每个会话持有自己的棋盘、落子历史、AI实例（含置换表/搜索树等缓存）、后台思考与状态锁；
+    规则引擎、评估器、存储、模型等只读资源取自SessionHost.resources，多个会话共用。
+    hosted为True时（服务端托管）对手落子后自动把AI回合排入宿主的有界线程池。
+    """
+    def __init__(self, host, session_id: str, event_manager: Optional[EventManager] = None, hosted: bool = False):
+        # 基础配置与工具
+        self.host = host
+        self.session_id = session_id
+        self.hosted = hosted
+        self.config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self._owns_event_manager = event_manager is None  # 自建的事件管理器（含分发线程）随会话关闭
+        self.event_manager = event_manager or EventManager()
+
+        # 共享只读组件
+        self.resources = host.resources
+        self.cpp_core = self.resources.cpp_core
+        self.data_utils = self.resources.data_utils
+        self.rule_engine = self.resources.rule_engine
+        self.model_manager = self.resources.model_manager
+        self.evaluator = self.resources.evaluator
+        self.board_analyzer = self.resources.board_analyzer
+        self.ranking_system = self.resources.ranking_system
+        self.user_storage = self.resources.user_storage
+        self.game_storage = self.resources.game_storage
+        self.ranking_storage = self.resources.ranking_storage
+
+        # 会话组件
+        self.mode_manager = GameModeManager(self)
+
+        # 游戏状态（线程安全；可重入：set_mode持锁调用reset_game）
+        self.state_lock = threading.RLock()
+        self.board_size = self.config.board_size
+        self.board = [[PIECE_COLORS['EMPTY'] for _ in range(self.board_size)] for _ in range(self.board_size)]
+        self.move_history = []  # 落子历史：[(x,y,color,is_ai,timestamp,score,quality)]
+        self.empty_count = self.board_size ** 2  # 剩余空位数（增量维护，用于判平局）
+        self.game_active = False
+        self.current_player = PIECE_COLORS['BLACK']
+        self.game_result = None  # 最终结果：{'winner': 'black/white/draw', 'win_line': [], 'ranking_update': {}}
+
+        # 模式配置
+        self.current_mode = None
+        self.ai_level = AI_LEVELS['HARD']
+        self.ai_type = 'rl+mcts'
+        self.ai_first = False
+        self.current_ai: Optional[BaseAI] = None
+        self.ai_team: Optional[AIFleet] = None
+        self.ponderer = Ponderer()  # 后台思考（PVE/ONLINE模式下对手回合继续搜索）
+        if hosted and not host.session_ponder:
+            self.ponderer.enabled = False  # 托管的大量会话不各自开后台思考线程
+        self._ai_future: Optional[Future] = None  # 在途的AI回合
+        self._ai_thinking_callback: Optional[Callable[[Dict], None]] = None
+        self._ai_future_lock = threading.Lock()
+
+        # 联机相关
+        self.is_online = False
+        self.online_client = None
+        self.online_sequencer = MoveSequencer()  # 联机落子序号（本局第几手），收到乱序/断档的增量时据此排序与重同步
+        self.current_room_id = None
+        self.online_opponent_id = None
+        self.online_opponent_name = None
+        self.online_callback: Optional[Callable[[Dict], None]] = None
+
+        # 训练相关
+        self.is_training = False
+        self.train_user_id = None
+        self.train_progress = 0.0  # 训练进度（0-100）
+
+        # 注册事件监听
+        self._register_events()
+
+    def _register_events(self):
+        """注册核心事件回调"""
+        self._event_handlers = (
+            ('game_start', self._on_game_start),
+            ('game_stop', self._on_game_stop),
+            ('move_made', self._on_move_made),
+            ('game_end', self._on_game_end),
+            ('model_saved', self._on_model_saved),
+            ('mode_changed', self._on_mode_changed)
+        )
+        for event_type, handler in self._event_handlers:
+            self.event_manager.register(event_type, handler)
+
+    # ------------------------------ 事件回调 ------------------------------
+    def _on_game_start(self, event: Event):
+        """游戏开始事件"""
+        self.logger.info(f"游戏启动：模式={self.current_mode}，AI类型={self.ai_type}，AI难度={self.ai_level}")
+        self.event_manager.emit(Event('ui_update', {
+            'type': 'game_start',
+            'data': {
+                'mode': self.current_mode,
+                'board_size': self.board_size,
+                'ai_first': self.ai_first,
+                'current_player': self.current_player
+            }
+        }))
+
+    def _on_game_stop(self, event: Event):
+        """游戏停止事件"""
+        self.game_active = False
+        self.ponderer.stop()
+        self.logger.info("游戏停止")
+        self.event_manager.emit(Event('ui_update', {'type': 'game_stop'}))
+
+    def _on_move_made(self, event: Event):
+        """落子事件"""
+        move_data = event.data
+        self.logger.info(f"落子记录：({move_data['x']},{move_data['y']})，颜色={move_data['color']}，AI={move_data['is_ai']}")
+        self.event_manager.emit(Event('ui_update', {'type': 'move_made', 'data': move_data}))
+
+    def _on_game_end(self, event: Event):
+        """游戏结束事件（异步分发时本局可能已被重置，记录一律取事件携带的快照）"""
+        result = {k: v for k, v in event.data.items() if k != 'move_history'}
+        history = event.data.get('move_history', self.move_history)
+        self.logger.info(f"游戏结束：结果={result}")
+
+        # 保存对战记录
+        self.game_storage.save_game_record({
+            'user_id': self.train_user_id,
+            'mode': self.current_mode,
+            'move_history': history,
+            'result': result,
+            'timestamp': time.time(),
+            'ai_level': self.ai_level,
+            'ai_type': self.ai_type
+        })
+
+        # 排行榜与复盘依赖本局的实时状态，本局已被重置则跳过
+        if history is self.move_history:
+            # 联机模式更新排行榜
+            if self.is_online and self.game_result and self.game_result['winner'] != 'draw':
+                self._update_online_ranking()
+
+            # 训练模式生成复盘报告
+            if self.current_mode == GAME_MODES['TRAIN']:
+                self._generate_replay_report()
+            result = self.game_result
+        else:
+            self.logger.warning("对局结束事件分发前已开始新局，跳过排行榜更新与复盘报告")
+
+        self.event_manager.emit(Event('ui_update', {'type': 'game_end', 'data': result}))
+
+    def _on_model_saved(self, event: Event):
+        """模型保存事件"""
+        model_data = event.data
+        self.logger.info(f"模型保存成功：路径={model_data['path']}")
+        self.event_manager.emit(Event('ui_update', {'type': 'model_saved', 'data': model_data}))
+
+    def _on_mode_changed(self, event: Event):
+        """模式切换事件"""
+        mode = event.data['mode']
+        self.logger.info(f"模式切换完成：{mode}")
+        self.event_manager.emit(Event('ui_update', {'type': 'mode_changed', 'data': {'mode': mode}}))
+
+    # ------------------------------ 核心逻辑 ------------------------------
+    def set_mode(self, mode: str, user_id: Optional[str] = None):
+        """设置游戏模式（线程安全）"""
+        with self.state_lock:
+            if mode not in GAME_MODES.values():
+                raise GameError(f"不支持的游戏模式：{mode}", 2001)
+
+            self.current_mode = mode
+            self.train_user_id = user_id
+            self.is_online = (mode == GAME_MODES['ONLINE'])
+            self.is_training = (mode == GAME_MODES['TRAIN'])
+
+            # 初始化对应模式组件
+            self.mode_manager.init_mode(mode)
+
+            # 重置游戏状态
+            self.reset_game()
+
+            # 触发模式切换事件（持状态锁发布：队列满时不等待）
+            self.event_manager.emit(Event('mode_changed', {'mode': mode}), block=False)
+
+    def reset_game(self):
+        """重置游戏状态"""
+        with self.state_lock:
+            self.board = [[PIECE_COLORS['EMPTY'] for _ in range(self.board_size)] for _ in range(self.board_size)]
+            self.move_history = []  # 换新列表：已发出的对局结束事件仍持有上一局的历史
+            self.empty_count = self.board_size ** 2
+            self.game_active = True
+            self.current_player = PIECE_COLORS['BLACK']
+            self.game_result = None
+            self.online_sequencer.reset()
+            self.ponderer.stop()
+            if self.current_ai:
+                self.current_ai.on_new_game()  # 清理AI跨回合保留的置换表等搜索状态
+
+            # AI先手逻辑（排入宿主的AI线程池）
+            if self.ai_first and self.current_ai:
+                self.request_ai_move()
+
+    def place_piece(self, x: int, y: int, is_ai: bool = False) -> str:
+        """玩家落子（含合法性校验）；托管会话在对手落子成功后自动调度AI回合"""
+        if not is_ai:
+            self.ponderer.stop()  # 对手落子：停止后台思考，搜索结果留给下一步AI落子复用
+        result = self._apply_move(x, y, is_ai)
+        if result == 'success' and not is_ai and self.hosted and self.current_ai \
+                and self.current_player == self.current_ai.color:
+            self.request_ai_move()
+        return result
+
+    def _apply_move(self, x: int, y: int, is_ai: bool, remote: bool = False) -> str:
+        """校验并执行一步落子（持状态锁）；remote为对手经网络同步来的落子，不再回发"""
+        with self.state_lock:
+            if not self.game_active:
+                return 'game_not_active'
+
+            # 规则校验（调用规则引擎）
+            valid, reason = self.rule_engine.validate_move(self.board, x, y, self.current_player)
+            if not valid:
+                self.logger.warning(f"落子失败：{reason}")
+                return reason
+
+            # 执行落子（C++核心加速）
+            self.board = self.cpp_core.place_piece(self.board, x, y, self.current_player)
+            self.empty_count -= 1
+
+            # 落子质量评估
+            eval_result = self.evaluator.analyze_move_quality(self.board, x, y, self.current_player)
+
+            # 记录落子历史
+            move_data = {
+                'x': x,
+                'y': y,
+                'color': self.current_player,
+                'is_ai': is_ai,
+                'timestamp': time.time(),
+                'score': eval_result['score'],
+                'quality': eval_result['quality'],
+                'pattern': eval_result['pattern']
+            }
+            self.move_history.append(move_data)
+            self.event_manager.emit(Event('move_made', move_data), block=False)
+
+            # 检查游戏结束（只检查过本次落子的四条线）
+            end_result = self.rule_engine.check_game_end_from(self.board, x, y, self.current_player, self.empty_count)
+            if end_result['is_end']:
+                self.game_result = {
+                    'winner': 'black' if end_result['winner'] == PIECE_COLORS['BLACK'] else 'white' if end_result['winner'] else 'draw',
+                    'win_line': end_result['win_line'],
+                    'move_count': len(self.move_history)
+                }
+                self.game_active = False
+                self.event_manager.emit(Event('game_end', {**self.game_result, 'move_history': self.move_history}),
+                                        block=False)
+                return 'game_end'
+
+            # 切换玩家
+            self.current_player = PIECE_COLORS['WHITE'] if self.current_player == PIECE_COLORS['BLACK'] else PIECE_COLORS['BLACK']
+
+            # 联机模式同步落子
+            if self.is_online and not remote:
+                self._sync_online_move(move_data)
+
+            return 'success'
+
+    def _sync_online_move(self, move_data: Dict):
+        """本方落子编码为带序号的增量帧发给对手（持状态锁调用，序号与落子顺序一致）"""
+        if self.online_client is None:
+            return
+        seq = self.online_sequencer.advance()
+        self.online_client.send_frame(encode_moves(seq, [move_data], self.board_size))
+
+    def apply_online_frame(self, message: Dict):
+        """应用对手发来的二进制帧（已由FrameDecoder解码）：增量按序号落子，快照整盘恢复，重同步请求回快照"""
+        msg_type = message.get('type')
+        with self.state_lock:
+            if msg_type == 'moves':
+                for move in self.online_sequencer.push(message['moves']):
+                    result = self._apply_move(move['x'], move['y'], is_ai=False, remote=True)
+                    if result not in ('success', 'game_end'):
+                        self.logger.warning(f"联机落子({move['x']},{move['y']})应用失败：{result}，请求重同步")
+                        self.online_client.send_frame(encode_resync(move['seq'] - 1))
+                        return
+                if self.online_sequencer.needs_resync:
+                    self.online_client.send_frame(encode_resync(self.online_sequencer.seq))
+            elif msg_type == 'snapshot':
+                self._load_snapshot(message)
+            elif msg_type == 'resync':
+                self.logger.info(f"对手请求重同步：对方序号{message['seq']}，本方序号{self.online_sequencer.seq}")
+                self.online_client.send_frame(encode_snapshot(self.board, self.online_sequencer.seq, self.current_player,
+                                                              (self.game_result or {}).get('win_line')))
+
+    def _load_snapshot(self, snapshot: Dict):
+        """用快照恢复局面与序号（快照不含落子顺序，之后的落子历史从恢复点继续记录）"""
+        with self.state_lock:
+            self.board = [row[:] for row in snapshot['board']]
+            self.board_size = len(self.board)
+            self.empty_count = sum(row.count(PIECE_COLORS['EMPTY']) for row in self.board)
+            self.current_player = snapshot['current_player']
+            self.online_sequencer.reset(snapshot['seq'])
+            self.logger.info(f"联机局面已按快照恢复：第{snapshot['seq']}手")
+        self.event_manager.emit(Event('ui_update', {
+            'type': 'board_resync',
+            'data': {'board': self.board, 'current_player': self.current_player, 'win_line': snapshot['win_line']}
+        }))
+
+    def ai_move(self, thinking_callback: Optional[Callable[[Dict], None]] = None) -> Tuple[int, int]:
+        """AI落子（支持多AI协同）"""
+        if not self.game_active or not self.current_ai:
+            raise GameError("AI落子失败：游戏未激活或AI未初始化", 2002)
+
+        if self.current_player != self.current_ai.color:
+            raise GameError("当前不是AI回合", 2003)
+        self.ponderer.stop()
+
+        # 单AI或多AI协同落子（AIFleet内部并发）
+        x, y = self.current_ai.move(self.board, thinking_callback)
+
+        # 执行落子，对局未结束时在对手思考期间后台搜索
+        result = self.place_piece(x, y, is_ai=True)
+        if result == 'success' and self.current_mode in (GAME_MODES['PVE'], GAME_MODES['ONLINE']):
+            self.ponderer.start(self.current_ai, self.board)
+        return (x, y)
+
+    def request_ai_move(self, thinking_callback: Optional[Callable[[Dict], None]] = None) -> Future:
+        """把AI回合排入宿主的有界线程池（已有在途回合时直接返回它）"""
+        with self._ai_future_lock:
+            if self._ai_future is None or self._ai_future.done():
+                self._ai_thinking_callback = thinking_callback
+                self._ai_future = self.host.submit_ai_turn(self)
+            return self._ai_future
+
+    def _run_ai_turn(self) -> Optional[Tuple[int, int]]:
+        """线程池中执行的AI回合（异常只记录，不影响其他会话）"""
+        try:
+            return self.ai_move(self._ai_thinking_callback)
+        except Exception as e:
+            self.logger.error(f"会话{self.session_id}AI落子失败：{str(e)}")
+            return None
+
+    def close(self):
+        """结束会话：停止后台思考，取消排队中的AI回合，让进行中的搜索尽快返回"""
+        with self.state_lock:
+            self.game_active = False
+        self.ponderer.stop()
+        with self._ai_future_lock:
+            future = self._ai_future
+        if future is not None and not future.cancel() and self.current_ai is not None:
+            self.current_ai.cancel()
+        if isinstance(self.current_ai, AIFleet):
+            self.current_ai.shutdown()
+        # 分发完已入队的事件（对局记录等）后注销回调；自建的分发线程一并停止，否则线程经回调一直持有整个会话
+        if self._owns_event_manager:
+            self.event_manager.stop()
+        for event_type, handler in self._event_handlers:
+            self.event_manager.unregister(event_type, handler)
+
+    # ------------------------------ 辅助功能 ------------------------------
+    def _update_online_ranking(self):
+        """更新联机对战排行榜（ELO积分）"""
+        try:
+            # 获取双方玩家信息
+            player1_id = self.train_user_id
+            player1_data = self.user_storage.load_user(player1_id)
+            if not player1_data:
+                raise GameError(f"用户数据不存在：{player1_id}", 3001)
+
+            player2_id = self.online_opponent_id
+            player2_data = self.user_storage.load_user(player2_id)
+            if not player2_data:
+                raise GameError(f"对手数据不存在：{player2_id}", 3002)
+
+            # 判断胜负
+            player1_win = (self.game_result['winner'] == 'black' and self.current_player == PIECE_COLORS['BLACK']) or \
+                          (self.game_result['winner'] == 'white' and self.current_player == PIECE_COLORS['WHITE'])
+
+            # 更新全球+本地排行榜
+            ranking_result = self.ranking_system.update_player_rating(
+                player1_id=player1_id,
+                player1_name=player1_data['nickname'],
+                player2_id=player2_id,
+                player2_name=player2_data['nickname'],
+                player1_win=player1_win,
+                is_global=True
+            )
+            self.ranking_system.update_player_rating(
+                player1_id=player1_id,
+                player1_name=player1_data['nickname'],
+                player2_id=player2_id,
+                player2_name=player2_data['nickname'],
+                player1_win=player1_win,
+                is_global=False
+            )
+
+            # 记录积分变化
+            self.game_result['ranking_update'] = {
+                'player1': ranking_result['player1'],
+                'player2': ranking_result['player2']
+            }
+
+        except Exception as e:
+            self.logger.error(f"更新排行榜失败：{str(e)}")
+
+    def _generate_replay_report(self):
+        """生成训练模式复盘报告"""
+        if not self.move_history:
+            return
+
+        # 分析落子质量统计
+        total_quality = sum(move['quality'] for move in self.move_history)
+        avg_quality = total_quality / len(self.move_history)
+        best_move = max(self.move_history, key=lambda x: x['quality'])
+        worst_move = min(self.move_history, key=lambda x: x['quality'])
+
+        # 棋型分布统计
+        pattern_counts = {}
+        for move in self.move_history:
+            pattern = move['pattern']
+            pattern_counts[pattern] = pattern_counts.get(pattern, 0) + 1
+
+        # 保存复盘报告
+        report = {
+            'game_id': f"replay_{self.train_user_id}_{int(time.time())}",
+            'timestamp': time.time(),
+            'move_count': len(self.move_history),
+            'result': self.game_result,
+            'avg_quality': round(avg_quality, 2),
+            'best_move': best_move,
+            'worst_move': worst_move,
+            'pattern_distribution': pattern_counts,
+            'ai_suggestions': self._get_ai_suggestions()
+        }
+
+        self.game_storage.save_replay_report(self.train_user_id, report)
+        self.logger.info(f"复盘报告生成完成：平均落子质量={avg_quality:.2f}")
+
+    def _get_ai_suggestions(self) -> List[Dict]:
+        """获取AI优化建议（针对低质量落子；复盘引擎按每步落子前的局面分析，逐步推送进度）"""
+        total = len(self.move_history)
+        done = [0]
+        done_lock = threading.Lock()
+
+        def on_ply(ply: Dict):
+            with done_lock:
+                done[0] += 1
+                finished = done[0]
+            self.event_manager.emit(Event('ui_update', {
+                'type': 'replay_progress',
+                'data': {'move_idx': ply['move_idx'], 'finished': finished, 'total': total, 'analysis': ply['move_quality']}
+            }))
+
+        plies = ReplayEngine(self.board_analyzer).analyze(self.move_history, len(self.board), on_ply)
+        suggestions = []
+        for idx, move in enumerate(self.move_history):
+            if move['quality'] < 60:  # 低质量落子（<60分）
+                x, y = move['x'], move['y']
+                # AI推荐的最优落子（该步落子前的局面）
+                best_move = plies[idx]['move_quality']['best_move']
+                suggestions.append({
+                    'move_idx': idx + 1,
+                    'bad_move': (x, y),
+                    'suggested_move': best_move,
+                    'quality': move['quality'],
+                    'reason': f"当前落子质量{move['quality']:.1f}分，建议落子{best_move}（质量分{plies[idx]['best_move_score']:.1f}）"
+                })
+        return suggestions
+
+    def load_ai_model(self, model_path: str):
+        """加载自定义AI模型"""
+        if self.ai_type == 'rl':
+            self.current_ai.load_model(model_path)
+        elif self.ai_type == 'nn':
+            self.current_ai = self.model_manager.load_model('nn', model_path, self.current_ai.color, self.ai_level)
+        self.logger.info(f"加载自定义模型：{model_path}")
+
+    def start_ai_training(self, num_games: int = 100):
+        """启动AI训练（仅训练模式）"""
+        if self.current_mode != GAME_MODES['TRAIN'] or not isinstance(self.current_ai, (RLAI, NNAI)):
+            raise GameError("仅训练模式支持AI训练，且AI类型需为RL或NN", 4001)
+
+        def train_worker():
+            self.is_training = True
+            self.train_progress = 0.0
+            for i in range(num_games):
+                self.current_ai.self_play(num_games=1)
+                self.train_progress = (i + 1) / num_games * 100
+                self.event_manager.emit(Event('ui_update', {
+                    'type': 'train_progress',
+                    'data': {'progress': self.train_progress, 'current_game': i + 1, 'total_games': num_games}
+                }))
+            self.is_training = False
+            self.logger.info(f"AI训练完成：{num_games}局自我对弈")
+            self.event_manager.emit(Event('ui_update', {'type': 'train_complete'}))
+
+        threading.Thread(target=train_worker, daemon=True).start()
\ No newline at end of file
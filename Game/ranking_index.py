@@ -0,0 +1,247 @@
+import os
+import json
+import random
+import threading
+from typing import Callable, Dict, List, Optional, Tuple, Iterator
+from Common.logger import Logger
+from Common.error_handler import StorageError
+
+class _SkipNode:
+    __slots__ = ('key', 'forward', 'width')
+
+    def __init__(self, key, level: int):
+        self.key = key
+        self.forward: List[Optional['_SkipNode']] = [None] * level
+        self.width: List[int] = [1] * level  # 每层到下一个节点跨过的元素数（尾部为到末尾的距离+1）
+
+class IndexableSkipList:
+    """带跨度的跳表（按键升序），插入/删除/按键求名次/按名次取元素均为O(log n)期望复杂度"""
+    MAX_LEVEL = 32
+
+    def __init__(self):
+        self.head = _SkipNode(None, self.MAX_LEVEL)
+        self.level = 1
+        self.size = 0
+
+    def __len__(self) -> int:
+        return self.size
+
+    def _random_level(self) -> int:
+        level = 1
+        while level < self.MAX_LEVEL and random.random() < 0.25:
+            level += 1
+        return level
+
+    def insert(self, key):
+        update = [self.head] * self.MAX_LEVEL
+        steps = [0] * self.MAX_LEVEL  # 各层update节点之前的元素数
+        node, pos = self.head, 0
+        for i in range(self.level - 1, -1, -1):
+            while node.forward[i] is not None and node.forward[i].key < key:
+                pos += node.width[i]
+                node = node.forward[i]
+            update[i], steps[i] = node, pos
+        level = self._random_level()
+        if level > self.level:
+            for i in range(self.level, level):
+                update[i], steps[i] = self.head, 0
+                self.head.width[i] = self.size + 1
+            self.level = level
+        new = _SkipNode(key, level)
+        for i in range(level):
+            prev = update[i]
+            new.forward[i] = prev.forward[i]
+            prev.forward[i] = new
+            new.width[i] = prev.width[i] - (pos - steps[i])
+            prev.width[i] = pos - steps[i] + 1
+        for i in range(level, self.level):
+            update[i].width[i] += 1
+        self.size += 1
+
+    def remove(self, key) -> bool:
+        update = [self.head] * self.MAX_LEVEL
+        node = self.head
+        for i in range(self.level - 1, -1, -1):
+            while node.forward[i] is not None and node.forward[i].key < key:
+                node = node.forward[i]
+            update[i] = node
+        target = node.forward[0]
+        if target is None or target.key != key:
+            return False
+        for i in range(self.level):
+            if update[i].forward[i] is target:
+                update[i].width[i] += target.width[i] - 1
+                update[i].forward[i] = target.forward[i]
+            else:
+                update[i].width[i] -= 1
+        while self.level > 1 and self.head.forward[self.level - 1] is None:
+            self.level -= 1
+        self.size -= 1
+        return True
+
+    def rank(self, key) -> int:
+        """key的名次（从1开始，key须在表中）"""
+        node, pos = self.head, 0
+        for i in range(self.level - 1, -1, -1):
+            while node.forward[i] is not None and node.forward[i].key <= key:
+                pos += node.width[i]
+                node = node.forward[i]
+        return pos
+
+    def slice(self, start: int, count: int) -> Iterator:
+        """顺序第start(从0开始)个起的count个键"""
+        if start >= self.size or count <= 0:
+            return
+        node, pos, target = self.head, 0, start + 1
+        for i in range(self.level - 1, -1, -1):
+            while node.forward[i] is not None and pos + node.width[i] <= target:
+                pos += node.width[i]
+                node = node.forward[i]
+        while node is not None and count > 0:
+            yield node.key
+            node = node.forward[0]
+            count -= 1
+
+class RankingIndex:
+    """索引化的排行榜存储（全球/本地各一个实例）
+
+    - 内存中user_id哈希索引 + 按(-积分, user_id)排序的带跨度跳表：单个玩家更新、名次查询、分页取前N均为O(log n)；
+    - 持久化为快照文件 + 追加日志：每次更新只在日志末尾追加涉及的玩家记录（JSON行），
+      日志条数超过compact_threshold（且不少于玩家数）时重写快照并清空日志；
+    - 启动时加载快照再重放日志，日志末尾写了一半的行直接丢弃。名次不落盘，读取时由跳表计算。
+    """
+    def __init__(self, directory: str, name: str, compact_threshold: int = 10000):
+        self.logger = Logger.get_instance()
+        self.name = name
+        self.snapshot_path = os.path.join(directory, f"{name}_ranking.jsonl")
+        self.log_path = os.path.join(directory, f"{name}_ranking.log")
+        self.compact_threshold = compact_threshold
+        self.players: Dict[str, Dict] = {}
+        self.order = IndexableSkipList()
+        self._log_entries = 0
+        self._log_file = None
+        self._lock = threading.RLock()
+        os.makedirs(directory, exist_ok=True)
+        self._load()
+
+    @staticmethod
+    def _key(player: Dict) -> Tuple[int, str]:
+        return (-player['score'], player['user_id'])
+
+    @property
+    def exists(self) -> bool:
+        """磁盘上是否已有该排行榜（用于判断是否需要从旧存储迁移）"""
+        return os.path.exists(self.snapshot_path) or os.path.exists(self.log_path)
+
+    def __len__(self) -> int:
+        return len(self.players)
+
+    # ------------------------------ 读写 ------------------------------
+    def get(self, user_id: str) -> Optional[Dict]:
+        """玩家数据副本（含当前名次）"""
+        with self._lock:
+            player = self.players.get(user_id)
+            if player is None:
+                return None
+            return dict(player, rank=self.order.rank(self._key(player)))
+
+    def rank(self, user_id: str) -> int:
+        """玩家名次（不在榜上返回0）"""
+        with self._lock:
+            player = self.players.get(user_id)
+            return self.order.rank(self._key(player)) if player else 0
+
+    def page(self, offset: int = 0, limit: int = 10) -> List[Dict]:
+        """按名次分页（offset从0开始），每项带rank"""
+        with self._lock:
+            return [dict(self.players[user_id], rank=offset + i + 1)
+                    for i, (_, user_id) in enumerate(self.order.slice(offset, limit))]
+
+    def upsert(self, players: List[Dict]):
+        """插入或更新若干玩家（同一批写入日志的同一次追加）"""
+        with self._lock:
+            lines = []
+            for player in players:
+                player = {k: v for k, v in player.items() if k != 'rank'}
+                self._apply(player)
+                lines.append(json.dumps(player, ensure_ascii=False))
+            self._append_log(lines)
+
+    def update(self, user_ids: List[str], fn: Callable[[List[Optional[Dict]]], List[Dict]]) -> List[Dict]:
+        """原子读-改-写：持锁取出这些玩家的数据副本（不存在为None）交给fn，写入fn返回的玩家并返回它们（带新名次）
+
+        并发结束的对局涉及同一玩家时，逐个get再upsert会丢失其中一次更新；fn在锁内执行，不应做耗时操作。
+        """
+        with self._lock:
+            players = fn([self.get(user_id) for user_id in user_ids])
+            self.upsert(players)
+            return [dict(player, rank=self.rank(player['user_id'])) for player in players]
+
+    def import_players(self, players: List[Dict]):
+        """整批导入（旧版整表存储迁移），直接写成快照"""
+        with self._lock:
+            for player in players:
+                self._apply({k: v for k, v in player.items() if k != 'rank'})
+            self.compact()
+
+    # ------------------------------ 持久化 ------------------------------
+    def _apply(self, player: Dict):
+        old = self.players.get(player['user_id'])
+        if old is not None:
+            self.order.remove(self._key(old))
+        self.players[player['user_id']] = player
+        self.order.insert(self._key(player))
+
+    def _load(self):
+        for path, is_log in ((self.snapshot_path, False), (self.log_path, True)):
+            if not os.path.exists(path):
+                continue
+            with open(path, 'r', encoding='utf-8') as f:
+                for line in f:
+                    try:
+                        player = json.loads(line)
+                    except ValueError:
+                        self.logger.warning(f"{self.name}排行榜{'日志' if is_log else '快照'}存在损坏记录，已跳过")
+                        continue
+                    self._apply(player)
+                    if is_log:
+                        self._log_entries += 1
+        if self.players:
+            self.logger.info(f"{self.name}排行榜加载完成：{len(self.players)}名玩家，待合并日志{self._log_entries}条")
+
+    def _append_log(self, lines: List[str]):
+        try:
+            if self._log_file is None:
+                self._log_file = open(self.log_path, 'a', encoding='utf-8')
+            self._log_file.write(''.join(line + '\n' for line in lines))
+            self._log_file.flush()
+        except OSError as e:
+            raise StorageError(f"{self.name}排行榜日志写入失败：{str(e)}", 6004)
+        self._log_entries += len(lines)
+        if self._log_entries >= max(self.compact_threshold, len(self.players)):
+            self.compact()
+
+    def compact(self):
+        """重写快照（先写临时文件再原子替换），清空追加日志"""
+        with self._lock:
+            tmp_path = self.snapshot_path + '.tmp'
+            try:
+                with open(tmp_path, 'w', encoding='utf-8') as f:
+                    for _, user_id in self.order.slice(0, len(self.order)):
+                        f.write(json.dumps(self.players[user_id], ensure_ascii=False) + '\n')
+                os.replace(tmp_path, self.snapshot_path)
+                if self._log_file is not None:
+                    self._log_file.close()
+                    self._log_file = None
+                if os.path.exists(self.log_path):
+                    os.remove(self.log_path)
+            except OSError as e:
+                raise StorageError(f"{self.name}排行榜快照写入失败：{str(e)}", 6004)
+            self.logger.info(f"{self.name}排行榜合并完成：{len(self.players)}名玩家（合并日志{self._log_entries}条）")
+            self._log_entries = 0
+
+    def close(self):
+        with self._lock:
+            if self._log_file is not None:
+                self._log_file.close()
+                self._log_file = None
@@ -1,11 +1,23 @@
+import os
 import math
-from typing import List, Dict, Optional
+import threading
+from typing import List, Dict, Optional, Tuple
+from Common.config import Config
 from Common.logger import Logger
 from Storage.ranking_storage import RankingStorage
+from Game.ranking_index import RankingIndex
 
 class ELORankingSystem:
-    """ELO积分排名系统（参考国际象棋规则，支持本地/全球排名）"""
+    """ELO积分排名系统（参考国际象棋规则，支持本地/全球排名）
+
+    排行榜数据在进程内按全球/本地各共享一个RankingIndex（哈希索引+跳表，追加日志持久化），
+    每局结算只更新两名玩家，不再整表读写。首次使用时从旧版RankingStorage的整表数据迁移。
+    """
+    _indexes: Dict[bool, RankingIndex] = {}
+    _indexes_lock = threading.Lock()
+
     def __init__(self):
+        self.config = Config.get_instance()
         self.logger = Logger.get_instance()
         self.ranking_storage = RankingStorage()
         self.base_rating = 1500  # 初始积分
@@ -13,6 +25,24 @@ class ELORankingSystem:
         self.k_factor_new = 40  # 新玩家系数（前20局）
         self.k_factor_master = 24  # 大师系数（积分≥2000）
 
+    def _index(self, is_global: bool) -> RankingIndex:
+        """全球/本地排行榜索引（进程内单例，首次打开时迁移旧数据）"""
+        index = self._indexes.get(is_global)
+        if index is None:
+            with self._indexes_lock:
+                index = self._indexes.get(is_global)
+                if index is None:
+                    ranking_dir = self.config.get('PATH', 'ranking_dir', os.path.join(os.getcwd(), 'data', 'ranking'))
+                    index = RankingIndex(ranking_dir, 'global' if is_global else 'local',
+                                         self.config.get_int('GAME', 'ranking_compact_threshold', 10000))
+                    if not index.exists:
+                        legacy = self.ranking_storage.load_global_ranking() if is_global else self.ranking_storage.load_local_ranking()
+                        if legacy:
+                            index.import_players(legacy)
+                            self.logger.info(f"{'全球' if is_global else '本地'}排行榜已从旧存储迁移：{len(legacy)}名玩家")
+                    self._indexes[is_global] = index
+        return index
+
     def calculate_new_ratings(self, player1_rating: int, player2_rating: int, player1_win: bool, player1_games: int, player2_games: int) -> Tuple[int, int]:
         """计算对战后双方新积分（动态K因子）"""
         # 动态K因子（根据对局数和当前积分调整）
@@ -34,68 +64,52 @@ class ELORankingSystem:
         return new_rating1, new_rating2
 
     def update_player_rating(self, player1_id: str, player1_name: str, player2_id: str, player2_name: str, player1_win: bool, is_global: bool = False) -> Dict:
-        """更新玩家积分并返回排名结果"""
-        # 加载排行榜数据
-        ranking = self.ranking_storage.load_global_ranking() if is_global else self.ranking_storage.load_local_ranking()
-        ranking = ranking or []
-
-        # 获取玩家当前数据
-        player1_data = next((p for p in ranking if p['user_id'] == player1_id), None)
-        player2_data = next((p for p in ranking if p['user_id'] == player2_id), None)
-
-        # 初始化新玩家数据
-        if not player1_data:
-            player1_data = self._init_player_data(player1_id, player1_name)
-        if not player2_data:
-            player2_data = self._init_player_data(player2_id, player2_name)
-
-        # 计算新积分
-        new_rating1, new_rating2 = self.calculate_new_ratings(
-            player1_rating=player1_data['score'],
-            player2_rating=player2_data['score'],
-            player1_win=player1_win,
-            player1_games=player1_data['total_games'],
-            player2_games=player2_data['total_games']
-        )
-
-        # 更新对战统计
-        self._update_player_stats(player1_data, player1_win)
-        self._update_player_stats(player2_data, not player1_win if player1_win is not None else None)
-
-        # 更新积分和最后活跃时间
-        player1_data['score'] = new_rating1
-        player2_data['score'] = new_rating2
-        player1_data['last_update'] = self._get_current_time()
-        player2_data['last_update'] = self._get_current_time()
-
-        # 更新排行榜
-        ranking = self._upsert_player(ranking, player1_data)
-        ranking = self._upsert_player(ranking, player2_data)
-
-        # 保存排行榜
-        if is_global:
-            self.ranking_storage.save_global_ranking(ranking)
-        else:
-            self.ranking_storage.save_local_ranking(ranking)
-
-        # 获取最终排名
-        player1_final = next(p for p in ranking if p['user_id'] == player1_id)
-        player2_final = next(p for p in ranking if p['user_id'] == player2_id)
+        """更新玩家积分并返回排名结果（O(log n)：只读写两名玩家的索引项）"""
+        index = self._index(is_global)
+        old_ratings = []
+
+        def apply(players: List[Optional[Dict]]) -> List[Dict]:
+            # 获取玩家当前数据（新玩家初始化）
+            player1_data = players[0] or self._init_player_data(player1_id, player1_name)
+            player2_data = players[1] or self._init_player_data(player2_id, player2_name)
+            old_ratings.extend((player1_data['score'], player2_data['score']))
+
+            # 计算新积分
+            new_rating1, new_rating2 = self.calculate_new_ratings(
+                player1_rating=old_ratings[0],
+                player2_rating=old_ratings[1],
+                player1_win=player1_win,
+                player1_games=player1_data['total_games'],
+                player2_games=player2_data['total_games']
+            )
+
+            # 更新对战统计
+            self._update_player_stats(player1_data, player1_win)
+            self._update_player_stats(player2_data, not player1_win if player1_win is not None else None)
+
+            # 更新积分和最后活跃时间
+            player1_data['score'] = new_rating1
+            player2_data['score'] = new_rating2
+            player1_data['last_update'] = self._get_current_time()
+            player2_data['last_update'] = self._get_current_time()
+            return [player1_data, player2_data]
+
+        # 读取、计算与写入索引在同一次持锁内完成（并发结束的对局不会互相覆盖），同一条追加日志，返回带最终排名
+        player1_data, player2_data = index.update([player1_id, player2_id], apply)
+        old_rating1, old_rating2 = old_ratings
+        new_rating1, new_rating2 = player1_data['score'], player2_data['score']
 
         return {
-            'player1': self._format_player_ranking(player1_final, player1_data['score'], new_rating1),
-            'player2': self._format_player_ranking(player2_final, player2_data['score'], new_rating2),
+            'player1': self._format_player_ranking(player1_data, old_rating1, new_rating1),
+            'player2': self._format_player_ranking(player2_data, old_rating2, new_rating2),
             'is_global': is_global,
-            'total_players': len(ranking)
+            'total_players': len(index)
         }
 
     def get_player_ranking(self, user_id: str, is_global: bool = False) -> Optional[Dict]:
         """获取单个玩家的排名信息"""
-        ranking = self.ranking_storage.load_global_ranking() if is_global else self.ranking_storage.load_local_ranking()
-        if not ranking:
-            return None
-
-        player = next((p for p in ranking if p['user_id'] == user_id), None)
+        index = self._index(is_global)
+        player = index.get(user_id)
         if not player:
             self.logger.warning(f"玩家{user_id}未在{'全球' if is_global else '本地'}排行榜中")
             return None
@@ -116,22 +130,17 @@ class ELORankingSystem:
             'win_rate': round(win_rate * 100, 2),
             'last_update': player['last_update'],
             'is_global': is_global,
-            'total_players': len(ranking)
+            'total_players': len(index)
         }
 
-    def get_ranking_list(self, top_n: int = 10, is_global: bool = False) -> List[Dict]:
-        """获取排行榜前N名"""
-        ranking = self.ranking_storage.load_global_ranking() if is_global else self.ranking_storage.load_local_ranking()
-        if not ranking:
-            return []
-
-        # 截取前N名并格式化
+    def get_ranking_list(self, top_n: int = 10, is_global: bool = False, offset: int = 0) -> List[Dict]:
+        """获取排行榜第offset+1名起的top_n名（分页）"""
         top_ranking = []
-        for i, player in enumerate(ranking[:top_n]):
+        for player in self._index(is_global).page(offset, top_n):
             total_games = player['win_count'] + player['lose_count'] + player['draw_count']
             win_rate = player['win_count'] / total_games if total_games > 0 else 0.0
             top_ranking.append({
-                'rank': i + 1,
+                'rank': player['rank'],
                 'name': player['name'],
                 'user_id': player['user_id'],
                 'score': player['score'],
@@ -144,6 +153,10 @@ class ELORankingSystem:
 
         return top_ranking
 
+    def get_total_players(self, is_global: bool = False) -> int:
+        """排行榜玩家总数（分页用）"""
+        return len(self._index(is_global))
+
     # ------------------------------ 辅助方法 ------------------------------
     def _get_k_factor(self, rating: int, game_count: int) -> int:
         """获取动态K因子"""
@@ -178,18 +191,6 @@ class ELORankingSystem:
         else:
             player_data['lose_count'] += 1
 
-    def _upsert_player(self, ranking: List[Dict], player_data: Dict) -> List[Dict]:
-        """插入或更新玩家排名"""
-        # 移除旧数据
-        ranking = [p for p in ranking if p['user_id'] != player_data['user_id']]
-        # 添加新数据
-        ranking.append(player_data)
-        # 按积分降序排序并更新排名
-        ranking.sort(key=lambda x: x['score'], reverse=True)
-        for i, p in enumerate(ranking):
-            p['rank'] = i + 1
-        return ranking
-
     def _format_player_ranking(self, player: Dict, old_rating: int, new_rating: int) -> Dict:
         """格式化玩家排名结果"""
         return {
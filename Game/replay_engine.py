@@ -0,0 +1,84 @@
+import threading
+from concurrent.futures import ThreadPoolExecutor
+from typing import List, Dict, Optional, Callable
+from Common.constants import PIECE_COLORS
+from Common.config import Config
+from Common.logger import Logger
+
+class ReplayEngine:
+    """复盘引擎（整局只在增量棋盘上重放一次，逐步分析分块派给线程池，每步完成即回调）
+
+    每个工作线程持有一块自己的搜索棋盘，按对局顺序领取连续的若干步：领到新块时只把自己的棋盘
+    向前补走到块首（make_move），块内每分析完一步再落下这一步，棋型计数与双方评分在相邻两步之间增量复用。
+    候选点扫描（scan_candidates）在C++中释放GIL，多块可真正并行。
+    """
+    def __init__(self, analyzer, workers: Optional[int] = None, block_size: Optional[int] = None):
+        config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self.analyzer = analyzer
+        self.workers = workers or config.get_int('GAME', 'replay_workers', 4)
+        self.block_size = block_size or config.get_int('GAME', 'replay_block_size', 8)  # 每个任务连续分析的步数
+
+    def analyze(self, move_history: List[Dict], board_size: int,
+                on_ply: Optional[Callable[[Dict], None]] = None) -> List[Dict]:
+        """逐步分析整局，返回按步序排列的结果；on_ply在工作线程中调用（每步一次，完成顺序不保证）"""
+        moves = [(move['x'], move['y'], move['color']) for move in move_history]
+        results: List[Optional[Dict]] = [None] * len(moves)
+        local = threading.local()
+        empty_board = [[PIECE_COLORS['EMPTY']] * board_size for _ in range(board_size)]
+
+        def run_block(start: int):
+            # 线程自己的棋盘：只会沿对局前进，补走到块首即可
+            if not hasattr(local, 'board'):
+                local.board = self.analyzer.cpp_core.create_search_board(empty_board)
+            search_board = local.board
+            while search_board.move_count() < start:
+                x, y, color = moves[search_board.move_count()]
+                search_board.make_move(x, y, color)
+            for idx in range(start, min(start + self.block_size, len(moves))):
+                results[idx] = self._analyze_ply(search_board, idx, moves[idx])
+                if on_ply:
+                    on_ply(results[idx])
+                x, y, color = moves[idx]
+                search_board.make_move(x, y, color)
+
+        blocks = range(0, len(moves), self.block_size)
+        if self.workers <= 1 or len(blocks) <= 1:
+            for start in blocks:
+                run_block(start)
+        else:
+            with ThreadPoolExecutor(max_workers=self.workers) as executor:
+                for future in [executor.submit(run_block, start) for start in blocks]:
+                    future.result()
+        return results
+
+    def _analyze_ply(self, search_board, idx: int, move) -> Dict:
+        """单步分析（search_board为该步落子前的局面）：落子质量、局势威胁、落子方的最优替代"""
+        x, y, color = move
+        black_scan = search_board.scan_candidates(PIECE_COLORS['BLACK'])
+        white_scan = search_board.scan_candidates(PIECE_COLORS['WHITE'])
+        mover_scan = black_scan if color == PIECE_COLORS['BLACK'] else white_scan
+        quality_info = self.analyzer.move_quality(search_board, x, y, color, mover_scan)
+        situation = self.analyzer.board_situation(search_board, black_scan, white_scan)
+        _, _, best_move_score = self.analyzer._best_from_scan(mover_scan)
+        return {
+            'move_idx': idx + 1,
+            'move_quality': {
+                'move_idx': idx + 1,
+                'x': x,
+                'y': y,
+                'color': color,
+                'quality': quality_info['quality'],
+                'pattern': quality_info['pattern'],
+                'best_move': quality_info['best_move'],
+                'quality_gap': quality_info['quality_gap']
+            },
+            'threats': {
+                'move_idx': idx + 1,
+                'black_threats': len(situation['black_threats']),
+                'white_threats': len(situation['white_threats']),
+                'situation': situation['situation']
+            },
+            'best_move_score': best_move_score,  # 最优替代落子的evaluate_move得分
+            'situation': situation
+        }
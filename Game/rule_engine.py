@@ -1,4 +1,4 @@
-from typing import List, Tuple, Dict
+from typing import List, Tuple, Dict, Optional
 from Common.constants import PIECE_COLORS
 from Common.logger import Logger
 from Compute.cpp_interface import CppCore
@@ -83,6 +83,35 @@ class RuleEngine:
 
         return {'is_end': False, 'winner': 0, 'win_line': []}
 
+    def check_game_end_from(self, board: List[List[int]], x: int, y: int, color: int, empty_count: Optional[int] = None) -> Dict:
+        """增量检查游戏结束（只看过最后落子(x,y)的四条线，每条最多9格）
+
+        empty_count为落子后的剩余空位数（由调用方维护），为None时退化为全盘计数
+        """
+        # 优先使用C++核心判断（高效）
+        if self.cpp_core:
+            return self.cpp_core.check_game_end_from(board, x, y, color, empty_count)
+
+        # Python降级判断（备用）
+        for dx, dy in [(0, 1), (1, 0), (1, 1), (1, -1)]:
+            run = []
+            for k in range(-4, 5):
+                nx, ny = x + k * dx, y + k * dy
+                if 0 <= nx < self.board_size and 0 <= ny < self.board_size and (k == 0 or board[nx][ny] == color):
+                    run.append((nx, ny))
+                    if len(run) == 5:
+                        return {'is_end': True, 'winner': color, 'win_line': run}
+                else:
+                    run = []
+
+        # 检查平局（无剩余空位）
+        if empty_count is None:
+            empty_count = sum(row.count(PIECE_COLORS['EMPTY']) for row in board)
+        if empty_count <= 0:
+            return {'is_end': True, 'winner': 0, 'win_line': []}
+
+        return {'is_end': False, 'winner': 0, 'win_line': []}
+
     def is_valid_board(self, board: List[List[int]]) -> Tuple[bool, str]:
         """校验棋盘状态合法性（用于联机同步校验）"""
         # 检查棋盘尺寸
@@ -0,0 +1,133 @@
+import uuid
+import threading
+from concurrent.futures import ThreadPoolExecutor, Future
+from typing import Dict, List, Optional, Callable
+from Common.config import Config
+from Common.logger import Logger
+from Common.data_utils import DataUtils
+from Common.error_handler import GameError
+from Common.event import EventManager
+from Common.metrics import SearchMetrics
+from AI.base_ai import BaseAI
+from AI.minimax_ai import MinimaxAI
+from AI.model_manager import ModelManager
+from AI.evaluator import BoardEvaluator
+from AI.opening_book import OpeningBook
+from Storage.user_storage import UserStorage
+from Storage.game_record_storage import GameRecordStorage
+from Storage.ranking_storage import RankingStorage
+from Compute.cpp_interface import CppCore
+from Game.rule_engine import RuleEngine
+from Game.board_analyzer import BoardAnalyzer
+from Game.ranking_system import ELORankingSystem
+
+class SharedResources:
+    """会话间共享的只读资源（规则引擎、评估器棋型表、复盘分析器、存储接口、开局库、已加载的模型）
+
+    这些组件都不保存对局状态，多个会话并发调用是安全的。AI每个会话新建一个实例（训练状态、运行标志、
+    评估器等都是会话自己的）；RL/NN的网络权重经ModelRegistry进程内共享，同一网络共用一个批量推理服务。
+    """
+
+    def __init__(self):
+        self.config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        board_size = self.config.board_size
+        self.cpp_core = CppCore()
+        self.data_utils = DataUtils()
+        self.rule_engine = RuleEngine(board_size)
+        self.evaluator = BoardEvaluator(board_size)
+        self.board_analyzer = BoardAnalyzer(board_size)
+        self.ranking_system = ELORankingSystem()
+        self.model_manager = ModelManager()
+        self.user_storage = UserStorage()
+        self.game_storage = GameRecordStorage()
+        self.ranking_storage = RankingStorage()
+        self.opening_book = OpeningBook.get_instance(board_size)
+
+    def create_ai(self, factory: Callable[[int, str], BaseAI], color: int, level: str,
+                  tt_size_mb: Optional[int] = None) -> BaseAI:
+        """创建会话用AI：Minimax按tt_size_mb分配会话自己的置换表；其余类型直接新建（模型类AI的权重由注册表共享）"""
+        if factory is MinimaxAI and tt_size_mb:
+            return MinimaxAI(color, level, tt=self.cpp_core.create_transposition_table(tt_size_mb))
+        return factory(color, level)
+
+class SessionHost:
+    """会话宿主（单进程托管大量并发对局）
+
+    每局一个GameSession（独立棋盘/历史/AI/锁），共享只读资源；AI回合统一提交到有界线程池执行，
+    不再每步新开线程。桌面端的GameCore是挂在默认宿主上的一个本地会话。
+    """
+    _instance = None
+    _instance_lock = threading.Lock()
+
+    def __init__(self, max_sessions: Optional[int] = None, ai_workers: Optional[int] = None):
+        self.config = Config.get_instance()
+        self.logger = Logger.get_instance()
+        self.max_sessions = max_sessions or self.config.get_int('GAME', 'max_sessions', 500)
+        self.ai_workers = ai_workers or self.config.get_int('GAME', 'session_ai_workers', 8)
+        self.session_tt_size_mb = self.config.get_int('GAME', 'session_tt_size_mb', 8)  # 托管会话的Minimax置换表
+        self.session_ponder = self.config.get_bool('GAME', 'session_ponder', False)  # 托管会话是否后台思考
+        self.resources = SharedResources()
+        self.sessions: Dict[str, 'GameSession'] = {}
+        self._sessions_lock = threading.Lock()
+        self.ai_pool = ThreadPoolExecutor(max_workers=self.ai_workers, thread_name_prefix='ai_turn')
+        SearchMetrics.get_instance().start_server()  # [SERVER] METRICS_PORT为0时不启动
+
+    @classmethod
+    def get_instance(cls) -> 'SessionHost':
+        """进程默认宿主（桌面端GameCore与服务端共用）"""
+        if cls._instance is None:
+            with cls._instance_lock:
+                if cls._instance is None:
+                    cls._instance = cls()
+        return cls._instance
+
+    def create_session(self, mode: str, user_id: Optional[str] = None, ai_type: Optional[str] = None,
+                       ai_level: Optional[str] = None, ai_first: bool = False,
+                       event_manager: Optional[EventManager] = None) -> 'GameSession':
+        """新建并开始一局托管对局（AI回合自动调度）"""
+        from Game.game_session import GameSession
+        with self._sessions_lock:
+            if len(self.sessions) >= self.max_sessions:
+                raise GameError(f"会话数已达上限：{self.max_sessions}", 2004)
+            session = GameSession(self, uuid.uuid4().hex, event_manager, hosted=True)
+            self.sessions[session.session_id] = session
+        if ai_type:
+            session.ai_type = ai_type
+        if ai_level:
+            session.ai_level = ai_level
+        session.ai_first = ai_first
+        session.set_mode(mode, user_id)
+        self.logger.info(f"创建会话：{session.session_id}，模式={mode}，当前会话数{len(self.sessions)}")
+        return session
+
+    def register(self, session: 'GameSession'):
+        """登记外部创建的会话（GameCore本地会话）"""
+        with self._sessions_lock:
+            self.sessions[session.session_id] = session
+
+    def get_session(self, session_id: str) -> Optional['GameSession']:
+        with self._sessions_lock:
+            return self.sessions.get(session_id)
+
+    def list_sessions(self) -> List[str]:
+        with self._sessions_lock:
+            return list(self.sessions)
+
+    def close_session(self, session_id: str):
+        """结束并移除会话（停止后台思考，释放会话私有的AI状态）"""
+        with self._sessions_lock:
+            session = self.sessions.pop(session_id, None)
+        if session is not None:
+            session.close()
+            self.logger.info(f"关闭会话：{session_id}，剩余会话数{len(self.sessions)}")
+
+    def submit_ai_turn(self, session: 'GameSession') -> Future:
+        """把一次AI落子排入有界线程池（同一会话同一时刻只会有一个AI回合在途）"""
+        return self.ai_pool.submit(session._run_ai_turn)
+
+    def shutdown(self):
+        """关闭全部会话与AI线程池"""
+        for session_id in self.list_sessions():
+            self.close_session(session_id)
+        self.ai_pool.shutdown(wait=True)
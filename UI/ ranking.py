@@ -25,17 +25,35 @@ class RankingPanel:
         self.switch_btn = pygame.Rect(x + width - 120, y + 10, 100, 30)
         # 刷新按钮
         self.refresh_btn = pygame.Rect(x + 20, y + 10, 80, 30)
+        # 翻页（每页page_size名，按名次从索引分页读取）
+        self.page_size = 10
+        self.page = 0
+        self.total_players = 0
+        self.prev_btn = pygame.Rect(x + 20, y + height - 45, 80, 30)
+        self.next_btn = pygame.Rect(x + width - 100, y + height - 45, 80, 30)
 
     def load_ranking(self):
         """加载排行榜数据（对接ELORankingSystem）"""
+        is_global = (self.rank_type == 'global')
+        self.total_players = self.ranking_system.get_total_players(is_global)
         self.rank_list = self.ranking_system.get_ranking_list(
-            top_n=10,
-            is_global=(self.rank_type == 'global')
+            top_n=self.page_size,
+            is_global=is_global,
+            offset=self.page * self.page_size
         )
 
+    def change_page(self, delta: int):
+        """翻页（越界时停在首页/末页）"""
+        last_page = max((self.total_players - 1) // self.page_size, 0)
+        page = max(0, min(self.page + delta, last_page))
+        if page != self.page:
+            self.page = page
+            self.load_ranking()
+
     def switch_rank_type(self):
         """切换本地/全球排行榜"""
         self.rank_type = 'global' if self.rank_type == 'local' else 'local'
+        self.page = 0
         self.load_ranking()
 
     def draw_header(self, surface: pygame.Surface):
@@ -71,7 +89,8 @@ class RankingPanel:
             bg_color = (*COLORS['PANEL_BG'], 150) if i % 2 == 0 else (*COLORS['PANEL_BG'], 100)
             pygame.draw.rect(surface, bg_color, (self.x + 20, y_pos, self.width - 40, item_height - 5), border_radius=3)
             # 排名（前3名特殊颜色）
-            rank_color = COLORS['GOLD'] if i == 0 else COLORS['SILVER'] if i == 1 else COLORS['BRONZE'] if i == 2 else COLORS['TEXT_LIGHT']
+            rank = item['rank']
+            rank_color = COLORS['GOLD'] if rank == 1 else COLORS['SILVER'] if rank == 2 else COLORS['BRONZE'] if rank == 3 else COLORS['TEXT_LIGHT']
             rank_text = self.fonts['rank'].render(f"{item['rank']}", True, rank_color)
             surface.blit(rank_text, (self.x + 25, y_pos + 5))
             # 昵称
@@ -90,6 +109,21 @@ class RankingPanel:
             self.switch_rank_type()
         elif self.refresh_btn.collidepoint(pos):
             self.load_ranking()
+        elif self.prev_btn.collidepoint(pos):
+            self.change_page(-1)
+        elif self.next_btn.collidepoint(pos):
+            self.change_page(1)
+
+    def draw_pager(self, surface: pygame.Surface):
+        """绘制翻页按钮与页码"""
+        last_page = max((self.total_players - 1) // self.page_size, 0)
+        for rect, label in ((self.prev_btn, "上一页"), (self.next_btn, "下一页")):
+            pygame.draw.rect(surface, COLORS['BUTTON'], rect, border_radius=3)
+            pygame.draw.rect(surface, COLORS['BUTTON_BORDER'], rect, width=2, border_radius=3)
+            text = self.fonts['small'].render(label, True, COLORS['TEXT_DARK'])
+            surface.blit(text, (rect.x + 18, rect.y + 7))
+        page_text = self.fonts['small'].render(f"{self.page + 1}/{last_page + 1}（共{self.total_players}人）", True, COLORS['TEXT_LIGHT'])
+        surface.blit(page_text, (self.x + self.width // 2 - 50, self.prev_btn.y + 7))
 
     def draw(self, surface: pygame.Surface):
         """绘制完整排行榜"""
@@ -99,6 +133,7 @@ class RankingPanel:
         # 绘制表头和条目
         self.draw_header(surface)
         self.draw_rank_items(surface)
+        self.draw_pager(surface)
         # 首次加载数据
         if not self.rank_list:
             self.load_ranking()
\ No newline at end of file
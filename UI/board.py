@@ -156,4 +156,19 @@ class Board:
         self.win_line = []
         self.animating = False
         self.animation_piece = None
-        self.game_core.reset_game()
\ No newline at end of file
+        self.game_core.reset_game()
+    def show_piece(self, board_x: int, board_y: int, color: int):
+        """仅显示一枚棋子（直播/联机同步用，不经过本地GameCore）"""
+        screen_x, screen_y = self.convert_board_to_screen(board_x, board_y)
+        self.pieces[(board_x, board_y)] = Piece(x=screen_x, y=screen_y, color=color, size=self.cell_size - 6, has_3d=True)
+
+    def show_position(self, board: List[List[int]], win_line: Optional[List[Tuple[int, int]]] = None):
+        """按整盘局面重绘（快照恢复），不经过本地GameCore"""
+        self.pieces.clear()
+        self.animating = False
+        self.animation_piece = None
+        for x, row in enumerate(board):
+            for y, color in enumerate(row):
+                if color != PIECE_COLORS['EMPTY']:
+                    self.show_piece(x, y, color)
+        self.win_line = list(win_line or [])
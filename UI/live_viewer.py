@@ -1,6 +1,8 @@
 import pygame
 from typing import List, Dict, Optional
 from Common.constants import COLORS
+from Common.data_utils import DataUtils
+from Common.wire_protocol import MoveSequencer, decode_snapshot, encode_resync
 from Network.live_stream import LiveStreamManager
 from UI.board import Board
 from UI.piece import Piece
@@ -25,6 +27,7 @@ class LiveViewer:
         self.host_name = ""
         self.viewer_count = 0
         self.board = Board(x + 50, y + 80, board_size, cell_size)  # 直播棋盘
+        self.sequencer = MoveSequencer()  # 直播落子增量按序号应用
         # 弹幕相关
         self.danmaku_list: List[Dict] = []
         self.danmaku_input_rect = pygame.Rect(x + 50, y + 600, 400, 35)
@@ -44,38 +47,58 @@ class LiveViewer:
         )
 
     def _on_live_data_received(self, data: Dict):
-        """直播数据回调：同步棋盘、弹幕等"""
+        """直播数据回调：同步棋盘、弹幕等（二进制帧由LiveStreamManager解码后回调）"""
         msg_type = data.get('type')
-        if msg_type == 'game_update':
-            # 同步棋盘状态
+        if msg_type == 'moves':
+            # 落子增量：按序号应用，断档时向服务器请求快照
+            for move in self.sequencer.push(data['moves']):
+                self.board.show_piece(move['x'], move['y'], move['color'])
+            if self.sequencer.needs_resync:
+                self.live_manager.send_frame(self.current_room_id, encode_resync(self.sequencer.seq))
+        elif msg_type == 'snapshot':
+            self._apply_snapshot(data)
+        elif msg_type == 'game_update':
+            # 旧版逐步消息
             game_data = data.get('data', {})
             if 'move' in game_data:
                 move = game_data['move']
-                self.board.place_piece(move['x'], move['y'], is_ai=move.get('is_ai', False))
+                self.board.show_piece(move['x'], move['y'], move['color'])
             if 'win_line' in game_data:
                 self.board.win_line = game_data['win_line']
+        elif msg_type == 'chat_batch':
+            for chat_data in data.get('messages', []):
+                self._add_danmaku(chat_data)
         elif msg_type == 'chat_message':
             # 接收弹幕
-            chat_data = data.get('data', {})
-            self.danmaku_list.append({
-                'user_name': chat_data.get('user_name', '匿名'),
-                'content': chat_data.get('content', ''),
-                'x': self.x + 50 + self.board_size * self.cell_size * 0.2,
-                'y': self.y + 80 + len(self.danmaku_list) * 20,
-                'alpha': 255
-            })
-            # 限制弹幕数量
-            if len(self.danmaku_list) > 15:
-                self.danmaku_list.pop(0)
+            self._add_danmaku(data.get('data', {}))
         elif msg_type == 'join_success':
             # 初始化直播间信息
             self.host_name = data.get('host_name', '未知主播')
             self.viewer_count = data.get('viewer_count', 0)
-            # 同步初始棋盘状态
+            # 同步初始棋盘状态：位棋盘快照，旧服务器下发board_to_str字符串
             current_game = data.get('current_game', {})
-            if 'board_state' in current_game:
-                # 简化实现：假设board_state为字符串格式，转换为棋盘
-                pass
+            if 'board_snapshot' in current_game:
+                self._apply_snapshot(decode_snapshot(current_game['board_snapshot']))
+            elif 'board_state' in current_game:
+                self.board.show_position(DataUtils.str_to_board(current_game['board_state']), current_game.get('win_line'))
+                self.sequencer.reset(current_game.get('move_count', 0))
+
+    def _apply_snapshot(self, snapshot: Dict):
+        """快照恢复直播棋盘，之后的增量从快照序号继续"""
+        self.board.show_position(snapshot['board'], snapshot['win_line'])
+        self.sequencer.reset(snapshot['seq'])
+
+    def _add_danmaku(self, chat_data: Dict):
+        self.danmaku_list.append({
+            'user_name': chat_data.get('user_name', '匿名'),
+            'content': chat_data.get('content', ''),
+            'x': self.x + 50 + self.board_size * self.cell_size * 0.2,
+            'y': self.y + 80 + len(self.danmaku_list) * 20,
+            'alpha': 255
+        })
+        # 限制弹幕数量
+        if len(self.danmaku_list) > 15:
+            self.danmaku_list.pop(0)
 
     def send_danmaku(self, user_name: str):
         """发送弹幕（对接LiveStreamManager）"""